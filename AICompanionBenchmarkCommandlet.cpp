@@ -0,0 +1,535 @@
+// AICompanionBenchmarkCommandlet.cpp
+// Benchmark cases and the counting allocator they run under
+
+#include "AICompanionBenchmarkCommandlet.h"
+#include "AICompanionLog.h"
+#include "AICompanionManager.h"
+#include "AICompanionProtocol.h"
+#include "AICompanionSendQueue.h"
+#include "AICompanionDateTimeParser.h"
+#include "AICompanionCalendarSlots.h"
+#include "AICompanionIntentClassifier.h"
+#include "HAL/MemoryBase.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include <atomic>
+
+namespace
+{
+	/** Forwards to the real allocator and counts what goes through it */
+	class FCountingMalloc final : public FMalloc
+	{
+	public:
+		explicit FCountingMalloc(FMalloc* InInner)
+			: Inner(InInner)
+		{
+		}
+
+		virtual void* Malloc(SIZE_T Count, uint32 Alignment) override
+		{
+			Record(Count);
+			return Inner->Malloc(Count, Alignment);
+		}
+
+		virtual void* Realloc(void* Original, SIZE_T Count, uint32 Alignment) override
+		{
+			// A shrink or free through Realloc is not an allocation
+			SIZE_T OldSize = 0;
+			if (Count > 0 && (!Original || !Inner->GetAllocationSize(Original, OldSize) || Count > OldSize))
+			{
+				Record(Count);
+			}
+			return Inner->Realloc(Original, Count, Alignment);
+		}
+
+		virtual void Free(void* Original) override
+		{
+			Inner->Free(Original);
+		}
+
+		virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override
+		{
+			return Inner->GetAllocationSize(Original, SizeOut);
+		}
+
+		virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override
+		{
+			return Inner->QuantizeSize(Count, Alignment);
+		}
+
+		virtual void Trim(bool bTrimThreadCaches) override
+		{
+			Inner->Trim(bTrimThreadCaches);
+		}
+
+		virtual bool IsInternallyThreadSafe() const override
+		{
+			return Inner->IsInternallyThreadSafe();
+		}
+
+		virtual const TCHAR* GetDescriptiveName() override
+		{
+			return TEXT("AICompanionBenchmark");
+		}
+
+		uint64 GetAllocations() const { return Allocations.load(std::memory_order_relaxed); }
+		uint64 GetBytes() const { return Bytes.load(std::memory_order_relaxed); }
+
+	private:
+		void Record(SIZE_T Size)
+		{
+			Allocations.fetch_add(1, std::memory_order_relaxed);
+			Bytes.fetch_add(Size, std::memory_order_relaxed);
+		}
+
+		FMalloc* Inner;
+		std::atomic<uint64> Allocations{ 0 };
+		std::atomic<uint64> Bytes{ 0 };
+	};
+
+	struct FBenchmarkResult
+	{
+		FString Name;
+		int32 PayloadBytes = 0;
+		double NanosPerOp = 0.0;
+		double AllocsPerOp = 0.0;
+		double BytesPerOp = 0.0;
+	};
+
+	class FBenchmarkRunner
+	{
+	public:
+		FBenchmarkRunner(int32 InIterations, const FString& InFilter)
+			: Iterations(FMath::Max(1, InIterations))
+			, Filter(InFilter)
+		{
+		}
+
+		/**
+		 * Time Iterations calls of Body(Index), each doing OpsPerCall operations.
+		 * Body returns false if the path under test misbehaved; the case then fails.
+		 */
+		template <typename FuncType>
+		void Run(const FString& Name, int32 PayloadBytes, int32 OpsPerCall, FuncType&& Body)
+		{
+			if (!Filter.IsEmpty() && !Name.Contains(Filter))
+			{
+				return;
+			}
+
+			// Warm up so grow-once buffers and lazily built tables are not counted
+			bool bOk = true;
+			const int32 Warmup = FMath::Clamp(Iterations / 10, 1, 1000);
+			for (int32 Index = 0; Index < Warmup && bOk; ++Index)
+			{
+				bOk = Body(Index);
+			}
+
+			uint64 Cycles = 0;
+			uint64 Allocations = 0;
+			uint64 Bytes = 0;
+			if (bOk)
+			{
+				// GMalloc is read on every allocation; swapping the pointer is safe because
+				// the wrapper forwards everything and owns nothing
+				FMalloc* const Previous = GMalloc;
+				FCountingMalloc Counter(Previous);
+				GMalloc = &Counter;
+
+				const uint64 Start = FPlatformTime::Cycles64();
+				for (int32 Index = 0; Index < Iterations; ++Index)
+				{
+					bOk &= Body(Index);
+				}
+				Cycles = FPlatformTime::Cycles64() - Start;
+
+				GMalloc = Previous;
+				Allocations = Counter.GetAllocations();
+				Bytes = Counter.GetBytes();
+			}
+
+			if (!bOk)
+			{
+				UE_LOG(LogAICompanion, Error, TEXT("[Benchmark] %s failed its check"), *Name);
+				++NumFailed;
+				return;
+			}
+
+			const double Ops = (double)Iterations * OpsPerCall;
+			FBenchmarkResult& Result = Results.AddDefaulted_GetRef();
+			Result.Name = Name;
+			Result.PayloadBytes = PayloadBytes;
+			Result.NanosPerOp = FPlatformTime::ToSeconds64(Cycles) * 1.0e9 / Ops;
+			Result.AllocsPerOp = Allocations / Ops;
+			Result.BytesPerOp = Bytes / Ops;
+
+			UE_LOG(LogAICompanion, Display, TEXT("[Benchmark] %-36s %6d B %12.1f ns/op %8.2f allocs/op %10.1f B/op"),
+				*Name, PayloadBytes, Result.NanosPerOp, Result.AllocsPerOp, Result.BytesPerOp);
+		}
+
+		bool WriteCsv(const FString& Path) const
+		{
+			FString Csv = TEXT("name,payload_bytes,ns_per_op,allocs_per_op,bytes_per_op\n");
+			for (const FBenchmarkResult& Result : Results)
+			{
+				Csv += FString::Printf(TEXT("%s,%d,%.1f,%.3f,%.1f\n"),
+					*Result.Name, Result.PayloadBytes, Result.NanosPerOp, Result.AllocsPerOp, Result.BytesPerOp);
+			}
+			return FFileHelper::SaveStringToFile(Csv, *Path);
+		}
+
+		int32 GetNumFailed() const { return NumFailed; }
+
+	private:
+		int32 Iterations;
+		FString Filter;
+		TArray<FBenchmarkResult> Results;
+		int32 NumFailed = 0;
+	};
+
+	/** Chat-like text of exactly Length characters, with the quotes and newlines that need escaping */
+	FString MakePayload(int32 Length)
+	{
+		static const TCHAR* Sentence = TEXT("Sure, I moved \"Team sync\" to 3pm tomorrow and kept the reminder.\n");
+
+		FString Payload;
+		Payload.Reserve(Length);
+		while (Payload.Len() < Length)
+		{
+			Payload += Sentence;
+		}
+		Payload.LeftInline(Length, EAllowShrinking::No);
+		return Payload;
+	}
+
+	/** Short chat line up to a large streamed-and-joined response */
+	const int32 PayloadSizes[] = { 32, 512, 2 * 1024, 8 * 1024 };
+
+	/** Frames handed to the decode pipeline between drains, about what one tick sees under load */
+	constexpr int32 DispatchBatch = 16;
+
+	const EAICompanionWireFormat Formats[] = { EAICompanionWireFormat::Json, EAICompanionWireFormat::Binary };
+
+	const TCHAR* FormatName(EAICompanionWireFormat Format)
+	{
+		return Format == EAICompanionWireFormat::Binary ? TEXT("Binary") : TEXT("Json");
+	}
+
+	/** What the backend sends back for a chat request */
+	void WriteChatResponse(FAICompanionMessageWriter& Writer, const FString& Text, int32 RequestId)
+	{
+		Writer.Begin(TEXT("chat_response"))
+			.WriteString(TEXT("message"), Text)
+			.WriteInt(TEXT("requestId"), RequestId)
+			.Finish();
+	}
+
+	bool DecodeFrame(const FAICompanionMessageWriter& Writer, FAICompanionInboundMessage& OutMessage)
+	{
+		return Writer.IsBinary()
+			? AICompanionProtocol::DecodeBinaryFrame(Writer.GetBytes().GetData(), Writer.GetBytes().Num(), OutMessage)
+			: AICompanionProtocol::DecodeJsonFrame(Writer.GetText(), OutMessage);
+	}
+
+	// ========================================
+	// CASES
+	// ========================================
+
+	void RunEncode(FBenchmarkRunner& Runner)
+	{
+		for (EAICompanionWireFormat Format : Formats)
+		{
+			FAICompanionMessageWriter Writer;
+			Writer.SetFormat(Format);
+
+			for (int32 Size : PayloadSizes)
+			{
+				// SendTestMessage / SendChatMessage
+				const FString Payload = MakePayload(Size);
+				Runner.Run(FString::Printf(TEXT("Encode.%s.Chat/%d"), FormatName(Format), Size), Size, 1,
+					[&Writer, &Payload](int32 Index)
+					{
+						Writer.Begin(TEXT("chat"))
+							.WriteString(TEXT("text"), Payload)
+							.WriteBool(TEXT("stream"), true)
+							.WriteInt(TEXT("requestId"), Index + 1)
+							.Finish();
+						return Writer.GetText().Len() + Writer.GetBytes().Num() > 0;
+					});
+			}
+
+			// SendEventToBackend
+			const FString Name = TEXT("Dentist appointment");
+			const FString Location = TEXT("Riverside Clinic, 2nd floor");
+			const FString Notes = MakePayload(128);
+			const FDateTime When(2026, 11, 5, 14, 30, 0);
+			Runner.Run(FString::Printf(TEXT("Encode.%s.CalendarEvent"), FormatName(Format)), Name.Len() + Location.Len() + Notes.Len(), 1,
+				[&](int32 Index)
+				{
+					Writer.Begin(TEXT("create_calendar_event"))
+						.WriteString(TEXT("eventName"), Name)
+						.WriteDateTime(TEXT("dateTime"), When)
+						.WriteInt(TEXT("durationMinutes"), 60)
+						.WriteString(TEXT("location"), Location)
+						.WriteString(TEXT("notes"), Notes)
+						.WriteInt(TEXT("priority"), 2)
+						.WriteInt(TEXT("requestId"), Index + 1)
+						.Finish();
+					return Writer.GetText().Len() + Writer.GetBytes().Num() > 0;
+				});
+		}
+	}
+
+	void RunSendQueue(FBenchmarkRunner& Runner)
+	{
+		FAICompanionSendQueue::FFlushParams Params;
+		Params.bCanBatch = true;
+		Params.bCanSendBinary = true;
+
+		for (EAICompanionWireFormat Format : Formats)
+		{
+			FAICompanionMessageWriter Writer;
+			Writer.SetFormat(Format);
+
+			for (int32 Size : PayloadSizes)
+			{
+				const FString Payload = MakePayload(Size);
+				Writer.Begin(TEXT("chat")).WriteString(TEXT("text"), Payload).WriteBool(TEXT("stream"), true).Finish();
+
+				FAICompanionSendQueue Queue(DispatchBatch);
+				Runner.Run(FString::Printf(TEXT("SendQueue.%s.Batched/%d"), FormatName(Format), Size), Size, DispatchBatch,
+					[&Writer, &Queue, &Params](int32 Index)
+					{
+						for (int32 Message = 0; Message < DispatchBatch; ++Message)
+						{
+							Queue.Enqueue(Writer);
+						}
+
+						int64 Sent = 0;
+						Queue.Flush(Params,
+							[&Sent](const FString& Frame) { Sent += Frame.Len(); },
+							[&Sent](const TArray<uint8>& Frame) { Sent += Frame.Num(); });
+						return Sent > 0 && Queue.IsEmpty();
+					});
+			}
+		}
+	}
+
+	void RunDecode(FBenchmarkRunner& Runner)
+	{
+		for (EAICompanionWireFormat Format : Formats)
+		{
+			for (int32 Size : PayloadSizes)
+			{
+				FAICompanionMessageWriter Writer;
+				Writer.SetFormat(Format);
+				WriteChatResponse(Writer, MakePayload(Size), 7);
+
+				Runner.Run(FString::Printf(TEXT("Decode.%s.ChatResponse/%d"), FormatName(Format), Size), Size, 1,
+					[&Writer, Size](int32 Index)
+					{
+						FAICompanionInboundMessage Message;
+						return DecodeFrame(Writer, Message) && Message.Text.Len() == Size && Message.RequestId == 7;
+					});
+			}
+		}
+
+		// What the backend sends once compression is negotiated: inflate, then decode
+		for (int32 Size : PayloadSizes)
+		{
+			FAICompanionMessageWriter Writer;
+			Writer.SetFormat(EAICompanionWireFormat::Binary);
+			WriteChatResponse(Writer, MakePayload(Size), 7);
+
+			TArray<uint8> Compressed;
+			if (!AICompanionProtocol::CompressBinaryFrame(Writer.GetBytes(), Compressed))
+			{
+				// Below the threshold; sent as an ordinary frame
+				continue;
+			}
+
+			Runner.Run(FString::Printf(TEXT("Decode.Compressed.ChatResponse/%d"), Size), Compressed.Num(), 1,
+				[&Compressed, Size](int32 Index)
+				{
+					FAICompanionInboundMessage Message;
+					return AICompanionProtocol::DecodeBinaryFrame(Compressed.GetData(), Compressed.Num(), Message)
+						&& Message.Text.Len() == Size && Message.RequestId == 7;
+				});
+		}
+	}
+
+	/**
+	 * HandleWebSocketMessage end to end: frames go into the decode pipeline the way the
+	 * socket hands them over, then are drained and routed through a handler map as in
+	 * AAICompanionManager::Tick. The loopback stands in for UWebSocketManager.
+	 */
+	void RunDispatch(FBenchmarkRunner& Runner)
+	{
+		for (EAICompanionWireFormat Format : Formats)
+		{
+			for (int32 Size : PayloadSizes)
+			{
+				FAICompanionMessageWriter Writer;
+				Writer.SetFormat(Format);
+				WriteChatResponse(Writer, MakePayload(Size), 7);
+
+				int64 Received = 0;
+				TMap<FName, FAICompanionMessageHandler> Handlers;
+				Handlers.Add(AICompanionMessageTypes::ChatResponse).BindLambda([&Received](const FAICompanionInboundMessage& Message)
+				{
+					Received += Message.Text.Len();
+				});
+
+				FAICompanionDecodePipeline Pipeline;
+				Runner.Run(FString::Printf(TEXT("Dispatch.%s.ChatResponse/%d"), FormatName(Format), Size), Size, DispatchBatch,
+					[&](int32 Index)
+					{
+						for (int32 Frame = 0; Frame < DispatchBatch; ++Frame)
+						{
+							if (Writer.IsBinary())
+							{
+								Pipeline.EnqueueBinary(Writer.GetBytes());
+							}
+							else
+							{
+								Pipeline.Enqueue(Writer.GetText());
+							}
+						}
+						Pipeline.Flush();
+
+						Received = 0;
+						FAICompanionInboundMessage Message;
+						while (Pipeline.Dequeue(Message))
+						{
+							if (const FAICompanionMessageHandler* Handler = Handlers.Find(Message.Type))
+							{
+								Handler->ExecuteIfBound(Message);
+							}
+						}
+						return Received == (int64)Size * DispatchBatch;
+					});
+			}
+		}
+	}
+
+	void RunCalendar(FBenchmarkRunner& Runner)
+	{
+		const FDateTime Now(2026, 10, 14, 9, 0, 0);
+
+		static const TCHAR* DateTimes[] =
+		{
+			TEXT("tomorrow at 2pm"),
+			TEXT("next friday at 10:30 a.m."),
+			TEXT("november 5 at noon"),
+			TEXT("in 3 days"),
+			TEXT("11/5/2026 14:30"),
+			TEXT("um, I think the day after tomorrow in the evening")
+		};
+		Runner.Run(TEXT("Calendar.ParseDateTime"), 0, UE_ARRAY_COUNT(DateTimes),
+			[&Now](int32 Index)
+			{
+				bool bOk = true;
+				for (const TCHAR* Input : DateTimes)
+				{
+					FDateTime Result;
+					bOk &= FAICompanionDateTimeParser::ParseDateTime(Input, Now, Result);
+				}
+				return bOk;
+			});
+
+		static const TCHAR* Durations[] =
+		{
+			TEXT("1 hour"),
+			TEXT("90 min"),
+			TEXT("1.5 hours"),
+			TEXT("an hour and a half"),
+			TEXT("1h30"),
+			TEXT("45")
+		};
+		Runner.Run(TEXT("Calendar.ParseDuration"), 0, UE_ARRAY_COUNT(Durations),
+			[](int32 Index)
+			{
+				bool bOk = true;
+				for (const TCHAR* Input : Durations)
+				{
+					bOk &= FAICompanionDateTimeParser::ParseDurationMinutes(Input) > 0;
+				}
+				return bOk;
+			});
+
+		// The number-reading that ExtractNumber used to do now happens inside these two
+		// parsers and the slot extractor, so it is covered by them
+		static const TCHAR* Requests[] =
+		{
+			TEXT("Schedule my dentist appointment tomorrow at 2pm for an hour at the clinic"),
+			TEXT("book a table for dinner on friday at 7:30 pm with Sam"),
+			TEXT("add an event team sync next monday at 10 for 45 minutes about the launch")
+		};
+		Runner.Run(TEXT("Calendar.ExtractSlots"), 0, UE_ARRAY_COUNT(Requests),
+			[&Now](int32 Index)
+			{
+				bool bOk = true;
+				for (const TCHAR* Input : Requests)
+				{
+					bOk &= FAICompanionCalendarSlots::Extract(Input, Now).Has(FAICompanionCalendarSlots::ESlot::DateTime);
+				}
+				return bOk;
+			});
+
+		Runner.Run(TEXT("Calendar.ClassifyIntent"), 0, UE_ARRAY_COUNT(Requests),
+			[](int32 Index)
+			{
+				bool bOk = true;
+				for (const TCHAR* Input : Requests)
+				{
+					bOk &= FAICompanionIntentClassifier::Classify(Input).Intent == EAICompanionIntent::CreateEvent;
+				}
+				return bOk;
+			});
+	}
+}
+
+UAICompanionBenchmarkCommandlet::UAICompanionBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsEditor = false;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UAICompanionBenchmarkCommandlet::Main(const FString& Params)
+{
+	int32 Iterations = 20000;
+	FParse::Value(*Params, TEXT("iterations="), Iterations);
+
+	FString Filter;
+	FParse::Value(*Params, TEXT("filter="), Filter);
+
+	FString CsvPath;
+	if (!FParse::Value(*Params, TEXT("csv="), CsvPath))
+	{
+		CsvPath = FPaths::ProjectSavedDir() / TEXT("AICompanion") / TEXT("Benchmark.csv");
+	}
+
+	UE_LOG(LogAICompanion, Display, TEXT("[Benchmark] %d iterations per case%s%s"),
+		Iterations, Filter.IsEmpty() ? TEXT("") : TEXT(", filter "), *Filter);
+
+	FBenchmarkRunner Runner(Iterations, Filter);
+	RunEncode(Runner);
+	RunSendQueue(Runner);
+	RunDecode(Runner);
+	RunDispatch(Runner);
+	RunCalendar(Runner);
+
+	if (Runner.WriteCsv(CsvPath))
+	{
+		UE_LOG(LogAICompanion, Display, TEXT("[Benchmark] Results written to %s"), *CsvPath);
+	}
+	else
+	{
+		UE_LOG(LogAICompanion, Warning, TEXT("[Benchmark] Could not write %s"), *CsvPath);
+	}
+
+	return Runner.GetNumFailed() == 0 ? 0 : 1;
+}
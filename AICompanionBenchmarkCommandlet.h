@@ -0,0 +1,30 @@
+// AICompanionBenchmarkCommandlet.h
+// Micro-benchmarks for the client message path, for CI figures
+//
+//   UnrealEditor-Cmd <Project> -run=AICompanionBenchmark [-iterations=20000] [-filter=Decode] [-csv=Out.csv]
+//
+// Covers outbound encode and send-queue flush, inbound decode (plain and compressed), decode-to-handler
+// dispatch through a loopback (frames go straight into the decode pipeline, as the
+// socket would hand them over), and the calendar parsers. Each case reports ns/op,
+// allocations/op and bytes allocated/op for payloads from a short chat line up to
+// an 8 KB response. Allocations are counted by wrapping GMalloc while a case runs.
+//
+// Returns non-zero if a case fails its sanity check (a frame that does not decode,
+// a phrase that does not parse), so a broken path cannot post a fast number.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "AICompanionBenchmarkCommandlet.generated.h"
+
+UCLASS()
+class JOEVISV3V1_API UAICompanionBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UAICompanionBenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
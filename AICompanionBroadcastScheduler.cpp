@@ -0,0 +1,117 @@
+// AICompanionBroadcastScheduler.cpp
+// Priority FIFOs and the per-frame delivery loop
+
+#include "AICompanionBroadcastScheduler.h"
+#include "AICompanionLog.h"
+#include "HAL/PlatformTime.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Deferred Broadcasts"), STAT_AICompanion_DeferredBroadcasts, STATGROUP_AICompanion);
+
+void FAICompanionBroadcastScheduler::Enqueue(EAICompanionBroadcastPriority Priority, const UObject* Owner, TUniqueFunction<void()>&& Delivery)
+{
+	if (BudgetSeconds <= 0.0)
+	{
+		Delivery();
+		return;
+	}
+
+	FEntry& Entry = Queues[(int32)Priority].AddDefaulted_GetRef();
+	Entry.Owner = Owner;
+	Entry.Delivery = MoveTemp(Delivery);
+}
+
+int32 FAICompanionBroadcastScheduler::Deliver()
+{
+	// Counts are taken up front, so whatever a handler queues waits for the next frame
+	const int32 HighCount = Queues[(int32)EAICompanionBroadcastPriority::High].Num() - Heads[(int32)EAICompanionBroadcastPriority::High];
+	const int32 NormalCount = Queues[(int32)EAICompanionBroadcastPriority::Normal].Num() - Heads[(int32)EAICompanionBroadcastPriority::Normal];
+
+	const uint64 Start = FPlatformTime::Cycles64();
+	const uint32 StartGeneration = Generation;
+	int32 Delivered = DeliverFrom(EAICompanionBroadcastPriority::High, HighCount, MAX_uint64);
+
+	// A handler tore the owner down (e.g. destroyed the manager); nothing left to deliver
+	if (Generation != StartGeneration)
+	{
+		return Delivered;
+	}
+
+	if (NormalCount > 0)
+	{
+		// High entries spend the budget too, but at least one Normal entry goes out per frame
+		const uint64 Deadline = Start + (uint64)(BudgetSeconds / FPlatformTime::GetSecondsPerCycle64());
+		const int32 NormalDelivered = DeliverFrom(EAICompanionBroadcastPriority::Normal, NormalCount, FMath::Max(Deadline, FPlatformTime::Cycles64() + 1));
+		Delivered += NormalDelivered;
+
+		if (NormalDelivered < NormalCount)
+		{
+			++DeferredFrames;
+			INC_DWORD_STAT_BY(STAT_AICompanion_DeferredBroadcasts, NormalCount - NormalDelivered);
+			UE_LOG(LogAICompanion, VeryVerbose, TEXT("[AICompanionBroadcastScheduler] Budget spent after %d broadcasts, %d deferred"), Delivered, NormalCount - NormalDelivered);
+		}
+	}
+
+	return Delivered;
+}
+
+int32 FAICompanionBroadcastScheduler::DeliverFrom(EAICompanionBroadcastPriority Priority, int32 Limit, uint64 Deadline)
+{
+	TArray<FEntry>& Queue = Queues[(int32)Priority];
+	int32& Head = Heads[(int32)Priority];
+
+	const uint32 StartGeneration = Generation;
+
+	int32 Delivered = 0;
+	while (Delivered < Limit && Head < Queue.Num())
+	{
+		// Moved out first: the handler may queue more, which can reallocate the array
+		FEntry& Entry = Queue[Head++];
+		const bool bOwnerAlive = Entry.Owner.IsValid();
+		TUniqueFunction<void()> Delivery = MoveTemp(Entry.Delivery);
+		++Delivered;
+
+		if (bOwnerAlive)
+		{
+			Delivery();
+		}
+
+		// Reset from inside the handler: Queue and Head have been emptied under us
+		if (Generation != StartGeneration)
+		{
+			return Delivered;
+		}
+
+		if (FPlatformTime::Cycles64() >= Deadline)
+		{
+			break;
+		}
+	}
+
+	if (Head == Queue.Num())
+	{
+		Queue.Reset();
+		Head = 0;
+	}
+
+	return Delivered;
+}
+
+void FAICompanionBroadcastScheduler::Reset()
+{
+	++Generation;
+	for (int32 Priority = 0; Priority < (int32)EAICompanionBroadcastPriority::Count; ++Priority)
+	{
+		Queues[Priority].Reset();
+		Heads[Priority] = 0;
+	}
+}
+
+int32 FAICompanionBroadcastScheduler::Num() const
+{
+	int32 Queued = 0;
+	for (int32 Priority = 0; Priority < (int32)EAICompanionBroadcastPriority::Count; ++Priority)
+	{
+		Queued += Queues[Priority].Num() - Heads[Priority];
+	}
+	return Queued;
+}
@@ -0,0 +1,71 @@
+// AICompanionBroadcastScheduler.h
+// Spreads Blueprint event delivery over frames under a time budget
+//
+// Handlers bound to OnAIResponseReceived, OnAskQuestion and the like often do
+// heavy UI work. Running them inline means a burst of replies lands in one frame
+// and becomes a hitch. Instead, broadcasts are queued here and delivered from the
+// manager's Tick until the frame's budget is spent; the rest wait for the next
+// frame. High priority entries (errors, connection status) go before everything
+// else and are never deferred. Within a priority, delivery order is queue order.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/WeakObjectPtr.h"
+
+enum class EAICompanionBroadcastPriority : uint8
+{
+	/** Errors and connection status: delivered first, whatever the budget */
+	High,
+
+	/** Responses, questions, events */
+	Normal,
+
+	Count
+};
+
+class FAICompanionBroadcastScheduler
+{
+public:
+	/** Per-frame budget for Normal deliveries; 0 delivers every broadcast inline from Enqueue */
+	void SetBudget(float Milliseconds) { BudgetSeconds = FMath::Max(Milliseconds, 0.0f) / 1000.0; }
+
+	/** Queue Delivery; skipped if Owner has been destroyed by the time it is due */
+	void Enqueue(EAICompanionBroadcastPriority Priority, const UObject* Owner, TUniqueFunction<void()>&& Delivery);
+
+	/**
+	 * Run every High entry, then Normal entries until the budget is spent (at least
+	 * one, so a backlog always drains). Entries queued while delivering wait for
+	 * the next call. Returns the number delivered.
+	 */
+	int32 Deliver();
+
+	/** Drop everything queued without delivering it; safe from inside a handler (Deliver stops there) */
+	void Reset();
+
+	bool IsEmpty() const { return Num() == 0; }
+	int32 Num() const;
+
+	/** Calls to Deliver() that ran out of budget with entries left over */
+	uint64 GetDeferredFrameCount() const { return DeferredFrames; }
+
+private:
+	struct FEntry
+	{
+		TWeakObjectPtr<const UObject> Owner;
+		TUniqueFunction<void()> Delivery;
+	};
+
+	/** Run entries of one priority from its head; stops at Limit entries or once Deadline (cycles) passes */
+	int32 DeliverFrom(EAICompanionBroadcastPriority Priority, int32 Limit, uint64 Deadline);
+
+	/** One FIFO per priority; consumed from Heads[] and reset once empty so capacity is reused */
+	TArray<FEntry> Queues[(int32)EAICompanionBroadcastPriority::Count];
+	int32 Heads[(int32)EAICompanionBroadcastPriority::Count] = {};
+
+	/** Bumped by Reset; a delivery loop that sees it change stops without touching the queues again */
+	uint32 Generation = 0;
+
+	double BudgetSeconds = 0.002;
+	uint64 DeferredFrames = 0;
+};
@@ -0,0 +1,219 @@
+// AICompanionCalendarIndex.cpp
+// Sorted interval index over the player's upcoming events
+
+#include "AICompanionCalendarIndex.h"
+#include "Dom/JsonObject.h"
+#include "Algo/BinarySearch.h"
+#include "Algo/StableSort.h"
+
+namespace
+{
+	/**
+	 * The backend stores times as the client wrote them (local wall-clock time with a
+	 * Z suffix), so parsing as-is gives back the same wall-clock the client compares
+	 * against FDateTime::Now().
+	 */
+	bool ParseTime(const FJsonObject& Event, const TCHAR* Key, FDateTime& OutTime)
+	{
+		FString Iso;
+		return Event.TryGetStringField(Key, Iso) && FDateTime::ParseIso8601(*Iso, OutTime);
+	}
+}
+
+void FAICompanionCalendarIndex::Reset()
+{
+	Entries.Reset();
+	StartById.Reset();
+	MaxDuration = FTimespan::Zero();
+	Revision = 0;
+	bSynced = false;
+}
+
+bool FAICompanionCalendarIndex::ApplySnapshot(const FJsonObject& Payload)
+{
+	const TArray<TSharedPtr<FJsonValue>>* Events = nullptr;
+	if (!Payload.TryGetArrayField(TEXT("events"), Events))
+	{
+		return false;
+	}
+
+	Entries.Reset(Events->Num());
+	StartById.Reset();
+	MaxDuration = FTimespan::Zero();
+
+	for (const TSharedPtr<FJsonValue>& Value : *Events)
+	{
+		const TSharedPtr<FJsonObject>* Event = nullptr;
+		FEntry Entry;
+		if (Value.IsValid() && Value->TryGetObject(Event) && ParseEvent(**Event, Entry))
+		{
+			StartById.Add(Entry.EventId, Entry.Start);
+			MaxDuration = FMath::Max(MaxDuration, Entry.End - Entry.Start);
+			Entries.Add(MoveTemp(Entry));
+		}
+	}
+
+	// The backend sends them in start order already; a stable sort keeps that cheap
+	Algo::StableSortBy(Entries, &FEntry::Start);
+
+	Revision = 0;
+	Payload.TryGetNumberField(TEXT("revision"), Revision);
+	bSynced = true;
+	return true;
+}
+
+FAICompanionCalendarIndex::EDeltaResult FAICompanionCalendarIndex::ApplyDelta(const FJsonObject& Payload)
+{
+	int64 DeltaRevision = 0;
+	if (!bSynced || !Payload.TryGetNumberField(TEXT("revision"), DeltaRevision))
+	{
+		bSynced = false;
+		return EDeltaResult::NeedsSync;
+	}
+	if (DeltaRevision <= Revision)
+	{
+		return EDeltaResult::Stale;
+	}
+	if (DeltaRevision != Revision + 1)
+	{
+		bSynced = false;
+		return EDeltaResult::NeedsSync;
+	}
+
+	FString Op;
+	Payload.TryGetStringField(TEXT("op"), Op);
+
+	const TSharedPtr<FJsonObject>* Event = nullptr;
+	if (Op == TEXT("upsert") && Payload.TryGetObjectField(TEXT("event"), Event))
+	{
+		FEntry Entry;
+		if (ParseEvent(**Event, Entry))
+		{
+			Upsert(MoveTemp(Entry));
+		}
+		else
+		{
+			// Completed or cancelled: no longer something to schedule around
+			FString EventId;
+			(*Event)->TryGetStringField(TEXT("eventId"), EventId);
+			Remove(EventId);
+		}
+	}
+	else if (Op == TEXT("remove"))
+	{
+		FString EventId;
+		Payload.TryGetStringField(TEXT("eventId"), EventId);
+		Remove(EventId);
+	}
+
+	Revision = DeltaRevision;
+	return EDeltaResult::Applied;
+}
+
+void FAICompanionCalendarIndex::Upsert(FEntry&& Entry)
+{
+	Remove(Entry.EventId);
+
+	StartById.Add(Entry.EventId, Entry.Start);
+	MaxDuration = FMath::Max(MaxDuration, Entry.End - Entry.Start);
+
+	// After any entries with the same start, so equal starts keep arrival order
+	const int32 Index = Algo::UpperBoundBy(Entries, Entry.Start, &FEntry::Start);
+	Entries.Insert(MoveTemp(Entry), Index);
+}
+
+bool FAICompanionCalendarIndex::Remove(const FString& EventId)
+{
+	const int32 Index = IndexOf(EventId);
+	if (Index == INDEX_NONE)
+	{
+		return false;
+	}
+
+	StartById.Remove(EventId);
+	Entries.RemoveAt(Index, 1, EAllowShrinking::No);
+	return true;
+}
+
+int32 FAICompanionCalendarIndex::FindOverlaps(const FDateTime& Start, const FDateTime& End, TArray<const FEntry*>& Out, const FString& ExcludeId) const
+{
+	const int32 NumBefore = Out.Num();
+
+	// Nothing that starts earlier than this can still be running at Start
+	for (int32 Index = LowerBound(Start - MaxDuration); Index < Entries.Num() && Entries[Index].Start < End; ++Index)
+	{
+		const FEntry& Entry = Entries[Index];
+		if (Entry.End > Start && Entry.EventId != ExcludeId)
+		{
+			Out.Add(&Entry);
+		}
+	}
+	return Out.Num() - NumBefore;
+}
+
+int32 FAICompanionCalendarIndex::GetUpcoming(const FDateTime& Now, int32 MaxCount, TArray<const FEntry*>& Out) const
+{
+	const int32 NumBefore = Out.Num();
+
+	for (int32 Index = LowerBound(Now - MaxDuration); Index < Entries.Num() && Out.Num() - NumBefore < MaxCount; ++Index)
+	{
+		if (Entries[Index].End > Now)
+		{
+			Out.Add(&Entries[Index]);
+		}
+	}
+	return Out.Num() - NumBefore;
+}
+
+const FAICompanionCalendarIndex::FEntry* FAICompanionCalendarIndex::Find(const FString& EventId) const
+{
+	const int32 Index = IndexOf(EventId);
+	return Index != INDEX_NONE ? &Entries[Index] : nullptr;
+}
+
+bool FAICompanionCalendarIndex::ParseEvent(const FJsonObject& Event, FEntry& OutEntry)
+{
+	FString Status;
+	if (Event.TryGetStringField(TEXT("status"), Status) && (Status == TEXT("completed") || Status == TEXT("cancelled")))
+	{
+		return false;
+	}
+
+	if (!Event.TryGetStringField(TEXT("eventId"), OutEntry.EventId) || OutEntry.EventId.IsEmpty()
+		|| !ParseTime(Event, TEXT("startTime"), OutEntry.Start)
+		|| !ParseTime(Event, TEXT("endTime"), OutEntry.End))
+	{
+		return false;
+	}
+
+	// A zero-length or inverted event still blocks its start time
+	OutEntry.End = FMath::Max(OutEntry.End, OutEntry.Start + FTimespan::FromMinutes(1.0));
+
+	Event.TryGetStringField(TEXT("title"), OutEntry.Title);
+	Event.TryGetStringField(TEXT("location"), OutEntry.Location);
+	Event.TryGetNumberField(TEXT("priority"), OutEntry.Priority);
+	return true;
+}
+
+int32 FAICompanionCalendarIndex::LowerBound(const FDateTime& Start) const
+{
+	return Algo::LowerBoundBy(Entries, Start, &FEntry::Start);
+}
+
+int32 FAICompanionCalendarIndex::IndexOf(const FString& EventId) const
+{
+	const FDateTime* Start = StartById.Find(EventId);
+	if (!Start)
+	{
+		return INDEX_NONE;
+	}
+
+	for (int32 Index = LowerBound(*Start); Index < Entries.Num() && Entries[Index].Start == *Start; ++Index)
+	{
+		if (Entries[Index].EventId == EventId)
+		{
+			return Index;
+		}
+	}
+	return INDEX_NONE;
+}
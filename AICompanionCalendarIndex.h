@@ -0,0 +1,99 @@
+// AICompanionCalendarIndex.h
+// Client-side copy of the player's upcoming events, for conflict checks and "what's next"
+//
+// The backend sends a calendar_sync snapshot after register or resume, then a
+// calendar_delta for every change, each stamped with the player's calendar revision.
+// A delta that skips a revision means one was missed; the caller then asks for a
+// fresh snapshot. Completed and cancelled events are not kept.
+//
+// Entries are sorted by start time. An overlap query binary-searches for the first
+// event that could still be running (start >= query start - longest duration) and
+// scans forward until events start after the query ends.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FJsonObject;
+
+class FAICompanionCalendarIndex
+{
+public:
+	struct FEntry
+	{
+		FString EventId;
+		FString Title;
+		FString Location;
+		FDateTime Start;
+		FDateTime End;
+		int32 Priority = 5;
+	};
+
+	enum class EDeltaResult : uint8
+	{
+		Applied,
+
+		/** At or before the current revision (already in the last snapshot) */
+		Stale,
+
+		/** A revision was skipped, or no snapshot yet; the index needs a calendar_sync */
+		NeedsSync
+	};
+
+	/** Forget everything (e.g. a new player session) */
+	void Reset();
+
+	/** Replace the contents with a calendar_sync payload: { revision, events: [...] } */
+	bool ApplySnapshot(const FJsonObject& Payload);
+
+	/** Apply a calendar_delta payload: { revision, op: upsert | remove, event | eventId } */
+	EDeltaResult ApplyDelta(const FJsonObject& Payload);
+
+	/** Insert, or replace the entry with the same EventId */
+	void Upsert(FEntry&& Entry);
+
+	bool Remove(const FString& EventId);
+
+	/** Events overlapping [Start, End) in start order, skipping ExcludeId. Returns how many were added. */
+	int32 FindOverlaps(const FDateTime& Start, const FDateTime& End, TArray<const FEntry*>& Out, const FString& ExcludeId = FString()) const;
+
+	/** Up to MaxCount events still running at Now or starting after it, in start order */
+	int32 GetUpcoming(const FDateTime& Now, int32 MaxCount, TArray<const FEntry*>& Out) const;
+
+	/** Entry by id, or null */
+	const FEntry* Find(const FString& EventId) const;
+
+	/** All entries in start order */
+	TConstArrayView<FEntry> GetEntries() const { return Entries; }
+
+	/** A snapshot has been applied and no delta has been missed since */
+	bool IsSynced() const { return bSynced; }
+
+	int64 GetRevision() const { return Revision; }
+	int32 Num() const { return Entries.Num(); }
+
+	/**
+	 * Read a backend event (eventId, title, startTime, endTime, location, priority).
+	 * False if it has no id or usable times, or its status is completed or cancelled.
+	 */
+	static bool ParseEvent(const FJsonObject& Event, FEntry& OutEntry);
+
+private:
+	/** First entry that does not start before Start */
+	int32 LowerBound(const FDateTime& Start) const;
+
+	/** Index of EventId's entry, or INDEX_NONE */
+	int32 IndexOf(const FString& EventId) const;
+
+	/** Sorted by Start */
+	TArray<FEntry> Entries;
+
+	/** EventId -> Start, so lookups by id binary-search instead of scanning */
+	TMap<FString, FDateTime> StartById;
+
+	/** Upper bound on any entry's duration; only grows until the next snapshot */
+	FTimespan MaxDuration = FTimespan::Zero();
+
+	int64 Revision = 0;
+	bool bSynced = false;
+};
@@ -0,0 +1,451 @@
+// AICompanionCalendarSlots.cpp
+// Clause splitting and slot assignment for one-shot event requests
+
+#include "AICompanionCalendarSlots.h"
+#include "AICompanionDateTimeParser.h"
+#include "Misc/StringBuilder.h"
+
+namespace AICompanionCalendarSlotsPrivate
+{
+	using EWordClass = FAICompanionDateTimeParser::EWordClass;
+
+	struct FWord
+	{
+		/** Trimmed of surrounding punctuation; a view into the utterance */
+		FStringView Text;
+		int32 Start = 0;
+		int32 End = 0;
+		EWordClass Class = EWordClass::Other;
+
+		/** Taken by an earlier pass (priority words, a length split off a date) */
+		bool bUsed = false;
+	};
+
+	using FWordArray = TArray<FWord, TInlineAllocator<48>>;
+
+	static bool Is(const FWord& Word, const TCHAR* Text)
+	{
+		return Word.Text.Equals(Text, ESearchCase::IgnoreCase);
+	}
+
+	static bool IsAny(const FWord& Word, std::initializer_list<const TCHAR*> Texts)
+	{
+		for (const TCHAR* Text : Texts)
+		{
+			if (Is(Word, Text))
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/** Words that start a clause */
+	static bool IsMarker(const FWord& Word)
+	{
+		return IsAny(Word, { TEXT("for"), TEXT("at"), TEXT("in"), TEXT("on"), TEXT("with"), TEXT("about") });
+	}
+
+	/** Glue inside date phrases ("the 5th of november", "an hour and a half", "2 weeks from now") */
+	static bool IsDateGlue(const FWord& Word)
+	{
+		return IsAny(Word, { TEXT("the"), TEXT("of"), TEXT("from"), TEXT("now"), TEXT("later"), TEXT("a"), TEXT("an"), TEXT("half"), TEXT("and") });
+	}
+
+	/** Request wording in front of the event name ("can you schedule a ...") */
+	static bool IsLeadingFiller(const FWord& Word)
+	{
+		return IsAny(Word, {
+			TEXT("please"), TEXT("can"), TEXT("could"), TEXT("would"), TEXT("you"), TEXT("i"), TEXT("i'd"), TEXT("want"),
+			TEXT("need"), TEXT("like"), TEXT("to"), TEXT("let's"), TEXT("schedule"), TEXT("create"), TEXT("add"), TEXT("book"),
+			TEXT("set"), TEXT("up"), TEXT("make"), TEXT("plan"), TEXT("put"), TEXT("new"), TEXT("a"), TEXT("an"), TEXT("my"),
+			TEXT("the"), TEXT("calendar"), TEXT("event"), TEXT("me"), TEXT("us") });
+	}
+
+	static bool IsDateish(const FWord& Word)
+	{
+		return Word.Class != EWordClass::Other || IsDateGlue(Word);
+	}
+
+	static void SplitWords(FStringView Utterance, FWordArray& OutWords)
+	{
+		const int32 Len = Utterance.Len();
+		int32 Pos = 0;
+		while (Pos < Len)
+		{
+			while (Pos < Len && FChar::IsWhitespace(Utterance[Pos]))
+			{
+				++Pos;
+			}
+			int32 Start = Pos;
+			while (Pos < Len && !FChar::IsWhitespace(Utterance[Pos]))
+			{
+				++Pos;
+			}
+			int32 End = Pos;
+
+			auto IsTrim = [](TCHAR Char) { return FCString::Strchr(TEXT(",.;:!?\"()"), Char) != nullptr; };
+			while (Start < End && IsTrim(Utterance[Start]))
+			{
+				++Start;
+			}
+			while (End > Start && IsTrim(Utterance[End - 1]))
+			{
+				--End;
+			}
+
+			if (End > Start)
+			{
+				FWord& Word = OutWords.AddDefaulted_GetRef();
+				Word.Text = Utterance.Mid(Start, End - Start);
+				Word.Start = Start;
+				Word.End = End;
+				Word.Class = FAICompanionDateTimeParser::ClassifyWord(Word.Text);
+			}
+		}
+
+		// "may", "sat": a date next to a day number ("may 5", "5th of may") or after next/this/on, otherwise just a word
+		auto IsDayNumber = [&OutWords](int32 Index)
+		{
+			return OutWords.IsValidIndex(Index) && FChar::IsDigit(OutWords[Index].Text[0])
+				&& (OutWords[Index].Class == EWordClass::Number || OutWords[Index].Class == EWordClass::DateTime);
+		};
+		for (int32 Index = 0; Index < OutWords.Num(); ++Index)
+		{
+			FWord& Word = OutWords[Index];
+			if (Word.Class == EWordClass::ContextualDate)
+			{
+				const bool bInContext = IsDayNumber(Index - 1) || IsDayNumber(Index + 1)
+					|| (Index > 0 && IsAny(OutWords[Index - 1], { TEXT("next"), TEXT("this"), TEXT("on") }))
+					|| (Index > 1 && Is(OutWords[Index - 1], TEXT("of")) && IsDayNumber(Index - 2));
+				Word.Class = bInContext ? EWordClass::DateTime : EWordClass::Other;
+			}
+		}
+	}
+
+	/** "urgent", "high priority", "priority 7"; marks the words used */
+	static int32 TakePriority(FWordArray& Words)
+	{
+		for (int32 Index = 0; Index < Words.Num(); ++Index)
+		{
+			FWord& Word = Words[Index];
+			if (IsAny(Word, { TEXT("urgent"), TEXT("important") }))
+			{
+				Word.bUsed = true;
+				return Is(Word, TEXT("urgent")) ? 9 : 8;
+			}
+			if (Is(Word, TEXT("priority")))
+			{
+				Word.bUsed = true;
+				if (Index > 0 && IsAny(Words[Index - 1], { TEXT("high"), TEXT("top") }))
+				{
+					Words[Index - 1].bUsed = true;
+					return 8;
+				}
+				if (Index > 0 && Is(Words[Index - 1], TEXT("low")))
+				{
+					Words[Index - 1].bUsed = true;
+					return 3;
+				}
+				if (Index + 1 < Words.Num() && Words[Index + 1].Class == EWordClass::Number)
+				{
+					Words[Index + 1].bUsed = true;
+					return FMath::Clamp(FCString::Atoi(Words[Index + 1].Text.GetData()), 1, 10);
+				}
+			}
+		}
+		return 0;
+	}
+
+	/**
+	 * First index of the date phrase ending the range [First, Last], or Last + 1 if none.
+	 * A bare number only counts when a suffix or another date word pins it down,
+	 * so "room 3 tomorrow" keeps "room 3" and "november 5" stays together.
+	 */
+	static int32 FindTrailingDate(const FWordArray& Words, int32 First, int32 Last)
+	{
+		int32 Begin = Last + 1;
+		for (int32 Index = Last; Index >= First; --Index)
+		{
+			const FWord& Word = Words[Index];
+			if (Word.bUsed)
+			{
+				continue;
+			}
+			if (Word.Class == EWordClass::Number)
+			{
+				const bool bSuffixed = Index < Last && (Words[Index + 1].Class == EWordClass::NumberSuffix || Words[Index + 1].Class == EWordClass::Unit);
+				const bool bAfterDate = Index > First && Words[Index - 1].Class == EWordClass::DateTime;
+				if (!bSuffixed && !bAfterDate)
+				{
+					break;
+				}
+			}
+			else if (!IsDateish(Word))
+			{
+				break;
+			}
+			Begin = Index;
+		}
+
+		// Glue at the front belongs to neither side ("dentist [the] day after tomorrow")
+		while (Begin <= Last && (Words[Begin].bUsed || (Words[Begin].Class == EWordClass::Other && IsDateGlue(Words[Begin]))))
+		{
+			++Begin;
+		}
+		return Begin;
+	}
+
+	static bool IsAllDateish(const FWordArray& Words, int32 First, int32 Last)
+	{
+		bool bAnyDate = false;
+		for (int32 Index = First; Index <= Last; ++Index)
+		{
+			if (Words[Index].bUsed)
+			{
+				continue;
+			}
+			if (!IsDateish(Words[Index]))
+			{
+				return false;
+			}
+			bAnyDate |= Words[Index].Class != EWordClass::Other;
+		}
+		return bAnyDate;
+	}
+
+	/**
+	 * The length phrase around the first unit in [First, Last] ("2 hours", "an hour and a half"),
+	 * as the range [OutBegin, OutEnd]. False if the range has no unit.
+	 */
+	static bool FindDuration(const FWordArray& Words, int32 First, int32 Last, int32& OutBegin, int32& OutEnd)
+	{
+		auto IsLengthWord = [&Words](int32 Index)
+		{
+			const FWord& Word = Words[Index];
+			return !Word.bUsed && (Word.Class == EWordClass::Number || Word.Class == EWordClass::Unit
+				|| IsAny(Word, { TEXT("a"), TEXT("an"), TEXT("and"), TEXT("half") }));
+		};
+
+		int32 Unit = First;
+		while (Unit <= Last && (Words[Unit].bUsed || Words[Unit].Class != EWordClass::Unit))
+		{
+			++Unit;
+		}
+		if (Unit > Last)
+		{
+			return false;
+		}
+
+		OutBegin = Unit;
+		while (OutBegin > First && IsLengthWord(OutBegin - 1))
+		{
+			--OutBegin;
+		}
+		OutEnd = Unit;
+		while (OutEnd < Last && IsLengthWord(OutEnd + 1))
+		{
+			++OutEnd;
+		}
+
+		// "2 hours and tomorrow": the "and" joins, it does not lengthen
+		while (OutEnd > Unit && IsAny(Words[OutEnd], { TEXT("a"), TEXT("an"), TEXT("and") }))
+		{
+			--OutEnd;
+		}
+		return true;
+	}
+
+	static void AppendWords(TStringBuilderBase<TCHAR>& Out, const FWordArray& Words, int32 First, int32 Last)
+	{
+		for (int32 Index = First; Index <= Last; ++Index)
+		{
+			if (!Words[Index].bUsed)
+			{
+				if (Out.Len() > 0)
+				{
+					Out.AppendChar(TEXT(' '));
+				}
+				Out.Append(Words[Index].Text);
+			}
+		}
+	}
+
+	/** The original text from word First to word Last, skipping used words at either end */
+	static FString SpanText(FStringView Utterance, const FWordArray& Words, int32 First, int32 Last)
+	{
+		while (First <= Last && Words[First].bUsed)
+		{
+			++First;
+		}
+		while (Last >= First && Words[Last].bUsed)
+		{
+			--Last;
+		}
+		if (First > Last)
+		{
+			return FString();
+		}
+		return FString(Utterance.Mid(Words[First].Start, Words[Last].End - Words[First].Start));
+	}
+}
+
+FAICompanionCalendarSlots FAICompanionCalendarSlots::Extract(FStringView Utterance, const FDateTime& Now)
+{
+	using namespace AICompanionCalendarSlotsPrivate;
+
+	FAICompanionCalendarSlots Slots;
+
+	FWordArray Words;
+	SplitWords(Utterance, Words);
+	if (Words.Num() == 0)
+	{
+		return Slots;
+	}
+
+	Slots.Priority = TakePriority(Words);
+	if (Slots.Priority > 0)
+	{
+		Slots.Set(ESlot::Priority);
+	}
+
+	TStringBuilder<128> DateText;
+	TStringBuilder<128> DurationText;
+
+	int32 ClauseStart = 0;
+	while (ClauseStart < Words.Num())
+	{
+		int32 ClauseEnd = ClauseStart + 1;
+		while (ClauseEnd < Words.Num() && !IsMarker(Words[ClauseEnd]))
+		{
+			++ClauseEnd;
+		}
+
+		const FWord* Marker = IsMarker(Words[ClauseStart]) ? &Words[ClauseStart] : nullptr;
+		const int32 First = Marker ? ClauseStart + 1 : ClauseStart;
+		const int32 Last = ClauseEnd - 1;
+		ClauseStart = ClauseEnd;
+
+		if (First > Last)
+		{
+			continue;
+		}
+
+		if (Marker && Is(*Marker, TEXT("for")))
+		{
+			// "for an hour" is a length; "for tomorrow" a date; "for mom's birthday" a note
+			if (IsAllDateish(Words, First, Last))
+			{
+				bool bHasUnit = false;
+				bool bHasDate = false;
+				for (int32 Index = First; Index <= Last; ++Index)
+				{
+					bHasUnit |= Words[Index].Class == EWordClass::Unit;
+					bHasDate |= Words[Index].Class == EWordClass::DateTime;
+				}
+
+				if (bHasUnit && !bHasDate)
+				{
+					AppendWords(DurationText, Words, First, Last);
+					continue;
+				}
+
+				// "for 2 hours tomorrow": the length is not an offset from the date
+				int32 DurationBegin = 0;
+				int32 DurationEnd = 0;
+				if (bHasUnit && FindDuration(Words, First, Last, DurationBegin, DurationEnd))
+				{
+					AppendWords(DurationText, Words, DurationBegin, DurationEnd);
+					for (int32 Index = DurationBegin; Index <= DurationEnd; ++Index)
+					{
+						Words[Index].bUsed = true;
+					}
+				}
+				AppendWords(DateText, Words, First, Last);
+				continue;
+			}
+		}
+
+		if (Marker && IsAllDateish(Words, First, Last))
+		{
+			// Keep "at" so "at 3" reads as a time
+			AppendWords(DateText, Words, First - 1, Last);
+			continue;
+		}
+
+		// Every clause can end in a date ("with Sam tomorrow", "at the cafe on friday")
+		const int32 DateBegin = FindTrailingDate(Words, First, Last);
+		if (DateBegin <= Last)
+		{
+			AppendWords(DateText, Words, DateBegin, Last);
+		}
+
+		if (Marker && IsAny(*Marker, { TEXT("with"), TEXT("about"), TEXT("for") }))
+		{
+			const FString Note = SpanText(Utterance, Words, First, DateBegin - 1);
+			if (!Note.IsEmpty())
+			{
+				Slots.Notes = Slots.Notes.IsEmpty() ? Note : Slots.Notes + TEXT("; ") + Note;
+				Slots.Set(ESlot::Notes);
+			}
+			continue;
+		}
+
+		int32 RestFirst = First;
+		const int32 RestLast = DateBegin - 1;
+		if (!Marker)
+		{
+			while (RestFirst <= RestLast && (Words[RestFirst].bUsed || IsLeadingFiller(Words[RestFirst])))
+			{
+				++RestFirst;
+			}
+
+			// "a meeting called budget review"
+			for (int32 Index = RestFirst; Index < RestLast; ++Index)
+			{
+				if (IsAny(Words[Index], { TEXT("called"), TEXT("named"), TEXT("titled") }))
+				{
+					RestFirst = Index + 1;
+					break;
+				}
+			}
+
+			FString Title = SpanText(Utterance, Words, RestFirst, RestLast);
+			if (Title.Len() >= 2)
+			{
+				Title[0] = FChar::ToUpper(Title[0]);
+				Slots.EventName = MoveTemp(Title);
+				Slots.Set(ESlot::Name);
+			}
+			continue;
+		}
+
+		// "on my calendar" is not a place
+		bool bOnlyFiller = true;
+		for (int32 Index = RestFirst; Index <= RestLast && bOnlyFiller; ++Index)
+		{
+			bOnlyFiller = Words[Index].bUsed || IsLeadingFiller(Words[Index]);
+		}
+		if (!bOnlyFiller && Slots.Location.IsEmpty())
+		{
+			Slots.Location = SpanText(Utterance, Words, RestFirst, RestLast);
+			Slots.Set(ESlot::Location);
+		}
+	}
+
+	if (DurationText.Len() > 0)
+	{
+		Slots.DurationMinutes = FAICompanionDateTimeParser::ParseDurationMinutes(DurationText.ToView());
+		if (Slots.DurationMinutes > 0)
+		{
+			Slots.Set(ESlot::Duration);
+		}
+	}
+
+	if (DateText.Len() > 0 && FAICompanionDateTimeParser::ParseDateTime(DateText.ToView(), Now, Slots.EventDateTime))
+	{
+		Slots.Set(ESlot::DateTime);
+	}
+
+	return Slots;
+}
@@ -0,0 +1,41 @@
+// AICompanionCalendarSlots.h
+// Pulls calendar event fields out of a single request sentence
+//
+// "Schedule my dentist appointment tomorrow at 2pm for an hour at the clinic"
+// fills name, date/time, duration and location in one go, so the dialogue only
+// has to ask for what is left. The sentence is split into clauses at prepositions
+// (for, at, in, on, with, about); each clause is taken as a date, a duration, a
+// place or a note by what its words mean to FAICompanionDateTimeParser.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FAICompanionCalendarSlots
+{
+	enum class ESlot : uint8
+	{
+		Name,
+		DateTime,
+		Duration,
+		Location,
+		Notes,
+		Priority
+	};
+
+	FString EventName;
+	FDateTime EventDateTime;
+	int32 DurationMinutes = 0;
+	FString Location;
+	FString Notes;
+	int32 Priority = 0;
+
+	/** One bit per ESlot that was found */
+	uint8 Filled = 0;
+
+	bool Has(ESlot Slot) const { return (Filled & (1 << (uint8)Slot)) != 0; }
+	void Set(ESlot Slot) { Filled |= 1 << (uint8)Slot; }
+	int32 Num() const { return FMath::CountBits(Filled); }
+
+	static FAICompanionCalendarSlots Extract(FStringView Utterance, const FDateTime& Now);
+};
@@ -0,0 +1,123 @@
+// AICompanionConnection.cpp
+// Engine WebSocket wrapper with text and binary frames
+
+#include "AICompanionConnection.h"
+#include "AICompanionLog.h"
+#include "IWebSocket.h"
+#include "WebSocketsModule.h"
+
+FAICompanionConnection::~FAICompanionConnection()
+{
+	DetachSocket();
+}
+
+void FAICompanionConnection::DetachSocket()
+{
+	if (Socket)
+	{
+		Socket->OnConnected().RemoveAll(this);
+		Socket->OnConnectionError().RemoveAll(this);
+		Socket->OnClosed().RemoveAll(this);
+		Socket->OnMessage().RemoveAll(this);
+		Socket->OnBinaryMessage().RemoveAll(this);
+		Socket->Close();
+		Socket.Reset();
+	}
+	PartialBinary.Reset();
+}
+
+void FAICompanionConnection::Connect(const FString& URL)
+{
+	// A late close from the previous socket must not report on the new one
+	DetachSocket();
+
+	Socket = FWebSocketsModule::Get().CreateWebSocket(URL);
+	Socket->OnConnected().AddSP(this, &FAICompanionConnection::HandleConnected);
+	Socket->OnConnectionError().AddSP(this, &FAICompanionConnection::HandleConnectionError);
+	Socket->OnClosed().AddSP(this, &FAICompanionConnection::HandleClosed);
+	Socket->OnMessage().AddSP(this, &FAICompanionConnection::HandleMessage);
+	Socket->OnBinaryMessage().AddSP(this, &FAICompanionConnection::HandleBinaryMessage);
+	Socket->Connect();
+}
+
+void FAICompanionConnection::Close()
+{
+	if (Socket)
+	{
+		Socket->Close();
+	}
+	PartialBinary.Reset();
+}
+
+void FAICompanionConnection::Abandon()
+{
+	if (!Socket)
+	{
+		return;
+	}
+
+	DetachSocket();
+	OnConnectionChanged.ExecuteIfBound(false);
+}
+
+bool FAICompanionConnection::IsConnected() const
+{
+	return Socket && Socket->IsConnected();
+}
+
+void FAICompanionConnection::SendText(const FString& Frame)
+{
+	if (IsConnected())
+	{
+		Socket->Send(Frame);
+	}
+}
+
+void FAICompanionConnection::SendBinary(const TArray<uint8>& Frame)
+{
+	if (IsConnected())
+	{
+		Socket->Send(Frame.GetData(), Frame.Num(), true);
+	}
+}
+
+void FAICompanionConnection::HandleConnected()
+{
+	OnConnectionChanged.ExecuteIfBound(true);
+}
+
+void FAICompanionConnection::HandleConnectionError(const FString& Error)
+{
+	OnError.ExecuteIfBound(Error);
+}
+
+void FAICompanionConnection::HandleClosed(int32 StatusCode, const FString& Reason, bool bWasClean)
+{
+	UE_LOG(LogAICompanion, Log, TEXT("[AICompanionConnection] Closed (%d%s) %s"), StatusCode, bWasClean ? TEXT("") : TEXT(", unclean"), *Reason);
+	PartialBinary.Reset();
+	OnConnectionChanged.ExecuteIfBound(false);
+}
+
+void FAICompanionConnection::HandleMessage(const FString& Message)
+{
+	OnTextFrame.ExecuteIfBound(Message);
+}
+
+void FAICompanionConnection::HandleBinaryMessage(const void* Data, SIZE_T Size, bool bIsLastFragment)
+{
+	// Fast path: whole message in one fragment
+	if (bIsLastFragment && PartialBinary.Num() == 0)
+	{
+		TArray<uint8> Frame((const uint8*)Data, (int32)Size);
+		OnBinaryFrame.ExecuteIfBound(Frame);
+		return;
+	}
+
+	PartialBinary.Append((const uint8*)Data, (int32)Size);
+	if (bIsLastFragment)
+	{
+		TArray<uint8> Frame = MoveTemp(PartialBinary);
+		PartialBinary.Reset();
+		OnBinaryFrame.ExecuteIfBound(Frame);
+	}
+}
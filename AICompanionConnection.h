@@ -0,0 +1,59 @@
+// AICompanionConnection.h
+// Thin wrapper over the engine WebSocket (WebSockets module)
+// Used instead of UWebSocketManager when binary frames are needed
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class IWebSocket;
+
+/**
+ * One WebSocket connection that can send and receive both text and binary frames.
+ * Callbacks are raised on the game thread.
+ */
+class FAICompanionConnection : public TSharedFromThis<FAICompanionConnection>
+{
+public:
+	DECLARE_DELEGATE_OneParam(FOnConnectionChanged, bool /*bConnected*/);
+	DECLARE_DELEGATE_OneParam(FOnTextFrame, const FString& /*Frame*/);
+	DECLARE_DELEGATE_OneParam(FOnBinaryFrame, TArray<uint8>& /*Frame - may be moved from*/);
+	DECLARE_DELEGATE_OneParam(FOnError, const FString& /*Error*/);
+
+	~FAICompanionConnection();
+
+	/** Open a connection to URL (ws:// or wss://) */
+	void Connect(const FString& URL);
+
+	/** Close the connection; OnConnectionChanged(false) follows */
+	void Close();
+
+	/**
+	 * Drop a socket that has stopped responding without waiting for the close handshake.
+	 * OnConnectionChanged(false) fires immediately and nothing more is heard from it.
+	 */
+	void Abandon();
+
+	bool IsConnected() const;
+
+	void SendText(const FString& Frame);
+	void SendBinary(const TArray<uint8>& Frame);
+
+	FOnConnectionChanged OnConnectionChanged;
+	FOnTextFrame OnTextFrame;
+	FOnBinaryFrame OnBinaryFrame;
+	FOnError OnError;
+
+private:
+	void DetachSocket();
+	void HandleConnected();
+	void HandleConnectionError(const FString& Error);
+	void HandleClosed(int32 StatusCode, const FString& Reason, bool bWasClean);
+	void HandleMessage(const FString& Message);
+	void HandleBinaryMessage(const void* Data, SIZE_T Size, bool bIsLastFragment);
+
+	TSharedPtr<IWebSocket> Socket;
+
+	/** Fragments of a binary message still being received */
+	TArray<uint8> PartialBinary;
+};
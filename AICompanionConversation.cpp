@@ -0,0 +1,174 @@
+// AICompanionConversation.cpp
+// Turn ring, text arena and eviction summary
+
+#include "AICompanionConversation.h"
+#include "HAL/PlatformTime.h"
+
+// Longest piece of an evicted turn kept in the summary
+static constexpr int32 SummarySentenceMaxChars = 120;
+
+FAICompanionConversationHistory::FAICompanionConversationHistory()
+{
+	Configure(64, 32 * 1024, 1024);
+}
+
+void FAICompanionConversationHistory::Configure(int32 MaxTurns, int32 ArenaChars, int32 SummaryChars)
+{
+	Entries.SetNum(FMath::Max(MaxTurns, 1));
+	Arena.SetNumUninitialized(FMath::Max(ArenaChars, 256));
+	SummaryMaxChars = FMath::Max(SummaryChars, 0);
+	Summary.Empty(SummaryMaxChars + SummarySentenceMaxChars + 16);
+	Reset();
+}
+
+void FAICompanionConversationHistory::Reset()
+{
+	Head = 0;
+	Count = 0;
+	ArenaTail = 0;
+	Summary.Reset();
+	EvictedCount = 0;
+}
+
+const TCHAR* FAICompanionConversationHistory::GetRoleName(ERole Role)
+{
+	return Role == ERole::User ? TEXT("User") : TEXT("Assistant");
+}
+
+void FAICompanionConversationHistory::Add(ERole Role, FStringView Text)
+{
+	// Empty turns carry nothing and would break the overlap test below
+	if (Text.IsEmpty())
+	{
+		return;
+	}
+
+	const int32 ArenaSize = Arena.Num();
+	const int32 Length = FMath::Min(Text.Len(), ArenaSize / 4);
+
+	if (Count == Entries.Num())
+	{
+		EvictOldest();
+	}
+
+	// Text stays contiguous; if it does not fit before the end, start again at zero
+	const bool bWrap = ArenaTail + Length > ArenaSize;
+	const int32 Write = bWrap ? 0 : ArenaTail;
+
+	// Allocation is sequential, so the turns in the way are always the oldest ones:
+	// first whatever sits in the skipped tail, then those under the new text
+	while (Count > 0)
+	{
+		const FEntry& Oldest = Entries[Head];
+		const bool bInSkippedTail = bWrap && Oldest.Offset >= ArenaTail;
+		const bool bOverlaps = Oldest.Offset < Write + Length && Oldest.Offset + Oldest.Length > Write;
+		if (!bInSkippedTail && !bOverlaps)
+		{
+			break;
+		}
+		EvictOldest();
+	}
+
+	FMemory::Memcpy(Arena.GetData() + Write, Text.GetData(), Length * sizeof(TCHAR));
+	ArenaTail = Write + Length;
+
+	FEntry& Entry = Entries[(Head + Count) % Entries.Num()];
+	Entry.Offset = Write;
+	Entry.Length = Length;
+	Entry.Timestamp = FPlatformTime::Seconds();
+	Entry.Role = Role;
+	++Count;
+}
+
+FAICompanionConversationHistory::FTurn FAICompanionConversationHistory::GetRecent(int32 IndexFromNewest) const
+{
+	FTurn Turn;
+	if (IndexFromNewest < 0 || IndexFromNewest >= Count)
+	{
+		return Turn;
+	}
+
+	const FEntry& Entry = EntryFromNewest(IndexFromNewest);
+	Turn.Role = Entry.Role;
+	Turn.Timestamp = Entry.Timestamp;
+	Turn.Text = FStringView(Arena.GetData() + Entry.Offset, Entry.Length);
+	return Turn;
+}
+
+void FAICompanionConversationHistory::EvictOldest()
+{
+	Summarize(Entries[Head]);
+	Head = (Head + 1) % Entries.Num();
+	--Count;
+	++EvictedCount;
+}
+
+void FAICompanionConversationHistory::Summarize(const FEntry& Entry)
+{
+	if (SummaryMaxChars <= 0)
+	{
+		return;
+	}
+
+	// First sentence of the turn, capped
+	FStringView Text(Arena.GetData() + Entry.Offset, FMath::Min(Entry.Length, SummarySentenceMaxChars));
+	for (int32 Index = 0; Index < Text.Len(); ++Index)
+	{
+		const TCHAR Char = Text[Index];
+		if (Char == TEXT('.') || Char == TEXT('?') || Char == TEXT('!') || Char == TEXT('\n'))
+		{
+			Text = Text.Left(Index + 1);
+			break;
+		}
+	}
+
+	Summary.Append(GetRoleName(Entry.Role));
+	Summary.Append(TEXT(": "));
+	Summary.Append(Text.TrimEnd());
+	Summary.AppendChar(TEXT('\n'));
+
+	// Drop the oldest summary lines once over budget
+	if (Summary.Len() > SummaryMaxChars)
+	{
+		int32 Cut = Summary.Len() - SummaryMaxChars;
+		const int32 LineEnd = Summary.Find(TEXT("\n"), ESearchCase::CaseSensitive, ESearchDir::FromStart, Cut - 1);
+		Cut = LineEnd == INDEX_NONE ? Summary.Len() : LineEnd + 1;
+		Summary.RemoveAt(0, Cut, EAllowShrinking::No);
+	}
+}
+
+void FAICompanionConversationHistory::BuildContext(int32 MaxChars, FString& Out) const
+{
+	Out.Reset();
+
+	// Newest turns take priority; walk back until the budget runs out
+	int32 Used = 0;
+	int32 TurnsThatFit = 0;
+	for (; TurnsThatFit < Count; ++TurnsThatFit)
+	{
+		const FEntry& Entry = EntryFromNewest(TurnsThatFit);
+		const int32 LineChars = FCString::Strlen(GetRoleName(Entry.Role)) + 2 + Entry.Length + 1;
+		if (Used + LineChars > MaxChars)
+		{
+			break;
+		}
+		Used += LineChars;
+	}
+
+	const bool bWithSummary = !Summary.IsEmpty() && Used + Summary.Len() <= MaxChars;
+	Out.Reserve(Used + (bWithSummary ? Summary.Len() : 0));
+
+	if (bWithSummary)
+	{
+		Out.Append(Summary);
+	}
+
+	for (int32 Index = TurnsThatFit - 1; Index >= 0; --Index)
+	{
+		const FEntry& Entry = EntryFromNewest(Index);
+		Out.Append(GetRoleName(Entry.Role));
+		Out.Append(TEXT(": "));
+		Out.Append(Arena.GetData() + Entry.Offset, Entry.Length);
+		Out.AppendChar(TEXT('\n'));
+	}
+}
@@ -0,0 +1,82 @@
+// AICompanionConversation.h
+// Bounded conversation history for prompt context
+//
+// Turns live in a fixed ring; their text is packed into one circular character
+// arena, so a long session never allocates after Configure(). When either the
+// ring or the arena fills, the oldest turns are evicted and their first sentence
+// is folded into a short running summary.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FAICompanionConversationHistory
+{
+public:
+	enum class ERole : uint8
+	{
+		User,
+		Assistant
+	};
+
+	struct FTurn
+	{
+		ERole Role = ERole::User;
+		double Timestamp = 0.0;
+
+		/** Points into the arena; valid until the next Add() */
+		FStringView Text;
+	};
+
+	FAICompanionConversationHistory();
+
+	/** Sizes the ring and arena and clears the history */
+	void Configure(int32 MaxTurns, int32 ArenaChars, int32 SummaryChars);
+
+	/** Append a turn, evicting the oldest as needed. Very long turns are truncated to a quarter of the arena. */
+	void Add(ERole Role, FStringView Text);
+
+	void Reset();
+
+	int32 Num() const { return Count; }
+	bool IsEmpty() const { return Count == 0; }
+
+	/** Turn by age, 0 = newest. O(1). */
+	FTurn GetRecent(int32 IndexFromNewest) const;
+
+	/** Running summary of evicted turns, oldest first */
+	const FString& GetSummary() const { return Summary; }
+	uint64 GetEvictedCount() const { return EvictedCount; }
+
+	/** Summary then as many recent turns as fit in MaxChars, as "Role: text" lines, oldest first */
+	void BuildContext(int32 MaxChars, FString& Out) const;
+
+	static const TCHAR* GetRoleName(ERole Role);
+
+private:
+	struct FEntry
+	{
+		int32 Offset = 0;
+		int32 Length = 0;
+		double Timestamp = 0.0;
+		ERole Role = ERole::User;
+	};
+
+	void EvictOldest();
+	void Summarize(const FEntry& Entry);
+
+	const FEntry& EntryFromNewest(int32 IndexFromNewest) const { return Entries[(Head + Count - 1 - IndexFromNewest) % Entries.Num()]; }
+
+	/** Ring of turns; Head is the oldest */
+	TArray<FEntry> Entries;
+	int32 Head = 0;
+	int32 Count = 0;
+
+	/** Circular text storage; ArenaTail is where the next turn is written */
+	TArray<TCHAR> Arena;
+	int32 ArenaTail = 0;
+
+	FString Summary;
+	int32 SummaryMaxChars = 0;
+	uint64 EvictedCount = 0;
+};
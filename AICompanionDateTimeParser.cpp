@@ -0,0 +1,963 @@
+// AICompanionDateTimeParser.cpp
+// Keyword tables, tokenizer and the date/time and duration grammars
+
+#include "AICompanionDateTimeParser.h"
+
+namespace AICompanionDateTimeGrammar
+{
+	// ========================================
+	// KEYWORDS
+	// ========================================
+
+	enum class EWord : uint8
+	{
+		Today,
+		Tonight,
+		Tomorrow,
+		Weekday,	// Value: 0 = Monday, matching EDayOfWeek
+		Month,		// Value: 1-12
+		Unit,		// Value: minutes, or negative months
+		AM,
+		PM,
+		Ordinal,
+		Noon,
+		Midnight,
+		PartOfDay,	// Value: the hour it suggests
+		OClock,
+		Next,
+		This,
+		At,
+		On,
+		In,
+		After,
+		Later,		// also "from", as in "from now"
+		Article,
+		Half
+	};
+
+	constexpr TCHAR LowerAscii(TCHAR Char)
+	{
+		return Char >= TEXT('A') && Char <= TEXT('Z') ? (TCHAR)(Char + (TEXT('a') - TEXT('A'))) : Char;
+	}
+
+	// FNV-1a over lowercased characters; the tokenizer folds input words the same way as it scans
+	constexpr uint32 HashStep(uint32 Hash, TCHAR Char)
+	{
+		return (Hash ^ (uint32)LowerAscii(Char)) * 16777619u;
+	}
+
+	constexpr uint32 HashSeed = 2166136261u;
+
+	constexpr uint32 HashWord(const TCHAR* Text)
+	{
+		uint32 Hash = HashSeed;
+		for (; *Text; ++Text)
+		{
+			Hash = HashStep(Hash, *Text);
+		}
+		return Hash;
+	}
+
+	struct FKeyword
+	{
+		const TCHAR* Text;
+		EWord Word;
+		int32 Value;
+		uint32 Hash;
+
+		/** Also an ordinary word ("may", "sat", "h"); only counts next to a number or after next/this/on */
+		bool bContextual;
+	};
+
+	constexpr FKeyword K(const TCHAR* Text, EWord Word, int32 Value = 0)
+	{
+		return { Text, Word, Value, HashWord(Text), false };
+	}
+
+	constexpr FKeyword KC(const TCHAR* Text, EWord Word, int32 Value = 0)
+	{
+		return { Text, Word, Value, HashWord(Text), true };
+	}
+
+	constexpr int32 MinutesPerHour = 60;
+	constexpr int32 MinutesPerDay = 24 * MinutesPerHour;
+
+	static constexpr FKeyword Keywords[] =
+	{
+		K(TEXT("today"), EWord::Today),
+		K(TEXT("tonight"), EWord::Tonight, 20),
+		K(TEXT("tomorrow"), EWord::Tomorrow),
+		K(TEXT("tmrw"), EWord::Tomorrow),
+
+		K(TEXT("monday"), EWord::Weekday, 0), K(TEXT("mon"), EWord::Weekday, 0),
+		K(TEXT("tuesday"), EWord::Weekday, 1), K(TEXT("tue"), EWord::Weekday, 1), K(TEXT("tues"), EWord::Weekday, 1),
+		K(TEXT("wednesday"), EWord::Weekday, 2), KC(TEXT("wed"), EWord::Weekday, 2), K(TEXT("weds"), EWord::Weekday, 2),
+		K(TEXT("thursday"), EWord::Weekday, 3), K(TEXT("thu"), EWord::Weekday, 3), K(TEXT("thur"), EWord::Weekday, 3), K(TEXT("thurs"), EWord::Weekday, 3),
+		K(TEXT("friday"), EWord::Weekday, 4), K(TEXT("fri"), EWord::Weekday, 4),
+		K(TEXT("saturday"), EWord::Weekday, 5), KC(TEXT("sat"), EWord::Weekday, 5),
+		K(TEXT("sunday"), EWord::Weekday, 6), KC(TEXT("sun"), EWord::Weekday, 6),
+
+		K(TEXT("january"), EWord::Month, 1), KC(TEXT("jan"), EWord::Month, 1),
+		K(TEXT("february"), EWord::Month, 2), K(TEXT("feb"), EWord::Month, 2),
+		K(TEXT("march"), EWord::Month, 3), KC(TEXT("mar"), EWord::Month, 3),
+		K(TEXT("april"), EWord::Month, 4), K(TEXT("apr"), EWord::Month, 4),
+		KC(TEXT("may"), EWord::Month, 5),
+		K(TEXT("june"), EWord::Month, 6), KC(TEXT("jun"), EWord::Month, 6),
+		K(TEXT("july"), EWord::Month, 7), K(TEXT("jul"), EWord::Month, 7),
+		K(TEXT("august"), EWord::Month, 8), K(TEXT("aug"), EWord::Month, 8),
+		K(TEXT("september"), EWord::Month, 9), K(TEXT("sep"), EWord::Month, 9), K(TEXT("sept"), EWord::Month, 9),
+		K(TEXT("october"), EWord::Month, 10), K(TEXT("oct"), EWord::Month, 10),
+		K(TEXT("november"), EWord::Month, 11), K(TEXT("nov"), EWord::Month, 11),
+		K(TEXT("december"), EWord::Month, 12), K(TEXT("dec"), EWord::Month, 12),
+
+		K(TEXT("minute"), EWord::Unit, 1), K(TEXT("minutes"), EWord::Unit, 1), K(TEXT("min"), EWord::Unit, 1), K(TEXT("mins"), EWord::Unit, 1),
+		K(TEXT("hour"), EWord::Unit, MinutesPerHour), K(TEXT("hours"), EWord::Unit, MinutesPerHour),
+		K(TEXT("hr"), EWord::Unit, MinutesPerHour), K(TEXT("hrs"), EWord::Unit, MinutesPerHour), KC(TEXT("h"), EWord::Unit, MinutesPerHour),
+		K(TEXT("day"), EWord::Unit, MinutesPerDay), K(TEXT("days"), EWord::Unit, MinutesPerDay),
+		K(TEXT("week"), EWord::Unit, 7 * MinutesPerDay), K(TEXT("weeks"), EWord::Unit, 7 * MinutesPerDay),
+		K(TEXT("month"), EWord::Unit, -1), K(TEXT("months"), EWord::Unit, -1),
+		K(TEXT("year"), EWord::Unit, -12), K(TEXT("years"), EWord::Unit, -12),
+
+		K(TEXT("am"), EWord::AM),
+		K(TEXT("pm"), EWord::PM),
+		K(TEXT("st"), EWord::Ordinal), K(TEXT("nd"), EWord::Ordinal), K(TEXT("rd"), EWord::Ordinal), K(TEXT("th"), EWord::Ordinal),
+		K(TEXT("noon"), EWord::Noon), K(TEXT("midday"), EWord::Noon),
+		K(TEXT("midnight"), EWord::Midnight),
+		K(TEXT("morning"), EWord::PartOfDay, 9),
+		K(TEXT("afternoon"), EWord::PartOfDay, 15),
+		K(TEXT("evening"), EWord::PartOfDay, 18),
+		K(TEXT("night"), EWord::PartOfDay, 20),
+		K(TEXT("oclock"), EWord::OClock),
+
+		K(TEXT("next"), EWord::Next), K(TEXT("coming"), EWord::Next),
+		K(TEXT("this"), EWord::This),
+		K(TEXT("at"), EWord::At),
+		K(TEXT("on"), EWord::On),
+		K(TEXT("in"), EWord::In),
+		K(TEXT("after"), EWord::After),
+		K(TEXT("later"), EWord::Later), K(TEXT("from"), EWord::Later),
+		K(TEXT("a"), EWord::Article), K(TEXT("an"), EWord::Article),
+		K(TEXT("half"), EWord::Half),
+	};
+
+	/** Word characters that are skipped inside a word ("p.m.", "o'clock") */
+	static bool IsWordJoiner(TCHAR Char)
+	{
+		return Char == TEXT('.') || Char == TEXT('\'');
+	}
+
+	static bool MatchesKeyword(const FKeyword& Keyword, FStringView Raw)
+	{
+		const TCHAR* Expected = Keyword.Text;
+		for (const TCHAR Char : Raw)
+		{
+			if (IsWordJoiner(Char))
+			{
+				continue;
+			}
+			if (*Expected == 0 || LowerAscii(Char) != *Expected)
+			{
+				return false;
+			}
+			++Expected;
+		}
+		return *Expected == 0;
+	}
+
+	/** Open-addressed index over Keywords by hash, filled in at compile time */
+	struct FKeywordIndex
+	{
+		static constexpr int32 NumBuckets = 256;
+
+		/** Keyword index + 1; 0 is an empty bucket */
+		uint8 Buckets[NumBuckets] = {};
+	};
+
+	static_assert(UE_ARRAY_COUNT(Keywords) < FKeywordIndex::NumBuckets / 2, "Keyword index is too full for short probes");
+
+	constexpr FKeywordIndex BuildKeywordIndex()
+	{
+		FKeywordIndex Index;
+		for (int32 Keyword = 0; Keyword < (int32)UE_ARRAY_COUNT(Keywords); ++Keyword)
+		{
+			uint32 Bucket = Keywords[Keyword].Hash & (FKeywordIndex::NumBuckets - 1);
+			while (Index.Buckets[Bucket] != 0)
+			{
+				Bucket = (Bucket + 1) & (FKeywordIndex::NumBuckets - 1);
+			}
+			Index.Buckets[Bucket] = (uint8)(Keyword + 1);
+		}
+		return Index;
+	}
+
+	static constexpr FKeywordIndex KeywordIndex = BuildKeywordIndex();
+
+	static const FKeyword* FindKeyword(uint32 Hash, FStringView Raw)
+	{
+		for (uint32 Bucket = Hash & (FKeywordIndex::NumBuckets - 1); KeywordIndex.Buckets[Bucket] != 0; Bucket = (Bucket + 1) & (FKeywordIndex::NumBuckets - 1))
+		{
+			const FKeyword& Keyword = Keywords[KeywordIndex.Buckets[Bucket] - 1];
+			if (Keyword.Hash == Hash && MatchesKeyword(Keyword, Raw))
+			{
+				return &Keyword;
+			}
+		}
+		return nullptr;
+	}
+
+	// ========================================
+	// TOKENIZER
+	// ========================================
+
+	enum class ETokenKind : uint8
+	{
+		End,
+		Word,	// Keyword is null for words we do not know
+		Number,
+		Time,	// hh:mm
+		Date	// m/d[/y] or y-m-d
+	};
+
+	struct FToken
+	{
+		ETokenKind Kind = ETokenKind::End;
+		const FKeyword* Keyword = nullptr;
+		double Number = 0.0;
+
+		// Time: Hour, Minute, bClock24; Date: Year (0 if absent), Month, Day
+		int32 A = 0;
+		int32 B = 0;
+		int32 C = 0;
+	};
+
+	class FLexer
+	{
+	public:
+		explicit FLexer(FStringView InInput)
+			: Input(InInput)
+		{
+		}
+
+		bool Next(FToken& Out)
+		{
+			while (Pos < Input.Len())
+			{
+				const TCHAR Char = Input[Pos];
+				if (FChar::IsDigit(Char))
+				{
+					LexNumber(Out);
+					return true;
+				}
+				if (FChar::IsAlpha(Char))
+				{
+					LexWord(Out);
+					return true;
+				}
+				++Pos;
+			}
+
+			Out = FToken();
+			return false;
+		}
+
+	private:
+		TCHAR Peek(int32 Ahead = 0) const
+		{
+			return Pos + Ahead < Input.Len() ? Input[Pos + Ahead] : TEXT('\0');
+		}
+
+		int32 ReadDigits(int32& OutCount)
+		{
+			int32 Value = 0;
+			OutCount = 0;
+			while (FChar::IsDigit(Peek()))
+			{
+				// Saturate; nothing we parse needs more than a few digits
+				if (OutCount < 9)
+				{
+					Value = Value * 10 + (Peek() - TEXT('0'));
+				}
+				++OutCount;
+				++Pos;
+			}
+			return Value;
+		}
+
+		void LexWord(FToken& Out)
+		{
+			const int32 Start = Pos;
+			uint32 Hash = HashSeed;
+			while (Pos < Input.Len())
+			{
+				const TCHAR Char = Input[Pos];
+				if (FChar::IsAlpha(Char))
+				{
+					Hash = HashStep(Hash, Char);
+					++Pos;
+				}
+				else if (IsWordJoiner(Char) && FChar::IsAlpha(Peek(1)))
+				{
+					++Pos;
+				}
+				else
+				{
+					break;
+				}
+			}
+
+			Out = FToken();
+			Out.Kind = ETokenKind::Word;
+			Out.Keyword = FindKeyword(Hash, Input.Mid(Start, Pos - Start));
+		}
+
+		void LexNumber(FToken& Out)
+		{
+			Out = FToken();
+
+			const bool bLeadingZero = Peek() == TEXT('0') && FChar::IsDigit(Peek(1));
+			int32 Digits = 0;
+			const int32 First = ReadDigits(Digits);
+
+			if (Peek() == TEXT(':') && FChar::IsDigit(Peek(1)))
+			{
+				++Pos;
+				int32 MinuteDigits = 0;
+				Out.Kind = ETokenKind::Time;
+				Out.A = First;
+				Out.B = ReadDigits(MinuteDigits);
+				Out.C = (bLeadingZero || First == 0 || First > 12) ? 1 : 0;
+				return;
+			}
+
+			if (Peek() == TEXT('/') && FChar::IsDigit(Peek(1)))
+			{
+				++Pos;
+				int32 SecondDigits = 0;
+				Out.Kind = ETokenKind::Date;
+				Out.B = First;
+				Out.C = ReadDigits(SecondDigits);
+				if (Peek() == TEXT('/') && FChar::IsDigit(Peek(1)))
+				{
+					++Pos;
+					int32 YearDigits = 0;
+					const int32 Year = ReadDigits(YearDigits);
+					Out.A = Year < 100 ? 2000 + Year : Year;
+				}
+				return;
+			}
+
+			if (Digits == 4 && Peek() == TEXT('-') && FChar::IsDigit(Peek(1)))
+			{
+				const int32 Save = Pos;
+				++Pos;
+				int32 MonthDigits = 0;
+				const int32 MonthValue = ReadDigits(MonthDigits);
+				if (Peek() == TEXT('-') && FChar::IsDigit(Peek(1)))
+				{
+					++Pos;
+					int32 DayDigits = 0;
+					Out.Kind = ETokenKind::Date;
+					Out.A = First;
+					Out.B = MonthValue;
+					Out.C = ReadDigits(DayDigits);
+					return;
+				}
+				Pos = Save;
+			}
+
+			Out.Kind = ETokenKind::Number;
+			Out.Number = First;
+
+			if (Peek() == TEXT('.') && FChar::IsDigit(Peek(1)))
+			{
+				++Pos;
+				double Scale = 0.1;
+				while (FChar::IsDigit(Peek()))
+				{
+					Out.Number += (Peek() - TEXT('0')) * Scale;
+					Scale *= 0.1;
+					++Pos;
+				}
+			}
+		}
+
+		FStringView Input;
+		int32 Pos = 0;
+	};
+
+	static bool IsWord(const FToken& Token, EWord Word)
+	{
+		return Token.Kind == ETokenKind::Word && Token.Keyword && Token.Keyword->Word == Word;
+	}
+
+	static FDateTime AddMonths(const FDateTime& Date, int32 Months)
+	{
+		const int32 Index = Date.GetYear() * 12 + (Date.GetMonth() - 1) + Months;
+		const int32 Year = Index / 12;
+		const int32 Month = Index % 12 + 1;
+		const int32 Day = FMath::Min(Date.GetDay(), FDateTime::DaysInMonth(Year, Month));
+		return FDateTime(Year, Month, Day) + Date.GetTimeOfDay();
+	}
+}
+
+using namespace AICompanionDateTimeGrammar;
+
+// ========================================
+// DATE AND TIME
+// ========================================
+
+bool FAICompanionDateTimeParser::ParseDateTime(FStringView Input, const FDateTime& Now, FDateTime& OutDateTime)
+{
+	bool bHasTime = false;
+	return ParseDateTime(Input, Now, OutDateTime, bHasTime);
+}
+
+bool FAICompanionDateTimeParser::ParseDateTime(FStringView Input, const FDateTime& Now, FDateTime& OutDateTime, bool& bOutHasTime)
+{
+	bool bRecognized = false;
+
+	// Which day
+	int32 DayOffset = 0;
+	bool bDayWord = false;
+	int32 Weekday = -1;
+	bool bThisWeekday = false;
+	int32 Year = 0;
+	int32 Month = 0;
+	int32 Day = 0;
+
+	// Relative to now
+	double OffsetMinutes = 0.0;
+	int32 OffsetMonths = 0;
+	bool bOffset = false;
+
+	// Time of day
+	int32 Hour = -1;
+	int32 Minute = 0;
+	bool bClock24 = false;
+	bool bMidnight = false;
+	int32 Meridiem = 0;		// 1 am, 2 pm
+	int32 DefaultHour = -1;	// from "morning", "tonight"...
+
+	// A number waiting for the word that says what it is ("5" in "5th", "2" in "2 pm")
+	bool bHavePending = false;
+	bool bPendingIsArticle = false;
+	double Pending = 0.0;
+
+	bool bAfterAt = false;
+	EWord Modifier = EWord::Article; // Next or This when one is waiting for its noun
+	bool bHaveModifier = false;
+	const FKeyword* Previous = nullptr;
+
+	// A contextual month ("may") waiting for the day number that makes it one
+	int32 TentativeMonth = 0;
+
+	// "a week" is only an offset after "in", or once "later" / "from now" follows
+	bool bArticleAfterIn = false;
+	double TentativeMinutes = 0.0;
+	int32 TentativeMonths = 0;
+	bool bTentativeOffset = false;
+
+	auto SetTime = [&](int32 InHour, int32 InMinute, bool bInClock24)
+	{
+		Hour = InHour;
+		Minute = InMinute;
+		bClock24 = bInClock24;
+		bAfterAt = false;
+		bRecognized = true;
+	};
+
+	// Nothing claimed the number: a day after a month name, a year, or an hour
+	auto FlushPending = [&]()
+	{
+		if (!bHavePending)
+		{
+			return;
+		}
+		bHavePending = false;
+		if (bPendingIsArticle)
+		{
+			return;
+		}
+
+		const int32 Number = (int32)Pending;
+		if (Month > 0 && Day == 0 && !bAfterAt && Number >= 1 && Number <= 31)
+		{
+			Day = Number;
+			bRecognized = true;
+		}
+		else if (Number >= 1000)
+		{
+			Year = Number;
+		}
+		else if (Hour < 0 && Number <= 24)
+		{
+			SetTime(Number == 24 ? 0 : Number, 0, Number == 24);
+		}
+	};
+
+	FLexer Lexer(Input);
+	FToken Token;
+	while (Lexer.Next(Token))
+	{
+		// "may 5"
+		if (TentativeMonth > 0)
+		{
+			if (Token.Kind == ETokenKind::Number && Token.Number >= 1 && Token.Number <= 31)
+			{
+				Month = TentativeMonth;
+				bRecognized = true;
+			}
+			TentativeMonth = 0;
+		}
+
+		// Before the pending number is claimed below
+		const bool bAfterNumber = bHavePending && !bPendingIsArticle;
+
+		// Words that say what the pending number is
+		if (bHavePending && Token.Kind == ETokenKind::Word && Token.Keyword)
+		{
+			const int32 Number = (int32)Pending;
+			switch (Token.Keyword->Word)
+			{
+			case EWord::AM:
+			case EWord::PM:
+			case EWord::OClock:
+				bHavePending = false;
+				if (!bPendingIsArticle)
+				{
+					SetTime(Number, 0, false);
+				}
+				break;
+			case EWord::Ordinal:
+				bHavePending = false;
+				Day = Number;
+				bRecognized = true;
+				break;
+			case EWord::Month:
+				bHavePending = false;
+				if (!bPendingIsArticle)
+				{
+					Day = Number;
+				}
+				break;
+			case EWord::Unit:
+				break;
+			default:
+				FlushPending();
+				break;
+			}
+		}
+		else if (bHavePending)
+		{
+			FlushPending();
+		}
+
+		switch (Token.Kind)
+		{
+		case ETokenKind::Number:
+			bHavePending = true;
+			bPendingIsArticle = false;
+			Pending = Token.Number;
+			break;
+
+		case ETokenKind::Time:
+			SetTime(Token.A, Token.B, Token.C != 0);
+			break;
+
+		case ETokenKind::Date:
+			Year = Token.A;
+			Month = Token.B;
+			Day = Token.C;
+			bRecognized = true;
+			break;
+
+		case ETokenKind::Word:
+			if (!Token.Keyword)
+			{
+				break;
+			}
+
+			switch (Token.Keyword->Word)
+			{
+			case EWord::Today:
+				bDayWord = true;
+				bRecognized = true;
+				break;
+			case EWord::Tonight:
+				bDayWord = true;
+				DefaultHour = Token.Keyword->Value;
+				bRecognized = true;
+				break;
+			case EWord::Tomorrow:
+				// "day after tomorrow"
+				DayOffset += (Previous && Previous->Word == EWord::After) ? 2 : 1;
+				bDayWord = true;
+				bRecognized = true;
+				break;
+			case EWord::Weekday:
+				// "sat" and "sun" are words too; "next sat", "on sun" are days
+				if (Token.Keyword->bContextual && !(Previous && (Previous->Word == EWord::Next || Previous->Word == EWord::This || Previous->Word == EWord::On)))
+				{
+					break;
+				}
+				Weekday = Token.Keyword->Value;
+				bThisWeekday = bHaveModifier && Modifier == EWord::This;
+				bHaveModifier = false;
+				bRecognized = true;
+				break;
+			case EWord::Month:
+				// "may" and "mar" only after a day number ("5 may", "the 5th of may") or before one
+				if (Token.Keyword->bContextual && !bAfterNumber && Day == 0)
+				{
+					TentativeMonth = Token.Keyword->Value;
+					break;
+				}
+				Month = Token.Keyword->Value;
+				bRecognized = true;
+				break;
+			case EWord::Unit:
+			{
+				// A bare "h" is only an hour straight after a number
+				if (Token.Keyword->bContextual && !bAfterNumber)
+				{
+					break;
+				}
+
+				// "3 days", "in an hour", "next week"
+				double Amount = 0.0;
+				bool bFromArticle = false;
+				if (bHavePending)
+				{
+					Amount = bPendingIsArticle ? 1.0 : Pending;
+					bFromArticle = bPendingIsArticle;
+					bHavePending = false;
+				}
+				else if (bHaveModifier && Modifier == EWord::Next)
+				{
+					Amount = 1.0;
+				}
+				bHaveModifier = false;
+
+				if (Amount > 0.0)
+				{
+					// "have a day off" is not a date; hold it until "later" or "from now" says it is
+					const bool bTentative = bFromArticle && !bArticleAfterIn;
+					double& Minutes = bTentative ? TentativeMinutes : OffsetMinutes;
+					int32& Months = bTentative ? TentativeMonths : OffsetMonths;
+					if (Token.Keyword->Value > 0)
+					{
+						Minutes += Amount * Token.Keyword->Value;
+					}
+					else
+					{
+						Months += (int32)Amount * -Token.Keyword->Value;
+					}
+					bTentativeOffset |= bTentative;
+					bOffset |= !bTentative;
+					bRecognized |= !bTentative;
+				}
+				break;
+			}
+			case EWord::Later:
+				if (bTentativeOffset)
+				{
+					OffsetMinutes += TentativeMinutes;
+					OffsetMonths += TentativeMonths;
+					TentativeMinutes = 0.0;
+					TentativeMonths = 0;
+					bTentativeOffset = false;
+					bOffset = true;
+					bRecognized = true;
+				}
+				break;
+			case EWord::AM:
+			case EWord::PM:
+				// "2:30 pm"; a bare number was handled above
+				Meridiem = Token.Keyword->Word == EWord::AM ? 1 : 2;
+				break;
+			case EWord::Noon:
+				SetTime(12, 0, true);
+				break;
+			case EWord::Midnight:
+				SetTime(0, 0, true);
+				bMidnight = true;
+				break;
+			case EWord::PartOfDay:
+				DefaultHour = Token.Keyword->Value;
+				bRecognized = true;
+				break;
+			case EWord::Next:
+			case EWord::This:
+				Modifier = Token.Keyword->Word;
+				bHaveModifier = true;
+				break;
+			case EWord::At:
+				bAfterAt = true;
+				break;
+			case EWord::Article:
+				bHavePending = true;
+				bPendingIsArticle = true;
+				bArticleAfterIn = Previous && Previous->Word == EWord::In;
+				Pending = 1.0;
+				break;
+			default:
+				break;
+			}
+			break;
+
+		default:
+			break;
+		}
+
+		Previous = Token.Kind == ETokenKind::Word ? Token.Keyword : nullptr;
+	}
+	FlushPending();
+
+	if (!bRecognized)
+	{
+		return false;
+	}
+
+	// ---- Day ----
+	const FDateTime Today = Now.GetDate();
+	FDateTime Date = Today;
+	const bool bExplicitDay = Month > 0 || Day > 0 || Weekday >= 0 || bDayWord;
+
+	if (Month > 0 || Day > 0)
+	{
+		const int32 DateMonth = Month > 0 ? Month : Now.GetMonth();
+		const int32 DateDay = Day > 0 ? Day : 1;
+		const int32 DateYear = Year > 0 ? Year : Now.GetYear();
+
+		if (!FDateTime::Validate(DateYear, DateMonth, DateDay, 0, 0, 0, 0))
+		{
+			return false;
+		}
+		Date = FDateTime(DateYear, DateMonth, DateDay);
+
+		// No year given and already past: next year's, or next month's for a bare "the 5th"
+		if (Year == 0 && Date < Today)
+		{
+			if (Month == 0)
+			{
+				Date = AddMonths(Date, 1);
+			}
+			else if (FDateTime::Validate(DateYear + 1, DateMonth, DateDay, 0, 0, 0, 0))
+			{
+				Date = FDateTime(DateYear + 1, DateMonth, DateDay);
+			}
+			else
+			{
+				return false;
+			}
+		}
+	}
+	else if (Weekday >= 0)
+	{
+		// Plain and "next" mean the coming one; only "this" can mean today
+		int32 Ahead = (Weekday - (int32)Now.GetDayOfWeek() + 7) % 7;
+		if (Ahead == 0 && !bThisWeekday)
+		{
+			Ahead = 7;
+		}
+		Date = Today + FTimespan::FromDays(Ahead);
+	}
+	Date += FTimespan::FromDays(DayOffset);
+
+	// ---- Offset ----
+	FDateTime Result = Date;
+	if (bOffset)
+	{
+		Result = (bExplicitDay ? Date + Now.GetTimeOfDay() : Now);
+		Result = AddMonths(Result, OffsetMonths) + FTimespan::FromMinutes(OffsetMinutes);
+	}
+
+	// ---- Time ----
+	if (Hour >= 0)
+	{
+		int32 FinalHour = Hour;
+		if (Meridiem == 2 && FinalHour < 12)
+		{
+			FinalHour += 12;
+		}
+		else if (Meridiem == 1 && FinalHour == 12)
+		{
+			FinalHour = 0;
+		}
+		else if (Meridiem == 0 && !bClock24 && FinalHour < 12)
+		{
+			// "evening at 7" is 19:00; otherwise 1-6 is more likely afternoon than before dawn
+			if (DefaultHour >= 12 || (DefaultHour < 0 && FinalHour >= 1 && FinalHour <= 6))
+			{
+				FinalHour += 12;
+			}
+		}
+
+		if (FinalHour > 23 || Minute > 59 || (Meridiem != 0 && Hour > 12))
+		{
+			return false;
+		}
+
+		Result = Result.GetDate() + FTimespan(FinalHour, Minute, 0);
+		if (bMidnight)
+		{
+			// The midnight that ends the day
+			Result += FTimespan::FromDays(1);
+		}
+	}
+	else if (DefaultHour >= 0)
+	{
+		Result = Result.GetDate() + FTimespan(DefaultHour, 0, 0);
+	}
+	else if (!bOffset)
+	{
+		Result = Result.GetDate() + FTimespan(12, 0, 0);
+	}
+
+	// A time alone that has already passed today means tomorrow
+	if (!bExplicitDay && !bOffset && Result <= Now)
+	{
+		Result += FTimespan::FromDays(1);
+	}
+
+	OutDateTime = Result;
+	bOutHasTime = Hour >= 0 || DefaultHour >= 0 || bOffset;
+	return true;
+}
+
+// ========================================
+// DURATION
+// ========================================
+
+int32 FAICompanionDateTimeParser::ParseDurationMinutes(FStringView Input)
+{
+	double Total = 0.0;
+	double Pending = -1.0;
+	bool bPendingIsArticle = false;
+	bool bHalf = false;
+	int32 LastUnit = 0;
+
+	FLexer Lexer(Input);
+	FToken Token;
+	while (Lexer.Next(Token))
+	{
+		switch (Token.Kind)
+		{
+		case ETokenKind::Number:
+			if (Pending >= 0.0 && !bPendingIsArticle)
+			{
+				Total += Pending;
+			}
+			Pending = Token.Number;
+			bPendingIsArticle = false;
+			break;
+
+		case ETokenKind::Time:
+			// "1:30" as a length
+			Total += Token.A * MinutesPerHour + Token.B;
+			break;
+
+		case ETokenKind::Word:
+			if (IsWord(Token, EWord::Unit) && Token.Keyword->Value > 0)
+			{
+				const double Amount = (Pending >= 0.0 ? Pending : 1.0) * (bHalf ? 0.5 : 1.0);
+				Total += Amount * Token.Keyword->Value;
+				LastUnit = Token.Keyword->Value;
+				Pending = -1.0;
+				bHalf = false;
+			}
+			else if (IsWord(Token, EWord::Article))
+			{
+				Pending = 1.0;
+				bPendingIsArticle = true;
+			}
+			else if (IsWord(Token, EWord::Half))
+			{
+				// "an hour and a half" vs "half an hour"
+				if (LastUnit > 0 && (Pending < 0.0 || bPendingIsArticle))
+				{
+					Total += LastUnit * 0.5;
+					Pending = -1.0;
+				}
+				else
+				{
+					bHalf = true;
+				}
+			}
+			break;
+
+		default:
+			break;
+		}
+	}
+
+	// A trailing bare number is minutes ("45", or the "30" in "1h30")
+	if (Pending >= 0.0 && !bPendingIsArticle)
+	{
+		Total += Pending;
+	}
+
+	return FMath::Max(FMath::RoundToInt(Total), 0);
+}
+
+// ========================================
+// WORDS
+// ========================================
+
+FAICompanionDateTimeParser::EWordClass FAICompanionDateTimeParser::ClassifyWord(FStringView Word)
+{
+	FLexer Lexer(Word);
+	FToken First;
+	if (!Lexer.Next(First))
+	{
+		return EWordClass::Other;
+	}
+
+	FToken Second;
+	const bool bMore = Lexer.Next(Second);
+
+	switch (First.Kind)
+	{
+	case ETokenKind::Time:
+	case ETokenKind::Date:
+		return EWordClass::DateTime;
+	case ETokenKind::Number:
+		// "2pm" and "3rd" carry their own suffix
+		if (bMore && Second.Kind == ETokenKind::Word && Second.Keyword)
+		{
+			return Second.Keyword->Word == EWord::Unit ? EWordClass::Unit : EWordClass::DateTime;
+		}
+		return EWordClass::Number;
+	default:
+		break;
+	}
+
+	if (!First.Keyword)
+	{
+		return EWordClass::Other;
+	}
+
+	switch (First.Keyword->Word)
+	{
+	case EWord::Unit:
+		// A lone "h" is a letter; "1h" was handled above
+		return First.Keyword->bContextual ? EWordClass::Other : EWordClass::Unit;
+	case EWord::Month:
+	case EWord::Weekday:
+		return First.Keyword->bContextual ? EWordClass::ContextualDate : EWordClass::DateTime;
+	case EWord::AM:
+	case EWord::PM:
+	case EWord::Ordinal:
+	case EWord::OClock:
+		return EWordClass::NumberSuffix;
+	case EWord::Article:
+	case EWord::Half:
+	case EWord::At:
+	case EWord::On:
+	case EWord::In:
+	case EWord::Later:
+		return EWordClass::Other;
+	default:
+		return EWordClass::DateTime;
+	}
+}
@@ -0,0 +1,50 @@
+// AICompanionDateTimeParser.h
+// Single-pass natural-language date, time and duration parsing for the calendar flow
+//
+// Recognized anywhere in the answer, mixed with filler words:
+//   day words   today, tonight, tomorrow, day after tomorrow
+//   weekdays    friday, next fri, this monday
+//   dates       november 5, 5th of nov, nov 5 2026, 11/5, 11/5/2026, 2026-11-05
+//   offsets     in 3 days, in an hour, 2 weeks from now, next week, next month
+//   times       2pm, 2:30 p.m., 14:30, at 3, 3 o'clock, noon, midnight, morning, evening
+//
+// Numeric dates are month/day. A bare hour from 1 to 6 with no am/pm is taken as
+// afternoon. Short forms that are also ordinary words only count in context: "may",
+// "mar", "jan", "jun" next to a day number, "sat", "sun", "wed" after next/this/on,
+// "h" right after a number, and "a week" after "in" or before "later"/"from now".
+// Keywords and their hash index are constexpr tables built at compile time and the
+// input is read in place, so parsing never allocates.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FAICompanionDateTimeParser
+{
+public:
+	/**
+	 * Resolve Input against Now. A day with no time means noon; a time with no day
+	 * means its next occurrence. False if nothing date- or time-like was found, or
+	 * the result is not a real date.
+	 */
+	static bool ParseDateTime(FStringView Input, const FDateTime& Now, FDateTime& OutDateTime);
+
+	/** As above; bOutHasTime says whether Input gave a time ("at noon", "tonight", "in an hour") or only a day */
+	static bool ParseDateTime(FStringView Input, const FDateTime& Now, FDateTime& OutDateTime, bool& bOutHasTime);
+
+	/** Minutes, e.g. "1 hour", "90 min", "1.5 hours", "an hour and a half", "1h30"; a bare number is minutes. 0 if none. */
+	static int32 ParseDurationMinutes(FStringView Input);
+
+	/** What one word means to the date grammar, for callers that pick date phrases out of a sentence */
+	enum class EWordClass : uint8
+	{
+		Other,
+		Number,			// "3": an hour, a day or a count depending on what follows
+		NumberSuffix,	// am, pm, ordinal, o'clock: gives a preceding number its meaning
+		Unit,			// minutes, hours, days...; also "90min"
+		DateTime,		// day words, weekdays, months, next/this, times and dates ("2pm", "14:30", "11/5")
+		ContextualDate	// "may", "sat": a date word only next to a day number or after next/this/on
+	};
+
+	static EWordClass ClassifyWord(FStringView Word);
+};
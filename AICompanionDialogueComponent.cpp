@@ -0,0 +1,119 @@
+// AICompanionDialogueComponent.cpp
+// Session bookkeeping around FAICompanionDialogueSession
+
+#include "AICompanionDialogueComponent.h"
+#include "AICompanionLog.h"
+
+UAICompanionDialogueComponent::UAICompanionDialogueComponent()
+{
+	// Everything happens in response to StartFlow / SubmitAnswer
+	PrimaryComponentTick.bCanEverTick = false;
+}
+
+void UAICompanionDialogueComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (FlowTable)
+	{
+		FAICompanionDialogueFlow::CompileTable(*FlowTable, TableFlows);
+		UE_LOG(LogAICompanion, Verbose, TEXT("[Dialogue] Compiled %d flows from %s"), TableFlows.Num(), *FlowTable->GetName());
+	}
+}
+
+TSharedPtr<const FAICompanionDialogueFlow> UAICompanionDialogueComponent::FindFlow(FName FlowName) const
+{
+	if (const TSharedPtr<const FAICompanionDialogueFlow>* Found = TableFlows.Find(FlowName))
+	{
+		return *Found;
+	}
+	return FAICompanionDialogueFlow::FindBuiltIn(FlowName);
+}
+
+int32 UAICompanionDialogueComponent::StartFlow(FName FlowName, bool bSkipOptional)
+{
+	TSharedPtr<const FAICompanionDialogueFlow> Flow = FindFlow(FlowName);
+	if (!Flow.IsValid())
+	{
+		UE_LOG(LogAICompanion, Warning, TEXT("[Dialogue] No flow named %s"), *FlowName.ToString());
+		return 0;
+	}
+
+	const int32 SessionId = NextSessionId++;
+	FAICompanionDialogueSession& Session = Sessions.Add(SessionId);
+	Session.Start(Flow.ToSharedRef());
+
+	const FAICompanionDialogueSession::EResult Result = Session.Begin(bSkipOptional);
+	HandleResult(SessionId, Result);
+	return Result == FAICompanionDialogueSession::EResult::Ask ? SessionId : 0;
+}
+
+bool UAICompanionDialogueComponent::SubmitAnswer(int32 SessionId, const FString& Answer)
+{
+	FAICompanionDialogueSession* Session = Sessions.Find(SessionId);
+	if (!Session)
+	{
+		return false;
+	}
+
+	HandleResult(SessionId, Session->Submit(Answer));
+	return true;
+}
+
+void UAICompanionDialogueComponent::CancelFlow(int32 SessionId)
+{
+	if (FAICompanionDialogueSession* Session = Sessions.Find(SessionId))
+	{
+		Session->Cancel();
+		HandleResult(SessionId, FAICompanionDialogueSession::EResult::Cancelled);
+	}
+}
+
+TArray<FAICompanionDialogueAnswer> UAICompanionDialogueComponent::GetAnswers(int32 SessionId) const
+{
+	TArray<FAICompanionDialogueAnswer> Answers;
+	if (const FAICompanionDialogueSession* Session = Sessions.Find(SessionId))
+	{
+		Session->ForEachValue([&Answers](FName Field, const FAICompanionDialogueValue& Value)
+		{
+			Answers.Add({ Field, Value.ToString() });
+		});
+	}
+	return Answers;
+}
+
+void UAICompanionDialogueComponent::HandleResult(int32 SessionId, FAICompanionDialogueSession::EResult Result)
+{
+	FAICompanionDialogueSession& Session = Sessions.FindChecked(SessionId);
+	const FName FlowName = Session.GetFlowName();
+
+	switch (Result)
+	{
+	case FAICompanionDialogueSession::EResult::Ask:
+	case FAICompanionDialogueSession::EResult::Rejected:
+	{
+		// Steps without a question (a final confirm) read back what we have
+		FString Question = Session.GetQuestion();
+		if (Question.IsEmpty())
+		{
+			Question = Session.BuildSummary() + TEXT("Should I go ahead?");
+		}
+		OnDialogueQuestion.Broadcast(SessionId, FlowName, Question);
+		break;
+	}
+	case FAICompanionDialogueSession::EResult::Completed:
+	{
+		// Removed before broadcasting so a handler can start the next flow
+		TArray<FAICompanionDialogueAnswer> Answers = GetAnswers(SessionId);
+		Sessions.Remove(SessionId);
+		UE_LOG(LogAICompanion, Verbose, TEXT("[Dialogue] Session %d (%s) completed"), SessionId, *FlowName.ToString());
+		OnDialogueCompleted.Broadcast(SessionId, FlowName, Answers);
+		break;
+	}
+	case FAICompanionDialogueSession::EResult::Cancelled:
+		Sessions.Remove(SessionId);
+		UE_LOG(LogAICompanion, Verbose, TEXT("[Dialogue] Session %d (%s) cancelled"), SessionId, *FlowName.ToString());
+		OnDialogueCancelled.Broadcast(SessionId, FlowName);
+		break;
+	}
+}
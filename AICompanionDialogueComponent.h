@@ -0,0 +1,90 @@
+// AICompanionDialogueComponent.h
+// Runs any number of table-driven dialogue flows (reminders, budgets, follow-ups...) side by side
+// Each StartFlow returns a session id; questions and results come back tagged with it
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "AICompanionDialogueFlow.h"
+#include "AICompanionDialogueComponent.generated.h"
+
+/**
+ * One collected answer, for Blueprints
+ */
+USTRUCT(BlueprintType)
+struct FAICompanionDialogueAnswer
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Dialogue")
+	FName Field;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Dialogue")
+	FString Value;
+};
+
+UCLASS(ClassGroup=(Custom), meta=(BlueprintSpawnableComponent))
+class JOEVISV3V1_API UAICompanionDialogueComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UAICompanionDialogueComponent();
+
+protected:
+	virtual void BeginPlay() override;
+
+public:
+	/** Flows made of FAICompanionDialogueStepRow rows; these override built-in flows of the same name */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Dialogue")
+	UDataTable* FlowTable = nullptr;
+
+	/**
+	 * Start a flow by name (from FlowTable, else built in: Calendar, Reminder, Budget, EventFollowUp).
+	 * Returns the session id, or 0 if there is no such flow or it has nothing to ask.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Dialogue")
+	int32 StartFlow(FName FlowName, bool bSkipOptional = false);
+
+	/** Answer the session's current question; false if the session is not running */
+	UFUNCTION(BlueprintCallable, Category = "Dialogue")
+	bool SubmitAnswer(int32 SessionId, const FString& Answer);
+
+	UFUNCTION(BlueprintCallable, Category = "Dialogue")
+	void CancelFlow(int32 SessionId);
+
+	UFUNCTION(BlueprintPure, Category = "Dialogue")
+	bool IsFlowActive(int32 SessionId) const { return Sessions.Contains(SessionId); }
+
+	UFUNCTION(BlueprintPure, Category = "Dialogue")
+	int32 GetActiveFlowCount() const { return Sessions.Num(); }
+
+	/** Answers collected so far */
+	UFUNCTION(BlueprintPure, Category = "Dialogue")
+	TArray<FAICompanionDialogueAnswer> GetAnswers(int32 SessionId) const;
+
+	DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FOnDialogueQuestion, int32, SessionId, FName, FlowName, const FString&, Question);
+	UPROPERTY(BlueprintAssignable, Category = "Dialogue")
+	FOnDialogueQuestion OnDialogueQuestion;
+
+	DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FOnDialogueCompleted, int32, SessionId, FName, FlowName, const TArray<FAICompanionDialogueAnswer>&, Answers);
+	UPROPERTY(BlueprintAssignable, Category = "Dialogue")
+	FOnDialogueCompleted OnDialogueCompleted;
+
+	DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnDialogueCancelled, int32, SessionId, FName, FlowName);
+	UPROPERTY(BlueprintAssignable, Category = "Dialogue")
+	FOnDialogueCancelled OnDialogueCancelled;
+
+private:
+	TSharedPtr<const FAICompanionDialogueFlow> FindFlow(FName FlowName) const;
+
+	/** Broadcast for the session's new position; removes it once finished */
+	void HandleResult(int32 SessionId, FAICompanionDialogueSession::EResult Result);
+
+	/** Compiled from FlowTable at BeginPlay */
+	TMap<FName, TSharedPtr<const FAICompanionDialogueFlow>> TableFlows;
+
+	TMap<int32, FAICompanionDialogueSession> Sessions;
+	int32 NextSessionId = 1;
+};
@@ -0,0 +1,597 @@
+// AICompanionDialogueFlow.cpp
+// Answer processors, flow compilation, built-in flows and session stepping
+
+#include "AICompanionDialogueFlow.h"
+#include "AICompanionDateTimeParser.h"
+#include "AICompanionLog.h"
+
+// ========================================
+// VALUES
+// ========================================
+
+FAICompanionDialogueValue FAICompanionDialogueValue::MakeText(const FString& InText)
+{
+	FAICompanionDialogueValue Value;
+	Value.Kind = EKind::Text;
+	Value.Text = InText;
+	return Value;
+}
+
+FAICompanionDialogueValue FAICompanionDialogueValue::MakeNumber(int64 InNumber)
+{
+	FAICompanionDialogueValue Value;
+	Value.Kind = EKind::Number;
+	Value.Number = InNumber;
+	return Value;
+}
+
+FAICompanionDialogueValue FAICompanionDialogueValue::MakeDateTime(const FDateTime& InTime)
+{
+	FAICompanionDialogueValue Value;
+	Value.Kind = EKind::DateTime;
+	Value.Time = InTime;
+	return Value;
+}
+
+FAICompanionDialogueValue FAICompanionDialogueValue::MakeBool(bool bInValue)
+{
+	FAICompanionDialogueValue Value;
+	Value.Kind = EKind::Bool;
+	Value.Number = bInValue ? 1 : 0;
+	return Value;
+}
+
+FString FAICompanionDialogueValue::ToString() const
+{
+	switch (Kind)
+	{
+	case EKind::Text:
+		return Text;
+	case EKind::Number:
+		return LexToString(Number);
+	case EKind::DateTime:
+		return Time.ToString(TEXT("%B %d, %Y at %I:%M %p"));
+	case EKind::Bool:
+		return Number != 0 ? TEXT("yes") : TEXT("no");
+	default:
+		return FString();
+	}
+}
+
+// ========================================
+// PROCESSORS
+// ========================================
+
+namespace AICompanionDialogueProcessors
+{
+	using EAnswer = EAICompanionDialogueAnswer;
+	using FValue = FAICompanionDialogueValue;
+
+	static bool IsNone(const FString& Trimmed)
+	{
+		return Trimmed.Equals(TEXT("none"), ESearchCase::IgnoreCase)
+			|| Trimmed.Equals(TEXT("no"), ESearchCase::IgnoreCase)
+			|| Trimmed.Equals(TEXT("skip"), ESearchCase::IgnoreCase);
+	}
+
+	/** First run of digits, or -1 */
+	static int64 FirstInteger(const FString& Answer)
+	{
+		int64 Number = -1;
+		for (const TCHAR Char : Answer)
+		{
+			if (FChar::IsDigit(Char))
+			{
+				Number = (Number < 0 ? 0 : Number * 10) + (Char - TEXT('0'));
+				if (Number > MAX_int32)
+				{
+					return -1;
+				}
+			}
+			else if (Number >= 0)
+			{
+				break;
+			}
+		}
+		return Number;
+	}
+
+	static EAnswer Text(const FString& Answer, FValue& OutValue)
+	{
+		const FString Trimmed = Answer.TrimStartAndEnd();
+		if (Trimmed.Len() < 2)
+		{
+			return EAnswer::Rejected;
+		}
+		OutValue = FValue::MakeText(Trimmed);
+		return EAnswer::Accepted;
+	}
+
+	/** Always accepted; "none", "no" or "skip" store an empty string */
+	static EAnswer OptionalText(const FString& Answer, FValue& OutValue)
+	{
+		const FString Trimmed = Answer.TrimStartAndEnd();
+		OutValue = FValue::MakeText(IsNone(Trimmed) ? FString() : Trimmed);
+		return EAnswer::Accepted;
+	}
+
+	static EAnswer DateTime(const FString& Answer, FValue& OutValue)
+	{
+		FDateTime Result;
+		if (!FAICompanionDateTimeParser::ParseDateTime(Answer, FDateTime::Now(), Result))
+		{
+			return EAnswer::Rejected;
+		}
+		OutValue = FValue::MakeDateTime(Result);
+		return EAnswer::Accepted;
+	}
+
+	/** Minutes */
+	static EAnswer Duration(const FString& Answer, FValue& OutValue)
+	{
+		const int32 Minutes = FAICompanionDateTimeParser::ParseDurationMinutes(Answer);
+		if (Minutes <= 0)
+		{
+			return EAnswer::Rejected;
+		}
+		OutValue = FValue::MakeNumber(Minutes);
+		return EAnswer::Accepted;
+	}
+
+	/** 1-10 */
+	static EAnswer Rating(const FString& Answer, FValue& OutValue)
+	{
+		const int64 Number = FirstInteger(Answer);
+		if (Number < 1 || Number > 10)
+		{
+			return EAnswer::Rejected;
+		}
+		OutValue = FValue::MakeNumber(Number);
+		return EAnswer::Accepted;
+	}
+
+	static EAnswer Number(const FString& Answer, FValue& OutValue)
+	{
+		const int64 Value = FirstInteger(Answer);
+		if (Value < 0)
+		{
+			return EAnswer::Rejected;
+		}
+		OutValue = FValue::MakeNumber(Value);
+		return EAnswer::Accepted;
+	}
+
+	/** Money: text "12.50", Number in cents */
+	static EAnswer Amount(const FString& Answer, FValue& OutValue)
+	{
+		int32 Start = 0;
+		while (Start < Answer.Len() && !FChar::IsDigit(Answer[Start]))
+		{
+			++Start;
+		}
+		int32 End = Start;
+		while (End < Answer.Len() && (FChar::IsDigit(Answer[End]) || Answer[End] == TEXT(',') || (Answer[End] == TEXT('.') && End + 1 < Answer.Len() && FChar::IsDigit(Answer[End + 1]))))
+		{
+			++End;
+		}
+		if (End == Start)
+		{
+			return EAnswer::Rejected;
+		}
+
+		const double Value = FCString::Atod(*Answer.Mid(Start, End - Start).Replace(TEXT(","), TEXT("")));
+		if (Value <= 0.0)
+		{
+			return EAnswer::Rejected;
+		}
+
+		OutValue = FValue::MakeText(FString::Printf(TEXT("%.2f"), Value));
+		OutValue.Number = FMath::RoundToInt64(Value * 100.0);
+		return EAnswer::Accepted;
+	}
+
+	/** Anything but a clear yes declines */
+	static EAnswer Confirm(const FString& Answer, FValue& OutValue)
+	{
+		static const TCHAR* const Affirmatives[] =
+		{
+			TEXT("yes"), TEXT("yeah"), TEXT("yep"), TEXT("sure"), TEXT("ok"), TEXT("okay"),
+			TEXT("y"), TEXT("confirm"), TEXT("correct"), TEXT("right")
+		};
+
+		const FString Trimmed = Answer.TrimStartAndEnd();
+		for (const TCHAR* Affirmative : Affirmatives)
+		{
+			if (Trimmed.Equals(Affirmative, ESearchCase::IgnoreCase))
+			{
+				OutValue = FValue::MakeBool(true);
+				return EAnswer::Accepted;
+			}
+		}
+		return EAnswer::Declined;
+	}
+
+	static TMap<FName, FAICompanionDialogueProcessor>& GetRegistry()
+	{
+		static TMap<FName, FAICompanionDialogueProcessor> Registry =
+		{
+			{ TEXT("Text"), &Text },
+			{ TEXT("OptionalText"), &OptionalText },
+			{ TEXT("DateTime"), &DateTime },
+			{ TEXT("Duration"), &Duration },
+			{ TEXT("Rating"), &Rating },
+			{ TEXT("Number"), &Number },
+			{ TEXT("Amount"), &Amount },
+			{ TEXT("Confirm"), &Confirm },
+		};
+		return Registry;
+	}
+}
+
+void FAICompanionDialogueFlow::RegisterProcessor(FName Name, FAICompanionDialogueProcessor Processor)
+{
+	check(IsInGameThread());
+	AICompanionDialogueProcessors::GetRegistry().Add(Name, Processor);
+}
+
+// ========================================
+// COMPILATION
+// ========================================
+
+namespace AICompanionDialogueFlowPrivate
+{
+	static const FName EndStep(TEXT("End"));
+	static const FName CancelStep(TEXT("Cancel"));
+
+	static bool ResolveStep(FName Target, int16 Default, const TMap<FName, int16>& StepIndices, int16& OutStep)
+	{
+		if (Target.IsNone())
+		{
+			OutStep = Default;
+		}
+		else if (Target == EndStep)
+		{
+			OutStep = FAICompanionDialogueFlow::StepComplete;
+		}
+		else if (Target == CancelStep)
+		{
+			OutStep = FAICompanionDialogueFlow::StepCancel;
+		}
+		else if (const int16* Found = StepIndices.Find(Target))
+		{
+			OutStep = *Found;
+		}
+		else
+		{
+			return false;
+		}
+		return true;
+	}
+}
+
+TSharedPtr<const FAICompanionDialogueFlow> FAICompanionDialogueFlow::Compile(FName FlowName, TConstArrayView<TPair<FName, const FAICompanionDialogueStepRow*>> Rows, FString& OutError)
+{
+	using namespace AICompanionDialogueFlowPrivate;
+
+	if (Rows.Num() == 0 || Rows.Num() > MAX_int16)
+	{
+		OutError = FString::Printf(TEXT("flow %s has %d steps"), *FlowName.ToString(), Rows.Num());
+		return nullptr;
+	}
+
+	TMap<FName, int16> StepIndices;
+	StepIndices.Reserve(Rows.Num());
+	for (int32 Index = 0; Index < Rows.Num(); ++Index)
+	{
+		StepIndices.Add(Rows[Index].Key, (int16)Index);
+	}
+
+	TSharedRef<FAICompanionDialogueFlow> Flow = MakeShared<FAICompanionDialogueFlow>();
+	Flow->Name = FlowName;
+	Flow->Steps.Reserve(Rows.Num());
+	Flow->Questions.Reserve(Rows.Num());
+
+	const TMap<FName, FAICompanionDialogueProcessor>& Processors = AICompanionDialogueProcessors::GetRegistry();
+	for (int32 Index = 0; Index < Rows.Num(); ++Index)
+	{
+		const FName StepName = Rows[Index].Key;
+		const FAICompanionDialogueStepRow& Row = *Rows[Index].Value;
+
+		const FAICompanionDialogueProcessor* Processor = Processors.Find(Row.Processor);
+		if (!Processor)
+		{
+			OutError = FString::Printf(TEXT("step %s uses unknown processor %s"), *StepName.ToString(), *Row.Processor.ToString());
+			return nullptr;
+		}
+
+		const FName FieldName = Row.Field.IsNone() ? StepName : Row.Field;
+		int32 Field = Flow->Fields.IndexOfByKey(FieldName);
+		if (Field == INDEX_NONE)
+		{
+			if (Flow->Fields.Num() > MAX_uint8)
+			{
+				OutError = FString::Printf(TEXT("flow %s has too many fields"), *FlowName.ToString());
+				return nullptr;
+			}
+			Field = Flow->Fields.Add(FieldName);
+		}
+
+		FStep& Step = Flow->Steps.AddDefaulted_GetRef();
+		Step.Process = *Processor;
+		Step.Field = (uint8)Field;
+		Step.bOptional = Row.bOptional;
+		Step.Question = Flow->Questions.Add(Row.Question);
+
+		const int16 Following = Index + 1 < Rows.Num() ? (int16)(Index + 1) : StepComplete;
+		if (!ResolveStep(Row.Next, Following, StepIndices, Step.Next)
+			|| !ResolveStep(Row.NextIfDeclined, StepCancel, StepIndices, Step.NextIfDeclined))
+		{
+			OutError = FString::Printf(TEXT("step %s goes to an unknown step"), *StepName.ToString());
+			return nullptr;
+		}
+	}
+
+	return Flow;
+}
+
+void FAICompanionDialogueFlow::CompileTable(const UDataTable& Table, TMap<FName, TSharedPtr<const FAICompanionDialogueFlow>>& OutFlows)
+{
+	if (!Table.GetRowStruct() || !Table.GetRowStruct()->IsChildOf(FAICompanionDialogueStepRow::StaticStruct()))
+	{
+		UE_LOG(LogAICompanion, Warning, TEXT("[DialogueFlow] %s does not hold FAICompanionDialogueStepRow rows"), *Table.GetName());
+		return;
+	}
+
+	// Rows keep their table order within each flow
+	TMap<FName, TArray<TPair<FName, const FAICompanionDialogueStepRow*>>> RowsByFlow;
+	for (const TPair<FName, uint8*>& Row : Table.GetRowMap())
+	{
+		const FAICompanionDialogueStepRow* Step = reinterpret_cast<const FAICompanionDialogueStepRow*>(Row.Value);
+		RowsByFlow.FindOrAdd(Step->Flow).Emplace(Row.Key, Step);
+	}
+
+	for (const TPair<FName, TArray<TPair<FName, const FAICompanionDialogueStepRow*>>>& Rows : RowsByFlow)
+	{
+		FString Error;
+		if (TSharedPtr<const FAICompanionDialogueFlow> Flow = Compile(Rows.Key, Rows.Value, Error))
+		{
+			OutFlows.Add(Rows.Key, MoveTemp(Flow));
+		}
+		else
+		{
+			UE_LOG(LogAICompanion, Warning, TEXT("[DialogueFlow] %s: %s"), *Table.GetName(), *Error);
+		}
+	}
+}
+
+// ========================================
+// BUILT-IN FLOWS
+// ========================================
+
+namespace AICompanionDialogueFlowPrivate
+{
+	struct FBuiltInStep
+	{
+		const TCHAR* Name;
+		const TCHAR* Processor;
+		const TCHAR* Question;
+		bool bOptional;
+		const TCHAR* Next;
+		const TCHAR* NextIfDeclined;
+	};
+
+	// Same questions as calendar-conversation-flow.js. The confirm question is left to the owner.
+	static const FBuiltInStep CalendarSteps[] =
+	{
+		{ TEXT("name"), TEXT("Text"), TEXT("What would you like to call this event?"), false, nullptr, nullptr },
+		{ TEXT("dateTime"), TEXT("DateTime"), TEXT("When would you like to schedule it? (e.g., 'tomorrow at 2pm', 'November 5 at 3:30pm')"), false, nullptr, nullptr },
+		{ TEXT("duration"), TEXT("Duration"), TEXT("How long will it take? (e.g., '1 hour', '30 minutes')"), true, nullptr, nullptr },
+		{ TEXT("location"), TEXT("OptionalText"), TEXT("Where will this take place? (or say 'none')"), true, nullptr, nullptr },
+		{ TEXT("notes"), TEXT("OptionalText"), TEXT("Any notes or details? (or say 'none')"), true, nullptr, nullptr },
+		{ TEXT("priority"), TEXT("Rating"), TEXT("How important is this event? (1-10, where 10 is most important)"), true, nullptr, nullptr },
+		{ TEXT("confirm"), TEXT("Confirm"), TEXT(""), false, nullptr, nullptr },
+	};
+
+	// Attendance check after an event, as in calendar-conversation-flow.js
+	static const FBuiltInStep EventFollowUpSteps[] =
+	{
+		{ TEXT("attended"), TEXT("Confirm"), TEXT("Did you attend the event?"), false, TEXT("End"), TEXT("importance") },
+		{ TEXT("importance"), TEXT("Rating"), TEXT("How important was it? (1-10)"), false, nullptr, nullptr },
+		{ TEXT("reschedule"), TEXT("Confirm"), TEXT("Would you like to reschedule it?"), false, nullptr, TEXT("End") },
+		{ TEXT("rescheduleTime"), TEXT("DateTime"), TEXT("When should it move to?"), false, nullptr, nullptr },
+	};
+
+	static const FBuiltInStep ReminderSteps[] =
+	{
+		{ TEXT("message"), TEXT("Text"), TEXT("What should I remind you about?"), false, nullptr, nullptr },
+		{ TEXT("time"), TEXT("DateTime"), TEXT("When should I remind you?"), false, nullptr, nullptr },
+		{ TEXT("confirm"), TEXT("Confirm"), TEXT("I'll remind you to {message} on {time}. Sound good?"), false, nullptr, nullptr },
+	};
+
+	// Spending limits as tracked by budget-manager-service.js
+	static const FBuiltInStep BudgetSteps[] =
+	{
+		{ TEXT("service"), TEXT("Text"), TEXT("Which service is the budget for?"), false, nullptr, nullptr },
+		{ TEXT("limit"), TEXT("Amount"), TEXT("What monthly limit should I set for {service}?"), false, nullptr, nullptr },
+		{ TEXT("confirm"), TEXT("Confirm"), TEXT("Set the {service} budget to ${limit} a month?"), false, nullptr, nullptr },
+	};
+
+	static TSharedPtr<const FAICompanionDialogueFlow> CompileBuiltIn(FName FlowName, TConstArrayView<FBuiltInStep> Steps)
+	{
+		TArray<FAICompanionDialogueStepRow> Rows;
+		Rows.Reserve(Steps.Num());
+		for (const FBuiltInStep& Step : Steps)
+		{
+			FAICompanionDialogueStepRow& Row = Rows.AddDefaulted_GetRef();
+			Row.Flow = FlowName;
+			Row.Field = Step.Name;
+			Row.Processor = Step.Processor;
+			Row.Question = Step.Question;
+			Row.bOptional = Step.bOptional;
+			Row.Next = Step.Next ? FName(Step.Next) : NAME_None;
+			Row.NextIfDeclined = Step.NextIfDeclined ? FName(Step.NextIfDeclined) : NAME_None;
+		}
+
+		TArray<TPair<FName, const FAICompanionDialogueStepRow*>> Named;
+		Named.Reserve(Rows.Num());
+		for (const FAICompanionDialogueStepRow& Row : Rows)
+		{
+			Named.Emplace(Row.Field, &Row);
+		}
+
+		FString Error;
+		TSharedPtr<const FAICompanionDialogueFlow> Flow = FAICompanionDialogueFlow::Compile(FlowName, Named, Error);
+		checkf(Flow.IsValid(), TEXT("Built-in dialogue flow %s: %s"), *FlowName.ToString(), *Error);
+		return Flow;
+	}
+}
+
+TSharedPtr<const FAICompanionDialogueFlow> FAICompanionDialogueFlow::FindBuiltIn(FName FlowName)
+{
+	using namespace AICompanionDialogueFlowPrivate;
+
+	check(IsInGameThread());
+	static TMap<FName, TSharedPtr<const FAICompanionDialogueFlow>> BuiltIns;
+	if (BuiltIns.Num() == 0)
+	{
+		BuiltIns.Add(TEXT("Calendar"), CompileBuiltIn(TEXT("Calendar"), CalendarSteps));
+		BuiltIns.Add(TEXT("EventFollowUp"), CompileBuiltIn(TEXT("EventFollowUp"), EventFollowUpSteps));
+		BuiltIns.Add(TEXT("Reminder"), CompileBuiltIn(TEXT("Reminder"), ReminderSteps));
+		BuiltIns.Add(TEXT("Budget"), CompileBuiltIn(TEXT("Budget"), BudgetSteps));
+	}
+	return BuiltIns.FindRef(FlowName);
+}
+
+// ========================================
+// SESSION
+// ========================================
+
+void FAICompanionDialogueSession::Start(TSharedRef<const FAICompanionDialogueFlow> InFlow)
+{
+	Flow = MoveTemp(InFlow);
+	Values.Reset();
+	Values.SetNum(Flow->NumFields());
+	Current = FAICompanionDialogueFlow::StepComplete;
+	bSkipOptional = false;
+}
+
+void FAICompanionDialogueSession::Prefill(FName Field, const FAICompanionDialogueValue& Value)
+{
+	const int32 FieldIndex = Flow.IsValid() ? Flow->FindField(Field) : INDEX_NONE;
+	if (FieldIndex != INDEX_NONE)
+	{
+		Values[FieldIndex] = Value;
+	}
+}
+
+FAICompanionDialogueSession::EResult FAICompanionDialogueSession::Begin(bool bInSkipOptional)
+{
+	bSkipOptional = bInSkipOptional;
+	return Flow.IsValid() ? MoveTo(0) : EResult::Cancelled;
+}
+
+FAICompanionDialogueSession::EResult FAICompanionDialogueSession::Submit(const FString& Answer)
+{
+	if (!IsActive())
+	{
+		return EResult::Cancelled;
+	}
+
+	const FAICompanionDialogueFlow::FStep& Step = Flow->GetStep(Current);
+	FAICompanionDialogueValue Value;
+	switch (Step.Process(Answer, Value))
+	{
+	case EAICompanionDialogueAnswer::Accepted:
+		Values[Step.Field] = MoveTemp(Value);
+		return MoveTo(Step.Next, Step.Next >= 0 && Step.Next <= Current);
+	case EAICompanionDialogueAnswer::Declined:
+		Values[Step.Field] = FAICompanionDialogueValue::MakeBool(false);
+		return MoveTo(Step.NextIfDeclined, true);
+	default:
+		return EResult::Rejected;
+	}
+}
+
+void FAICompanionDialogueSession::Cancel()
+{
+	Current = FAICompanionDialogueFlow::StepCancel;
+}
+
+FAICompanionDialogueSession::EResult FAICompanionDialogueSession::MoveTo(int16 Step, bool bAskTarget)
+{
+	// Skipping answered steps; a flow that loops back over them cannot spin forever.
+	// A branch target is asked again even if answered (e.g. a declined confirmation
+	// routing back to the step it confirmed); its old value still fills {field}.
+	for (int32 Guard = 0; Step >= 0 && Guard <= Flow->NumSteps(); ++Guard)
+	{
+		const FAICompanionDialogueFlow::FStep& Next = Flow->GetStep(Step);
+		if ((bAskTarget && Guard == 0) || (!Values[Next.Field].IsSet() && !(bSkipOptional && Next.bOptional)))
+		{
+			Current = Step;
+			return EResult::Ask;
+		}
+		Step = Next.Next;
+	}
+
+	Current = Step >= 0 ? FAICompanionDialogueFlow::StepComplete : Step;
+	return Current == FAICompanionDialogueFlow::StepCancel ? EResult::Cancelled : EResult::Completed;
+}
+
+FName FAICompanionDialogueSession::GetCurrentField() const
+{
+	return IsActive() ? Flow->GetFieldName(Flow->GetStep(Current).Field) : NAME_None;
+}
+
+FString FAICompanionDialogueSession::GetQuestion() const
+{
+	if (!IsActive())
+	{
+		return FString();
+	}
+
+	FString Question = Flow->GetQuestionTemplate(Current);
+	int32 Open = INDEX_NONE;
+	if (!Question.FindChar(TEXT('{'), Open))
+	{
+		return Question;
+	}
+
+	for (int32 Field = 0; Field < Values.Num(); ++Field)
+	{
+		if (Values[Field].IsSet())
+		{
+			Question.ReplaceInline(*FString::Printf(TEXT("{%s}"), *Flow->GetFieldName(Field).ToString()), *Values[Field].ToString());
+		}
+	}
+	return Question;
+}
+
+FString FAICompanionDialogueSession::BuildSummary() const
+{
+	FString Summary;
+	ForEachValue([&Summary](FName Field, const FAICompanionDialogueValue& Value)
+	{
+		if (Value.Kind != FAICompanionDialogueValue::EKind::Bool && !(Value.Kind == FAICompanionDialogueValue::EKind::Text && Value.Text.IsEmpty()))
+		{
+			Summary += FString::Printf(TEXT("%s: %s\n"), *Field.ToString(), *Value.ToString());
+		}
+	});
+	return Summary;
+}
+
+const FAICompanionDialogueValue* FAICompanionDialogueSession::FindValue(FName Field) const
+{
+	const int32 FieldIndex = Flow.IsValid() ? Flow->FindField(Field) : INDEX_NONE;
+	return FieldIndex != INDEX_NONE && Values[FieldIndex].IsSet() ? &Values[FieldIndex] : nullptr;
+}
+
+void FAICompanionDialogueSession::ForEachValue(TFunctionRef<void(FName Field, const FAICompanionDialogueValue& Value)> Visit) const
+{
+	for (int32 Field = 0; Field < Values.Num(); ++Field)
+	{
+		if (Values[Field].IsSet())
+		{
+			Visit(Flow->GetFieldName(Field), Values[Field]);
+		}
+	}
+}
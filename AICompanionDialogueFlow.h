@@ -0,0 +1,205 @@
+// AICompanionDialogueFlow.h
+// Table-driven question flows (calendar events, reminders, budgets...)
+//
+// A flow is a list of steps: ask a question, run the answer through a named
+// processor ("DateTime", "Rating", "Confirm"...), store the value under a field
+// and go to the next step. Flows are authored as FAICompanionDialogueStepRow rows
+// in a DataTable (or come built in) and compiled once into a flat step array
+// holding processor function pointers; a session is just that array, a step
+// index and the values collected so far, so any number can run side by side.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataTable.h"
+#include "AICompanionDialogueFlow.generated.h"
+
+/**
+ * One step of a dialogue flow. The row name is the step's id.
+ */
+USTRUCT(BlueprintType)
+struct FAICompanionDialogueStepRow : public FTableRowBase
+{
+	GENERATED_BODY()
+
+	/** Flow this step belongs to; steps run in row order */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue")
+	FName Flow;
+
+	/** Name the answer is stored under */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue")
+	FName Field;
+
+	/** Text, OptionalText, DateTime, Duration, Rating, Number, Amount or Confirm (see FAICompanionDialogueFlow::RegisterProcessor) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue")
+	FName Processor;
+
+	/** What to ask; {field} is replaced by that field's answer. Empty asks the owner to phrase it (e.g. a summary). */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue", meta = (MultiLine = true))
+	FString Question;
+
+	/** Skipped when the flow only asks for what it needs */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue")
+	bool bOptional = false;
+
+	/** Step after an accepted answer: a row name, End, or None for the next row */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue")
+	FName Next;
+
+	/** Step after a declined Confirm: a row name, End, or None to cancel the flow */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue")
+	FName NextIfDeclined;
+};
+
+/**
+ * An answer as stored by a processor
+ */
+struct FAICompanionDialogueValue
+{
+	enum class EKind : uint8
+	{
+		Unset,
+		Text,
+		Number,
+		DateTime,
+		Bool
+	};
+
+	EKind Kind = EKind::Unset;
+	FString Text;
+	int64 Number = 0;
+	FDateTime Time;
+
+	static FAICompanionDialogueValue MakeText(const FString& InText);
+	static FAICompanionDialogueValue MakeNumber(int64 InNumber);
+	static FAICompanionDialogueValue MakeDateTime(const FDateTime& InTime);
+	static FAICompanionDialogueValue MakeBool(bool bInValue);
+
+	bool IsSet() const { return Kind != EKind::Unset; }
+
+	/** For questions, summaries and Blueprint answers */
+	FString ToString() const;
+};
+
+/**
+ * What a processor made of an answer
+ */
+enum class EAICompanionDialogueAnswer : uint8
+{
+	Accepted,
+	Rejected,	// Not understood; ask again
+	Declined	// A Confirm step was answered no
+};
+
+using FAICompanionDialogueProcessor = EAICompanionDialogueAnswer (*)(const FString& Answer, FAICompanionDialogueValue& OutValue);
+
+/**
+ * A compiled, immutable flow
+ */
+class FAICompanionDialogueFlow
+{
+public:
+	/** Step index meaning "finish the flow" */
+	static constexpr int16 StepComplete = -1;
+
+	/** Step index meaning "abandon the flow" */
+	static constexpr int16 StepCancel = -2;
+
+	struct FStep
+	{
+		FAICompanionDialogueProcessor Process = nullptr;
+		int16 Next = StepComplete;
+		int16 NextIfDeclined = StepCancel;
+		uint8 Field = 0;
+		bool bOptional = false;
+		int32 Question = 0;
+	};
+
+	/** Compile the rows of one flow, in order; null (with OutError set) if a processor or step name is unknown */
+	static TSharedPtr<const FAICompanionDialogueFlow> Compile(FName FlowName, TConstArrayView<TPair<FName, const FAICompanionDialogueStepRow*>> Rows, FString& OutError);
+
+	/** Compile every flow in a table of FAICompanionDialogueStepRow; bad flows are logged and skipped */
+	static void CompileTable(const UDataTable& Table, TMap<FName, TSharedPtr<const FAICompanionDialogueFlow>>& OutFlows);
+
+	/** Calendar, Reminder, Budget and EventFollowUp; compiled on first use */
+	static TSharedPtr<const FAICompanionDialogueFlow> FindBuiltIn(FName FlowName);
+
+	/** Add or replace a processor available to flows compiled afterwards (game thread) */
+	static void RegisterProcessor(FName Name, FAICompanionDialogueProcessor Processor);
+
+	FName GetName() const { return Name; }
+	int32 NumSteps() const { return Steps.Num(); }
+	const FStep& GetStep(int32 Index) const { return Steps[Index]; }
+	const FString& GetQuestionTemplate(int32 StepIndex) const { return Questions[Steps[StepIndex].Question]; }
+
+	int32 NumFields() const { return Fields.Num(); }
+	FName GetFieldName(int32 FieldIndex) const { return Fields[FieldIndex]; }
+
+	/** INDEX_NONE if no step stores this field */
+	int32 FindField(FName Field) const { return Fields.IndexOfByKey(Field); }
+
+private:
+	FName Name;
+	TArray<FStep> Steps;
+	TArray<FString> Questions;
+	TArray<FName> Fields;
+};
+
+/**
+ * One run through a flow
+ */
+class FAICompanionDialogueSession
+{
+public:
+	enum class EResult : uint8
+	{
+		Ask,		// A (new) question is waiting: GetQuestion
+		Rejected,	// The answer was not understood; same question again
+		Completed,
+		Cancelled
+	};
+
+	/** Reset to the flow's start; Prefill, then Begin */
+	void Start(TSharedRef<const FAICompanionDialogueFlow> InFlow);
+
+	/** Store an answer ahead of time; its step is skipped. Ignored for fields the flow does not have. */
+	void Prefill(FName Field, const FAICompanionDialogueValue& Value);
+
+	/** Go to the first step that still needs asking. bSkipOptional drops optional steps without a value. */
+	EResult Begin(bool bSkipOptional = false);
+
+	EResult Submit(const FString& Answer);
+
+	void Cancel();
+
+	bool IsActive() const { return Flow.IsValid() && Current >= 0; }
+	FName GetFlowName() const { return Flow.IsValid() ? Flow->GetName() : NAME_None; }
+
+	/** Field of the current step, or None when not active */
+	FName GetCurrentField() const;
+
+	/** Current question with {field} placeholders filled in; empty if the step leaves phrasing to the owner */
+	FString GetQuestion() const;
+
+	/** "Field: value" lines for every answer so far */
+	FString BuildSummary() const;
+
+	const FAICompanionDialogueValue* FindValue(FName Field) const;
+
+	void ForEachValue(TFunctionRef<void(FName Field, const FAICompanionDialogueValue& Value)> Visit) const;
+
+private:
+	/**
+	 * Ask the first unanswered step from Step on. bAskTarget asks Step itself even if
+	 * answered: set for declined branches and for moves back to this or an earlier step.
+	 */
+	EResult MoveTo(int16 Step, bool bAskTarget = false);
+
+	TSharedPtr<const FAICompanionDialogueFlow> Flow;
+
+	/** Indexed by the flow's field index */
+	TArray<FAICompanionDialogueValue, TInlineAllocator<8>> Values;
+
+	int16 Current = FAICompanionDialogueFlow::StepComplete;
+	bool bSkipOptional = false;
+};
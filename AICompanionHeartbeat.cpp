@@ -0,0 +1,148 @@
+// AICompanionHeartbeat.cpp
+// Adaptive heartbeat interval and missed-pong detection
+
+#include "AICompanionHeartbeat.h"
+#include "AICompanionLog.h"
+
+// Stay this far below an observed idle cutoff
+static constexpr double HeartbeatCutoffMargin = 0.7;
+
+// Idle pings that must be answered before the interval is allowed to grow
+static constexpr int32 HeartbeatPingsBeforeGrowth = 3;
+static constexpr double HeartbeatGrowthFactor = 1.25;
+
+void FAICompanionHeartbeat::Configure(const FSettings& InSettings)
+{
+	Settings = InSettings;
+	Settings.MinInterval = FMath::Max(Settings.MinInterval, 1.0f);
+	Settings.MaxInterval = FMath::Max(Settings.MaxInterval, Settings.MinInterval);
+	Settings.MaxMissedPongs = FMath::Max(Settings.MaxMissedPongs, 1);
+
+	Interval = FMath::Clamp((double)Settings.InitialInterval, (double)Settings.MinInterval, (double)Settings.MaxInterval);
+	IdleCutoff = 0.0;
+	AnsweredIdlePings = 0;
+}
+
+void FAICompanionHeartbeat::Start(double Now)
+{
+	bRunning = true;
+	LastSent = Now;
+	LastReceived = Now;
+	OutstandingPingId = 0;
+	MissedPongs = 0;
+}
+
+void FAICompanionHeartbeat::Stop()
+{
+	bRunning = false;
+	OutstandingPingId = 0;
+}
+
+void FAICompanionHeartbeat::NoteConnectionLost(double Now)
+{
+	if (!bRunning)
+	{
+		return;
+	}
+
+	// A drop after a quiet spell looks like an idle cut; keep future gaps well under it
+	const double Idle = Now - FMath::Max(LastSent, LastReceived);
+	if (Idle >= Settings.MinInterval)
+	{
+		IdleCutoff = IdleCutoff > 0.0 ? FMath::Min(IdleCutoff, Idle) : Idle;
+		Interval = FMath::Clamp(IdleCutoff * HeartbeatCutoffMargin, (double)Settings.MinInterval, Interval);
+		AnsweredIdlePings = 0;
+
+		UE_LOG(LogAICompanion, Log, TEXT("[AICompanionHeartbeat] Connection lost after %.1fs idle; heartbeat interval now %.1fs"), Idle, Interval);
+	}
+
+	Stop();
+}
+
+void FAICompanionHeartbeat::NotePingSent(int32 RequestId, double Now)
+{
+	OutstandingPingId = RequestId;
+	PingSentAt = Now;
+}
+
+void FAICompanionHeartbeat::NotePong(int32 RequestId, double Now)
+{
+	if (RequestId == 0 || RequestId != OutstandingPingId)
+	{
+		return;
+	}
+
+	// RFC 6298 smoothing
+	const double Sample = Now - PingSentAt;
+	if (!bHaveRtt)
+	{
+		SmoothedRtt = Sample;
+		RttVariance = Sample * 0.5;
+		bHaveRtt = true;
+	}
+	else
+	{
+		RttVariance = 0.75 * RttVariance + 0.25 * FMath::Abs(SmoothedRtt - Sample);
+		SmoothedRtt = 0.875 * SmoothedRtt + 0.125 * Sample;
+	}
+
+	OutstandingPingId = 0;
+	MissedPongs = 0;
+
+	// The link survived a full idle interval; probe a longer one, staying under any cutoff seen
+	if (++AnsweredIdlePings >= HeartbeatPingsBeforeGrowth)
+	{
+		AnsweredIdlePings = 0;
+
+		double Grown = FMath::Min(Interval * HeartbeatGrowthFactor, (double)Settings.MaxInterval);
+		if (IdleCutoff > 0.0)
+		{
+			Grown = FMath::Min(Grown, IdleCutoff * HeartbeatCutoffMargin);
+		}
+		Interval = FMath::Max(Interval, Grown);
+	}
+}
+
+double FAICompanionHeartbeat::GetPongTimeout() const
+{
+	return bHaveRtt ? FMath::Clamp(SmoothedRtt + 4.0 * RttVariance, 1.0, 10.0) : 5.0;
+}
+
+FAICompanionHeartbeat::EAction FAICompanionHeartbeat::Update(double Now)
+{
+	if (!bRunning)
+	{
+		return EAction::None;
+	}
+
+	if (OutstandingPingId != 0)
+	{
+		if (Now - PingSentAt < GetPongTimeout())
+		{
+			return EAction::None;
+		}
+
+		OutstandingPingId = 0;
+
+		// Other frames arrived meanwhile, so the socket is alive even if the pong was lost
+		if (LastReceived > PingSentAt)
+		{
+			MissedPongs = 0;
+			return EAction::None;
+		}
+
+		if (++MissedPongs >= Settings.MaxMissedPongs)
+		{
+			UE_LOG(LogAICompanion, Warning, TEXT("[AICompanionHeartbeat] %d pongs missed, connection is dead"), MissedPongs);
+			return EAction::ConnectionDead;
+		}
+		return EAction::SendPing;
+	}
+
+	// Outgoing traffic keeps the proxy happy and incoming traffic proves liveness; ping only if either is stale
+	if (Now - LastSent >= Interval || Now - LastReceived >= Interval)
+	{
+		return EAction::SendPing;
+	}
+	return EAction::None;
+}
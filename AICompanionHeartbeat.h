@@ -0,0 +1,87 @@
+// AICompanionHeartbeat.h
+// Keep-alive and dead-socket detection for the backend connection
+//
+// Pings are only sent when the socket has been quiet for a full interval in
+// either direction; ordinary traffic counts as a heartbeat. The interval adapts:
+// it shrinks below any idle time after which the connection was cut (e.g. by a
+// proxy), and slowly grows again while idle pings keep coming back.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FAICompanionHeartbeat
+{
+public:
+	struct FSettings
+	{
+		/** Interval to start with (seconds) */
+		float InitialInterval = 20.0f;
+
+		/** Bounds for the adapted interval (seconds) */
+		float MinInterval = 5.0f;
+		float MaxInterval = 55.0f;
+
+		/** Consecutive unanswered pings before the socket is declared dead */
+		int32 MaxMissedPongs = 2;
+	};
+
+	enum class EAction : uint8
+	{
+		None,
+		SendPing,
+		ConnectionDead
+	};
+
+	/** Apply settings; resets the learned interval */
+	void Configure(const FSettings& InSettings);
+
+	/** Connection is up and registered */
+	void Start(double Now);
+
+	/** Connection closed on purpose or declared dead */
+	void Stop();
+
+	/** Connection dropped without us noticing first; learns the idle cutoff if it looks like one */
+	void NoteConnectionLost(double Now);
+
+	void NoteSent(double Now) { LastSent = Now; }
+
+	/** Any inbound frame proves the socket is alive */
+	void NoteReceived(double Now) { LastReceived = Now; }
+
+	void NotePingSent(int32 RequestId, double Now);
+	void NotePong(int32 RequestId, double Now);
+
+	/** Call periodically; tells the owner whether to ping or give up on the socket */
+	EAction Update(double Now);
+
+	bool IsRunning() const { return bRunning; }
+	float GetInterval() const { return (float)Interval; }
+	float GetSmoothedRtt() const { return (float)SmoothedRtt; }
+
+	/** How long to wait for a pong: smoothed RTT plus four deviations, as TCP does */
+	double GetPongTimeout() const;
+
+private:
+	FSettings Settings;
+	double Interval = 20.0;
+
+	/** Shortest idle time after which we have seen the connection cut (0 = none seen) */
+	double IdleCutoff = 0.0;
+
+	bool bRunning = false;
+	double LastSent = 0.0;
+	double LastReceived = 0.0;
+
+	int32 OutstandingPingId = 0;
+	double PingSentAt = 0.0;
+	int32 MissedPongs = 0;
+
+	/** Idle pings answered in a row since the interval last changed */
+	int32 AnsweredIdlePings = 0;
+
+	bool bHaveRtt = false;
+	double SmoothedRtt = 0.0;
+	double RttVariance = 0.0;
+};
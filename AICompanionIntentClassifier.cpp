@@ -0,0 +1,403 @@
+// AICompanionIntentClassifier.cpp
+// Phrase table, word trie and the streaming matcher
+
+#include "AICompanionIntentClassifier.h"
+
+namespace AICompanionIntents
+{
+	struct FPhrase
+	{
+		const TCHAR* Text;
+		EAICompanionIntent Intent;
+		float Weight;
+
+		/** Only counts when the utterance also names a day or time ("what's the schedule for the concert?" does not) */
+		bool bNeedsTime = false;
+	};
+
+	// Longer phrases are more specific and weigh more; an intent scores its best phrase
+	static const FPhrase Phrases[] =
+	{
+		{ TEXT("schedule"), EAICompanionIntent::CreateEvent, 0.8f, true },
+		{ TEXT("schedule a"), EAICompanionIntent::CreateEvent, 0.9f },
+		{ TEXT("schedule an"), EAICompanionIntent::CreateEvent, 0.9f },
+		{ TEXT("schedule my"), EAICompanionIntent::CreateEvent, 0.85f },
+		{ TEXT("create an event"), EAICompanionIntent::CreateEvent, 1.0f },
+		{ TEXT("create event"), EAICompanionIntent::CreateEvent, 1.0f },
+		{ TEXT("create a calendar event"), EAICompanionIntent::CreateEvent, 1.0f },
+		{ TEXT("add an event"), EAICompanionIntent::CreateEvent, 1.0f },
+		{ TEXT("add event"), EAICompanionIntent::CreateEvent, 1.0f },
+		{ TEXT("new event"), EAICompanionIntent::CreateEvent, 0.9f },
+		{ TEXT("add to my calendar"), EAICompanionIntent::CreateEvent, 1.0f },
+		{ TEXT("add to calendar"), EAICompanionIntent::CreateEvent, 1.0f },
+		{ TEXT("put on my calendar"), EAICompanionIntent::CreateEvent, 1.0f },
+		{ TEXT("on my calendar"), EAICompanionIntent::CreateEvent, 0.6f },
+		{ TEXT("set up a meeting"), EAICompanionIntent::CreateEvent, 1.0f },
+		{ TEXT("set up an appointment"), EAICompanionIntent::CreateEvent, 1.0f },
+		{ TEXT("make an appointment"), EAICompanionIntent::CreateEvent, 1.0f },
+		{ TEXT("book a meeting"), EAICompanionIntent::CreateEvent, 1.0f },
+		{ TEXT("book an appointment"), EAICompanionIntent::CreateEvent, 1.0f },
+		{ TEXT("book a"), EAICompanionIntent::CreateEvent, 0.8f, true },
+		{ TEXT("book an"), EAICompanionIntent::CreateEvent, 0.8f, true },
+
+		{ TEXT("my schedule"), EAICompanionIntent::QueryCalendar, 0.85f },
+		{ TEXT("my calendar"), EAICompanionIntent::QueryCalendar, 0.6f },
+		{ TEXT("what's on my"), EAICompanionIntent::QueryCalendar, 0.9f },
+		// "Do I have enough gold?" is not about the calendar; only the forms that name plans or a day count
+		{ TEXT("what do i have on"), EAICompanionIntent::QueryCalendar, 0.9f },
+		{ TEXT("what do i have today"), EAICompanionIntent::QueryCalendar, 0.9f },
+		{ TEXT("what do i have tomorrow"), EAICompanionIntent::QueryCalendar, 0.9f },
+		{ TEXT("what do i have planned"), EAICompanionIntent::QueryCalendar, 0.9f },
+		{ TEXT("what do i have coming up"), EAICompanionIntent::QueryCalendar, 0.9f },
+		{ TEXT("do i have plans"), EAICompanionIntent::QueryCalendar, 0.85f },
+		{ TEXT("do i have any plans"), EAICompanionIntent::QueryCalendar, 0.85f },
+		{ TEXT("do i have anything on"), EAICompanionIntent::QueryCalendar, 0.85f },
+		{ TEXT("do i have anything planned"), EAICompanionIntent::QueryCalendar, 0.85f },
+		{ TEXT("do i have anything scheduled"), EAICompanionIntent::QueryCalendar, 0.9f },
+		{ TEXT("do i have a meeting"), EAICompanionIntent::QueryCalendar, 0.85f },
+		{ TEXT("do i have any meetings"), EAICompanionIntent::QueryCalendar, 0.85f },
+		{ TEXT("do i have an appointment"), EAICompanionIntent::QueryCalendar, 0.85f },
+		{ TEXT("do i have any appointments"), EAICompanionIntent::QueryCalendar, 0.85f },
+		{ TEXT("am i free"), EAICompanionIntent::QueryCalendar, 0.9f },
+		{ TEXT("am i busy"), EAICompanionIntent::QueryCalendar, 0.9f },
+		{ TEXT("when is my"), EAICompanionIntent::QueryCalendar, 0.8f },
+
+		{ TEXT("remind me"), EAICompanionIntent::SetReminder, 0.9f },
+		{ TEXT("set a reminder"), EAICompanionIntent::SetReminder, 1.0f },
+		{ TEXT("reminder"), EAICompanionIntent::SetReminder, 0.7f },
+
+		{ TEXT("cancel"), EAICompanionIntent::Cancel, 0.8f },
+		{ TEXT("never mind"), EAICompanionIntent::Cancel, 0.9f },
+		{ TEXT("nevermind"), EAICompanionIntent::Cancel, 0.9f },
+		{ TEXT("forget it"), EAICompanionIntent::Cancel, 0.9f },
+		{ TEXT("stop"), EAICompanionIntent::Cancel, 0.6f },
+	};
+
+	// A phrase starting within this many words after a negation is ignored
+	static const TCHAR* const Negations[] = { TEXT("don't"), TEXT("not"), TEXT("without") };
+	constexpr int32 NegationWindow = 2;
+
+	// Words that name a day or time for bNeedsTime phrases; any word with a digit ("3pm", "15th") counts too
+	static const TCHAR* const TimeCues[] =
+	{
+		TEXT("today"), TEXT("tomorrow"), TEXT("tonight"), TEXT("morning"), TEXT("afternoon"), TEXT("evening"),
+		TEXT("noon"), TEXT("midnight"), TEXT("o'clock"), TEXT("week"), TEXT("weekend"),
+		TEXT("monday"), TEXT("tuesday"), TEXT("wednesday"), TEXT("thursday"), TEXT("friday"), TEXT("saturday"), TEXT("sunday")
+	};
+
+	// Phrases that can be partially matched at once; the table's longest phrase bounds what is useful
+	constexpr int32 MaxCursors = 8;
+
+	// Completed phrases kept per utterance; later ones are ignored past this
+	constexpr int32 MaxMatches = 32;
+
+	/**
+	 * Calls Visit(Hash, bHasDigit) with the FNV-1a hash of each lowercased word;
+	 * apostrophes inside words are dropped
+	 */
+	template <typename FunctorType>
+	static void ForEachWord(FStringView Text, FunctorType&& Visit)
+	{
+		const int32 Len = Text.Len();
+		int32 Pos = 0;
+		while (Pos < Len)
+		{
+			if (!FChar::IsAlnum(Text[Pos]))
+			{
+				++Pos;
+				continue;
+			}
+
+			uint32 Hash = 2166136261u;
+			bool bHasDigit = false;
+			while (Pos < Len)
+			{
+				const TCHAR Char = Text[Pos];
+				if (FChar::IsAlnum(Char))
+				{
+					Hash = (Hash ^ (uint32)FChar::ToLower(Char)) * 16777619u;
+					bHasDigit |= FChar::IsDigit(Char);
+				}
+				else if (!(Char == TEXT('\'') && Pos + 1 < Len && FChar::IsAlpha(Text[Pos + 1])))
+				{
+					break;
+				}
+				++Pos;
+			}
+			Visit(Hash, bHasDigit);
+		}
+	}
+
+	static uint32 HashSingleWord(const TCHAR* Text)
+	{
+		uint32 Result = 0;
+		ForEachWord(FStringView(Text), [&Result](uint32 Hash, bool) { Result = Hash; });
+		return Result;
+	}
+
+	/** Word-level trie; node 0 is the root. Built once, read-only afterwards. */
+	class FIntentTrie
+	{
+	public:
+		FIntentTrie()
+		{
+			Nodes.Reserve(UE_ARRAY_COUNT(Phrases) * 2);
+			Nodes.AddDefaulted();
+
+			for (const FPhrase& Phrase : Phrases)
+			{
+				int32 NodeIndex = 0;
+				ForEachWord(FStringView(Phrase.Text), [this, &NodeIndex](uint32 Hash, bool)
+				{
+					int32 Child = FindChild(NodeIndex, Hash);
+					if (Child == INDEX_NONE)
+					{
+						Child = Nodes.AddDefaulted();
+						Nodes[Child].WordHash = Hash;
+						Nodes[Child].NextSibling = Nodes[NodeIndex].FirstChild;
+						Nodes[NodeIndex].FirstChild = Child;
+					}
+					NodeIndex = Child;
+				});
+
+				Nodes[NodeIndex].Intent = Phrase.Intent;
+				Nodes[NodeIndex].Weight = FMath::Max(Nodes[NodeIndex].Weight, Phrase.Weight);
+				Nodes[NodeIndex].bNeedsTime = Phrase.bNeedsTime;
+			}
+
+			for (int32 Index = 0; Index < UE_ARRAY_COUNT(Negations); ++Index)
+			{
+				NegationHashes[Index] = HashSingleWord(Negations[Index]);
+			}
+			for (int32 Index = 0; Index < UE_ARRAY_COUNT(TimeCues); ++Index)
+			{
+				TimeCueHashes[Index] = HashSingleWord(TimeCues[Index]);
+			}
+		}
+
+		int32 FindChild(int32 NodeIndex, uint32 WordHash) const
+		{
+			for (int32 Child = Nodes[NodeIndex].FirstChild; Child != INDEX_NONE; Child = Nodes[Child].NextSibling)
+			{
+				if (Nodes[Child].WordHash == WordHash)
+				{
+					return Child;
+				}
+			}
+			return INDEX_NONE;
+		}
+
+		bool IsNegation(uint32 WordHash) const
+		{
+			for (const uint32 Negation : NegationHashes)
+			{
+				if (Negation == WordHash)
+				{
+					return true;
+				}
+			}
+			return false;
+		}
+
+		bool IsTimeCue(uint32 WordHash) const
+		{
+			for (const uint32 Cue : TimeCueHashes)
+			{
+				if (Cue == WordHash)
+				{
+					return true;
+				}
+			}
+			return false;
+		}
+
+		struct FNode
+		{
+			uint32 WordHash = 0;
+			int32 FirstChild = INDEX_NONE;
+			int32 NextSibling = INDEX_NONE;
+			EAICompanionIntent Intent = EAICompanionIntent::None;
+			float Weight = 0.0f;
+			bool bNeedsTime = false;
+		};
+
+		TArray<FNode> Nodes;
+		uint32 NegationHashes[UE_ARRAY_COUNT(Negations)];
+		uint32 TimeCueHashes[UE_ARRAY_COUNT(TimeCues)];
+	};
+
+	static const FIntentTrie& GetTrie()
+	{
+		static const FIntentTrie Trie;
+		return Trie;
+	}
+}
+
+FAICompanionIntentClassifier::FResult FAICompanionIntentClassifier::Classify(FStringView Utterance)
+{
+	using namespace AICompanionIntents;
+
+	const FIntentTrie& Trie = GetTrie();
+
+	struct FCursor
+	{
+		int32 Node;
+		int32 FirstWord;
+		bool bNegated;
+	};
+	FCursor Cursors[MaxCursors];
+	int32 NumCursors = 0;
+
+	// Every completed phrase with the words it covers; scored once the whole utterance is in
+	struct FMatch
+	{
+		int32 FirstWord;
+		int32 LastWord;
+		EAICompanionIntent Intent;
+		float Weight;
+		bool bNeedsTime;
+	};
+	FMatch Found[MaxMatches];
+	int32 NumFound = 0;
+	bool bHasTimeCue = false;
+
+	int32 WordIndex = 0;
+	int32 LastNegation = -NegationWindow - 1;
+
+	ForEachWord(Utterance, [&](uint32 Hash, bool bHasDigit)
+	{
+		// Advance every partial match by this word, dropping the ones it breaks
+		int32 Kept = 0;
+		for (int32 Index = 0; Index < NumCursors; ++Index)
+		{
+			const int32 Child = Trie.FindChild(Cursors[Index].Node, Hash);
+			if (Child != INDEX_NONE)
+			{
+				Cursors[Kept++] = { Child, Cursors[Index].FirstWord, Cursors[Index].bNegated };
+			}
+		}
+		NumCursors = Kept;
+
+		// And start a new one here
+		if (NumCursors < MaxCursors)
+		{
+			const int32 Child = Trie.FindChild(0, Hash);
+			if (Child != INDEX_NONE)
+			{
+				Cursors[NumCursors++] = { Child, WordIndex, WordIndex - LastNegation <= NegationWindow };
+			}
+		}
+
+		for (int32 Index = 0; Index < NumCursors && NumFound < MaxMatches; ++Index)
+		{
+			const FIntentTrie::FNode& Node = Trie.Nodes[Cursors[Index].Node];
+			if (Node.Intent != EAICompanionIntent::None && !Cursors[Index].bNegated)
+			{
+				Found[NumFound++] = { Cursors[Index].FirstWord, WordIndex, Node.Intent, Node.Weight, Node.bNeedsTime };
+			}
+		}
+
+		if (Trie.IsNegation(Hash))
+		{
+			LastNegation = WordIndex;
+		}
+		bHasTimeCue |= bHasDigit || Trie.IsTimeCue(Hash);
+		++WordIndex;
+	});
+
+	// bNeedsTime phrases only count if a time cue turned up anywhere
+	if (!bHasTimeCue)
+	{
+		int32 Kept = 0;
+		for (int32 Index = 0; Index < NumFound; ++Index)
+		{
+			if (!Found[Index].bNeedsTime)
+			{
+				Found[Kept++] = Found[Index];
+			}
+		}
+		NumFound = Kept;
+	}
+
+	// A phrase lying wholly inside a longer match is part of it, not a second opinion:
+	// "my calendar" in "add to my calendar", "schedule" in "schedule a"
+	bool bCounted[MaxMatches];
+	for (int32 Index = 0; Index < NumFound; ++Index)
+	{
+		const FMatch& Inner = Found[Index];
+		bCounted[Index] = true;
+		for (int32 Other = 0; Other < NumFound && bCounted[Index]; ++Other)
+		{
+			const FMatch& Outer = Found[Other];
+			bCounted[Index] = !(Outer.FirstWord <= Inner.FirstWord && Inner.LastWord <= Outer.LastWord
+				&& Outer.LastWord - Outer.FirstWord > Inner.LastWord - Inner.FirstWord);
+		}
+	}
+
+	constexpr int32 NumIntents = (int32)EAICompanionIntent::Count;
+	auto ScoreIntents = [&](auto&& Include, float (&OutScores)[NumIntents])
+	{
+		float Best[NumIntents] = {};
+		int32 Matches[NumIntents] = {};
+		for (int32 Index = 0; Index < NumFound; ++Index)
+		{
+			if (bCounted[Index] && Include(Found[Index]))
+			{
+				const int32 Slot = (int32)Found[Index].Intent;
+				Best[Slot] = FMath::Max(Best[Slot], Found[Index].Weight);
+				++Matches[Slot];
+			}
+		}
+
+		// Each extra phrase for the same intent adds a little certainty
+		for (int32 Slot = 0; Slot < NumIntents; ++Slot)
+		{
+			OutScores[Slot] = Matches[Slot] > 0 ? FMath::Min(Best[Slot] + 0.05f * (Matches[Slot] - 1), 1.0f) : 0.0f;
+		}
+	};
+
+	float Scores[NumIntents];
+	ScoreIntents([](const FMatch&) { return true; }, Scores);
+
+	FResult Result;
+	for (int32 Slot = 1; Slot < NumIntents; ++Slot)
+	{
+		if (Scores[Slot] > Result.Confidence)
+		{
+			Result.Confidence = Scores[Slot];
+			Result.Intent = (EAICompanionIntent)Slot;
+		}
+	}
+	if (Result.Intent == EAICompanionIntent::None)
+	{
+		return Result;
+	}
+
+	// A runner-up only makes the winner less certain if it was found in other words:
+	// "remind me to cancel" is in doubt, but "on my calendar" inside "what's on my calendar" is not
+	const EAICompanionIntent Winner = Result.Intent;
+	auto OverlapsWinner = [&](const FMatch& Match)
+	{
+		for (int32 Index = 0; Index < NumFound; ++Index)
+		{
+			const FMatch& Won = Found[Index];
+			if (bCounted[Index] && Won.Intent == Winner && Won.FirstWord <= Match.LastWord && Match.FirstWord <= Won.LastWord)
+			{
+				return true;
+			}
+		}
+		return false;
+	};
+
+	float RunnerScores[NumIntents];
+	ScoreIntents([&](const FMatch& Match) { return Match.Intent != Winner && !OverlapsWinner(Match); }, RunnerScores);
+
+	float Runner = 0.0f;
+	for (int32 Slot = 1; Slot < NumIntents; ++Slot)
+	{
+		Runner = FMath::Max(Runner, RunnerScores[Slot]);
+	}
+
+	Result.Confidence = FMath::Max(Result.Confidence - 0.5f * Runner, 0.0f);
+	return Result;
+}
@@ -0,0 +1,43 @@
+// AICompanionIntentClassifier.h
+// Local keyword intent detection for chat utterances
+//
+// Phrases ("schedule a", "add to my calendar", "never mind") live in a word trie
+// built once from a static table. An utterance is read in a single pass with a
+// few live cursors into the trie, so it is classified without allocating. Phrases
+// right after a negation ("don't schedule ...") do not count. Loose triggers such
+// as a bare "schedule" or "book a" only count alongside a day or time. A phrase
+// wholly inside a longer match ("my calendar" in "add to my calendar") is not
+// scored on its own.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AICompanionIntentClassifier.generated.h"
+
+/**
+ * What a chat utterance is asking for
+ */
+UENUM(BlueprintType)
+enum class EAICompanionIntent : uint8
+{
+	None UMETA(DisplayName = "None"),
+	CreateEvent UMETA(DisplayName = "Create Event"),
+	QueryCalendar UMETA(DisplayName = "Query Calendar"),
+	SetReminder UMETA(DisplayName = "Set Reminder"),
+	Cancel UMETA(DisplayName = "Cancel"),
+	Count UMETA(Hidden)
+};
+
+class FAICompanionIntentClassifier
+{
+public:
+	struct FResult
+	{
+		EAICompanionIntent Intent = EAICompanionIntent::None;
+
+		/** 0-1; the best phrase weight, reduced when another intent matched in other words */
+		float Confidence = 0.0f;
+	};
+
+	static FResult Classify(FStringView Utterance);
+};
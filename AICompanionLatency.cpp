@@ -0,0 +1,85 @@
+// AICompanionLatency.cpp
+// Histogram buckets
+
+#include "AICompanionLatency.h"
+
+// ========================================
+// HISTOGRAM
+// ========================================
+
+FAICompanionLatencyHistogram::FAICompanionLatencyHistogram()
+{
+	Reset();
+}
+
+void FAICompanionLatencyHistogram::Reset()
+{
+	FMemory::Memzero(Counts, sizeof(Counts));
+	TotalCount = 0;
+	Sum = 0;
+	MinValue = MAX_uint64;
+	MaxValue = 0;
+}
+
+int32 FAICompanionLatencyHistogram::IndexOf(uint64 Value)
+{
+	if (Value < SubBucketCount)
+	{
+		return (int32)Value;
+	}
+
+	const int32 Magnitude = (int32)FMath::FloorLog2_64(Value);
+	if (Magnitude > MaxMagnitude)
+	{
+		return BucketCount - 1;
+	}
+
+	// Keep the top SubBucketBits + 1 bits; the leading one is implied by the magnitude
+	const int32 Shift = Magnitude - SubBucketBits;
+	const int32 SubBucket = (int32)(Value >> Shift) - SubBucketCount;
+	return SubBucketCount + Shift * SubBucketCount + SubBucket;
+}
+
+uint64 FAICompanionLatencyHistogram::HighestEquivalent(int32 Index)
+{
+	if (Index < SubBucketCount)
+	{
+		return (uint64)Index;
+	}
+
+	const int32 Shift = (Index - SubBucketCount) / SubBucketCount;
+	const int32 SubBucket = (Index - SubBucketCount) % SubBucketCount;
+	const uint64 Lowest = (uint64)(SubBucket + SubBucketCount) << Shift;
+	return Lowest + ((uint64)1 << Shift) - 1;
+}
+
+void FAICompanionLatencyHistogram::Record(uint64 ValueMicros)
+{
+	++Counts[IndexOf(ValueMicros)];
+	++TotalCount;
+	Sum += ValueMicros;
+	MinValue = FMath::Min(MinValue, ValueMicros);
+	MaxValue = FMath::Max(MaxValue, ValueMicros);
+}
+
+uint64 FAICompanionLatencyHistogram::GetValueAtPercentile(double Percentile) const
+{
+	if (TotalCount == 0)
+	{
+		return 0;
+	}
+
+	const double Fraction = FMath::Clamp(Percentile, 0.0, 100.0) / 100.0;
+	const uint64 Target = FMath::Max<uint64>((uint64)FMath::CeilToDouble(Fraction * TotalCount), 1);
+
+	uint64 Seen = 0;
+	for (int32 Index = 0; Index < BucketCount; ++Index)
+	{
+		Seen += Counts[Index];
+		if (Seen >= Target)
+		{
+			return FMath::Min(HighestEquivalent(Index), MaxValue);
+		}
+	}
+	return MaxValue;
+}
@@ -0,0 +1,63 @@
+// AICompanionLatency.h
+// Latency histograms for backend round trips
+// Filled by FAICompanionRequestTable (AICompanionRequests.h) as replies arrive
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AICompanionLatency.generated.h"
+
+/**
+ * Latencies tracked by the AI Companion Manager
+ */
+UENUM(BlueprintType)
+enum class EAICompanionLatencyMetric : uint8
+{
+	PingRTT UMETA(DisplayName = "Ping Round Trip"),
+	TimeToFirstChunk UMETA(DisplayName = "Time To First Chunk"),
+	ChatResponse UMETA(DisplayName = "Chat Response"),
+	VoiceResponse UMETA(DisplayName = "Voice Response"),
+	CalendarResponse UMETA(DisplayName = "Calendar Response"),
+	Count UMETA(Hidden)
+};
+
+/**
+ * HDR-style histogram of microsecond values.
+ *
+ * Values below 32 are counted exactly; above that every power of two is split
+ * into 32 linear sub-buckets, so any recorded value is reported within ~3%.
+ * Fixed size, no allocation after construction.
+ */
+class FAICompanionLatencyHistogram
+{
+public:
+	FAICompanionLatencyHistogram();
+
+	void Record(uint64 ValueMicros);
+	void Reset();
+
+	/** Highest value equivalent to the given percentile (0-100) */
+	uint64 GetValueAtPercentile(double Percentile) const;
+
+	uint64 GetCount() const { return TotalCount; }
+	uint64 GetMin() const { return TotalCount ? MinValue : 0; }
+	uint64 GetMax() const { return MaxValue; }
+	double GetMean() const { return TotalCount ? (double)Sum / TotalCount : 0.0; }
+
+private:
+	static constexpr int32 SubBucketBits = 5;
+	static constexpr int32 SubBucketCount = 1 << SubBucketBits;
+
+	/** Largest tracked magnitude; anything longer (~12 days) is clamped */
+	static constexpr int32 MaxMagnitude = 40;
+	static constexpr int32 BucketCount = SubBucketCount + (MaxMagnitude - SubBucketBits + 1) * SubBucketCount;
+
+	static int32 IndexOf(uint64 Value);
+	static uint64 HighestEquivalent(int32 Index);
+
+	uint32 Counts[BucketCount];
+	uint64 TotalCount = 0;
+	uint64 Sum = 0;
+	uint64 MinValue = MAX_uint64;
+	uint64 MaxValue = 0;
+};
@@ -0,0 +1,578 @@
+// AICompanionLoadGenerator.cpp
+// Simulated client state machine, action mix and reporting
+
+#include "AICompanionLoadGenerator.h"
+#include "AICompanionLog.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/FileHelper.h"
+
+namespace
+{
+	const TCHAR* const ChatPrompts[] =
+	{
+		TEXT("What's on my schedule today?"),
+		TEXT("Remind me what we talked about yesterday"),
+		TEXT("Can you suggest a good time for a workout this week?"),
+		TEXT("How much have I spent on groceries this month?"),
+		TEXT("Give me a quick summary of my next meeting"),
+		TEXT("I'm feeling a bit overwhelmed, can you help me plan the afternoon?")
+	};
+
+	const TCHAR* const EventNames[] =
+	{
+		TEXT("Team sync"),
+		TEXT("Dentist appointment"),
+		TEXT("Lunch with Sam"),
+		TEXT("Gym"),
+		TEXT("Project review")
+	};
+
+	const TCHAR* ActionName(FAICompanionLoadGenerator::EAction Action)
+	{
+		switch (Action)
+		{
+		case FAICompanionLoadGenerator::EAction::Chat:		return TEXT("chat");
+		case FAICompanionLoadGenerator::EAction::Voice:		return TEXT("voice");
+		case FAICompanionLoadGenerator::EAction::Calendar:	return TEXT("calendar");
+		default:											return TEXT("?");
+		}
+	}
+
+	const TCHAR* MetricName(EAICompanionLatencyMetric Metric)
+	{
+		switch (Metric)
+		{
+		case EAICompanionLatencyMetric::PingRTT:			return TEXT("ping");
+		case EAICompanionLatencyMetric::TimeToFirstChunk:	return TEXT("first_chunk");
+		case EAICompanionLatencyMetric::ChatResponse:		return TEXT("chat");
+		case EAICompanionLatencyMetric::VoiceResponse:		return TEXT("voice");
+		case EAICompanionLatencyMetric::CalendarResponse:	return TEXT("calendar");
+		default:											return TEXT("?");
+		}
+	}
+
+	const double ReportPercentiles[] = { 50.0, 90.0, 99.0, 99.9 };
+
+	/** "p50 12.3ms p90 ..." for a microsecond histogram */
+	FString FormatPercentiles(const FAICompanionLatencyHistogram& Histogram)
+	{
+		FString Line;
+		for (double Percentile : ReportPercentiles)
+		{
+			Line += FString::Printf(TEXT("p%g %.1fms "), Percentile, Histogram.GetValueAtPercentile(Percentile) / 1000.0);
+		}
+		Line += FString::Printf(TEXT("max %.1fms"), Histogram.GetMax() / 1000.0);
+		return Line;
+	}
+}
+
+FAICompanionLoadGenerator::FAICompanionLoadGenerator(const FSettings& InSettings)
+	: Settings(InSettings)
+	, Random(InSettings.Seed)
+{
+	Settings.NumClients = FMath::Max(Settings.NumClients, 1);
+	Settings.ThinkMaxSeconds = FMath::Max(Settings.ThinkMaxSeconds, Settings.ThinkMinSeconds);
+	Settings.ReconnectMaxSeconds = FMath::Max(Settings.ReconnectMaxSeconds, Settings.ReconnectMinSeconds);
+	Settings.VoiceChunkSeconds = FMath::Max(Settings.VoiceChunkSeconds, 0.02f);
+
+	// Quiet tone rather than silence, so voice activity detection has something to hear
+	const int32 Samples = FMath::CeilToInt(Settings.VoiceSampleRate * Settings.VoiceChunkSeconds);
+	VoiceChunk.SetNumUninitialized(Samples * 2);
+	for (int32 Sample = 0; Sample < Samples; ++Sample)
+	{
+		const int16 Value = (int16)(2000.0f * FMath::Sin(2.0f * PI * 220.0f * Sample / Settings.VoiceSampleRate));
+		VoiceChunk[Sample * 2] = (uint8)(Value & 0xFF);
+		VoiceChunk[Sample * 2 + 1] = (uint8)((Value >> 8) & 0xFF);
+	}
+
+	Clients.SetNum(Settings.NumClients);
+	for (int32 Index = 0; Index < Clients.Num(); ++Index)
+	{
+		FClient& Client = Clients[Index];
+		Client.PlayerId = FString::Printf(TEXT("%s-%05d"), *Settings.PlayerPrefix, Index);
+		Client.Decode = MakeUnique<FAICompanionDecodePipeline>();
+
+		Client.Socket = MakeShared<FAICompanionConnection>();
+		Client.Socket->OnTextFrame.BindRaw(this, &FAICompanionLoadGenerator::HandleText, Index);
+		Client.Socket->OnBinaryFrame.BindRaw(this, &FAICompanionLoadGenerator::HandleBinary, Index);
+		Client.Socket->OnConnectionChanged.BindRaw(this, &FAICompanionLoadGenerator::HandleConnectionChanged, Index);
+		Client.Socket->OnError.BindRaw(this, &FAICompanionLoadGenerator::HandleError, Index);
+	}
+}
+
+FAICompanionLoadGenerator::~FAICompanionLoadGenerator()
+{
+	Stop();
+
+	for (FClient& Client : Clients)
+	{
+		// Nothing may call back into a generator that is going away
+		Client.Socket->OnTextFrame.Unbind();
+		Client.Socket->OnBinaryFrame.Unbind();
+		Client.Socket->OnConnectionChanged.Unbind();
+		Client.Socket->OnError.Unbind();
+		Client.Decode->Flush();
+	}
+}
+
+void FAICompanionLoadGenerator::Start(double Now)
+{
+	bRunning = true;
+	StartedAt = Now;
+	NextReportAt = Now + Settings.ReportIntervalSeconds;
+
+	// Evenly spread, so the backend sees a steady ramp rather than a thundering herd
+	const double Spacing = Clients.Num() > 1 ? Settings.RampUpSeconds / (Clients.Num() - 1) : 0.0;
+	for (int32 Index = 0; Index < Clients.Num(); ++Index)
+	{
+		Clients[Index].State = EClientState::Offline;
+		Clients[Index].NextActionAt = Now + Index * Spacing;
+	}
+
+	UE_LOG(LogAICompanion, Display, TEXT("[LoadTest] %d clients against %s, %.0fs ramp-up, %.0fs run, think %.1f-%.1fs, mix chat %d / voice %d / calendar %d, %s"),
+		Clients.Num(), *Settings.URL, Settings.RampUpSeconds, Settings.DurationSeconds, Settings.ThinkMinSeconds, Settings.ThinkMaxSeconds,
+		Settings.ChatWeight, Settings.VoiceWeight, Settings.CalendarWeight, Settings.bUseBinaryProtocol ? TEXT("bin1") : TEXT("json"));
+}
+
+void FAICompanionLoadGenerator::Stop()
+{
+	if (!bRunning)
+	{
+		return;
+	}
+	bRunning = false;
+
+	for (FClient& Client : Clients)
+	{
+		if (Client.RequestId != 0)
+		{
+			Requests.Forget(Client.RequestId);
+			Client.RequestId = 0;
+		}
+		Client.State = EClientState::Offline;
+		Client.Socket->Close();
+	}
+}
+
+bool FAICompanionLoadGenerator::Tick(double Now)
+{
+	if (!bRunning)
+	{
+		return false;
+	}
+
+	for (int32 Index = 0; Index < Clients.Num(); ++Index)
+	{
+		FAICompanionInboundMessage Message;
+		while (Clients[Index].Decode->Dequeue(Message))
+		{
+			DispatchMessage(Index, Message, Now);
+		}
+
+		UpdateClient(Index, Now);
+	}
+
+	Requests.Tick(Now);
+
+	if (Settings.ReportIntervalSeconds > 0.0f && Now >= NextReportAt)
+	{
+		NextReportAt = Now + Settings.ReportIntervalSeconds;
+		LogProgress(Now);
+	}
+
+	return Now - StartedAt < Settings.DurationSeconds;
+}
+
+void FAICompanionLoadGenerator::UpdateClient(int32 ClientIndex, double Now)
+{
+	FClient& Client = Clients[ClientIndex];
+	if (Now < Client.NextActionAt)
+	{
+		return;
+	}
+
+	switch (Client.State)
+	{
+	case EClientState::Offline:
+		Client.State = EClientState::Connecting;
+		Client.Format = EAICompanionWireFormat::Json;
+		Client.PhaseStartedAt = Now;
+		Client.NextActionAt = MAX_dbl;
+		Client.Socket->Connect(Settings.URL);
+		break;
+
+	case EClientState::Thinking:
+		StartAction(ClientIndex, Now);
+		break;
+
+	case EClientState::Speaking:
+		SendVoiceChunk(ClientIndex, Now);
+		break;
+
+	default:
+		// Connecting, Registering and Waiting advance on replies
+		break;
+	}
+}
+
+// ========================================
+// SOCKET
+// ========================================
+
+void FAICompanionLoadGenerator::HandleText(const FString& Frame, int32 ClientIndex)
+{
+	Clients[ClientIndex].Decode->Enqueue(Frame);
+}
+
+void FAICompanionLoadGenerator::HandleBinary(TArray<uint8>& Frame, int32 ClientIndex)
+{
+	Clients[ClientIndex].Decode->EnqueueBinary(MoveTemp(Frame));
+}
+
+void FAICompanionLoadGenerator::HandleConnectionChanged(bool bConnected, int32 ClientIndex)
+{
+	// Connected only opens the socket; the client registers once the backend says hello
+	if (!bConnected)
+	{
+		HandleLost(ClientIndex);
+	}
+}
+
+void FAICompanionLoadGenerator::HandleError(const FString& Error, int32 ClientIndex)
+{
+	UE_LOG(LogAICompanion, Verbose, TEXT("[LoadTest] %s error: %s"), *Clients[ClientIndex].PlayerId, *Error);
+	HandleLost(ClientIndex);
+}
+
+void FAICompanionLoadGenerator::HandleLost(int32 ClientIndex)
+{
+	FClient& Client = Clients[ClientIndex];
+
+	// Errors and closes both report the same failure; and Stop() closes everything on purpose
+	if (!bRunning || Client.State == EClientState::Offline)
+	{
+		return;
+	}
+
+	if (Client.RequestId != 0)
+	{
+		Requests.Forget(Client.RequestId);
+		Client.RequestId = 0;
+		++Actions[(int32)Client.Action].Dropped;
+	}
+
+	++Disconnects;
+	Client.State = EClientState::Offline;
+	Client.NextActionAt = FPlatformTime::Seconds() + Random.FRandRange(Settings.ReconnectMinSeconds, Settings.ReconnectMaxSeconds);
+	UE_LOG(LogAICompanion, Verbose, TEXT("[LoadTest] %s disconnected"), *Client.PlayerId);
+}
+
+// ========================================
+// MESSAGES
+// ========================================
+
+void FAICompanionLoadGenerator::DispatchMessage(int32 ClientIndex, const FAICompanionInboundMessage& Message, double Now)
+{
+	FClient& Client = Clients[ClientIndex];
+
+	if (Message.Type == AICompanionMessageTypes::Connected)
+	{
+		ConnectLatency.Record((uint64)((Now - Client.PhaseStartedAt) * 1.0e6));
+
+		// Registration always goes out as JSON, as in AAICompanionManager::RegisterPlayer
+		Writer.SetFormat(EAICompanionWireFormat::Json);
+		Writer.Begin(TEXT("register")).WriteString(TEXT("playerId"), Client.PlayerId);
+		if (Settings.bUseBinaryProtocol)
+		{
+			Writer.WriteString(TEXT("wire"), AICOMPANION_BINARY_WIRE_NAME);
+			if (Settings.bCompressFrames)
+			{
+				Writer.WriteString(TEXT("compression"), AICOMPANION_COMPRESSION_NAME);
+			}
+		}
+		Writer.Finish();
+		Transmit(Client);
+
+		Client.State = EClientState::Registering;
+		Client.PhaseStartedAt = Now;
+		return;
+	}
+
+	if (Message.Type == AICompanionMessageTypes::Registered)
+	{
+		RegisterLatency.Record((uint64)((Now - Client.PhaseStartedAt) * 1.0e6));
+
+		FString Wire;
+		if (Settings.bUseBinaryProtocol && Message.Payload.IsValid() && Message.Payload->TryGetStringField(TEXT("wire"), Wire) && Wire == AICOMPANION_BINARY_WIRE_NAME)
+		{
+			Client.Format = EAICompanionWireFormat::Binary;
+		}
+
+		// First action after a think, so a reconnect storm does not turn into a request storm
+		Client.State = EClientState::Thinking;
+		Client.NextActionAt = Now + ThinkTime();
+		return;
+	}
+
+	ResolveRequest(Message);
+}
+
+void FAICompanionLoadGenerator::ResolveRequest(const FAICompanionInboundMessage& Message)
+{
+	if (Message.RequestId == 0)
+	{
+		return;
+	}
+
+	// Same rules as AAICompanionManager: streamed chunks keep the request open, anything else answers it
+	if (Message.Type == AICompanionMessageTypes::ChatDelta || Message.Type == AICompanionMessageTypes::VoicePartial)
+	{
+		Requests.MarkFirstChunk(Message.RequestId);
+	}
+	else if (Message.Type == AICompanionMessageTypes::Error)
+	{
+		Requests.Fail(Message.RequestId, Message);
+	}
+	else
+	{
+		Requests.Complete(Message.RequestId, Message);
+	}
+}
+
+// ========================================
+// ACTIONS
+// ========================================
+
+void FAICompanionLoadGenerator::StartAction(int32 ClientIndex, double Now)
+{
+	FClient& Client = Clients[ClientIndex];
+	Client.Action = PickAction();
+
+	switch (Client.Action)
+	{
+	case EAction::Chat:
+		BeginMessage(Client, TEXT("chat"))
+			.WriteString(TEXT("text"), ChatPrompts[Random.RandHelper(UE_ARRAY_COUNT(ChatPrompts))])
+			.WriteBool(TEXT("stream"), Settings.bStreamResponses);
+		SendRequest(ClientIndex, EAction::Chat, EAICompanionLatencyMetric::ChatResponse);
+		break;
+
+	case EAction::Calendar:
+	{
+		const FDateTime When = FDateTime::Now().GetDate() + FTimespan::FromDays(Random.RandRange(1, 30)) + FTimespan::FromHours(Random.RandRange(9, 17));
+		BeginMessage(Client, TEXT("create_calendar_event"))
+			.WriteString(TEXT("eventName"), EventNames[Random.RandHelper(UE_ARRAY_COUNT(EventNames))])
+			.WriteDateTime(TEXT("dateTime"), When)
+			.WriteInt(TEXT("durationMinutes"), 30 * Random.RandRange(1, 4))
+			.WriteString(TEXT("location"), TEXT(""))
+			.WriteString(TEXT("notes"), TEXT("Created by the load test"))
+			.WriteInt(TEXT("priority"), Random.RandRange(0, 3));
+		SendRequest(ClientIndex, EAction::Calendar, EAICompanionLatencyMetric::CalendarResponse);
+		break;
+	}
+
+	case EAction::Voice:
+	default:
+		// voice_start rides with the first chunk, as in AAICompanionManager::PumpVoiceStream
+		++Client.VoiceStreamId;
+		Client.VoiceSeq = 0;
+		Client.VoiceChunksLeft = FMath::Max(1, FMath::RoundToInt(Settings.VoiceSeconds / Settings.VoiceChunkSeconds));
+		Client.State = EClientState::Speaking;
+
+		BeginMessage(Client, TEXT("voice_start"))
+			.WriteInt(TEXT("streamId"), Client.VoiceStreamId)
+			.WriteInt(TEXT("sampleRate"), Settings.VoiceSampleRate)
+			.WriteInt(TEXT("channels"), 1)
+			.WriteString(TEXT("encoding"), TEXT("pcm16"))
+			.Finish();
+		Transmit(Client);
+
+		SendVoiceChunk(ClientIndex, Now);
+		break;
+	}
+}
+
+void FAICompanionLoadGenerator::SendVoiceChunk(int32 ClientIndex, double Now)
+{
+	FClient& Client = Clients[ClientIndex];
+
+	BeginMessage(Client, TEXT("voice_chunk"))
+		.WriteInt(TEXT("streamId"), Client.VoiceStreamId)
+		.WriteInt(TEXT("seq"), Client.VoiceSeq++)
+		.WriteBytes(TEXT("audio"), VoiceChunk)
+		.Finish();
+	Transmit(Client);
+
+	if (--Client.VoiceChunksLeft > 0)
+	{
+		// Real-time pacing: the next chunk is what the microphone would have captured by then
+		Client.NextActionAt = Now + Settings.VoiceChunkSeconds;
+		return;
+	}
+
+	// Timed from end of speech to the answer
+	BeginMessage(Client, TEXT("voice_end"))
+		.WriteInt(TEXT("streamId"), Client.VoiceStreamId)
+		.WriteInt(TEXT("seq"), Client.VoiceSeq);
+	SendRequest(ClientIndex, EAction::Voice, EAICompanionLatencyMetric::VoiceResponse);
+}
+
+void FAICompanionLoadGenerator::SendRequest(int32 ClientIndex, EAction Action, EAICompanionLatencyMetric Metric)
+{
+	FClient& Client = Clients[ClientIndex];
+
+	Client.RequestId = Requests.Begin(Metric, Settings.RequestTimeoutSeconds,
+		FAICompanionRequestCallback::CreateRaw(this, &FAICompanionLoadGenerator::HandleRequestFinished, ClientIndex));
+	Writer.WriteInt(TEXT("requestId"), Client.RequestId).Finish();
+	Transmit(Client);
+
+	Client.State = EClientState::Waiting;
+	Client.NextActionAt = MAX_dbl;
+	++Actions[(int32)Action].Sent;
+}
+
+void FAICompanionLoadGenerator::HandleRequestFinished(EAICompanionRequestResult Result, const FAICompanionInboundMessage& Reply, int32 ClientIndex)
+{
+	FClient& Client = Clients[ClientIndex];
+	FActionStats& Stats = Actions[(int32)Client.Action];
+
+	switch (Result)
+	{
+	case EAICompanionRequestResult::Completed:	++Stats.Completed; break;
+	case EAICompanionRequestResult::Failed:		++Stats.Failed; break;
+	case EAICompanionRequestResult::TimedOut:	++Stats.TimedOut; break;
+	default:									break;
+	}
+
+	if (Result == EAICompanionRequestResult::Failed)
+	{
+		UE_LOG(LogAICompanion, Verbose, TEXT("[LoadTest] %s %s failed: %s"), *Client.PlayerId, ActionName(Client.Action), *Reply.Error);
+	}
+
+	// Closed loop: one request per client, the next one after a think
+	Client.RequestId = 0;
+	if (Client.State == EClientState::Waiting)
+	{
+		Client.State = EClientState::Thinking;
+		Client.NextActionAt = FPlatformTime::Seconds() + ThinkTime();
+	}
+}
+
+FAICompanionMessageWriter& FAICompanionLoadGenerator::BeginMessage(const FClient& Client, const TCHAR* Type)
+{
+	Writer.SetFormat(Client.Format);
+	return Writer.Begin(Type);
+}
+
+void FAICompanionLoadGenerator::Transmit(const FClient& Client)
+{
+	if (Writer.IsBinary())
+	{
+		Client.Socket->SendBinary(Writer.GetBytes());
+	}
+	else
+	{
+		Client.Socket->SendText(Writer.GetText());
+	}
+}
+
+FAICompanionLoadGenerator::EAction FAICompanionLoadGenerator::PickAction()
+{
+	const int32 Chat = FMath::Max(Settings.ChatWeight, 0);
+	const int32 Voice = FMath::Max(Settings.VoiceWeight, 0);
+	const int32 Total = Chat + Voice + FMath::Max(Settings.CalendarWeight, 0);
+	if (Total <= 0)
+	{
+		return EAction::Chat;
+	}
+
+	const int32 Roll = Random.RandHelper(Total);
+	return Roll < Chat ? EAction::Chat : Roll < Chat + Voice ? EAction::Voice : EAction::Calendar;
+}
+
+double FAICompanionLoadGenerator::ThinkTime()
+{
+	return Random.FRandRange(Settings.ThinkMinSeconds, Settings.ThinkMaxSeconds);
+}
+
+int32 FAICompanionLoadGenerator::NumRegistered() const
+{
+	int32 Registered = 0;
+	for (const FClient& Client : Clients)
+	{
+		Registered += Client.State >= EClientState::Thinking ? 1 : 0;
+	}
+	return Registered;
+}
+
+// ========================================
+// REPORTING
+// ========================================
+
+void FAICompanionLoadGenerator::LogProgress(double Now)
+{
+	uint64 Completed = 0;
+	uint64 Errors = 0;
+	for (const FActionStats& Stats : Actions)
+	{
+		Completed += Stats.Completed;
+		Errors += Stats.Failed + Stats.TimedOut + Stats.Dropped;
+	}
+
+	const double Rate = (Completed - CompletedAtLastReport) / FMath::Max((double)Settings.ReportIntervalSeconds, 0.001);
+	CompletedAtLastReport = Completed;
+
+	UE_LOG(LogAICompanion, Display, TEXT("[LoadTest] %5.0fs  %d/%d registered  %d in flight  %.1f req/s  %llu errors  %llu disconnects  chat %s"),
+		Now - StartedAt, NumRegistered(), Clients.Num(), Requests.Num(), Rate, Errors, Disconnects,
+		*FormatPercentiles(Requests.GetHistogram(EAICompanionLatencyMetric::ChatResponse)));
+}
+
+void FAICompanionLoadGenerator::LogReport(double Now) const
+{
+	const double Elapsed = FMath::Max(Now - StartedAt, 0.001);
+
+	UE_LOG(LogAICompanion, Display, TEXT("[LoadTest] ==== %d clients, %.1fs, %llu disconnects ===="), Clients.Num(), Elapsed, Disconnects);
+
+	for (int32 Action = 0; Action < (int32)EAction::Count; ++Action)
+	{
+		const FActionStats& Stats = Actions[Action];
+		UE_LOG(LogAICompanion, Display, TEXT("[LoadTest] %-10s sent %8llu  ok %8llu  failed %6llu  timed out %6llu  dropped %6llu  %.2f ok/s"),
+			ActionName((EAction)Action), Stats.Sent, Stats.Completed, Stats.Failed, Stats.TimedOut, Stats.Dropped, Stats.Completed / Elapsed);
+	}
+
+	UE_LOG(LogAICompanion, Display, TEXT("[LoadTest] %-12s n=%-8llu %s"), TEXT("connect"), ConnectLatency.GetCount(), *FormatPercentiles(ConnectLatency));
+	UE_LOG(LogAICompanion, Display, TEXT("[LoadTest] %-12s n=%-8llu %s"), TEXT("register"), RegisterLatency.GetCount(), *FormatPercentiles(RegisterLatency));
+	for (int32 Metric = 0; Metric < (int32)EAICompanionLatencyMetric::Count; ++Metric)
+	{
+		const FAICompanionLatencyHistogram& Histogram = Requests.GetHistogram((EAICompanionLatencyMetric)Metric);
+		if (Histogram.GetCount() > 0)
+		{
+			UE_LOG(LogAICompanion, Display, TEXT("[LoadTest] %-12s n=%-8llu %s"), MetricName((EAICompanionLatencyMetric)Metric), Histogram.GetCount(), *FormatPercentiles(Histogram));
+		}
+	}
+}
+
+bool FAICompanionLoadGenerator::WriteCsv(const FString& Path, double Now) const
+{
+	const double Elapsed = FMath::Max(Now - StartedAt, 0.001);
+
+	FString Csv = TEXT("metric,count,per_second,p50_ms,p90_ms,p99_ms,p999_ms,max_ms\n");
+	auto AddRow = [&Csv, Elapsed](const TCHAR* Name, const FAICompanionLatencyHistogram& Histogram)
+	{
+		Csv += FString::Printf(TEXT("%s,%llu,%.2f"), Name, Histogram.GetCount(), Histogram.GetCount() / Elapsed);
+		for (double Percentile : ReportPercentiles)
+		{
+			Csv += FString::Printf(TEXT(",%.2f"), Histogram.GetValueAtPercentile(Percentile) / 1000.0);
+		}
+		Csv += FString::Printf(TEXT(",%.2f\n"), Histogram.GetMax() / 1000.0);
+	};
+
+	AddRow(TEXT("connect"), ConnectLatency);
+	AddRow(TEXT("register"), RegisterLatency);
+	for (int32 Metric = 0; Metric < (int32)EAICompanionLatencyMetric::Count; ++Metric)
+	{
+		AddRow(MetricName((EAICompanionLatencyMetric)Metric), Requests.GetHistogram((EAICompanionLatencyMetric)Metric));
+	}
+
+	return FFileHelper::SaveStringToFile(Csv, *Path);
+}
@@ -0,0 +1,198 @@
+// AICompanionLoadGenerator.h
+// Many simulated AI Companion clients against one backend, for capacity testing
+//
+// Each simulated client opens its own socket and speaks the same protocol as
+// AAICompanionManager: register (negotiating bin1), then a closed loop of think,
+// act, wait for the reply. An action is a chat request (streamed or not), a voice
+// stream paced in real time (voice_start, voice_chunk..., voice_end) or a
+// create_calendar_event. Replies are matched through one shared request table,
+// so its latency histograms cover every client.
+//
+// Driven by UAICompanionLoadTestCommandlet; Tick() must be called from the game thread.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AICompanionConnection.h"
+#include "AICompanionProtocol.h"
+#include "AICompanionRequests.h"
+#include "AICompanionLatency.h"
+
+class FAICompanionLoadGenerator
+{
+public:
+	struct FSettings
+	{
+		FString URL;
+
+		int32 NumClients = 100;
+
+		/** Clients connect evenly spread over this window */
+		float RampUpSeconds = 10.0f;
+
+		/** Measured from the first connect; clients are closed after it */
+		float DurationSeconds = 60.0f;
+
+		/** Pause between a reply and the next action, uniform in [Min, Max] */
+		float ThinkMinSeconds = 2.0f;
+		float ThinkMaxSeconds = 8.0f;
+
+		/** Relative weights of the three actions */
+		int32 ChatWeight = 70;
+		int32 VoiceWeight = 10;
+		int32 CalendarWeight = 20;
+
+		bool bUseBinaryProtocol = true;
+		bool bStreamResponses = true;
+
+		/** Offer dictionary compression along with bin1 */
+		bool bCompressFrames = true;
+
+		/** Simulated utterance, sent in real-time chunks */
+		float VoiceSeconds = 2.0f;
+		float VoiceChunkSeconds = 0.25f;
+		int32 VoiceSampleRate = 16000;
+
+		float RequestTimeoutSeconds = 30.0f;
+
+		/** Delay before a dropped client connects again, uniform in [Min, Max] */
+		float ReconnectMinSeconds = 1.0f;
+		float ReconnectMaxSeconds = 5.0f;
+
+		/** 0 = no progress lines */
+		float ReportIntervalSeconds = 5.0f;
+
+		/** Clients register as <PlayerPrefix>-<index> */
+		FString PlayerPrefix = TEXT("loadtest");
+
+		int32 Seed = 0;
+	};
+
+	/** How each kind of action ended */
+	struct FActionStats
+	{
+		uint64 Sent = 0;
+		uint64 Completed = 0;
+		uint64 Failed = 0;
+		uint64 TimedOut = 0;
+
+		/** In flight when the client's socket dropped */
+		uint64 Dropped = 0;
+	};
+
+	enum class EAction : uint8
+	{
+		Chat,
+		Voice,
+		Calendar,
+		Count
+	};
+
+	explicit FAICompanionLoadGenerator(const FSettings& InSettings);
+	~FAICompanionLoadGenerator();
+
+	/** Begin ramping up clients */
+	void Start(double Now);
+
+	/** Close every client; pending requests are abandoned */
+	void Stop();
+
+	/** Connect, drain replies, run actions and expire requests. False once the run is over. */
+	bool Tick(double Now);
+
+	/** Final summary: per-action outcomes, throughput and latency percentiles */
+	void LogReport(double Now) const;
+
+	/** Same figures as LogReport, one line per metric */
+	bool WriteCsv(const FString& Path, double Now) const;
+
+	const FAICompanionRequestTable& GetRequests() const { return Requests; }
+	const FActionStats& GetActionStats(EAction Action) const { return Actions[(int32)Action]; }
+
+	int32 NumRegistered() const;
+
+private:
+	enum class EClientState : uint8
+	{
+		Offline,
+		Connecting,
+		Registering,
+		Thinking,
+		Speaking,
+		Waiting
+	};
+
+	struct FClient
+	{
+		FString PlayerId;
+		TSharedPtr<FAICompanionConnection> Socket;
+		TUniquePtr<FAICompanionDecodePipeline> Decode;
+
+		EClientState State = EClientState::Offline;
+		EAICompanionWireFormat Format = EAICompanionWireFormat::Json;
+
+		/** When to connect (Offline), act (Thinking) or send the next chunk (Speaking) */
+		double NextActionAt = 0.0;
+
+		/** Start of the current connect or registration, for their histograms */
+		double PhaseStartedAt = 0.0;
+
+		EAction Action = EAction::Chat;
+		int32 RequestId = 0;
+
+		int32 VoiceStreamId = 0;
+		int32 VoiceSeq = 0;
+		int32 VoiceChunksLeft = 0;
+	};
+
+	void HandleConnectionChanged(bool bConnected, int32 ClientIndex);
+	void HandleError(const FString& Error, int32 ClientIndex);
+	void HandleText(const FString& Frame, int32 ClientIndex);
+	void HandleBinary(TArray<uint8>& Frame, int32 ClientIndex);
+	void HandleLost(int32 ClientIndex);
+
+	void UpdateClient(int32 ClientIndex, double Now);
+	void DispatchMessage(int32 ClientIndex, const FAICompanionInboundMessage& Message, double Now);
+	void ResolveRequest(const FAICompanionInboundMessage& Message);
+
+	void StartAction(int32 ClientIndex, double Now);
+	void SendVoiceChunk(int32 ClientIndex, double Now);
+	void SendRequest(int32 ClientIndex, EAction Action, EAICompanionLatencyMetric Metric);
+	void HandleRequestFinished(EAICompanionRequestResult Result, const FAICompanionInboundMessage& Reply, int32 ClientIndex);
+
+	FAICompanionMessageWriter& BeginMessage(const FClient& Client, const TCHAR* Type);
+	void Transmit(const FClient& Client);
+
+	EAction PickAction();
+	double ThinkTime();
+
+	void LogProgress(double Now);
+
+	FSettings Settings;
+	FRandomStream Random;
+
+	TArray<FClient> Clients;
+	bool bRunning = false;
+	double StartedAt = 0.0;
+	double NextReportAt = 0.0;
+
+	/** Shared by all clients; requestIds are unique across the run */
+	FAICompanionRequestTable Requests;
+
+	/** Shared encoder; switched to each client's format per message */
+	FAICompanionMessageWriter Writer;
+
+	/** One chunk of synthetic speech, reused for every voice_chunk */
+	TArray<uint8> VoiceChunk;
+
+	FActionStats Actions[(int32)EAction::Count];
+
+	/** Socket open to "connected" frame, and register to registered */
+	FAICompanionLatencyHistogram ConnectLatency;
+	FAICompanionLatencyHistogram RegisterLatency;
+
+	uint64 Disconnects = 0;
+
+	/** Completed requests at the last progress line */
+	uint64 CompletedAtLastReport = 0;
+};
@@ -0,0 +1,111 @@
+// AICompanionLoadTestCommandlet.cpp
+// Command line parsing and the tick loop around FAICompanionLoadGenerator
+
+#include "AICompanionLoadTestCommandlet.h"
+#include "AICompanionLoadGenerator.h"
+#include "AICompanionLog.h"
+#include "CoreGlobals.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "Containers/Ticker.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/Paths.h"
+
+UAICompanionLoadTestCommandlet::UAICompanionLoadTestCommandlet()
+{
+	IsClient = false;
+	IsEditor = false;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UAICompanionLoadTestCommandlet::Main(const FString& Params)
+{
+	FAICompanionLoadGenerator::FSettings Settings;
+	if (!FParse::Value(*Params, TEXT("url="), Settings.URL) || Settings.URL.IsEmpty())
+	{
+		UE_LOG(LogAICompanion, Error, TEXT("[LoadTest] -url=ws://host:port is required"));
+		return 1;
+	}
+
+	FParse::Value(*Params, TEXT("clients="), Settings.NumClients);
+	FParse::Value(*Params, TEXT("rampup="), Settings.RampUpSeconds);
+	FParse::Value(*Params, TEXT("duration="), Settings.DurationSeconds);
+	FParse::Value(*Params, TEXT("thinkmin="), Settings.ThinkMinSeconds);
+	FParse::Value(*Params, TEXT("thinkmax="), Settings.ThinkMaxSeconds);
+	FParse::Value(*Params, TEXT("voiceseconds="), Settings.VoiceSeconds);
+	FParse::Value(*Params, TEXT("timeout="), Settings.RequestTimeoutSeconds);
+	FParse::Value(*Params, TEXT("report="), Settings.ReportIntervalSeconds);
+	FParse::Value(*Params, TEXT("seed="), Settings.Seed);
+	FParse::Value(*Params, TEXT("prefix="), Settings.PlayerPrefix);
+	Settings.bUseBinaryProtocol = !FParse::Param(*Params, TEXT("json"));
+	Settings.bStreamResponses = !FParse::Param(*Params, TEXT("nostream"));
+	Settings.bCompressFrames = !FParse::Param(*Params, TEXT("nocompress"));
+
+	FString Mix;
+	if (FParse::Value(*Params, TEXT("mix="), Mix, false))
+	{
+		TArray<FString> Weights;
+		Mix.ParseIntoArray(Weights, TEXT(","));
+		if (Weights.Num() != 3)
+		{
+			UE_LOG(LogAICompanion, Error, TEXT("[LoadTest] -mix takes three weights: chat,voice,calendar"));
+			return 1;
+		}
+		Settings.ChatWeight = FCString::Atoi(*Weights[0]);
+		Settings.VoiceWeight = FCString::Atoi(*Weights[1]);
+		Settings.CalendarWeight = FCString::Atoi(*Weights[2]);
+	}
+
+	FString CsvPath;
+	if (!FParse::Value(*Params, TEXT("csv="), CsvPath))
+	{
+		CsvPath = FPaths::ProjectSavedDir() / TEXT("AICompanion") / TEXT("LoadTest.csv");
+	}
+
+	// Nothing else ticks in a commandlet: pump game-thread tasks and the core ticker,
+	// which is where the WebSockets module delivers its callbacks
+	FAICompanionLoadGenerator Generator(Settings);
+	double LastTime = FPlatformTime::Seconds();
+	Generator.Start(LastTime);
+
+	while (!IsEngineExitRequested())
+	{
+		const double Now = FPlatformTime::Seconds();
+		FTaskGraphInterface::Get().ProcessThreadUntilIdle(ENamedThreads::GameThread);
+		FTSTicker::GetCoreTicker().Tick((float)(Now - LastTime));
+		LastTime = Now;
+
+		if (!Generator.Tick(Now))
+		{
+			break;
+		}
+
+		// Coarse enough to leave the CPU to the sockets, fine enough not to skew latencies much
+		FPlatformProcess::Sleep(0.002f);
+	}
+
+	const double EndTime = FPlatformTime::Seconds();
+	Generator.Stop();
+
+	// Let the close handshakes go out before the sockets are destroyed
+	const double CloseDeadline = EndTime + 2.0;
+	while (FPlatformTime::Seconds() < CloseDeadline)
+	{
+		FTaskGraphInterface::Get().ProcessThreadUntilIdle(ENamedThreads::GameThread);
+		FTSTicker::GetCoreTicker().Tick(0.01f);
+		FPlatformProcess::Sleep(0.01f);
+	}
+
+	Generator.LogReport(EndTime);
+	if (Generator.WriteCsv(CsvPath, EndTime))
+	{
+		UE_LOG(LogAICompanion, Display, TEXT("[LoadTest] Results written to %s"), *CsvPath);
+	}
+	else
+	{
+		UE_LOG(LogAICompanion, Warning, TEXT("[LoadTest] Could not write %s"), *CsvPath);
+	}
+
+	return 0;
+}
@@ -0,0 +1,28 @@
+// AICompanionLoadTestCommandlet.h
+// Headless load test of the backend with simulated AI Companion clients
+//
+//   UnrealEditor-Cmd <Project> -run=AICompanionLoadTest -url=wss://host [-clients=1000] [-rampup=30] [-duration=300]
+//       [-thinkmin=2] [-thinkmax=8] [-mix=70,10,20] [-json] [-nostream] [-nocompress] [-voiceseconds=2] [-timeout=30]
+//       [-report=5] [-seed=0] [-csv=Out.csv]
+//
+// -mix is the chat, voice and calendar weights. Progress is logged every -report
+// seconds; the summary (throughput, outcomes, latency percentiles) is logged at the
+// end and written as CSV. Each client holds a socket, so large runs may need a higher
+// open-file limit on the machine driving them.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "AICompanionLoadTestCommandlet.generated.h"
+
+UCLASS()
+class JOEVISV3V1_API UAICompanionLoadTestCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UAICompanionLoadTestCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,58 @@
+// AICompanionLog.cpp
+// Log category definition and rate-limited payload logging
+
+#include "AICompanionLog.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+
+DEFINE_LOG_CATEGORY(LogAICompanion);
+
+#if AICOMPANION_LOG_PAYLOADS
+
+static int32 GAICompanionLogPayloads = 0;
+static FAutoConsoleVariableRef CVarAICompanionLogPayloads(
+	TEXT("AICompanion.LogPayloads"),
+	GAICompanionLogPayloads,
+	TEXT("Maximum raw WebSocket payloads logged per second (0 = off)."));
+
+static int32 GAICompanionLogPayloadMaxChars = 256;
+static FAutoConsoleVariableRef CVarAICompanionLogPayloadMaxChars(
+	TEXT("AICompanion.LogPayloadMaxChars"),
+	GAICompanionLogPayloadMaxChars,
+	TEXT("Characters of each logged payload to keep."));
+
+bool AICompanionLog::ShouldLogPayload()
+{
+	if (GAICompanionLogPayloads <= 0 || !UE_LOG_ACTIVE(LogAICompanion, Log))
+	{
+		return false;
+	}
+
+	// Game thread only, so plain statics are enough for the per-second window
+	static double WindowStart = 0.0;
+	static int32 LoggedInWindow = 0;
+
+	const double Now = FPlatformTime::Seconds();
+	if (Now - WindowStart >= 1.0)
+	{
+		WindowStart = Now;
+		LoggedInWindow = 0;
+	}
+
+	return LoggedInWindow++ < GAICompanionLogPayloads;
+}
+
+void AICompanionLog::LogPayload(const TCHAR* Direction, const FString& Payload)
+{
+	const int32 MaxChars = FMath::Max(GAICompanionLogPayloadMaxChars, 0);
+	if (Payload.Len() > MaxChars)
+	{
+		UE_LOG(LogAICompanion, Log, TEXT("%s %s... (%d chars)"), Direction, *Payload.Left(MaxChars), Payload.Len());
+	}
+	else
+	{
+		UE_LOG(LogAICompanion, Log, TEXT("%s %s"), Direction, *Payload);
+	}
+}
+
+#endif
@@ -0,0 +1,43 @@
+// AICompanionLog.h
+// Log category, stats group and payload logging for the AI Companion client
+//
+// Verbose/Log lines compile out of Shipping builds. Raw payloads are only
+// logged when AICompanion.LogPayloads is set, capped per second.
+// Runtime counters show up under STAT AICompanion.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Logging/LogMacros.h"
+#include "Stats/Stats.h"
+
+#if UE_BUILD_SHIPPING
+	#define AICOMPANION_LOG_COMPILE_VERBOSITY Warning
+#else
+	#define AICOMPANION_LOG_COMPILE_VERBOSITY All
+#endif
+
+DECLARE_LOG_CATEGORY_EXTERN(LogAICompanion, Log, AICOMPANION_LOG_COMPILE_VERBOSITY);
+
+DECLARE_STATS_GROUP(TEXT("AICompanion"), STATGROUP_AICompanion, STATCAT_Advanced);
+
+#define AICOMPANION_LOG_PAYLOADS (!NO_LOGGING && !UE_BUILD_SHIPPING)
+
+namespace AICompanionLog
+{
+#if AICOMPANION_LOG_PAYLOADS
+	/** True if another payload may be logged this second (reads AICompanion.LogPayloads) */
+	bool ShouldLogPayload();
+
+	/** Log a payload on one line, truncated to AICompanion.LogPayloadMaxChars */
+	void LogPayload(const TCHAR* Direction, const FString& Payload);
+#endif
+}
+
+/** Log a raw frame if payload logging is enabled and under its rate limit */
+#if AICOMPANION_LOG_PAYLOADS
+	#define AICOMPANION_LOG_PAYLOAD(Direction, Payload) \
+		do { if (AICompanionLog::ShouldLogPayload()) { AICompanionLog::LogPayload(Direction, Payload); } } while (0)
+#else
+	#define AICOMPANION_LOG_PAYLOAD(Direction, Payload) do { } while (0)
+#endif
@@ -3,57 +3,103 @@
 // Copy to: D:/Joevisv3v1/Source/Joevisv3v1/AICompanionManager.cpp
 
 #include "AICompanionManager.h"
-#include "Json.h"
-#include "JsonUtilities.h"
+#include "AICompanionLog.h"
+#include "AICompanionSubsystem.h"
 #include "Misc/Guid.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/Paths.h"
 #include "TimerManager.h"
 
 AAICompanionManager::AAICompanionManager()
 {
 	PrimaryActorTick.bCanEverTick = true;
+
+	// Asleep until there is work: socket callbacks, sends and startup tasks wake it (WakeTick),
+	// and Tick puts it back to sleep once everything is drained
+	PrimaryActorTick.bStartWithTickEnabled = false;
+
+	// Late in the frame, so messages queued by gameplay this frame are flushed together
+	PrimaryActorTick.TickGroup = TG_PostUpdateWork;
+
+	RegisterBuiltInHandlers();
 }
 
 void AAICompanionManager::BeginPlay()
 {
 	Super::BeginPlay();
 
-	UE_LOG(LogTemp, Warning, TEXT("================================================="));
-	UE_LOG(LogTemp, Warning, TEXT("[AICompanionManager] *** BEGIN PLAY ***"));
-	UE_LOG(LogTemp, Warning, TEXT("[AICompanionManager] Actor placed in level!"));
-	UE_LOG(LogTemp, Warning, TEXT("[AICompanionManager] Backend URL: %s"), *BackendURL);
-	UE_LOG(LogTemp, Warning, TEXT("[AICompanionManager] WebSocket URL: %s"), *WebSocketURL);
-	UE_LOG(LogTemp, Warning, TEXT("================================================="));
+	UE_LOG(LogAICompanion, Log, TEXT("[AICompanionManager] BeginPlay (backend %s, websocket %s)"), *BackendURL, *WebSocketURL);
+
+	// Make this manager discoverable by calendar and other components
+	if (UAICompanionSubsystem* Subsystem = GetWorld()->GetSubsystem<UAICompanionSubsystem>())
+	{
+		Subsystem->RegisterManager(this);
+	}
 
 	// Generate unique player ID
 	PlayerID = GeneratePlayerID();
-	UE_LOG(LogTemp, Log, TEXT("[AICompanionManager] Generated Player ID: %s"), *PlayerID);
+	UE_LOG(LogAICompanion, Log, TEXT("[AICompanionManager] Generated Player ID: %s"), *PlayerID);
+	BeginPlaySeconds = FPlatformTime::Seconds();
 
-	// Initialize managers
-	InitializeManagers();
+	// Socket first, so the TLS handshake is under way while everything else loads
+	InitializeConnection();
 
 	// Auto-connect if enabled
 	if (bAutoConnect)
 	{
-		UE_LOG(LogTemp, Warning, TEXT("[AICompanionManager] *** CONNECTING TO BACKEND ***"));
 		ConnectToBackend();
 	}
 
-	UE_LOG(LogTemp, Warning, TEXT("================================================="));
-	UE_LOG(LogTemp, Warning, TEXT("[AICompanionManager] 💡 HOW TO TEST CHAT:"));
-	UE_LOG(LogTemp, Warning, TEXT("[AICompanionManager] 1. Wait for 'PLAYER REGISTERED' message"));
-	UE_LOG(LogTemp, Warning, TEXT("[AICompanionManager] 2. Auto-test message will fire after 2 seconds"));
-	UE_LOG(LogTemp, Warning, TEXT("[AICompanionManager] 3. Watch Output Log for responses"));
-	UE_LOG(LogTemp, Warning, TEXT("================================================="));
+	// Voice and memory load in the background; OnManagerReady fires once they and the connection are up
+	InitializeManagers();
 }
 
 void AAICompanionManager::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-	UE_LOG(LogTemp, Log, TEXT("[AICompanionManager] EndPlay called"));
+	UE_LOG(LogAICompanion, Verbose, TEXT("[AICompanionManager] EndPlay called"));
+
+	bWantsConnection = false;
+	GetWorld()->GetTimerManager().ClearTimer(ReconnectTimer);
+	GetWorld()->GetTimerManager().ClearTimer(HeartbeatTimer);
+	GetWorld()->GetTimerManager().ClearTimer(RequestTimer);
 	
+	// Both background startup tasks use members torn down below
+	if (VoicePrepareTask.IsValid())
+	{
+		VoicePrepareTask.Wait();
+	}
+	if (bMemoryLoading)
+	{
+		// Still writes what was said while it loaded
+		FinishMemoryLoad(MemoryLoadTask.GetResult());
+	}
+
+	VoiceStream.Reset();
+
+	// Closes its sockets and every player's memory store
+	SessionHost.Reset();
+
 	if (WebSocketManager)
 	{
 		WebSocketManager->Disconnect();
 	}
+	Connection.Reset();
+
+	// Waits for in-flight decodes before releasing the queue
+	DecodePipeline.Reset();
+
+	// No replies will be dispatched from here on
+	Requests.CancelAll();
+	StreamingResponses.Reset();
+	Broadcasts.Reset();
+
+	// Waits for queued writes
+	MemoryStore.Close();
+
+	if (UAICompanionSubsystem* Subsystem = GetWorld()->GetSubsystem<UAICompanionSubsystem>())
+	{
+		Subsystem->UnregisterManager(this);
+	}
 
 	Super::EndPlay(EndPlayReason);
 }
@@ -61,25 +107,169 @@ void AAICompanionManager::EndPlay(const EEndPlayReason::Type EndPlayReason)
 void AAICompanionManager::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
+
+	if (SessionHost)
+	{
+		SessionHost->Tick(FPlatformTime::Seconds());
+	}
+
+	if (ReadyParts != ReadyAll)
+	{
+		PollBackgroundInitialization();
+	}
+
+	// Dispatch everything the decode stage finished since last frame
+	if (DecodePipeline)
+	{
+		FAICompanionInboundMessage Message;
+		while (DecodePipeline->Dequeue(Message))
+		{
+			DispatchMessage(Message);
+		}
+	}
+
+	// Upload whatever the microphone captured since last frame
+	if (VoiceStream)
+	{
+		PumpVoiceStream();
+	}
+
+	// Handlers see this frame's messages within the budget; the rest go out next frame
+	Broadcasts.Deliver();
+
+	FlushSendQueue();
+
+	// Starts or finishes a background compaction when due
+	if (!bMemoryLoading)
+	{
+		MemoryStore.Tick();
+	}
+
+	if (!HasPendingWork())
+	{
+		SetActorTickEnabled(false);
+	}
 }
 
-void AAICompanionManager::InitializeManagers()
+void AAICompanionManager::QueueBroadcast(EAICompanionBroadcastPriority Priority, const UObject* Owner, TUniqueFunction<void()>&& Delivery)
+{
+	Broadcasts.Enqueue(Priority, Owner, MoveTemp(Delivery));
+	if (!Broadcasts.IsEmpty())
+	{
+		WakeTick();
+	}
+}
+
+void AAICompanionManager::WakeTick()
 {
-	UE_LOG(LogTemp, Log, TEXT("[AICompanionManager] Initializing managers..."));
+	if (!IsActorTickEnabled())
+	{
+		SetActorTickEnabled(true);
+	}
+}
 
-	// Initialize Voice Manager
-	if (bEnableVoice)
+bool AAICompanionManager::HasPendingWork() const
+{
+	// The host polls its links' heartbeats and reconnect deadlines every frame
+	if (SessionHost)
 	{
-		VoiceManager = NewObject<UVoiceManager>(this);
-		if (VoiceManager)
+		return true;
+	}
+
+	// Frames still decoding, events still to deliver, audio still arriving, or messages the socket can take now
+	if ((DecodePipeline && !DecodePipeline->IsIdle()) || !Broadcasts.IsEmpty() || (VoiceStream && VoiceStream->IsCapturing()))
+	{
+		return true;
+	}
+	if (SendQueue.HasUnsent() && bIsRegistered && IsSocketConnected())
+	{
+		return true;
+	}
+
+	// Startup and compaction tasks are picked up by polling
+	return bMemoryLoading || MemoryStore.IsCompacting() || (VoicePrepareTask.IsValid() && !VoicePrepareTask.IsCompleted());
+}
+
+void AAICompanionManager::WatchRequests()
+{
+	// A few times a second is plenty for timeouts, and costs nothing per frame
+	FTimerManager& TimerManager = GetWorld()->GetTimerManager();
+	if (!TimerManager.IsTimerActive(RequestTimer))
+	{
+		TimerManager.SetTimer(RequestTimer, this, &AAICompanionManager::UpdateRequests, 0.25f, true);
+	}
+}
+
+void AAICompanionManager::UpdateRequests()
+{
+	// Fires callbacks for requests that timed out
+	Requests.Tick(FPlatformTime::Seconds());
+
+	// Drop partial responses whose request timed out or was cancelled (0 = untracked, legacy backend)
+	if (StreamingResponses.Num() > 0)
+	{
+		for (auto It = StreamingResponses.CreateIterator(); It; ++It)
 		{
-			VoiceManager->Initialize(GetWorld());
-			UE_LOG(LogTemp, Log, TEXT("[AICompanionManager] ✓ Voice Manager initialized"));
+			if (It.Key() != 0 && !Requests.Contains(It.Key()))
+			{
+				It.Value().Reset();
+				SpareStreamingBuffers.Add(MoveTemp(It.Value()));
+				It.RemoveCurrent();
+			}
+		}
+	}
+	if (PendingCacheKeys.Num() > 0)
+	{
+		for (auto It = PendingCacheKeys.CreateIterator(); It; ++It)
+		{
+			if (!Requests.Contains(It.Key()))
+			{
+				It.RemoveCurrent();
+			}
 		}
 	}
 
-	// Initialize WebSocket Manager
-	WebSocketManager = NewObject<UWebSocketManager>(this);
+	if (Requests.Num() == 0)
+	{
+		GetWorld()->GetTimerManager().ClearTimer(RequestTimer);
+	}
+}
+
+void AAICompanionManager::InitializeConnection()
+{
+	DecodePipeline = MakeUnique<FAICompanionDecodePipeline>();
+	SendQueue.SetCapacity(MaxQueuedMessages);
+	Broadcasts.SetBudget(BroadcastBudgetMs);
+
+	FAICompanionHeartbeat::FSettings HeartbeatSettings;
+	HeartbeatSettings.InitialInterval = HeartbeatInterval;
+	HeartbeatSettings.MinInterval = HeartbeatMinInterval;
+	HeartbeatSettings.MaxInterval = HeartbeatMaxInterval;
+	HeartbeatSettings.MaxMissedPongs = MaxMissedPongs;
+	Heartbeat.Configure(HeartbeatSettings);
+
+	// The host owns every socket, memory store and conversation; nothing per-manager is needed
+	if (bMultiplexPlayers)
+	{
+		InitializeSessionHost();
+		return;
+	}
+
+	// Binary-capable engine socket, or the project's text-only WebSocket Manager
+	if (bUseBinaryProtocol)
+	{
+		Connection = MakeShared<FAICompanionConnection>();
+		Connection->OnTextFrame.BindUObject(this, &AAICompanionManager::HandleWebSocketMessage);
+		Connection->OnBinaryFrame.BindUObject(this, &AAICompanionManager::HandleBinaryMessage);
+		Connection->OnConnectionChanged.BindUObject(this, &AAICompanionManager::HandleConnectionStatusChange);
+		Connection->OnError.BindUObject(this, &AAICompanionManager::HandleWebSocketError);
+		UE_LOG(LogAICompanion, Verbose, TEXT("[AICompanionManager] Binary-capable connection initialized"));
+	}
+	else
+	{
+		WebSocketManager = NewObject<UWebSocketManager>(this);
+	}
+
 	if (WebSocketManager)
 	{
 		WebSocketManager->Initialize(GetWorld());
@@ -89,8 +279,64 @@ void AAICompanionManager::InitializeManagers()
 		WebSocketManager->OnConnected.AddDynamic(this, &AAICompanionManager::HandleConnectionStatusChange);
 		WebSocketManager->OnError.AddDynamic(this, &AAICompanionManager::HandleWebSocketError);
 		
-		UE_LOG(LogTemp, Log, TEXT("[AICompanionManager] ✓ WebSocket Manager initialized"));
-		UE_LOG(LogTemp, Warning, TEXT("[AICompanionManager] ✓ Delegates bound: OnMessage, OnConnected, OnError"));
+		UE_LOG(LogAICompanion, Verbose, TEXT("[AICompanionManager] WebSocket Manager initialized"));
+	}
+}
+
+void AAICompanionManager::InitializeManagers()
+{
+	UE_LOG(LogAICompanion, Verbose, TEXT("[AICompanionManager] Initializing managers..."));
+
+	// Players' voice and memory live in the session host
+	if (SessionHost)
+	{
+		bIsInitialized = true;
+		MarkReady(ReadyVoice | ReadyMemory);
+		return;
+	}
+
+	Conversation.Configure(MaxConversationTurns, ConversationHistoryChars, ConversationSummaryChars);
+	ResponseCache.Configure(MaxCachedResponses, ResponseCacheMaxChars, ResponseCacheTTLSeconds);
+
+	// Mapping the snapshot and replaying its log is file I/O; Tick picks up the result
+	if (bPersistMemory)
+	{
+		bMemoryLoading = true;
+		MemoryLoadTask = UE::Tasks::Launch(UE_SOURCE_LOCATION,
+			[this, Directory = FPaths::ProjectSavedDir() / TEXT("AICompanion"), Name = MemoryStoreName, MaxTurns = MaxConversationTurns]()
+			{
+				return MemoryStore.Open(Directory, Name, MaxTurns);
+			});
+	}
+
+	// Device enumeration would otherwise stall the first StartVoiceRecording
+	if (bEnableVoice && bStreamVoice)
+	{
+		VoiceStream = MakeUnique<FAICompanionVoiceStream>(VoiceChunkSeconds);
+		VoicePrepareTask = UE::Tasks::Launch(UE_SOURCE_LOCATION, [Stream = VoiceStream.Get()]()
+		{
+			return Stream->Prepare();
+		});
+	}
+
+	// Tick polls the tasks above until they are done
+	WakeTick();
+
+	// The UObject managers have to initialize on the game thread; next frame, so this one stays short
+	GetWorld()->GetTimerManager().SetTimerForNextTick(this, &AAICompanionManager::FinishDeferredInitialization);
+}
+
+void AAICompanionManager::FinishDeferredInitialization()
+{
+	// Initialize Voice Manager
+	if (bEnableVoice)
+	{
+		VoiceManager = NewObject<UVoiceManager>(this);
+		if (VoiceManager)
+		{
+			VoiceManager->Initialize(GetWorld());
+			UE_LOG(LogAICompanion, Verbose, TEXT("[AICompanionManager] Voice Manager initialized"));
+		}
 	}
 
 	// Initialize Memory Manager
@@ -100,23 +346,184 @@ void AAICompanionManager::InitializeManagers()
 		if (MemoryManager)
 		{
 			MemoryManager->Initialize(PlayerID);
-			UE_LOG(LogTemp, Log, TEXT("[AICompanionManager] ✓ Memory Manager initialized"));
+			UE_LOG(LogAICompanion, Verbose, TEXT("[AICompanionManager] Memory Manager initialized"));
 		}
 	}
 
 	bIsInitialized = true;
-	UE_LOG(LogTemp, Warning, TEXT("[AICompanionManager] *** ALL MANAGERS INITIALIZED ***"));
+	UE_LOG(LogAICompanion, Log, TEXT("[AICompanionManager] Managers initialized"));
+
+	PollBackgroundInitialization();
+}
+
+void AAICompanionManager::PollBackgroundInitialization()
+{
+	if (bMemoryLoading && MemoryLoadTask.IsCompleted())
+	{
+		FinishMemoryLoad(MemoryLoadTask.GetResult());
+	}
+
+	if (SessionHost && SessionHost->NumConnectedLinks() > 0)
+	{
+		MarkReady(ReadySocket);
+	}
+
+	// Both wait for the deferred UObject managers as well as their background task
+	if (!bIsInitialized)
+	{
+		return;
+	}
+	if (!bMemoryLoading)
+	{
+		MarkReady(ReadyMemory);
+	}
+	if (!VoicePrepareTask.IsValid() || VoicePrepareTask.IsCompleted())
+	{
+		MarkReady(ReadyVoice);
+	}
+}
+
+void AAICompanionManager::FinishMemoryLoad(bool bOpened)
+{
+	bMemoryLoading = false;
+	MemoryLoadTask = {};
+
+	if (bOpened)
+	{
+		if (bClearStoreTurnsOnLoad)
+		{
+			MemoryStore.ClearTurns();
+		}
+
+		// Persisted turns come before anything said while loading; rebuild the history in order
+		Conversation.Reset();
+		MemoryStore.ForEachTurn([this](FAICompanionConversationHistory::ERole Role, FStringView Text)
+		{
+			Conversation.Add(Role, Text);
+		});
+
+		for (const TPair<FAICompanionConversationHistory::ERole, FString>& Turn : PendingStoreTurns)
+		{
+			Conversation.Add(Turn.Key, Turn.Value);
+			MemoryStore.AppendTurn(Turn.Key, Turn.Value);
+		}
+		for (const TPair<FString, FString>& Preference : PendingPreferences)
+		{
+			MemoryStore.SetPreference(Preference.Key, Preference.Value);
+		}
+	}
+	else if (MemoryManager)
+	{
+		for (const TPair<FString, FString>& Preference : PendingPreferences)
+		{
+			MemoryManager->AddPreference(Preference.Key, Preference.Value);
+		}
+	}
+
+	UE_LOG(LogAICompanion, Verbose, TEXT("[AICompanionManager] Memory store %s (%d turns, %d preferences set while loading)"),
+		bOpened ? TEXT("loaded") : TEXT("unavailable"), PendingStoreTurns.Num(), PendingPreferences.Num());
+
+	PendingStoreTurns.Reset();
+	PendingPreferences.Reset();
+	bClearStoreTurnsOnLoad = false;
+}
+
+void AAICompanionManager::MarkReady(uint8 Parts)
+{
+	if (ReadyParts == ReadyAll)
+	{
+		return;
+	}
+
+	ReadyParts |= Parts;
+	if (ReadyParts == ReadyAll)
+	{
+		UE_LOG(LogAICompanion, Log, TEXT("[AICompanionManager] Ready %.0f ms after BeginPlay"), (FPlatformTime::Seconds() - BeginPlaySeconds) * 1000.0);
+		ReadyEvent.Trigger();
+		OnManagerReady.Broadcast();
+	}
+}
+
+void AAICompanionManager::InitializeSessionHost()
+{
+	FAICompanionSessionHost::FSettings Settings;
+	Settings.URL = WebSocketURL;
+	Settings.NumLinks = ServerConnectionCount;
+	Settings.bUseBinaryProtocol = bUseBinaryProtocol;
+	Settings.bCompressFrames = bCompressFrames;
+	Settings.bStreamResponses = bStreamResponses;
+	Settings.MaxQueuedMessages = MaxQueuedMessages;
+	Settings.MaxBatchBytes = MaxBatchBytes;
+	Settings.RequestTimeoutSeconds = RequestTimeoutSeconds;
+	Settings.ReconnectBaseDelay = ReconnectBaseDelay;
+	Settings.ReconnectMaxDelay = ReconnectMaxDelay;
+	Settings.MaxReconnectAttempts = MaxReconnectAttempts;
+	Settings.bEnableHeartbeat = bEnableHeartbeat;
+	Settings.Heartbeat.InitialInterval = HeartbeatInterval;
+	Settings.Heartbeat.MinInterval = HeartbeatMinInterval;
+	Settings.Heartbeat.MaxInterval = HeartbeatMaxInterval;
+	Settings.Heartbeat.MaxMissedPongs = MaxMissedPongs;
+	Settings.bPersistMemory = bPersistMemory;
+	Settings.MemoryDirectory = FPaths::ProjectSavedDir() / TEXT("AICompanion") / TEXT("Players");
+	Settings.MemoryStoreName = MemoryStoreName;
+	Settings.MaxConversationTurns = MaxConversationTurns;
+	Settings.ConversationHistoryChars = ConversationHistoryChars;
+	Settings.ConversationSummaryChars = ConversationSummaryChars;
+
+	SessionHost = MakeUnique<FAICompanionSessionHost>(Settings);
+	SessionHost->OnResponse.BindWeakLambda(this, [this](const FString& SessionPlayerId, const FString& Text)
+	{
+		QueueBroadcast(EAICompanionBroadcastPriority::Normal, this, [this, SessionPlayerId, Text]()
+		{
+			OnPlayerAIResponseReceived.Broadcast(SessionPlayerId, Text);
+		});
+	});
+	SessionHost->OnDelta.BindWeakLambda(this, [this](const FString& SessionPlayerId, const FString& Text)
+	{
+		QueueBroadcast(EAICompanionBroadcastPriority::Normal, this, [this, SessionPlayerId, Text]()
+		{
+			OnPlayerAIResponseDelta.Broadcast(SessionPlayerId, Text);
+		});
+	});
+	SessionHost->OnDialogueQuestion.BindWeakLambda(this, [this](const FString& SessionPlayerId, FName FlowName, const FString& Question)
+	{
+		QueueBroadcast(EAICompanionBroadcastPriority::Normal, this, [this, SessionPlayerId, FlowName, Question]()
+		{
+			OnPlayerDialogueQuestion.Broadcast(SessionPlayerId, FlowName, Question);
+		});
+	});
+	SessionHost->OnDialogueFinished.BindUObject(this, &AAICompanionManager::HandlePlayerDialogueFinished);
+	SessionHost->OnUnhandledMessage.BindUObject(this, &AAICompanionManager::HandlePlayerMessage);
+	WakeTick();
+
+	UE_LOG(LogAICompanion, Log, TEXT("[AICompanionManager] Multiplexing player sessions over %d connections"), ServerConnectionCount);
 }
 
 void AAICompanionManager::ConnectToBackend()
 {
+	bWantsConnection = true;
+	GetWorld()->GetTimerManager().ClearTimer(ReconnectTimer);
+
+	if (SessionHost)
+	{
+		SessionHost->Connect();
+		return;
+	}
+
+	if (Connection)
+	{
+		UE_LOG(LogAICompanion, Log, TEXT("[AICompanionManager] Connecting to: %s"), *WebSocketURL);
+		Connection->Connect(WebSocketURL);
+		return;
+	}
+
 	if (!WebSocketManager)
 	{
-		UE_LOG(LogTemp, Error, TEXT("[AICompanionManager] WebSocket Manager not initialized!"));
+		UE_LOG(LogAICompanion, Error, TEXT("[AICompanionManager] WebSocket Manager not initialized!"));
 		return;
 	}
 
-	UE_LOG(LogTemp, Log, TEXT("[AICompanionManager] Connecting to: %s"), *WebSocketURL);
+	UE_LOG(LogAICompanion, Log, TEXT("[AICompanionManager] Connecting to: %s"), *WebSocketURL);
 	
 	// ✅ FIXED: Set ServerURL property first (Connect() takes no parameters)
 	WebSocketManager->ServerURL = WebSocketURL;
@@ -127,6 +534,17 @@ void AAICompanionManager::ConnectToBackend()
 
 void AAICompanionManager::DisconnectFromBackend()
 {
+	bWantsConnection = false;
+	GetWorld()->GetTimerManager().ClearTimer(ReconnectTimer);
+
+	if (SessionHost)
+	{
+		SessionHost->Disconnect();
+	}
+	if (Connection)
+	{
+		Connection->Close();
+	}
 	if (WebSocketManager)
 	{
 		WebSocketManager->Disconnect();
@@ -135,241 +553,1105 @@ void AAICompanionManager::DisconnectFromBackend()
 
 bool AAICompanionManager::IsConnected() const
 {
-	return bIsConnected;
+	// Multiplexed: at least one shared socket is up
+	return SessionHost ? SessionHost->NumConnectedLinks() > 0 : bIsConnected;
 }
 
-void AAICompanionManager::SendChatMessage(const FString& Message)
+bool AAICompanionManager::IsReconnecting() const
 {
-	SendTestMessage(Message);
+	const UWorld* World = GetWorld();
+	return World && World->GetTimerManager().IsTimerActive(ReconnectTimer);
 }
 
-void AAICompanionManager::SendTestMessage(const FString& Message)
+void AAICompanionManager::ScheduleReconnect()
 {
-	if (!WebSocketManager || !WebSocketManager->IsConnected())
+	UWorld* World = GetWorld();
+	if (!bAutoReconnect || !bWantsConnection || !World)
 	{
-		UE_LOG(LogTemp, Warning, TEXT("[AICompanionManager] Cannot send message: Not connected"));
 		return;
 	}
 
-	UE_LOG(LogTemp, Warning, TEXT("================================================="));
-	UE_LOG(LogTemp, Warning, TEXT("[AICompanionManager] 💬 SENDING MESSAGE"));
-	UE_LOG(LogTemp, Warning, TEXT("[AICompanionManager] Message: %s"), *Message);
-	UE_LOG(LogTemp, Warning, TEXT("================================================="));
+	// Errors and closes both report the same failure; retry once
+	FTimerManager& TimerManager = World->GetTimerManager();
+	if (TimerManager.IsTimerActive(ReconnectTimer))
+	{
+		return;
+	}
 
-	// Create JSON message
-	TSharedPtr<FJsonObject> JsonObject = MakeShareable(new FJsonObject);
-	JsonObject->SetStringField(TEXT("type"), TEXT("chat"));
-	JsonObject->SetStringField(TEXT("text"), Message);
+	if (MaxReconnectAttempts > 0 && ReconnectAttempt >= MaxReconnectAttempts)
+	{
+		UE_LOG(LogAICompanion, Error, TEXT("[AICompanionManager] Giving up after %d reconnect attempts"), ReconnectAttempt);
+		return;
+	}
 
-	// Convert to string
-	FString JsonString;
-	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&JsonString);
-	FJsonSerializer::Serialize(JsonObject.ToSharedRef(), Writer);
+	// Full jitter: uniform in [0, min(max, base * 2^attempt)], so a fleet dropped by
+	// the same backend restart spreads its retries out instead of arriving together
+	const float Ceiling = FMath::Min(ReconnectMaxDelay, ReconnectBaseDelay * FMath::Pow(2.0f, (float)FMath::Min(ReconnectAttempt, 16)));
+	const float Delay = FMath::Max(FMath::FRandRange(0.0f, Ceiling), 0.01f);
+	++ReconnectAttempt;
 
-	// Send via WebSocket
-	WebSocketManager->SendMessage(JsonString);
+	UE_LOG(LogAICompanion, Log, TEXT("[AICompanionManager] Reconnecting in %.2fs (attempt %d)"), Delay, ReconnectAttempt);
+	TimerManager.SetTimer(ReconnectTimer, this, &AAICompanionManager::HandleReconnectTimer, Delay, false);
 }
 
-void AAICompanionManager::StartVoiceRecording()
+void AAICompanionManager::HandleReconnectTimer()
 {
-	if (VoiceManager)
+	if (bWantsConnection && !IsSocketConnected())
 	{
-		VoiceManager->StartRecording();
-		UE_LOG(LogTemp, Log, TEXT("[AICompanionManager] Voice recording started"));
+		ConnectToBackend();
 	}
 }
 
-void AAICompanionManager::StopVoiceRecording()
+void AAICompanionManager::SendChatMessage(const FString& Message)
 {
-	if (VoiceManager)
+	if (bEnableLocalIntents && TryHandleLocalIntent(Message))
 	{
-		VoiceManager->StopRecording();
-		UE_LOG(LogTemp, Log, TEXT("[AICompanionManager] Voice recording stopped"));
+		return;
 	}
+
+	SendTestMessage(Message);
 }
 
-void AAICompanionManager::AddMemory(const FString& Key, const FString& Value)
+bool AAICompanionManager::TryHandleLocalIntent(const FString& Message)
 {
-	if (MemoryManager)
+	if (IntentHandlers.Num() == 0)
 	{
-		MemoryManager->AddPreference(Key, Value);
-		UE_LOG(LogTemp, Log, TEXT("[AICompanionManager] Memory added: %s = %s"), *Key, *Value);
+		return false;
 	}
-}
 
-FString AAICompanionManager::GetMemory(const FString& Key)
-{
-	if (MemoryManager)
+	const FAICompanionIntentClassifier::FResult Intent = FAICompanionIntentClassifier::Classify(Message);
+	if (Intent.Intent == EAICompanionIntent::None || Intent.Confidence < LocalIntentConfidence)
 	{
-		return MemoryManager->GetPreference(Key);
+		return false;
 	}
-	return TEXT("");
+
+	const FAICompanionIntentHandler* Handler = IntentHandlers.Find(Intent.Intent);
+	bHandlingLocalIntent = true;
+	const bool bHandled = Handler && Handler->IsBound() && Handler->Execute(Intent.Intent, Message);
+	bHandlingLocalIntent = false;
+	if (!bHandled)
+	{
+		PendingLocalResponse.Reset();
+		return false;
+	}
+
+	UE_LOG(LogAICompanion, Verbose, TEXT("[AICompanionManager] Chat handled locally as %s (confidence %.2f)"),
+		*UEnum::GetValueAsString(Intent.Intent), Intent.Confidence);
+	RecordTurn(FAICompanionConversationHistory::ERole::User, Message);
+
+	// The handler answered the question itself
+	if (!PendingLocalResponse.IsEmpty())
+	{
+		const FString Response = MoveTemp(PendingLocalResponse);
+		PendingLocalResponse.Reset();
+		DeliverLocalResponse(Response);
+	}
+	return true;
 }
 
-void AAICompanionManager::RegisterPlayer()
+void AAICompanionManager::DeliverLocalResponse(const FString& Response)
 {
-	if (!WebSocketManager || !WebSocketManager->IsConnected())
+	// Inside an intent handler the user's turn is not recorded yet; TryHandleLocalIntent delivers it after
+	if (bHandlingLocalIntent)
 	{
-		UE_LOG(LogTemp, Warning, TEXT("[AICompanionManager] Cannot register: Not connected"));
+		PendingLocalResponse = Response;
 		return;
 	}
 
-	UE_LOG(LogTemp, Log, TEXT("[AICompanionManager] Registering player: %s"), *PlayerID);
+	FAICompanionInboundMessage Reply;
+	Reply.Type = AICompanionMessageTypes::ChatResponse;
+	Reply.RequestId = Requests.ReserveId();
+	Reply.Text = Response;
+	HandleChatResponseMessage(Reply);
+}
 
-	// Create registration message
-	TSharedPtr<FJsonObject> JsonObject = MakeShareable(new FJsonObject);
-	JsonObject->SetStringField(TEXT("type"), TEXT("register"));
-	JsonObject->SetStringField(TEXT("playerId"), PlayerID);
+bool AAICompanionManager::IsSocketConnected() const
+{
+	return Connection ? Connection->IsConnected() : (WebSocketManager && WebSocketManager->IsConnected());
+}
 
-	// Convert to string
-	FString JsonString;
-	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&JsonString);
-	FJsonSerializer::Serialize(JsonObject.ToSharedRef(), Writer);
+bool AAICompanionManager::SendMessageToBackend(const FString& JsonMessage)
+{
+	WakeTick();
+	return SendQueue.EnqueueText(JsonMessage);
+}
 
-	// Send registration
-	WebSocketManager->SendMessage(JsonString);
+bool AAICompanionManager::SendEncodedMessage(const FAICompanionMessageWriter& Writer)
+{
+	// Flushed at the end of this frame together with anything else sent meanwhile
+	WakeTick();
+	return SendQueue.Enqueue(Writer);
 }
 
-void AAICompanionManager::HandleWebSocketMessage(const FString& Message)
+void AAICompanionManager::FlushSendQueue()
 {
-	UE_LOG(LogTemp, Warning, TEXT("[AICompanionManager] ✅ HandleWebSocketMessage CALLED!"));
-	UE_LOG(LogTemp, Warning, TEXT("[AICompanionManager] Raw message: %s"), *Message);
-	
-	// Parse JSON
-	TSharedPtr<FJsonObject> JsonObject;
-	TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(Message);
-	
-	if (!FJsonSerializer::Deserialize(Reader, JsonObject))
+	// Messages wait through reconnects until the backend has registered us again
+	if (SendQueue.IsEmpty() || !bIsRegistered || !IsSocketConnected())
 	{
-		UE_LOG(LogTemp, Error, TEXT("[AICompanionManager] Failed to parse message"));
 		return;
 	}
 
-	FString MessageType;
-	if (JsonObject->TryGetStringField(TEXT("type"), MessageType))
+	FAICompanionSendQueue::FFlushParams Params;
+	Params.bCanBatch = bBackendAcceptsBatch;
+	Params.bCanSendBinary = Connection && GetWireFormat() == EAICompanionWireFormat::Binary;
+	Params.bRetainUntilAcked = !SessionToken.IsEmpty();
+	Params.MaxBatchBytes = MaxBatchBytes;
+
+	SendQueue.Flush(Params,
+		[this](const FString& Frame) { TransmitText(Frame); },
+		[this](const TArray<uint8>& Frame) { TransmitBinary(Frame); });
+}
+
+bool AAICompanionManager::SendImmediate(const FAICompanionMessageWriter& Writer)
+{
+	if (!IsSocketConnected())
 	{
-		UE_LOG(LogTemp, Log, TEXT("[AICompanionManager] Received message type: %s"), *MessageType);
+		UE_LOG(LogAICompanion, Warning, TEXT("[AICompanionManager] Cannot send message: Not connected"));
+		return false;
+	}
 
-		if (MessageType == TEXT("connected"))
-		{
-			FString ClientId;
-			JsonObject->TryGetStringField(TEXT("clientId"), ClientId);
-			
-			UE_LOG(LogTemp, Warning, TEXT("================================================="));
-			UE_LOG(LogTemp, Warning, TEXT("[AICompanionManager] ✅ CONNECTION CONFIRMED"));
-			UE_LOG(LogTemp, Warning, TEXT("[AICompanionManager] Client ID: %s"), *ClientId);
-			UE_LOG(LogTemp, Warning, TEXT("================================================="));
-			
-			// Auto-register player
-			RegisterPlayer();
+	if (Writer.IsBinary())
+	{
+		TransmitBinary(Writer.GetBytes());
+	}
+	else
+	{
+		TransmitText(Writer.GetText());
+	}
+	return true;
+}
+
+void AAICompanionManager::TransmitText(const FString& Frame)
+{
+	Heartbeat.NoteSent(FPlatformTime::Seconds());
+	AICOMPANION_LOG_PAYLOAD(TEXT("[AICompanionManager] >>"), Frame);
+	if (Connection)
+	{
+		Connection->SendText(Frame);
+	}
+	else if (WebSocketManager)
+	{
+		WebSocketManager->SendMessage(Frame);
+	}
+}
+
+void AAICompanionManager::TransmitBinary(const TArray<uint8>& Frame)
+{
+	Heartbeat.NoteSent(FPlatformTime::Seconds());
+	if (Connection)
+	{
+		Connection->SendBinary(Frame);
+	}
+}
+
+void AAICompanionManager::SendTestMessage(const FString& Message)
+{
+	SendChatRequest(Message);
+}
+
+int32 AAICompanionManager::SendChatRequest(const FString& Message, FAICompanionRequestCallback Callback)
+{
+	UE_LOG(LogAICompanion, Verbose, TEXT("[AICompanionManager] Sending chat (%d chars)"), Message.Len());
+
+	const uint64 CacheKey = bEnableResponseCache ? FAICompanionResponseCache::MakeKey(Message, ResponseCacheVersion) : 0;
+	if (bEnableResponseCache)
+	{
+		if (const FString* Cached = ResponseCache.Find(CacheKey, FPlatformTime::Seconds()))
+		{
+			// Answered locally, exactly as if chat_response had arrived
+			FAICompanionInboundMessage Reply;
+			Reply.Type = AICompanionMessageTypes::ChatResponse;
+			Reply.RequestId = Requests.ReserveId();
+			Reply.Text = *Cached;
+
+			UE_LOG(LogAICompanion, Verbose, TEXT("[AICompanionManager] Chat answered from cache"));
+			RecordTurn(FAICompanionConversationHistory::ERole::User, Message);
+			HandleChatResponseMessage(Reply);
+			Callback.ExecuteIfBound(EAICompanionRequestResult::Completed, Reply);
+			return Reply.RequestId;
 		}
-		else if (MessageType == TEXT("registered"))
+	}
+
+	// Encode into the recycled outbound buffer; queued if we are offline
+	OutboundWriter.Begin(TEXT("chat"))
+		.WriteString(TEXT("text"), Message)
+		.WriteBool(TEXT("stream"), bStreamResponses);
+
+	const int32 RequestId = SendRequest(OutboundWriter, EAICompanionLatencyMetric::ChatResponse, MoveTemp(Callback));
+	if (RequestId == 0)
+	{
+		UE_LOG(LogAICompanion, Warning, TEXT("[AICompanionManager] Chat message dropped: send queue full"));
+		return 0;
+	}
+
+	RecordTurn(FAICompanionConversationHistory::ERole::User, Message);
+	LastChatRequestId = RequestId;
+	if (bEnableResponseCache)
+	{
+		PendingCacheKeys.Add(RequestId, CacheKey);
+	}
+	return RequestId;
+}
+
+int32 AAICompanionManager::SendRequest(FAICompanionMessageWriter& Writer, EAICompanionLatencyMetric Metric, FAICompanionRequestCallback Callback, float TimeoutSeconds)
+{
+	// Timed from the moment it is queued, so time spent offline counts against the timeout
+	const int32 RequestId = Requests.Begin(Metric, TimeoutSeconds < 0.0f ? RequestTimeoutSeconds : TimeoutSeconds, MoveTemp(Callback));
+	WatchRequests();
+
+	if (!SendEncodedMessage(Writer.WriteInt(TEXT("requestId"), RequestId).Finish()))
+	{
+		Requests.Forget(RequestId);
+		return 0;
+	}
+	return RequestId;
+}
+
+void AAICompanionManager::StartVoiceRecording()
+{
+	// Stream chunks while recording when we can; Tick uploads them as they fill
+	if (bStreamVoice && IsSocketConnected())
+	{
+		if (!VoiceStream)
 		{
-			FString PlayerId;
-			JsonObject->TryGetStringField(TEXT("playerId"), PlayerId);
-			
-			UE_LOG(LogTemp, Warning, TEXT("================================================="));
-			UE_LOG(LogTemp, Warning, TEXT("[AICompanionManager] ✅ PLAYER REGISTERED"));
-			UE_LOG(LogTemp, Warning, TEXT("[AICompanionManager] Player ID: %s"), *PlayerId);
-			UE_LOG(LogTemp, Warning, TEXT("[AICompanionManager] 🎮 READY TO CHAT!"));
-			UE_LOG(LogTemp, Warning, TEXT("================================================="));
-			
-			// Send a test message automatically after 2 seconds
-			FTimerHandle TestMessageTimer;
-			GetWorld()->GetTimerManager().SetTimer(TestMessageTimer, [this]()
-			{
-				SendTestMessage(TEXT("Hello from Unreal Engine!"));
-			}, 2.0f, false);
+			VoiceStream = MakeUnique<FAICompanionVoiceStream>(VoiceChunkSeconds);
+		}
+
+		// Recording straight after BeginPlay: the device list is nearly done, let it finish
+		if (VoicePrepareTask.IsValid())
+		{
+			VoicePrepareTask.Wait();
 		}
-		else if (MessageType == TEXT("chat_response"))
+
+		if (VoiceStream->IsCapturing())
 		{
-			FString ResponseText;
-			if (JsonObject->TryGetStringField(TEXT("text"), ResponseText))
-			{
-				UE_LOG(LogTemp, Warning, TEXT("================================================="));
-				UE_LOG(LogTemp, Warning, TEXT("[AICompanionManager] 🤖 AI RESPONSE RECEIVED"));
-				UE_LOG(LogTemp, Warning, TEXT("================================================="));
-				UE_LOG(LogTemp, Display, TEXT("%s"), *ResponseText);
-				UE_LOG(LogTemp, Warning, TEXT("================================================="));
-				
-				// Store in memory
-				if (MemoryManager)
-				{
-					MemoryManager->AddConversation(TEXT("Assistant"), ResponseText, TEXT(""));
-				}
-				
-				// Broadcast to blueprints
-				OnAIResponseReceived.Broadcast(ResponseText);
-			}
+			return;
+		}
+
+		if (VoiceStream->Start())
+		{
+			++VoiceStreamId;
+			VoiceChunkSeq = 0;
+			bVoiceStreamOpen = false;
+			WakeTick();
+			UE_LOG(LogAICompanion, Verbose, TEXT("[AICompanionManager] Voice stream %d started"), VoiceStreamId);
+			return;
+		}
+	}
+
+	// Record-then-send
+	if (VoiceManager)
+	{
+		VoiceManager->StartRecording();
+		UE_LOG(LogAICompanion, Verbose, TEXT("[AICompanionManager] Voice recording started"));
+	}
+}
+
+void AAICompanionManager::StopVoiceRecording()
+{
+	if (VoiceStream && VoiceStream->IsCapturing())
+	{
+		// Stop() queues the last partial chunk; send it before closing the stream
+		VoiceStream->Stop();
+		PumpVoiceStream();
+
+		if (bVoiceStreamOpen)
+		{
+			// Timed from end of speech to the answer
+			OutboundWriter.Begin(TEXT("voice_end"))
+				.WriteInt(TEXT("streamId"), VoiceStreamId)
+				.WriteInt(TEXT("seq"), VoiceChunkSeq);
+			SendRequest(OutboundWriter, EAICompanionLatencyMetric::VoiceResponse, FAICompanionRequestCallback());
+			bVoiceStreamOpen = false;
 		}
-		else if (MessageType == TEXT("voice_processed"))
+
+		UE_LOG(LogAICompanion, Verbose, TEXT("[AICompanionManager] Voice stream %d stopped (%d chunks)"), VoiceStreamId, VoiceChunkSeq);
+		return;
+	}
+
+	if (VoiceManager)
+	{
+		VoiceManager->StopRecording();
+		UE_LOG(LogAICompanion, Verbose, TEXT("[AICompanionManager] Voice recording stopped"));
+	}
+}
+
+void AAICompanionManager::PumpVoiceStream()
+{
+	FAICompanionVoiceStream::FChunk& Chunk = VoiceChunk;
+	while (VoiceStream->DequeueChunk(Chunk))
+	{
+		// The capture rate is only known once audio arrives, so voice_start rides with the first chunk
+		if (!bVoiceStreamOpen)
 		{
-			FString Transcription;
-			FString AIResponse;
-			
-			JsonObject->TryGetStringField(TEXT("transcription"), Transcription);
-			JsonObject->TryGetStringField(TEXT("aiResponse"), AIResponse);
-			
-			UE_LOG(LogTemp, Warning, TEXT("================================================="));
-			UE_LOG(LogTemp, Warning, TEXT("[AICompanionManager] 🎤 VOICE PROCESSED"));
-			UE_LOG(LogTemp, Warning, TEXT("[AICompanionManager] Transcription: %s"), *Transcription);
-			if (!AIResponse.IsEmpty())
+			bVoiceStreamOpen = SendEncodedMessage(OutboundWriter.Begin(TEXT("voice_start"))
+				.WriteInt(TEXT("streamId"), VoiceStreamId)
+				.WriteInt(TEXT("sampleRate"), Chunk.SampleRate)
+				.WriteInt(TEXT("channels"), 1)
+				.WriteString(TEXT("encoding"), TEXT("pcm16"))
+				.Finish());
+
+			if (!bVoiceStreamOpen)
 			{
-				UE_LOG(LogTemp, Warning, TEXT("[AICompanionManager] AI Response: %s"), *AIResponse);
+				// Send queue full; drop audio until the backend catches up
+				continue;
 			}
-			UE_LOG(LogTemp, Warning, TEXT("================================================="));
 		}
-		else if (MessageType == TEXT("error"))
+
+		SendEncodedMessage(OutboundWriter.Begin(TEXT("voice_chunk"))
+			.WriteInt(TEXT("streamId"), VoiceStreamId)
+			.WriteInt(TEXT("seq"), VoiceChunkSeq++)
+			.WriteBytes(TEXT("audio"), Chunk.Pcm16)
+			.Finish());
+	}
+}
+
+void AAICompanionManager::SendPing()
+{
+	// Straight to the socket: queue time would skew the round trip, and pings are not acknowledged.
+	// The heartbeat judges missed pongs itself; the table entry only needs to outlive the longest pong timeout.
+	const int32 RequestId = Requests.Begin(EAICompanionLatencyMetric::PingRTT, 10.0f);
+	WatchRequests();
+	const bool bSent = SendImmediate(OutboundWriter.Begin(TEXT("ping"))
+		.WriteInt(TEXT("requestId"), RequestId)
+		.Finish());
+
+	if (bSent)
+	{
+		Heartbeat.NotePingSent(RequestId, FPlatformTime::Seconds());
+	}
+	else
+	{
+		Requests.Forget(RequestId);
+	}
+}
+
+void AAICompanionManager::UpdateHeartbeat()
+{
+	switch (Heartbeat.Update(FPlatformTime::Seconds()))
+	{
+	case FAICompanionHeartbeat::EAction::SendPing:
+		SendPing();
+		break;
+	case FAICompanionHeartbeat::EAction::ConnectionDead:
+		DropDeadConnection();
+		break;
+	default:
+		break;
+	}
+}
+
+void AAICompanionManager::DropDeadConnection()
+{
+	UE_LOG(LogAICompanion, Warning, TEXT("[AICompanionManager] Backend stopped answering pings, reconnecting"));
+
+	// Not a deliberate disconnect: bWantsConnection stays set, so the close schedules a reconnect
+	Heartbeat.Stop();
+	GetWorld()->GetTimerManager().ClearTimer(HeartbeatTimer);
+
+	if (Connection)
+	{
+		Connection->Abandon();
+	}
+	else if (WebSocketManager)
+	{
+		WebSocketManager->Disconnect();
+	}
+}
+
+float AAICompanionManager::GetLatencyPercentile(EAICompanionLatencyMetric Metric, float Percentile) const
+{
+	if (Metric >= EAICompanionLatencyMetric::Count)
+	{
+		return 0.0f;
+	}
+	return (float)(Requests.GetHistogram(Metric).GetValueAtPercentile(Percentile) / 1000.0);
+}
+
+int64 AAICompanionManager::GetLatencySampleCount(EAICompanionLatencyMetric Metric) const
+{
+	if (Metric >= EAICompanionLatencyMetric::Count)
+	{
+		return 0;
+	}
+	return (int64)Requests.GetHistogram(Metric).GetCount();
+}
+
+void AAICompanionManager::ResetLatencyStats()
+{
+	Requests.ResetHistograms();
+}
+
+FString AAICompanionManager::GetConversationContext(int32 MaxChars) const
+{
+	FString Context;
+	Conversation.BuildContext(MaxChars, Context);
+	return Context;
+}
+
+void AAICompanionManager::ClearConversationHistory()
+{
+	Conversation.Reset();
+	InvalidateResponseCache();
+
+	// The persisted turns too, or they come back on the next launch
+	if (bMemoryLoading)
+	{
+		// The store belongs to its loading task; FinishMemoryLoad clears it instead of restoring it
+		PendingStoreTurns.Reset();
+		bClearStoreTurnsOnLoad = true;
+	}
+	else
+	{
+		MemoryStore.ClearTurns();
+	}
+}
+
+void AAICompanionManager::InvalidateResponseCache()
+{
+	// Old entries can no longer be looked up; they age out of the LRU as new ones arrive
+	++ResponseCacheVersion;
+	PendingCacheKeys.Reset();
+}
+
+void AAICompanionManager::RecordTurn(FAICompanionConversationHistory::ERole Role, const FString& Text)
+{
+	Conversation.Add(Role, Text);
+
+	// An append may push the log past its compaction threshold, which Tick checks
+	WakeTick();
+
+	// The store belongs to its loading task until FinishMemoryLoad
+	if (bMemoryLoading)
+	{
+		PendingStoreTurns.Emplace(Role, Text);
+	}
+	else
+	{
+		MemoryStore.AppendTurn(Role, Text);
+	}
+}
+
+void AAICompanionManager::AddMemory(const FString& Key, const FString& Value)
+{
+	// Answers may depend on what we remember about the player
+	InvalidateResponseCache();
+	WakeTick();
+
+	if (bMemoryLoading)
+	{
+		PendingPreferences.Add(Key, Value);
+	}
+	else if (MemoryStore.IsOpen())
+	{
+		MemoryStore.SetPreference(Key, Value);
+		UE_LOG(LogAICompanion, Verbose, TEXT("[AICompanionManager] Memory added: %s"), *Key);
+	}
+	else if (MemoryManager)
+	{
+		MemoryManager->AddPreference(Key, Value);
+		UE_LOG(LogAICompanion, Verbose, TEXT("[AICompanionManager] Memory added: %s"), *Key);
+	}
+}
+
+FString AAICompanionManager::GetMemory(const FString& Key)
+{
+	FString Value;
+	if (bMemoryLoading)
+	{
+		if (const FString* Pending = PendingPreferences.Find(Key))
 		{
-			FString ErrorMsg;
-			JsonObject->TryGetStringField(TEXT("error"), ErrorMsg);
-			
-			UE_LOG(LogTemp, Error, TEXT("================================================="));
-			UE_LOG(LogTemp, Error, TEXT("[AICompanionManager] ❌ ERROR FROM BACKEND"));
-			UE_LOG(LogTemp, Error, TEXT("[AICompanionManager] Error: %s"), *ErrorMsg);
-			UE_LOG(LogTemp, Error, TEXT("================================================="));
+			return *Pending;
 		}
-		else if (MessageType == TEXT("pong"))
+	}
+	else if (MemoryStore.GetPreference(Key, Value))
+	{
+		return Value;
+	}
+	if (MemoryManager)
+	{
+		return MemoryManager->GetPreference(Key);
+	}
+	return TEXT("");
+}
+
+bool AAICompanionManager::AddPlayerSession(const FString& SessionPlayerId)
+{
+	if (!SessionHost)
+	{
+		UE_LOG(LogAICompanion, Warning, TEXT("[AICompanionManager] AddPlayerSession needs bMultiplexPlayers"));
+		return false;
+	}
+	return SessionHost->AddPlayer(SessionPlayerId);
+}
+
+void AAICompanionManager::RemovePlayerSession(const FString& SessionPlayerId)
+{
+	if (SessionHost)
+	{
+		SessionHost->RemovePlayer(SessionPlayerId);
+	}
+}
+
+int32 AAICompanionManager::GetPlayerSessionCount() const
+{
+	return SessionHost ? SessionHost->NumPlayers() : 0;
+}
+
+void AAICompanionManager::SendPlayerChatMessage(const FString& SessionPlayerId, const FString& Message)
+{
+	if (SessionHost)
+	{
+		SessionHost->SendChat(SessionPlayerId, Message);
+	}
+}
+
+int32 AAICompanionManager::SendPlayerChatRequest(const FString& SessionPlayerId, const FString& Message, FAICompanionRequestCallback Callback)
+{
+	return SessionHost ? SessionHost->SendChatRequest(SessionPlayerId, Message, MoveTemp(Callback)) : 0;
+}
+
+bool AAICompanionManager::StartPlayerDialogue(const FString& SessionPlayerId, FName FlowName, bool bSkipOptional)
+{
+	TSharedPtr<const FAICompanionDialogueFlow> Flow = FAICompanionDialogueFlow::FindBuiltIn(FlowName);
+	if (!SessionHost || !Flow.IsValid())
+	{
+		UE_LOG(LogAICompanion, Warning, TEXT("[AICompanionManager] Cannot start dialogue %s for %s"), *FlowName.ToString(), *SessionPlayerId);
+		return false;
+	}
+	return SessionHost->StartDialogue(SessionPlayerId, Flow.ToSharedRef(), bSkipOptional);
+}
+
+void AAICompanionManager::CancelPlayerDialogue(const FString& SessionPlayerId)
+{
+	if (SessionHost)
+	{
+		SessionHost->CancelDialogue(SessionPlayerId);
+	}
+}
+
+void AAICompanionManager::AddPlayerMemory(const FString& SessionPlayerId, const FString& Key, const FString& Value)
+{
+	if (SessionHost)
+	{
+		SessionHost->SetMemory(SessionPlayerId, Key, Value);
+	}
+}
+
+FString AAICompanionManager::GetPlayerMemory(const FString& SessionPlayerId, const FString& Key) const
+{
+	FString Value;
+	if (SessionHost)
+	{
+		SessionHost->GetMemory(SessionPlayerId, Key, Value);
+	}
+	return Value;
+}
+
+FString AAICompanionManager::GetPlayerConversationContext(const FString& SessionPlayerId, int32 MaxChars) const
+{
+	return SessionHost ? SessionHost->GetConversationContext(SessionPlayerId, MaxChars) : FString();
+}
+
+void AAICompanionManager::HandlePlayerDialogueFinished(const FString& SessionPlayerId, const FAICompanionDialogueSession& Session, bool bCompleted)
+{
+	TArray<FAICompanionDialogueAnswer> Answers;
+	Session.ForEachValue([&Answers](FName Field, const FAICompanionDialogueValue& Value)
+	{
+		Answers.Add({ Field, Value.ToString() });
+	});
+	QueueBroadcast(EAICompanionBroadcastPriority::Normal, this, [this, SessionPlayerId, FlowName = Session.GetFlowName(), bCompleted, Answers = MoveTemp(Answers)]()
+	{
+		OnPlayerDialogueFinished.Broadcast(SessionPlayerId, FlowName, bCompleted, Answers);
+	});
+}
+
+void AAICompanionManager::HandlePlayerMessage(const FAICompanionInboundMessage& Message)
+{
+	// Same routing table as single-player messages; handlers can tell players apart by Message.PlayerId
+	const FAICompanionMessageHandler* Handler = MessageHandlers.Find(Message.Type);
+	if (Handler && Handler->IsBound())
+	{
+		Handler->Execute(Message);
+	}
+	else if (Message.RequestId == 0)
+	{
+		UE_LOG(LogAICompanion, Log, TEXT("[AICompanionManager] Unhandled message type %s for %s"), *Message.Type.ToString(), *Message.PlayerId);
+	}
+}
+
+void AAICompanionManager::RegisterPlayer()
+{
+	if (!IsSocketConnected())
+	{
+		UE_LOG(LogAICompanion, Warning, TEXT("[AICompanionManager] Cannot register: Not connected"));
+		return;
+	}
+
+	UE_LOG(LogAICompanion, Log, TEXT("[AICompanionManager] Registering player: %s"), *PlayerID);
+
+	// Registration always goes out as JSON; binary is only used once the backend agrees to it
+	OutboundWriter.SetFormat(EAICompanionWireFormat::Json);
+	OutboundWriter.Begin(TEXT("register"))
+		.WriteString(TEXT("playerId"), PlayerID);
+
+	if (Connection)
+	{
+		OutboundWriter.WriteString(TEXT("wire"), AICOMPANION_BINARY_WIRE_NAME);
+		if (bCompressFrames)
 		{
-			UE_LOG(LogTemp, Log, TEXT("[AICompanionManager] Pong received (connection alive)"));
+			OutboundWriter.WriteString(TEXT("compression"), AICOMPANION_COMPRESSION_NAME);
 		}
-		else
+	}
+
+	// Ahead of anything queued - the backend rejects other messages until we are registered
+	SendImmediate(OutboundWriter.Finish());
+}
+
+void AAICompanionManager::ResumeSession()
+{
+	if (!IsSocketConnected())
+	{
+		return;
+	}
+
+	UE_LOG(LogAICompanion, Log, TEXT("[AICompanionManager] Resuming session for player: %s"), *PlayerID);
+
+	// Same negotiation as registration: JSON first, binary once accepted
+	OutboundWriter.SetFormat(EAICompanionWireFormat::Json);
+	OutboundWriter.Begin(TEXT("resume"))
+		.WriteString(TEXT("playerId"), PlayerID)
+		.WriteString(TEXT("sessionToken"), SessionToken);
+
+	if (Connection)
+	{
+		OutboundWriter.WriteString(TEXT("wire"), AICOMPANION_BINARY_WIRE_NAME);
+		if (bCompressFrames)
 		{
-			UE_LOG(LogTemp, Log, TEXT("[AICompanionManager] Unhandled message type: %s"), *MessageType);
+			OutboundWriter.WriteString(TEXT("compression"), AICOMPANION_COMPRESSION_NAME);
 		}
 	}
+
+	SendImmediate(OutboundWriter.Finish());
 }
 
-void AAICompanionManager::HandleConnectionStatusChange(bool bConnected)
+void AAICompanionManager::HandleWebSocketMessage(const FString& Message)
+{
+	AICOMPANION_LOG_PAYLOAD(TEXT("[AICompanionManager] <<"), Message);
+	Heartbeat.NoteReceived(FPlatformTime::Seconds());
+	WakeTick();
+
+	// Parsing happens on the decode pipe; Tick dispatches the result
+	if (DecodePipeline)
+	{
+		DecodePipeline->Enqueue(Message);
+	}
+}
+
+void AAICompanionManager::HandleBinaryMessage(TArray<uint8>& Frame)
+{
+	Heartbeat.NoteReceived(FPlatformTime::Seconds());
+	WakeTick();
+
+	if (DecodePipeline)
+	{
+		DecodePipeline->EnqueueBinary(MoveTemp(Frame));
+	}
+}
+
+void AAICompanionManager::RegisterMessageHandler(FName MessageType, FAICompanionMessageHandler Handler)
+{
+	MessageHandlers.Add(MessageType, MoveTemp(Handler));
+}
+
+void AAICompanionManager::UnregisterMessageHandler(FName MessageType)
+{
+	MessageHandlers.Remove(MessageType);
+}
+
+void AAICompanionManager::RegisterIntentHandler(EAICompanionIntent Intent, FAICompanionIntentHandler Handler)
+{
+	IntentHandlers.Add(Intent, MoveTemp(Handler));
+}
+
+void AAICompanionManager::UnregisterIntentHandler(EAICompanionIntent Intent)
+{
+	IntentHandlers.Remove(Intent);
+}
+
+void AAICompanionManager::RegisterBuiltInHandlers()
 {
-	bIsConnected = bConnected;
+	RegisterMessageHandler(AICompanionMessageTypes::Connected, FAICompanionMessageHandler::CreateUObject(this, &AAICompanionManager::HandleConnectedMessage));
+	RegisterMessageHandler(AICompanionMessageTypes::Registered, FAICompanionMessageHandler::CreateUObject(this, &AAICompanionManager::HandleRegisteredMessage));
+	RegisterMessageHandler(AICompanionMessageTypes::ChatResponse, FAICompanionMessageHandler::CreateUObject(this, &AAICompanionManager::HandleChatResponseMessage));
+	RegisterMessageHandler(AICompanionMessageTypes::ChatDelta, FAICompanionMessageHandler::CreateUObject(this, &AAICompanionManager::HandleChatDeltaMessage));
+	RegisterMessageHandler(AICompanionMessageTypes::VoiceProcessed, FAICompanionMessageHandler::CreateUObject(this, &AAICompanionManager::HandleVoiceProcessedMessage));
+	RegisterMessageHandler(AICompanionMessageTypes::VoicePartial, FAICompanionMessageHandler::CreateUObject(this, &AAICompanionManager::HandleVoicePartialMessage));
+	RegisterMessageHandler(AICompanionMessageTypes::Error, FAICompanionMessageHandler::CreateUObject(this, &AAICompanionManager::HandleErrorMessage));
+	RegisterMessageHandler(AICompanionMessageTypes::Pong, FAICompanionMessageHandler::CreateUObject(this, &AAICompanionManager::HandlePongMessage));
+	RegisterMessageHandler(AICompanionMessageTypes::Resumed, FAICompanionMessageHandler::CreateUObject(this, &AAICompanionManager::HandleResumedMessage));
+	RegisterMessageHandler(AICompanionMessageTypes::ResumeFailed, FAICompanionMessageHandler::CreateUObject(this, &AAICompanionManager::HandleResumeFailedMessage));
+	RegisterMessageHandler(AICompanionMessageTypes::CalendarSync, FAICompanionMessageHandler::CreateUObject(this, &AAICompanionManager::HandleCalendarSyncMessage));
+	RegisterMessageHandler(AICompanionMessageTypes::CalendarDelta, FAICompanionMessageHandler::CreateUObject(this, &AAICompanionManager::HandleCalendarDeltaMessage));
+}
+
+void AAICompanionManager::DispatchMessage(const FAICompanionInboundMessage& Message)
+{
+	UE_LOG(LogAICompanion, Verbose, TEXT("[AICompanionManager] Received message type: %s"), *Message.Type.ToString());
+
+	// Backend replies carry the number of our messages it has received
+	int64 Ack = 0;
+	if (Message.Payload.IsValid() && Message.Payload->TryGetNumberField(TEXT("ack"), Ack))
+	{
+		SendQueue.Acknowledge((uint64)Ack);
+	}
+
+	const FAICompanionMessageHandler* Handler = MessageHandlers.Find(Message.Type);
+	if (Handler && Handler->IsBound())
+	{
+		Handler->Execute(Message);
+	}
+	else if (Message.RequestId == 0)
+	{
+		UE_LOG(LogAICompanion, Log, TEXT("[AICompanionManager] Unhandled message type: %s"), *Message.Type.ToString());
+	}
+
+	// After the handler, so Blueprint events fire before the caller's callback
+	ResolveRequest(Message);
+}
+
+void AAICompanionManager::ResolveRequest(const FAICompanionInboundMessage& Message)
+{
+	if (Message.RequestId == 0)
+	{
+		return;
+	}
+
+	// Streamed chunks keep the request open; anything else answers it
+	if (Message.Type == AICompanionMessageTypes::ChatDelta || Message.Type == AICompanionMessageTypes::VoicePartial)
+	{
+		Requests.MarkFirstChunk(Message.RequestId);
+	}
+	else if (Message.Type == AICompanionMessageTypes::Error)
+	{
+		Requests.Fail(Message.RequestId, Message);
+	}
+	else
+	{
+		Requests.Complete(Message.RequestId, Message);
+	}
+}
+
+FString& AAICompanionManager::GetStreamingBuffer(int32 RequestId)
+{
+	if (FString* Existing = StreamingResponses.Find(RequestId))
+	{
+		return *Existing;
+	}
+
+	FString Buffer = SpareStreamingBuffers.Num() > 0 ? SpareStreamingBuffers.Pop(EAllowShrinking::No) : FString();
+	if (Buffer.GetAllocatedSize() == 0)
+	{
+		Buffer.Reserve(StreamingBufferReserve);
+	}
+	return StreamingResponses.Add(RequestId, MoveTemp(Buffer));
+}
+
+void AAICompanionManager::ReleaseStreamingBuffer(int32 RequestId)
+{
+	if (FString* Buffer = StreamingResponses.Find(RequestId))
+	{
+		// Keep the allocation for the next response
+		Buffer->Reset();
+		SpareStreamingBuffers.Add(MoveTemp(*Buffer));
+		StreamingResponses.Remove(RequestId);
+	}
+}
+
+FString AAICompanionManager::GetStreamingResponse() const
+{
+	const FString* Buffer = StreamingResponses.Find(LastChatRequestId);
+	return Buffer ? *Buffer : FString();
+}
+
+void AAICompanionManager::HandleConnectedMessage(const FAICompanionInboundMessage& Message)
+{
+	UE_LOG(LogAICompanion, Log, TEXT("[AICompanionManager] Connection confirmed (client %s)"), *Message.ClientId);
 	
-	if (bConnected)
+	// Pick up the existing session after a reconnect, otherwise auto-register player
+	if (!SessionToken.IsEmpty())
 	{
-		UE_LOG(LogTemp, Warning, TEXT("================================================="));
-		UE_LOG(LogTemp, Warning, TEXT("[AICompanionManager] *** CONNECTED TO BACKEND! ***"));
-		UE_LOG(LogTemp, Warning, TEXT("================================================="));
+		ResumeSession();
 	}
 	else
 	{
-		UE_LOG(LogTemp, Warning, TEXT("================================================="));
-		UE_LOG(LogTemp, Warning, TEXT("[AICompanionManager] *** DISCONNECTED FROM BACKEND ***"));
-		UE_LOG(LogTemp, Warning, TEXT("================================================="));
+		RegisterPlayer();
 	}
+}
+
+void AAICompanionManager::HandleRegisteredMessage(const FAICompanionInboundMessage& Message)
+{
+	UE_LOG(LogAICompanion, Log, TEXT("[AICompanionManager] Player registered: %s"), *Message.PlayerId);
+
+	ApplySessionFeatures(Message);
+
+	// New session on the backend: anything we still hold is numbered (and replayed) from zero
+	SendQueue.RestartSequence();
 	
-	OnConnectionStatusChanged.Broadcast(bConnected);
+	// Send a test message automatically after 2 seconds
+	FTimerHandle TestMessageTimer;
+	GetWorld()->GetTimerManager().SetTimer(TestMessageTimer, [this]()
+	{
+		SendTestMessage(TEXT("Hello from Unreal Engine!"));
+	}, 2.0f, false);
+}
+
+void AAICompanionManager::HandleResumedMessage(const FAICompanionInboundMessage& Message)
+{
+	ApplySessionFeatures(Message);
+
+	// DispatchMessage has already released what the backend acknowledged; replay the rest
+	const int32 Replayed = SendQueue.GetUnackedCount();
+	SendQueue.Rewind();
+	UE_LOG(LogAICompanion, Log, TEXT("[AICompanionManager] Session resumed (%d messages to replay)"), Replayed);
+
+	FlushSendQueue();
+}
+
+void AAICompanionManager::HandleResumeFailedMessage(const FAICompanionInboundMessage& Message)
+{
+	UE_LOG(LogAICompanion, Log, TEXT("[AICompanionManager] Session could not be resumed, registering again"));
+
+	SessionToken.Reset();
+	RegisterPlayer();
+}
+
+void AAICompanionManager::HandleCalendarSyncMessage(const FAICompanionInboundMessage& Message)
+{
+	bCalendarSyncRequested = false;
+	if (!Message.Payload.IsValid() || !CalendarIndex.ApplySnapshot(*Message.Payload))
+	{
+		UE_LOG(LogAICompanion, Warning, TEXT("[AICompanionManager] Malformed calendar_sync ignored"));
+		return;
+	}
+
+	UE_LOG(LogAICompanion, Verbose, TEXT("[AICompanionManager] Calendar synced: %d upcoming events (revision %lld)"),
+		CalendarIndex.Num(), CalendarIndex.GetRevision());
+	InvalidateResponseCache();
+}
+
+void AAICompanionManager::HandleCalendarDeltaMessage(const FAICompanionInboundMessage& Message)
+{
+	if (!Message.Payload.IsValid())
+	{
+		return;
+	}
+
+	switch (CalendarIndex.ApplyDelta(*Message.Payload))
+	{
+	case FAICompanionCalendarIndex::EDeltaResult::Applied:
+		// Cached answers about the calendar are stale now
+		InvalidateResponseCache();
+		break;
+	case FAICompanionCalendarIndex::EDeltaResult::NeedsSync:
+		RequestCalendarSync();
+		break;
+	default:
+		break;
+	}
+}
+
+void AAICompanionManager::RequestCalendarSync()
+{
+	if (bCalendarSyncRequested)
+	{
+		return;
+	}
+
+	UE_LOG(LogAICompanion, Verbose, TEXT("[AICompanionManager] Calendar delta missed (at revision %lld), asking for a snapshot"), CalendarIndex.GetRevision());
+	bCalendarSyncRequested = SendEncodedMessage(OutboundWriter.Begin(TEXT("calendar_sync")).Finish());
+}
+
+void AAICompanionManager::ApplySessionFeatures(const FAICompanionInboundMessage& Message)
+{
+	bIsRegistered = true;
+	bBackendAcceptsBatch = false;
+	ReconnectAttempt = 0;
+	MarkReady(ReadySocket);
+
+	// Whatever queued up while we were away can go now
+	WakeTick();
+
+	if (bEnableHeartbeat)
+	{
+		// Checked twice a second; the heartbeat itself decides when a ping is due
+		Heartbeat.Start(FPlatformTime::Seconds());
+		GetWorld()->GetTimerManager().SetTimer(HeartbeatTimer, this, &AAICompanionManager::UpdateHeartbeat, 0.5f, true);
+	}
+
+	if (!Message.Payload.IsValid())
+	{
+		return;
+	}
+
+	Message.Payload->TryGetBoolField(TEXT("batch"), bBackendAcceptsBatch);
+	Message.Payload->TryGetStringField(TEXT("sessionToken"), SessionToken);
+
+	// Switch to binary if we offered it and the backend accepted
+	FString Wire;
+	if (Connection && Message.Payload->TryGetStringField(TEXT("wire"), Wire) && Wire == AICOMPANION_BINARY_WIRE_NAME)
+	{
+		OutboundWriter.SetFormat(EAICompanionWireFormat::Binary);
+
+		// Nothing to switch on our side: DecodeBinaryFrame inflates whatever arrives flagged as compressed
+		FString Compression;
+		const bool bCompressed = Message.Payload->TryGetStringField(TEXT("compression"), Compression) && Compression == AICOMPANION_COMPRESSION_NAME;
+		UE_LOG(LogAICompanion, Log, TEXT("[AICompanionManager] Using binary wire format%s"), bCompressed ? TEXT(" (compressed)") : TEXT(""));
+	}
+}
+
+void AAICompanionManager::HandleChatResponseMessage(const FAICompanionInboundMessage& Message)
+{
+	// A streamed response may close with an empty chat_response; fall back to what was accumulated
+	const FString* Streamed = StreamingResponses.Find(Message.RequestId);
+	const FString& ResponseText = (Message.Text.IsEmpty() && Streamed) ? *Streamed : Message.Text;
+
+	if (!ResponseText.IsEmpty())
+	{
+		UE_LOG(LogAICompanion, Verbose, TEXT("[AICompanionManager] AI response received (%d chars)"), ResponseText.Len());
+		
+		uint64 CacheKey = 0;
+		if (PendingCacheKeys.RemoveAndCopyValue(Message.RequestId, CacheKey))
+		{
+			ResponseCache.Add(CacheKey, ResponseText, FPlatformTime::Seconds());
+		}
+
+		// Store in the bounded history (and on disk)
+		RecordTurn(FAICompanionConversationHistory::ERole::Assistant, ResponseText);
+		
+		// Broadcast to blueprints; copied, since the streaming buffer is recycled below
+		QueueBroadcast(EAICompanionBroadcastPriority::Normal, this, [this, ResponseText = FString(ResponseText)]()
+		{
+			OnAIResponseReceived.Broadcast(ResponseText);
+		});
+	}
+
+	ReleaseStreamingBuffer(Message.RequestId);
+}
+
+void AAICompanionManager::HandleChatDeltaMessage(const FAICompanionInboundMessage& Message)
+{
+	if (Message.Text.IsEmpty())
+	{
+		return;
+	}
+
+	// Interleaved responses each accumulate in their own buffer
+	GetStreamingBuffer(Message.RequestId).Append(Message.Text);
+	QueueBroadcast(EAICompanionBroadcastPriority::Normal, this, [this, Delta = Message.Text]()
+	{
+		OnAIResponseDelta.Broadcast(Delta);
+	});
+}
+
+void AAICompanionManager::HandleVoiceProcessedMessage(const FAICompanionInboundMessage& Message)
+{
+	UE_LOG(LogAICompanion, Verbose, TEXT("[AICompanionManager] Voice processed (transcription %d chars, response %d chars)"),
+		Message.Transcription.Len(), Message.AIResponse.Len());
+
+	if (!Message.Transcription.IsEmpty())
+	{
+		RecordTurn(FAICompanionConversationHistory::ERole::User, Message.Transcription);
+		QueueBroadcast(EAICompanionBroadcastPriority::Normal, this, [this, Transcription = Message.Transcription]()
+		{
+			OnVoiceTranscription.Broadcast(Transcription, true);
+		});
+	}
+
+	if (!Message.AIResponse.IsEmpty())
+	{
+		RecordTurn(FAICompanionConversationHistory::ERole::Assistant, Message.AIResponse);
+		QueueBroadcast(EAICompanionBroadcastPriority::Normal, this, [this, Response = Message.AIResponse]()
+		{
+			OnAIResponseReceived.Broadcast(Response);
+		});
+	}
+}
+
+void AAICompanionManager::HandleVoicePartialMessage(const FAICompanionInboundMessage& Message)
+{
+	// A partial can still be in flight after the next recording has started
+	if (Message.Transcription.IsEmpty() || !IsCurrentVoiceStream(Message))
+	{
+		return;
+	}
+
+	QueueBroadcast(EAICompanionBroadcastPriority::Normal, this, [this, Transcription = Message.Transcription]()
+	{
+		OnVoiceTranscription.Broadcast(Transcription, false);
+	});
+}
+
+bool AAICompanionManager::IsCurrentVoiceStream(const FAICompanionInboundMessage& Message) const
+{
+	int32 StreamId = 0;
+	return !Message.Payload.IsValid() || !Message.Payload->TryGetNumberField(TEXT("streamId"), StreamId) || StreamId == VoiceStreamId;
+}
+
+void AAICompanionManager::HandleErrorMessage(const FAICompanionInboundMessage& Message)
+{
+	UE_LOG(LogAICompanion, Error, TEXT("[AICompanionManager] Backend error: %s"), *Message.Error);
+}
+
+void AAICompanionManager::HandlePongMessage(const FAICompanionInboundMessage& Message)
+{
+	Heartbeat.NotePong(Message.RequestId, FPlatformTime::Seconds());
+	UE_LOG(LogAICompanion, Verbose, TEXT("[AICompanionManager] Pong received (connection alive)"));
+}
+
+void AAICompanionManager::HandleConnectionStatusChange(bool bConnected)
+{
+	if (!bConnected)
+	{
+		UE_LOG(LogAICompanion, Log, TEXT("[AICompanionManager] Disconnected from backend"));
+		HandleConnectionLost();
+		return;
+	}
+
+	bIsConnected = true;
+	UE_LOG(LogAICompanion, Log, TEXT("[AICompanionManager] Connected to backend"));
+
+	QueueBroadcast(EAICompanionBroadcastPriority::High, this, [this]()
+	{
+		OnConnectionStatusChanged.Broadcast(true);
+	});
 }
 
 void AAICompanionManager::HandleWebSocketError(const FString& ErrorMessage)
 {
-	UE_LOG(LogTemp, Error, TEXT("================================================="));
-	UE_LOG(LogTemp, Error, TEXT("[AICompanionManager] ❌ WEBSOCKET ERROR"));
-	UE_LOG(LogTemp, Error, TEXT("[AICompanionManager] Error: %s"), *ErrorMessage);
-	UE_LOG(LogTemp, Error, TEXT("================================================="));
-	
-	// Update connection status
+	UE_LOG(LogAICompanion, Error, TEXT("[AICompanionManager] WebSocket error: %s"), *ErrorMessage);
+	HandleConnectionLost();
+}
+
+void AAICompanionManager::HandleConnectionLost()
+{
+	// Queued messages wait for the next registration, and every new connection
+	// starts in JSON until registration negotiates otherwise
 	bIsConnected = false;
-	OnConnectionStatusChanged.Broadcast(false);
+	bIsRegistered = false;
+	bBackendAcceptsBatch = false;
+	OutboundWriter.SetFormat(EAICompanionWireFormat::Json);
+	GetWorld()->GetTimerManager().ClearTimer(HeartbeatTimer);
+
+	// Learns from drops we did not see coming (e.g. an idle cut by a proxy)
+	Heartbeat.NoteConnectionLost(FPlatformTime::Seconds());
+
+	QueueBroadcast(EAICompanionBroadcastPriority::High, this, [this]()
+	{
+		OnConnectionStatusChanged.Broadcast(false);
+	});
+
+	ScheduleReconnect();
 }
 
 FString AAICompanionManager::GeneratePlayerID()
@@ -6,14 +6,45 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "Tasks/Task.h"
 #include "WebSocketManager.h"
 #include "VoiceManager.h"
 #include "MemoryManager.h"
+#include "AICompanionProtocol.h"
+#include "AICompanionConnection.h"
+#include "AICompanionVoiceStream.h"
+#include "AICompanionSendQueue.h"
+#include "AICompanionRequests.h"
+#include "AICompanionHeartbeat.h"
+#include "AICompanionConversation.h"
+#include "AICompanionMemoryStore.h"
+#include "AICompanionResponseCache.h"
+#include "AICompanionCalendarIndex.h"
+#include "AICompanionIntentClassifier.h"
+#include "AICompanionSessionHost.h"
+#include "AICompanionDialogueComponent.h"
+#include "AICompanionBroadcastScheduler.h"
 #include "AICompanionManager.generated.h"
 
 // Delegate for AI responses - Use in Blueprints to update UI
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnAIResponseReceived, const FString&, Response);
+// Delegate for streamed response chunks - fires before OnAIResponseReceived
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnAIResponseDelta, const FString&, Delta);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnConnectionStatusChanged, bool, bIsConnected);
+// Voice, memory and the backend connection have all finished starting up
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnAICompanionReady);
+// Delegate for voice transcriptions - partial while streaming, then final
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnVoiceTranscription, const FString&, Transcription, bool, bIsFinal);
+// Multiplexed player sessions (bMultiplexPlayers) - the same events, tagged with the player they belong to
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnPlayerAIResponse, const FString&, PlayerId, const FString&, Response);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FOnPlayerDialogueQuestion, const FString&, PlayerId, FName, FlowName, const FString&, Question);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_FourParams(FOnPlayerDialogueFinished, const FString&, PlayerId, FName, FlowName, bool, bCompleted, const TArray<FAICompanionDialogueAnswer>&, Answers);
+
+// Handler for one backend message type - see AAICompanionManager::RegisterMessageHandler
+DECLARE_DELEGATE_OneParam(FAICompanionMessageHandler, const FAICompanionInboundMessage&);
+
+// Local handler for a recognized chat intent; return true if it dealt with the utterance (it is then not sent)
+DECLARE_DELEGATE_RetVal_TwoParams(bool, FAICompanionIntentHandler, EAICompanionIntent /*Intent*/, const FString& /*Utterance*/);
 
 UCLASS()
 class JOEVISV3V1_API AAICompanionManager : public AActor
@@ -46,6 +77,40 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI Companion|Configuration")
 	bool bAutoConnect = true;
 
+	// Reconnect automatically after the connection drops
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI Companion|Configuration")
+	bool bAutoReconnect = true;
+
+	// Backoff ceiling for the first retry; doubles per attempt up to ReconnectMaxDelay (seconds)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI Companion|Configuration", meta = (ClampMin = "0.05"))
+	float ReconnectBaseDelay = 0.5f;
+
+	// Longest wait between reconnect attempts (seconds)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI Companion|Configuration", meta = (ClampMin = "0.05"))
+	float ReconnectMaxDelay = 30.0f;
+
+	// Give up after this many consecutive failures (0 = keep trying)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI Companion|Configuration", meta = (ClampMin = "0"))
+	int32 MaxReconnectAttempts = 0;
+
+	// Ping the backend when the socket goes quiet, to keep proxies from cutting it and to spot dead sockets
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI Companion|Configuration")
+	bool bEnableHeartbeat = true;
+
+	// Starting heartbeat interval; adapts between the min and max below (seconds)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI Companion|Configuration", meta = (ClampMin = "1"))
+	float HeartbeatInterval = 20.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI Companion|Configuration", meta = (ClampMin = "1"))
+	float HeartbeatMinInterval = 5.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI Companion|Configuration", meta = (ClampMin = "1"))
+	float HeartbeatMaxInterval = 55.0f;
+
+	// Unanswered pings in a row before the socket is dropped and reconnected
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI Companion|Configuration", meta = (ClampMin = "1"))
+	int32 MaxMissedPongs = 2;
+
 	// Enable voice features
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI Companion|Configuration")
 	bool bEnableVoice = true;
@@ -54,6 +119,101 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI Companion|Configuration")
 	bool bEnableMemory = true;
 
+	// Ask the backend to stream chat responses as chat_delta chunks
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI Companion|Configuration")
+	bool bStreamResponses = true;
+
+	// Offer the compact binary wire format at registration (JSON stays the fallback).
+	// Uses the engine WebSocket directly instead of UWebSocketManager, which is text-only.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI Companion|Configuration")
+	bool bUseBinaryProtocol = false;
+
+	// With the binary format, also offer dictionary compression: the backend deflates its larger frames
+	// and they are inflated on the background decode task
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI Companion|Configuration")
+	bool bCompressFrames = true;
+
+	// Upload microphone audio in chunks while recording (falls back to the Voice Manager if capture fails)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI Companion|Configuration")
+	bool bStreamVoice = true;
+
+	// Seconds of audio per streamed voice chunk
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI Companion|Configuration", meta = (ClampMin = "0.02", ClampMax = "1.0"))
+	float VoiceChunkSeconds = 0.1f;
+
+	// Outbound messages held while disconnected or waiting for the next flush; new ones are rejected beyond this
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI Companion|Configuration", meta = (ClampMin = "1"))
+	int32 MaxQueuedMessages = 256;
+
+	// Largest coalesced frame sent in one flush (bytes)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI Companion|Configuration", meta = (ClampMin = "256"))
+	int32 MaxBatchBytes = 16 * 1024;
+
+	// Requests without a reply after this long complete as TimedOut (seconds, 0 = never)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI Companion|Configuration", meta = (ClampMin = "0"))
+	float RequestTimeoutSeconds = 30.0f;
+
+	// Keep memories and conversation history on disk (Saved/AICompanion) between sessions
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI Companion|Configuration")
+	bool bPersistMemory = true;
+
+	// File name prefix for the persistent memory store
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI Companion|Configuration")
+	FString MemoryStoreName = TEXT("Memory");
+
+	// Conversation turns kept for prompt context; older turns are folded into a short summary
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI Companion|Configuration", meta = (ClampMin = "1"))
+	int32 MaxConversationTurns = 64;
+
+	// Characters of conversation text kept in memory (fixed, allocated once)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI Companion|Configuration", meta = (ClampMin = "256"))
+	int32 ConversationHistoryChars = 32 * 1024;
+
+	// Characters kept for the summary of evicted turns
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI Companion|Configuration", meta = (ClampMin = "0"))
+	int32 ConversationSummaryChars = 1024;
+
+	// Answer repeated prompts from a local cache instead of a backend round trip
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI Companion|Configuration")
+	bool bEnableResponseCache = false;
+
+	// How long a cached response stays valid (seconds)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI Companion|Configuration", meta = (ClampMin = "1"))
+	float ResponseCacheTTLSeconds = 300.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI Companion|Configuration", meta = (ClampMin = "1"))
+	int32 MaxCachedResponses = 64;
+
+	// Total characters of cached response text
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI Companion|Configuration", meta = (ClampMin = "256"))
+	int32 ResponseCacheMaxChars = 64 * 1024;
+
+	// Classify chat messages locally and hand confident matches (e.g. "schedule a meeting") to registered intent handlers
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI Companion|Configuration")
+	bool bEnableLocalIntents = true;
+
+	// Classifier confidence (0-1) needed before a message is handled locally instead of sent
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI Companion|Configuration", meta = (ClampMin = "0", ClampMax = "1"))
+	float LocalIntentConfidence = 0.75f;
+
+	// Characters reserved up front for each streamed response buffer
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI Companion|Configuration", meta = (ClampMin = "0"))
+	int32 StreamingBufferReserve = 8192;
+
+	// Time per frame for delivering events to Blueprints (ms); the rest wait for the next frame.
+	// Errors and connection status are always delivered first. 0 broadcasts inline as messages are handled.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI Companion|Configuration", meta = (ClampMin = "0"))
+	float BroadcastBudgetMs = 2.0f;
+
+	// Dedicated servers: serve every player from this manager over a few shared sockets instead of one socket per player.
+	// Players are added with AddPlayerSession; the single-player calls (SendChatMessage, voice...) are unused then.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI Companion|Server")
+	bool bMultiplexPlayers = false;
+
+	// Sockets shared by all player sessions; each player is pinned to the least loaded one
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI Companion|Server", meta = (ClampMin = "1", ClampMax = "64"))
+	int32 ServerConnectionCount = 4;
+
 	// ============================================================================
 	// STATUS - Read-only status information
 	// ============================================================================
@@ -82,10 +242,38 @@ public:
 	UPROPERTY(BlueprintAssignable, Category = "AI Companion|Events")
 	FOnAIResponseReceived OnAIResponseReceived;
 
+	// Fires for each streamed chunk of a response - Use to type text out as it arrives
+	UPROPERTY(BlueprintAssignable, Category = "AI Companion|Events")
+	FOnAIResponseDelta OnAIResponseDelta;
+
 	// Fires when connection status changes
 	UPROPERTY(BlueprintAssignable, Category = "AI Companion|Events")
 	FOnConnectionStatusChanged OnConnectionStatusChanged;
 
+	// Fires with partial transcriptions while speaking, then once with the final one
+	UPROPERTY(BlueprintAssignable, Category = "AI Companion|Events")
+	FOnVoiceTranscription OnVoiceTranscription;
+
+	// Fires once voice, memory and the first backend registration are all done (see IsManagerReady)
+	UPROPERTY(BlueprintAssignable, Category = "AI Companion|Events")
+	FOnAICompanionReady OnManagerReady;
+
+	// Multiplexed sessions: a player's response arrived
+	UPROPERTY(BlueprintAssignable, Category = "AI Companion|Server")
+	FOnPlayerAIResponse OnPlayerAIResponseReceived;
+
+	// Multiplexed sessions: a streamed chunk of a player's response
+	UPROPERTY(BlueprintAssignable, Category = "AI Companion|Server")
+	FOnPlayerAIResponse OnPlayerAIResponseDelta;
+
+	// Multiplexed sessions: a player's dialogue asks its next question
+	UPROPERTY(BlueprintAssignable, Category = "AI Companion|Server")
+	FOnPlayerDialogueQuestion OnPlayerDialogueQuestion;
+
+	// Multiplexed sessions: a player's dialogue completed or was cancelled
+	UPROPERTY(BlueprintAssignable, Category = "AI Companion|Server")
+	FOnPlayerDialogueFinished OnPlayerDialogueFinished;
+
 	// ============================================================================
 	// PUBLIC FUNCTIONS - Call from Blueprints or C++
 	// ============================================================================
@@ -102,10 +290,23 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "AI Companion")
 	bool IsConnected() const;
 
+	// Voice and memory have loaded and the backend has registered us at least once.
+	// Chat sent earlier is not lost: it waits in the send queue.
+	UFUNCTION(BlueprintPure, Category = "AI Companion|Status")
+	bool IsManagerReady() const { return ReadyParts == ReadyAll; }
+
+	// Completes on the game thread together with OnManagerReady; use it as a task prerequisite,
+	// or wait on it from another thread (never from the game thread, which has to complete it)
+	UE::Tasks::FTaskEvent GetReadyEvent() const { return ReadyEvent; }
+
 	// Send a chat message to AI
 	UFUNCTION(BlueprintCallable, Category = "AI Companion")
 	void SendChatMessage(const FString& Message);
 
+	// Queue an already-encoded JSON message; returns false if the send queue is full
+	UFUNCTION(BlueprintCallable, Category = "AI Companion")
+	bool SendMessageToBackend(const FString& JsonMessage);
+
 	// Send a test message (same as SendChatMessage)
 	UFUNCTION(BlueprintCallable, Category = "AI Companion")
 	void SendTestMessage(const FString& Message);
@@ -126,16 +327,332 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "AI Companion")
 	FString GetMemory(const FString& Key);
 
+	// Recent conversation as "Role: text" lines (summary of older turns first), up to MaxChars
+	UFUNCTION(BlueprintPure, Category = "AI Companion|Memory")
+	FString GetConversationContext(int32 MaxChars = 4096) const;
+
+	// Turns currently held in the conversation history
+	UFUNCTION(BlueprintPure, Category = "AI Companion|Memory")
+	int32 GetConversationTurnCount() const { return Conversation.Num(); }
+
+	// Forget the conversation so far
+	UFUNCTION(BlueprintCallable, Category = "AI Companion|Memory")
+	void ClearConversationHistory();
+
+	// Text streamed so far for the most recent chat request
+	UFUNCTION(BlueprintPure, Category = "AI Companion")
+	FString GetStreamingResponse() const;
+
+	// Requests sent (or queued) that have not been answered yet
+	UFUNCTION(BlueprintPure, Category = "AI Companion|Status")
+	int32 GetRequestsInFlight() const { return Requests.Num(); }
+
+	// True while waiting to retry a dropped connection
+	UFUNCTION(BlueprintPure, Category = "AI Companion|Status")
+	bool IsReconnecting() const;
+
+	// Heartbeat interval currently in use (seconds)
+	UFUNCTION(BlueprintPure, Category = "AI Companion|Status")
+	float GetHeartbeatInterval() const { return Heartbeat.GetInterval(); }
+
+	// Consecutive reconnect attempts since the last successful registration
+	UFUNCTION(BlueprintPure, Category = "AI Companion|Status")
+	int32 GetReconnectAttempt() const { return ReconnectAttempt; }
+
+	// Measure round-trip time to the backend now (result lands in the PingRTT histogram)
+	UFUNCTION(BlueprintCallable, Category = "AI Companion|Latency")
+	void SendPing();
+
+	// Latency in milliseconds at a percentile (0-100), e.g. 50 or 99
+	UFUNCTION(BlueprintPure, Category = "AI Companion|Latency")
+	float GetLatencyPercentile(EAICompanionLatencyMetric Metric, float Percentile = 50.0f) const;
+
+	// Number of samples recorded for a metric
+	UFUNCTION(BlueprintPure, Category = "AI Companion|Latency")
+	int64 GetLatencySampleCount(EAICompanionLatencyMetric Metric) const;
+
+	// Clear all latency histograms
+	UFUNCTION(BlueprintCallable, Category = "AI Companion|Latency")
+	void ResetLatencyStats();
+
+	// Retire every cached response (call when something the answers depend on has changed)
+	UFUNCTION(BlueprintCallable, Category = "AI Companion|Cache")
+	void InvalidateResponseCache();
+
+	// Chat messages answered from the response cache
+	UFUNCTION(BlueprintPure, Category = "AI Companion|Cache")
+	int64 GetResponseCacheHits() const { return (int64)ResponseCache.GetHitCount(); }
+
+	// True once the backend has sent the player's calendar and no change has been missed since
+	UFUNCTION(BlueprintPure, Category = "AI Companion|Calendar")
+	bool IsCalendarSynced() const { return CalendarIndex.IsSynced(); }
+
+	// Upcoming events held locally
+	UFUNCTION(BlueprintPure, Category = "AI Companion|Calendar")
+	int32 GetCalendarEventCount() const { return CalendarIndex.Num(); }
+
+	// Messages waiting in the send queue (including sent ones kept for replay until acknowledged)
+	UFUNCTION(BlueprintPure, Category = "AI Companion|Status")
+	int32 GetQueuedMessageCount() const { return SendQueue.Num(); }
+
+	// Messages dropped because the send queue was full
+	UFUNCTION(BlueprintPure, Category = "AI Companion|Status")
+	int64 GetDroppedMessageCount() const { return (int64)SendQueue.GetDroppedCount(); }
+
+	// Socket frames written so far (a batch counts once)
+	UFUNCTION(BlueprintPure, Category = "AI Companion|Status")
+	int64 GetSentFrameCount() const { return (int64)SendQueue.GetFramesSent(); }
+
+	// ============================================================================
+	// PLAYER SESSIONS - Multiplexed mode (bMultiplexPlayers) only
+	// ============================================================================
+
+	// Start a session for a player; registers on the backend as soon as its socket is up. False if it already exists.
+	UFUNCTION(BlueprintCallable, Category = "AI Companion|Server")
+	bool AddPlayerSession(const FString& SessionPlayerId);
+
+	// End a player's session (e.g. on logout)
+	UFUNCTION(BlueprintCallable, Category = "AI Companion|Server")
+	void RemovePlayerSession(const FString& SessionPlayerId);
+
+	UFUNCTION(BlueprintPure, Category = "AI Companion|Server")
+	int32 GetPlayerSessionCount() const;
+
+	// Chat for one player; answers their running dialogue instead if there is one
+	UFUNCTION(BlueprintCallable, Category = "AI Companion|Server")
+	void SendPlayerChatMessage(const FString& SessionPlayerId, const FString& Message);
+
+	// Start a built-in dialogue flow (Calendar, Reminder, Budget, EventFollowUp) for one player; the player's chat answers it
+	UFUNCTION(BlueprintCallable, Category = "AI Companion|Server")
+	bool StartPlayerDialogue(const FString& SessionPlayerId, FName FlowName, bool bSkipOptional = false);
+
+	UFUNCTION(BlueprintCallable, Category = "AI Companion|Server")
+	void CancelPlayerDialogue(const FString& SessionPlayerId);
+
+	UFUNCTION(BlueprintCallable, Category = "AI Companion|Server")
+	void AddPlayerMemory(const FString& SessionPlayerId, const FString& Key, const FString& Value);
+
+	UFUNCTION(BlueprintCallable, Category = "AI Companion|Server")
+	FString GetPlayerMemory(const FString& SessionPlayerId, const FString& Key) const;
+
+	UFUNCTION(BlueprintPure, Category = "AI Companion|Server")
+	FString GetPlayerConversationContext(const FString& SessionPlayerId, int32 MaxChars = 4096) const;
+
+	// Chat request for one player whose reply also goes to Callback; 0 if the player is unknown or the queue is full
+	int32 SendPlayerChatRequest(const FString& SessionPlayerId, const FString& Message, FAICompanionRequestCallback Callback = FAICompanionRequestCallback());
+
+	// ============================================================================
+	// MESSAGE ROUTING - C++ only
+	// ============================================================================
+
+	// Route a backend message type to a handler (replaces any existing handler for that type)
+	void RegisterMessageHandler(FName MessageType, FAICompanionMessageHandler Handler);
+
+	// Stop routing a message type
+	void UnregisterMessageHandler(FName MessageType);
+
+	// Handle an intent locally when SendChatMessage recognizes it (replaces any existing handler for that intent)
+	void RegisterIntentHandler(EAICompanionIntent Intent, FAICompanionIntentHandler Handler);
+
+	void UnregisterIntentHandler(EAICompanionIntent Intent);
+
+	// Answer a chat message without the backend, exactly as if chat_response had arrived.
+	// From an intent handler, the answer follows the user's turn in the history.
+	void DeliverLocalResponse(const FString& Response);
+
+	// Local copy of the player's upcoming events, kept current by calendar_sync and calendar_delta
+	const FAICompanionCalendarIndex& GetCalendarIndex() const { return CalendarIndex; }
+
+	// Shared outbound encoder - Begin() a message, then pass Finish() to SendEncodedMessage.
+	// Writes JSON or binary depending on what was negotiated with the backend.
+	FAICompanionMessageWriter& GetMessageWriter() { return OutboundWriter; }
+
+	// Queue a finished message from a writer; returns false if the send queue is full.
+	// Queued messages go out at the end of the frame, coalesced where the backend allows.
+	bool SendEncodedMessage(const FAICompanionMessageWriter& Writer);
+
+	// Send a request and get its reply through Callback. Begin() the message on GetMessageWriter()
+	// and write its fields; this adds the requestId, finishes and queues it. Any number of
+	// requests may be in flight at once. Returns the requestId, or 0 if the send queue is full
+	// (Callback is not called then). TimeoutSeconds < 0 uses RequestTimeoutSeconds.
+	int32 SendRequest(FAICompanionMessageWriter& Writer, EAICompanionLatencyMetric Metric, FAICompanionRequestCallback Callback, float TimeoutSeconds = -1.0f);
+
+	// Chat message whose reply (chat_response, after any chat_delta chunks) goes to Callback as well as OnAIResponseReceived
+	int32 SendChatRequest(const FString& Message, FAICompanionRequestCallback Callback = FAICompanionRequestCallback());
+
+	// Deliver a Blueprint broadcast under the per-frame budget (BroadcastBudgetMs). Skipped if Owner is gone by then.
+	void QueueBroadcast(EAICompanionBroadcastPriority Priority, const UObject* Owner, TUniqueFunction<void()>&& Delivery);
+
+	// Wire format currently in use
+	EAICompanionWireFormat GetWireFormat() const { return OutboundWriter.GetFormat(); }
+
 private:
 	// Internal initialization
+	void InitializeConnection();
 	void InitializeManagers();
+	void FinishDeferredInitialization();
+	void PollBackgroundInitialization();
+	void FinishMemoryLoad(bool bOpened);
+	void MarkReady(uint8 Parts);
+	void WakeTick();
+	bool HasPendingWork() const;
+	void WatchRequests();
+	void UpdateRequests();
+	void InitializeSessionHost();
+	void HandlePlayerMessage(const FAICompanionInboundMessage& Message);
+	void HandlePlayerDialogueFinished(const FString& SessionPlayerId, const FAICompanionDialogueSession& Session, bool bCompleted);
 	void RegisterPlayer();
+	void ResumeSession();
+	void ApplySessionFeatures(const FAICompanionInboundMessage& Message);
+	void ScheduleReconnect();
+	void HandleReconnectTimer();
+	void UpdateHeartbeat();
+	void DropDeadConnection();
 	void HandleWebSocketMessage(const FString& Message);
+	void HandleBinaryMessage(TArray<uint8>& Frame);
+	bool IsSocketConnected() const;
+	void FlushSendQueue();
+	bool SendImmediate(const FAICompanionMessageWriter& Writer);
+	void TransmitText(const FString& Frame);
+	void TransmitBinary(const TArray<uint8>& Frame);
+	void DispatchMessage(const FAICompanionInboundMessage& Message);
+	bool TryHandleLocalIntent(const FString& Message);
+	void RecordTurn(FAICompanionConversationHistory::ERole Role, const FString& Text);
+	void ResolveRequest(const FAICompanionInboundMessage& Message);
+	FString& GetStreamingBuffer(int32 RequestId);
+	void ReleaseStreamingBuffer(int32 RequestId);
+	void RegisterBuiltInHandlers();
+	void HandleConnectedMessage(const FAICompanionInboundMessage& Message);
+	void HandleRegisteredMessage(const FAICompanionInboundMessage& Message);
+	void HandleChatResponseMessage(const FAICompanionInboundMessage& Message);
+	void HandleChatDeltaMessage(const FAICompanionInboundMessage& Message);
+	void HandleVoiceProcessedMessage(const FAICompanionInboundMessage& Message);
+	void HandleVoicePartialMessage(const FAICompanionInboundMessage& Message);
+	void PumpVoiceStream();
+	bool IsCurrentVoiceStream(const FAICompanionInboundMessage& Message) const;
+	void HandleErrorMessage(const FAICompanionInboundMessage& Message);
+	void HandlePongMessage(const FAICompanionInboundMessage& Message);
+	void HandleResumedMessage(const FAICompanionInboundMessage& Message);
+	void HandleResumeFailedMessage(const FAICompanionInboundMessage& Message);
+	void HandleCalendarSyncMessage(const FAICompanionInboundMessage& Message);
+	void HandleCalendarDeltaMessage(const FAICompanionInboundMessage& Message);
+	void RequestCalendarSync();
 	void HandleConnectionStatusChange(bool bConnected);
 	void HandleWebSocketError(const FString& ErrorMessage);  // ← ADDED: Error handler
+
+	/** Shared by a close and an error: drop to JSON, forget registration, schedule a reconnect */
+	void HandleConnectionLost();
 	FString GeneratePlayerID();
 	
 	// Internal state
 	bool bIsInitialized = false;
+
+	// Startup progress; IsManagerReady once all three are in
+	static constexpr uint8 ReadyVoice = 1 << 0;
+	static constexpr uint8 ReadyMemory = 1 << 1;
+	static constexpr uint8 ReadySocket = 1 << 2;
+	static constexpr uint8 ReadyAll = ReadyVoice | ReadyMemory | ReadySocket;
+	uint8 ReadyParts = 0;
+	UE::Tasks::FTaskEvent ReadyEvent{ UE_SOURCE_LOCATION };
+	double BeginPlaySeconds = 0.0;
+
+	// Opens MemoryStore in the background; until it finishes, turns and preferences wait below
+	UE::Tasks::TTask<bool> MemoryLoadTask;
+	bool bMemoryLoading = false;
+	TArray<TPair<FAICompanionConversationHistory::ERole, FString>> PendingStoreTurns;
+	TMap<FString, FString> PendingPreferences;
+
+	// ClearConversationHistory ran while loading; the loaded turns are cleared rather than restored
+	bool bClearStoreTurnsOnLoad = false;
+
+	// Enumerates capture devices for VoiceStream in the background
+	UE::Tasks::TTask<bool> VoicePrepareTask;
 	bool bIsConnected = false;
+
+	// Set by the registered reply; the send queue only flushes once registered
+	bool bIsRegistered = false;
+	bool bBackendAcceptsBatch = false;
+
+	// Cleared by DisconnectFromBackend/EndPlay so a deliberate close is not retried
+	bool bWantsConnection = false;
+	int32 ReconnectAttempt = 0;
+	FTimerHandle ReconnectTimer;
+
+	// Issued at registration; lets a reconnect resume the session instead of registering again
+	FString SessionToken;
+
+	// Engine socket used when bUseBinaryProtocol is set (WebSocketManager is not created then)
+	TSharedPtr<FAICompanionConnection> Connection;
+
+	// Every player session and its sockets when bMultiplexPlayers is set (nothing else connects then)
+	TUniquePtr<FAICompanionSessionHost> SessionHost;
+
+	// Inbound frames are parsed here and drained in Tick
+	TUniquePtr<FAICompanionDecodePipeline> DecodePipeline;
+
+	// Message type -> handler (FName compares by index, so lookup is a single hash probe)
+	TMap<FName, FAICompanionMessageHandler> MessageHandlers;
+
+	// Intent -> local handler, consulted by SendChatMessage before anything is sent
+	TMap<EAICompanionIntent, FAICompanionIntentHandler> IntentHandlers;
+
+	// Set while an intent handler runs; DeliverLocalResponse holds its answer until the user's turn is recorded
+	bool bHandlingLocalIntent = false;
+	FString PendingLocalResponse;
+
+	// The player's upcoming events; a missed delta asks for a new snapshot (once until it arrives)
+	FAICompanionCalendarIndex CalendarIndex;
+	bool bCalendarSyncRequested = false;
+
+	// Shared encoder for everything we send; its buffer is reused between messages
+	FAICompanionMessageWriter OutboundWriter;
+
+	// Encoded messages waiting for the socket
+	FAICompanionSendQueue SendQueue;
+
+	// Requests waiting for a reply, with their callbacks and latency histograms
+	FAICompanionRequestTable Requests;
+
+	// Expires timed-out requests while any are pending (the actor only ticks while it has work to drain)
+	FTimerHandle RequestTimer;
+
+	// Bounded turn history (replaces unbounded UMemoryManager::AddConversation)
+	FAICompanionConversationHistory Conversation;
+
+	// On-disk preferences and turns; written in the background
+	FAICompanionMemoryStore MemoryStore;
+
+	// Answers to repeated prompts, keyed by normalized prompt + ResponseCacheVersion
+	FAICompanionResponseCache ResponseCache;
+
+	// Blueprint broadcasts waiting for Tick
+	FAICompanionBroadcastScheduler Broadcasts;
+	uint32 ResponseCacheVersion = 0;
+
+	// Cache key for each chat request that missed, so its reply can be stored
+	TMap<int32, uint64> PendingCacheKeys;
+
+	// Keep-alive state; checked by HeartbeatTimer while registered
+	FAICompanionHeartbeat Heartbeat;
+	FTimerHandle HeartbeatTimer;
+
+	// chat_delta chunks accumulate per requestId until that request's chat_response arrives
+	TMap<int32, FString> StreamingResponses;
+
+	// Released buffers, kept with their allocation for the next streamed response
+	TArray<FString> SpareStreamingBuffers;
+
+	// Most recent chat request, for GetStreamingResponse
+	int32 LastChatRequestId = 0;
+
+	// Microphone capture for streamed voice (created on first use)
+	TUniquePtr<FAICompanionVoiceStream> VoiceStream;
+
+	// Chunks are copied out into this one, so its buffer is reused across pumps
+	FAICompanionVoiceStream::FChunk VoiceChunk;
+
+	// Current voice upload: id, next chunk number, and whether voice_start went out
+	int32 VoiceStreamId = 0;
+	int32 VoiceChunkSeq = 0;
+	bool bVoiceStreamOpen = false;
 };
@@ -0,0 +1,854 @@
+// AICompanionMemoryStore.cpp
+// Snapshot format, log records and background compaction
+
+#include "AICompanionMemoryStore.h"
+#include "AICompanionLog.h"
+#include "Async/MappedFileHandle.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/Crc.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+// ========================================
+// ON-DISK FORMAT
+// ========================================
+//
+// Snapshot (native byte order, read in place):
+//   FHeader
+//   FPreferenceRecord[PreferenceCount]   sorted by key bytes
+//   FTurnRecord[TurnCount]               oldest first
+//   UTF-8 strings referenced by offset from StringsOffset
+//
+// Log: a sequence of [u32 PayloadLength][u32 PayloadCrc][Payload]. A record
+// that is cut short or fails its CRC ends the log (torn write on crash).
+//   Payload := u8 Kind, then
+//     Preference: Str Key, Str Value
+//     Turn:       u8 Role, Str Text
+//     ClearTurns: (nothing) - every turn before it is gone
+//   Str := u32 Length, UTF-8 bytes
+
+namespace AICompanionMemoryFormat
+{
+	static constexpr uint32 Magic = 0x4D434941; // "AICM"
+	static constexpr uint32 Version = 1;
+
+	struct FHeader
+	{
+		uint32 Magic;
+		uint32 Version;
+		uint32 PreferenceCount;
+		uint32 TurnCount;
+		uint32 StringsOffset;
+		uint32 StringsSize;
+	};
+
+	struct FPreferenceRecord
+	{
+		uint32 KeyOffset;
+		uint32 KeyLength;
+		uint32 ValueOffset;
+		uint32 ValueLength;
+	};
+
+	struct FTurnRecord
+	{
+		uint32 TextOffset;
+		uint32 TextLength;
+		uint32 Role;
+	};
+
+	static_assert(sizeof(FHeader) == 24 && sizeof(FPreferenceRecord) == 16 && sizeof(FTurnRecord) == 12, "Snapshot records must stay packed");
+
+	static constexpr uint8 Record_Preference = 1;
+	static constexpr uint8 Record_Turn = 2;
+	static constexpr uint8 Record_ClearTurns = 3;
+	static constexpr int32 RecordHeaderSize = 8;
+
+	static const FHeader& GetHeader(const uint8* Data) { return *reinterpret_cast<const FHeader*>(Data); }
+	static const FPreferenceRecord* GetPreferences(const uint8* Data) { return reinterpret_cast<const FPreferenceRecord*>(Data + sizeof(FHeader)); }
+	static const FTurnRecord* GetTurns(const uint8* Data) { return reinterpret_cast<const FTurnRecord*>(GetPreferences(Data) + GetHeader(Data).PreferenceCount); }
+	static const uint8* GetStrings(const uint8* Data) { return Data + GetHeader(Data).StringsOffset; }
+
+	static bool Validate(const uint8* Data, int64 Size)
+	{
+		if (Size < (int64)sizeof(FHeader))
+		{
+			return false;
+		}
+
+		const FHeader& Header = GetHeader(Data);
+		if (Header.Magic != Magic || Header.Version != Version)
+		{
+			return false;
+		}
+
+		const uint64 TablesEnd = sizeof(FHeader) + (uint64)Header.PreferenceCount * sizeof(FPreferenceRecord) + (uint64)Header.TurnCount * sizeof(FTurnRecord);
+		if (TablesEnd > Header.StringsOffset || (uint64)Header.StringsOffset + Header.StringsSize > (uint64)Size)
+		{
+			return false;
+		}
+
+		const FPreferenceRecord* Preferences = GetPreferences(Data);
+		for (uint32 Index = 0; Index < Header.PreferenceCount; ++Index)
+		{
+			const FPreferenceRecord& Record = Preferences[Index];
+			if ((uint64)Record.KeyOffset + Record.KeyLength > Header.StringsSize || (uint64)Record.ValueOffset + Record.ValueLength > Header.StringsSize)
+			{
+				return false;
+			}
+		}
+
+		const FTurnRecord* Turns = GetTurns(Data);
+		for (uint32 Index = 0; Index < Header.TurnCount; ++Index)
+		{
+			const FTurnRecord& Record = Turns[Index];
+			if ((uint64)Record.TextOffset + Record.TextLength > Header.StringsSize || Record.Role > (uint32)FAICompanionConversationHistory::ERole::Assistant)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	static int32 CompareBytes(const uint8* A, uint32 ALength, const uint8* B, uint32 BLength)
+	{
+		const int32 Result = FMemory::Memcmp(A, B, FMath::Min(ALength, BLength));
+		return Result != 0 ? Result : (int32)ALength - (int32)BLength;
+	}
+
+	static FString ToString(const uint8* Utf8, uint32 Length)
+	{
+		FUTF8ToTCHAR Converted(reinterpret_cast<const ANSICHAR*>(Utf8), Length);
+		return FString(Converted.Length(), Converted.Get());
+	}
+
+	static void WriteU32(TArray<uint8>& Out, uint32 Value)
+	{
+		Out.Append(reinterpret_cast<const uint8*>(&Value), sizeof(Value));
+	}
+
+	static void WriteStr(TArray<uint8>& Out, FStringView Text)
+	{
+		FTCHARToUTF8 Utf8(Text.GetData(), Text.Len());
+		WriteU32(Out, (uint32)Utf8.Length());
+		Out.Append(reinterpret_cast<const uint8*>(Utf8.Get()), Utf8.Length());
+	}
+
+	struct FReader
+	{
+		const uint8* Data;
+		uint32 Size;
+		uint32 Pos = 0;
+
+		bool ReadU8(uint8& Out)
+		{
+			if (Pos + 1 > Size)
+			{
+				return false;
+			}
+			Out = Data[Pos++];
+			return true;
+		}
+
+		bool ReadU32(uint32& Out)
+		{
+			if (Pos + sizeof(uint32) > Size)
+			{
+				return false;
+			}
+			FMemory::Memcpy(&Out, Data + Pos, sizeof(uint32));
+			Pos += sizeof(uint32);
+			return true;
+		}
+
+		bool ReadStr(FString& Out)
+		{
+			uint32 Length = 0;
+			if (!ReadU32(Length) || (uint64)Pos + Length > Size)
+			{
+				return false;
+			}
+			Out = ToString(Data + Pos, Length);
+			Pos += Length;
+			return true;
+		}
+	};
+}
+
+using namespace AICompanionMemoryFormat;
+
+// ========================================
+// LIFETIME
+// ========================================
+
+FAICompanionMemoryStore::FAICompanionMemoryStore()
+	: Pipe(TEXT("AICompanionMemory"))
+{
+}
+
+FAICompanionMemoryStore::~FAICompanionMemoryStore()
+{
+	Close();
+}
+
+FString FAICompanionMemoryStore::GetSnapshotPath(int32 Gen) const
+{
+	return Directory / FString::Printf(TEXT("%s-%d.snap"), *Name, Gen);
+}
+
+FString FAICompanionMemoryStore::GetLogPath(int32 Gen) const
+{
+	return Directory / FString::Printf(TEXT("%s-%d.log"), *Name, Gen);
+}
+
+bool FAICompanionMemoryStore::Open(const FString& InDirectory, const FString& InName, int32 InMaxTurns)
+{
+	Close();
+
+	Directory = InDirectory;
+	Name = InName;
+	MaxTurns = FMath::Max(InMaxTurns, 0);
+
+	IFileManager& FileManager = IFileManager::Get();
+	if (!FileManager.MakeDirectory(*Directory, true))
+	{
+		UE_LOG(LogAICompanion, Warning, TEXT("[AICompanionMemoryStore] Cannot create %s"), *Directory);
+		return false;
+	}
+
+	// <Name>-<Gen>.<ext>; the newest complete snapshot wins, .tmp files are unfinished compactions
+	TArray<FString> Files;
+	FileManager.FindFiles(Files, *(Directory / (Name + TEXT("-*"))), true, false);
+
+	auto ParseGeneration = [this](const FString& File) -> int32
+	{
+		const FString Base = FPaths::GetBaseFilename(File);
+		return Base.Len() > Name.Len() + 1 && FChar::IsDigit(Base[Name.Len() + 1]) ? FCString::Atoi(*Base + Name.Len() + 1) : -1;
+	};
+
+	Generation = 0;
+	for (const FString& File : Files)
+	{
+		if (FPaths::GetExtension(File) == TEXT("snap"))
+		{
+			Generation = FMath::Max(Generation, ParseGeneration(File));
+		}
+	}
+
+	if (Generation > 0 && !MapSnapshot(Generation))
+	{
+		UE_LOG(LogAICompanion, Warning, TEXT("[AICompanionMemoryStore] Snapshot %s is unreadable, starting from its log only"), *GetSnapshotPath(Generation));
+	}
+
+	// The log is small (compaction keeps it so), so it is replayed rather than mapped
+	TArray<uint8> LogContents;
+	FFileHelper::LoadFileToArray(LogContents, *GetLogPath(Generation), FILEREAD_Silent);
+	LogBytes = ReplayLog(LogContents);
+
+	const bool bTorn = LogBytes != LogContents.Num();
+	if (bTorn)
+	{
+		UE_LOG(LogAICompanion, Warning, TEXT("[AICompanionMemoryStore] Dropping %lld bytes of torn log"), LogContents.Num() - LogBytes);
+		LogContents.SetNum((int32)LogBytes);
+	}
+
+	TArray<FString> Stale;
+	for (const FString& File : Files)
+	{
+		const int32 FileGeneration = ParseGeneration(File);
+		if (FileGeneration >= 0 && (FileGeneration < Generation || FPaths::GetExtension(File) == TEXT("tmp")))
+		{
+			Stale.Add(Directory / File);
+		}
+	}
+
+	// File work happens on the pipe from here on; appends queue up behind this
+	Pipe.Launch(TEXT("AICompanionMemoryOpenLog"), [this, LogPath = GetLogPath(Generation), bTorn, ValidLog = MoveTemp(LogContents), Stale = MoveTemp(Stale)]()
+	{
+		for (const FString& File : Stale)
+		{
+			IFileManager::Get().Delete(*File, false, false, true);
+		}
+
+		// A torn log is rewritten with its intact prefix so new records are not stranded behind garbage
+		IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+		LogHandle.Reset(PlatformFile.OpenWrite(*LogPath, !bTorn, false));
+		if (!LogHandle)
+		{
+			UE_LOG(LogAICompanion, Warning, TEXT("[AICompanionMemoryStore] Cannot open %s for writing"), *LogPath);
+		}
+		else if (bTorn)
+		{
+			LogHandle->Write(ValidLog.GetData(), ValidLog.Num());
+			LogHandle->Flush();
+		}
+	});
+
+	bOpen = true;
+	UE_LOG(LogAICompanion, Log, TEXT("[AICompanionMemoryStore] Opened %s generation %d (%lld log bytes)"), *Name, Generation, LogBytes);
+	return true;
+}
+
+void FAICompanionMemoryStore::Close()
+{
+	if (!bOpen)
+	{
+		return;
+	}
+
+	// Everything on disk is consistent at any point; a compaction that finished here is picked up by the next Open()
+	Pipe.WaitUntilEmpty();
+	bCompacting = false;
+
+	LogHandle.Reset();
+	UnmapSnapshot();
+	Overlay.Reset();
+	Frozen.Reset();
+	LogBytes = 0;
+	CompactionBackoffBytes = 0;
+	bOpen = false;
+}
+
+// ========================================
+// SNAPSHOT
+// ========================================
+
+bool FAICompanionMemoryStore::MapSnapshot(int32 Gen)
+{
+	// Loaded to the side, so a snapshot that fails leaves the current one mapped
+	const FString Path = GetSnapshotPath(Gen);
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+	TUniquePtr<IMappedFileHandle> NewFile(PlatformFile.OpenMapped(*Path));
+	TUniquePtr<IMappedFileRegion> NewRegion;
+	if (NewFile && NewFile->GetFileSize() > 0)
+	{
+		NewRegion.Reset(NewFile->MapRegion(0, NewFile->GetFileSize()));
+	}
+
+	TArray<uint8> NewCopy;
+	if (!NewRegion)
+	{
+		// No mapping support: a plain read, still used in place
+		NewFile.Reset();
+		if (!FFileHelper::LoadFileToArray(NewCopy, *Path, FILEREAD_Silent))
+		{
+			return false;
+		}
+	}
+
+	const uint8* NewData = NewRegion ? NewRegion->GetMappedPtr() : NewCopy.GetData();
+	const int64 NewSize = NewRegion ? NewRegion->GetMappedSize() : NewCopy.Num();
+	if (!Validate(NewData, NewSize))
+	{
+		return false;
+	}
+
+	UnmapSnapshot();
+	MappedFile = MoveTemp(NewFile);
+	MappedRegion = MoveTemp(NewRegion);
+	SnapshotCopy = MoveTemp(NewCopy);
+	SnapshotData = NewData;
+	SnapshotSize = NewSize;
+	return true;
+}
+
+void FAICompanionMemoryStore::UnmapSnapshot()
+{
+	SnapshotData = nullptr;
+	SnapshotSize = 0;
+
+	// Region before the file it maps
+	MappedRegion.Reset();
+	MappedFile.Reset();
+	SnapshotCopy.Empty();
+}
+
+bool FAICompanionMemoryStore::FindSnapshotPreference(const FString& Key, FString& OutValue) const
+{
+	if (!SnapshotData)
+	{
+		return false;
+	}
+
+	const uint32 Count = GetHeader(SnapshotData).PreferenceCount;
+	const FPreferenceRecord* Records = GetPreferences(SnapshotData);
+	const uint8* Strings = GetStrings(SnapshotData);
+
+	FTCHARToUTF8 Utf8(*Key, Key.Len());
+	const uint8* KeyBytes = reinterpret_cast<const uint8*>(Utf8.Get());
+	const uint32 KeyLength = (uint32)Utf8.Length();
+
+	// Lower bound over the sorted records
+	uint32 Low = 0;
+	uint32 High = Count;
+	while (Low < High)
+	{
+		const uint32 Mid = Low + (High - Low) / 2;
+		if (CompareBytes(Strings + Records[Mid].KeyOffset, Records[Mid].KeyLength, KeyBytes, KeyLength) < 0)
+		{
+			Low = Mid + 1;
+		}
+		else
+		{
+			High = Mid;
+		}
+	}
+
+	if (Low == Count || CompareBytes(Strings + Records[Low].KeyOffset, Records[Low].KeyLength, KeyBytes, KeyLength) != 0)
+	{
+		return false;
+	}
+
+	OutValue = ToString(Strings + Records[Low].ValueOffset, Records[Low].ValueLength);
+	return true;
+}
+
+// ========================================
+// READS AND WRITES
+// ========================================
+
+bool FAICompanionMemoryStore::GetPreference(const FString& Key, FString& OutValue) const
+{
+	if (const FString* Value = Overlay.Preferences.Find(Key))
+	{
+		OutValue = *Value;
+		return true;
+	}
+	if (const FString* Value = Frozen.Preferences.Find(Key))
+	{
+		OutValue = *Value;
+		return true;
+	}
+	return FindSnapshotPreference(Key, OutValue);
+}
+
+void FAICompanionMemoryStore::SetPreference(const FString& Key, const FString& Value)
+{
+	if (!bOpen)
+	{
+		return;
+	}
+
+	// Rewriting an unchanged value would only grow the log
+	FString Existing;
+	if (GetPreference(Key, Existing) && Existing.Equals(Value, ESearchCase::CaseSensitive))
+	{
+		return;
+	}
+
+	Overlay.Preferences.Add(Key, Value);
+
+	TArray<uint8> Record;
+	Record.AddZeroed(RecordHeaderSize);
+	Record.Add(Record_Preference);
+	WriteStr(Record, Key);
+	WriteStr(Record, Value);
+	AppendRecord(MoveTemp(Record));
+}
+
+void FAICompanionMemoryStore::AppendTurn(ERole Role, FStringView Text)
+{
+	if (!bOpen || Text.IsEmpty())
+	{
+		return;
+	}
+
+	Overlay.Turns.Add({ Role, FString(Text) });
+
+	// A compaction only keeps MaxTurns anyway; trim in bulk so this stays amortised O(1)
+	if (Overlay.Turns.Num() > FMath::Max(MaxTurns, 1) * 2)
+	{
+		Overlay.Turns.RemoveAt(0, Overlay.Turns.Num() - MaxTurns, EAllowShrinking::No);
+	}
+
+	TArray<uint8> Record;
+	Record.AddZeroed(RecordHeaderSize);
+	Record.Add(Record_Turn);
+	Record.Add((uint8)Role);
+	WriteStr(Record, Text);
+	AppendRecord(MoveTemp(Record));
+}
+
+void FAICompanionMemoryStore::ClearTurns()
+{
+	if (!bOpen)
+	{
+		return;
+	}
+
+	// The snapshot (and a compaction's frozen turns) stay on disk; the marker hides them
+	Overlay.Turns.Reset();
+	Overlay.bClearsTurns = true;
+
+	TArray<uint8> Record;
+	Record.AddZeroed(RecordHeaderSize);
+	Record.Add(Record_ClearTurns);
+	AppendRecord(MoveTemp(Record));
+}
+
+void FAICompanionMemoryStore::AppendRecord(TArray<uint8>&& Record)
+{
+	const uint32 PayloadLength = (uint32)(Record.Num() - RecordHeaderSize);
+	const uint32 Crc = FCrc::MemCrc32(Record.GetData() + RecordHeaderSize, PayloadLength);
+	FMemory::Memcpy(Record.GetData(), &PayloadLength, sizeof(uint32));
+	FMemory::Memcpy(Record.GetData() + sizeof(uint32), &Crc, sizeof(uint32));
+
+	LogBytes += Record.Num();
+
+	Pipe.Launch(TEXT("AICompanionMemoryAppend"), [this, Record = MoveTemp(Record)]()
+	{
+		if (LogHandle)
+		{
+			LogHandle->Write(Record.GetData(), Record.Num());
+			LogHandle->Flush();
+		}
+	});
+}
+
+int64 FAICompanionMemoryStore::ReplayLog(const TArray<uint8>& Bytes)
+{
+	int64 Pos = 0;
+	while (Pos + RecordHeaderSize <= Bytes.Num())
+	{
+		uint32 PayloadLength = 0;
+		uint32 Crc = 0;
+		FMemory::Memcpy(&PayloadLength, Bytes.GetData() + Pos, sizeof(uint32));
+		FMemory::Memcpy(&Crc, Bytes.GetData() + Pos + sizeof(uint32), sizeof(uint32));
+
+		const uint8* Payload = Bytes.GetData() + Pos + RecordHeaderSize;
+		if (Pos + RecordHeaderSize + PayloadLength > Bytes.Num() || FCrc::MemCrc32(Payload, PayloadLength) != Crc)
+		{
+			break;
+		}
+
+		FReader Reader{ Payload, PayloadLength };
+		uint8 Kind = 0;
+		Reader.ReadU8(Kind);
+
+		if (Kind == Record_Preference)
+		{
+			FString Key;
+			FString Value;
+			if (Reader.ReadStr(Key) && Reader.ReadStr(Value))
+			{
+				Overlay.Preferences.Add(MoveTemp(Key), MoveTemp(Value));
+			}
+		}
+		else if (Kind == Record_Turn)
+		{
+			uint8 Role = 0;
+			FTurn Turn;
+			if (Reader.ReadU8(Role) && Role <= (uint8)ERole::Assistant && Reader.ReadStr(Turn.Text))
+			{
+				Turn.Role = (ERole)Role;
+				Overlay.Turns.Add(MoveTemp(Turn));
+			}
+		}
+		else if (Kind == Record_ClearTurns)
+		{
+			Overlay.Turns.Reset();
+			Overlay.bClearsTurns = true;
+		}
+
+		Pos += RecordHeaderSize + PayloadLength;
+	}
+	return Pos;
+}
+
+void FAICompanionMemoryStore::ForEachTurn(TFunctionRef<void(ERole, FStringView)> Visitor) const
+{
+	if (SnapshotData && !Frozen.bClearsTurns && !Overlay.bClearsTurns)
+	{
+		const uint32 Count = GetHeader(SnapshotData).TurnCount;
+		const FTurnRecord* Records = GetTurns(SnapshotData);
+		const uint8* Strings = GetStrings(SnapshotData);
+		for (uint32 Index = 0; Index < Count; ++Index)
+		{
+			FUTF8ToTCHAR Text(reinterpret_cast<const ANSICHAR*>(Strings + Records[Index].TextOffset), Records[Index].TextLength);
+			Visitor((ERole)Records[Index].Role, FStringView(Text.Get(), Text.Length()));
+		}
+	}
+
+	if (!Overlay.bClearsTurns)
+	{
+		for (const FTurn& Turn : Frozen.Turns)
+		{
+			Visitor(Turn.Role, Turn.Text);
+		}
+	}
+	for (const FTurn& Turn : Overlay.Turns)
+	{
+		Visitor(Turn.Role, Turn.Text);
+	}
+}
+
+// ========================================
+// COMPACTION
+// ========================================
+
+void FAICompanionMemoryStore::Tick()
+{
+	if (!bOpen)
+	{
+		return;
+	}
+
+	if (bCompacting)
+	{
+		if (CompactionTask.IsCompleted())
+		{
+			FinishCompaction();
+		}
+		return;
+	}
+
+	if (LogBytes >= CompactLogBytes + CompactionBackoffBytes)
+	{
+		Compact();
+	}
+}
+
+void FAICompanionMemoryStore::Compact()
+{
+	if (!bOpen || bCompacting)
+	{
+		return;
+	}
+
+	// Freeze what the new snapshot will contain; later changes land in a fresh overlay (and the new log)
+	Frozen = MoveTemp(Overlay);
+	Overlay.Reset();
+	LogBytesAtCompaction = LogBytes;
+	bCompacting = true;
+
+	const int32 NewGeneration = Generation + 1;
+	CompactionTask = Pipe.Launch(TEXT("AICompanionMemoryCompact"), [this, NewGeneration]()
+	{
+		return WriteCompactedSnapshot(NewGeneration);
+	});
+}
+
+bool FAICompanionMemoryStore::WriteCompactedSnapshot(int32 NewGen)
+{
+	// The game thread leaves the mapped snapshot and Frozen alone until this task completes
+	TArray<FPreferenceRecord> Preferences;
+	TArray<FTurnRecord> Turns;
+	TArray<uint8> Strings;
+
+	auto AddString = [&Strings](const uint8* Data, uint32 Length)
+	{
+		const uint32 Offset = (uint32)Strings.Num();
+		Strings.Append(Data, Length);
+		return Offset;
+	};
+
+	// Frozen preferences in the snapshot's byte order, so the two sorted lists can be merged
+	struct FPendingPreference
+	{
+		FTCHARToUTF8 Key;
+		FTCHARToUTF8 Value;
+
+		FPendingPreference(const FString& InKey, const FString& InValue)
+			: Key(*InKey, InKey.Len())
+			, Value(*InValue, InValue.Len())
+		{
+		}
+
+		const uint8* KeyBytes() const { return reinterpret_cast<const uint8*>(Key.Get()); }
+		const uint8* ValueBytes() const { return reinterpret_cast<const uint8*>(Value.Get()); }
+	};
+
+	TArray<TUniquePtr<FPendingPreference>> Pending;
+	Pending.Reserve(Frozen.Preferences.Num());
+	for (const TPair<FString, FString>& Pair : Frozen.Preferences)
+	{
+		Pending.Add(MakeUnique<FPendingPreference>(Pair.Key, Pair.Value));
+	}
+	Pending.Sort([](const TUniquePtr<FPendingPreference>& A, const TUniquePtr<FPendingPreference>& B)
+	{
+		return CompareBytes(A->KeyBytes(), A->Key.Length(), B->KeyBytes(), B->Key.Length()) < 0;
+	});
+
+	const uint32 OldCount = SnapshotData ? GetHeader(SnapshotData).PreferenceCount : 0;
+	const FPreferenceRecord* OldRecords = SnapshotData ? GetPreferences(SnapshotData) : nullptr;
+	const uint8* OldStrings = SnapshotData ? GetStrings(SnapshotData) : nullptr;
+
+	uint32 OldIndex = 0;
+	int32 PendingIndex = 0;
+	while (OldIndex < OldCount || PendingIndex < Pending.Num())
+	{
+		int32 Order = 0;
+		if (OldIndex == OldCount)
+		{
+			Order = 1;
+		}
+		else if (PendingIndex == Pending.Num())
+		{
+			Order = -1;
+		}
+		else
+		{
+			const FPendingPreference& Next = *Pending[PendingIndex];
+			Order = CompareBytes(OldStrings + OldRecords[OldIndex].KeyOffset, OldRecords[OldIndex].KeyLength, Next.KeyBytes(), Next.Key.Length());
+		}
+
+		FPreferenceRecord& Record = Preferences.AddDefaulted_GetRef();
+		if (Order < 0)
+		{
+			const FPreferenceRecord& Old = OldRecords[OldIndex++];
+			Record.KeyOffset = AddString(OldStrings + Old.KeyOffset, Old.KeyLength);
+			Record.KeyLength = Old.KeyLength;
+			Record.ValueOffset = AddString(OldStrings + Old.ValueOffset, Old.ValueLength);
+			Record.ValueLength = Old.ValueLength;
+		}
+		else
+		{
+			// Newer value wins a tie
+			OldIndex += Order == 0 ? 1 : 0;
+			const FPendingPreference& Next = *Pending[PendingIndex++];
+			Record.KeyOffset = AddString(Next.KeyBytes(), Next.Key.Length());
+			Record.KeyLength = Next.Key.Length();
+			Record.ValueOffset = AddString(Next.ValueBytes(), Next.Value.Length());
+			Record.ValueLength = Next.Value.Length();
+		}
+	}
+
+	// Newest MaxTurns turns across the old snapshot and Frozen; a clear in Frozen drops the snapshot's
+	const uint32 OldTurnCount = SnapshotData && !Frozen.bClearsTurns ? GetHeader(SnapshotData).TurnCount : 0;
+	const FTurnRecord* OldTurns = SnapshotData ? GetTurns(SnapshotData) : nullptr;
+	const int32 TotalTurns = (int32)OldTurnCount + Frozen.Turns.Num();
+	const int32 SkipTurns = FMath::Max(TotalTurns - MaxTurns, 0);
+
+	for (int32 Index = SkipTurns; Index < TotalTurns; ++Index)
+	{
+		FTurnRecord& Record = Turns.AddDefaulted_GetRef();
+		if (Index < (int32)OldTurnCount)
+		{
+			const FTurnRecord& Old = OldTurns[Index];
+			Record.TextOffset = AddString(OldStrings + Old.TextOffset, Old.TextLength);
+			Record.TextLength = Old.TextLength;
+			Record.Role = Old.Role;
+		}
+		else
+		{
+			const FTurn& Turn = Frozen.Turns[Index - (int32)OldTurnCount];
+			FTCHARToUTF8 Utf8(*Turn.Text, Turn.Text.Len());
+			Record.TextOffset = AddString(reinterpret_cast<const uint8*>(Utf8.Get()), Utf8.Length());
+			Record.TextLength = Utf8.Length();
+			Record.Role = (uint32)Turn.Role;
+		}
+	}
+
+	FHeader Header;
+	Header.Magic = Magic;
+	Header.Version = Version;
+	Header.PreferenceCount = Preferences.Num();
+	Header.TurnCount = Turns.Num();
+	Header.StringsOffset = sizeof(FHeader) + Preferences.Num() * sizeof(FPreferenceRecord) + Turns.Num() * sizeof(FTurnRecord);
+	Header.StringsSize = Strings.Num();
+
+	TArray<uint8> Snapshot;
+	Snapshot.Reserve(Header.StringsOffset + Header.StringsSize);
+	Snapshot.Append(reinterpret_cast<const uint8*>(&Header), sizeof(Header));
+	Snapshot.Append(reinterpret_cast<const uint8*>(Preferences.GetData()), Preferences.Num() * sizeof(FPreferenceRecord));
+	Snapshot.Append(reinterpret_cast<const uint8*>(Turns.GetData()), Turns.Num() * sizeof(FTurnRecord));
+	Snapshot.Append(Strings);
+
+	// Write-then-rename, so a crash leaves either the old generation or the complete new one
+	const FString FinalPath = GetSnapshotPath(NewGen);
+	const FString TempPath = FinalPath + TEXT(".tmp");
+	if (!FFileHelper::SaveArrayToFile(Snapshot, *TempPath) || !IFileManager::Get().Move(*FinalPath, *TempPath, true, true))
+	{
+		UE_LOG(LogAICompanion, Warning, TEXT("[AICompanionMemoryStore] Could not write %s"), *FinalPath);
+		IFileManager::Get().Delete(*TempPath, false, false, true);
+		return false;
+	}
+
+	// Appends queued after this task belong to the new generation
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	LogHandle.Reset(PlatformFile.OpenWrite(*GetLogPath(NewGen), false, false));
+	return true;
+}
+
+void FAICompanionMemoryStore::FinishCompaction()
+{
+	bCompacting = false;
+
+	if (!CompactionTask.GetResult())
+	{
+		// Old snapshot and log are untouched; keep serving the frozen changes and retry later
+		RestoreFrozen();
+		CompactionBackoffBytes = LogBytes;
+		return;
+	}
+
+	const int32 OldGeneration = Generation;
+	const int32 NewGeneration = OldGeneration + 1;
+	if (!MapSnapshot(NewGeneration))
+	{
+		// Still on the old snapshot. Roll the files back as well, or the next Open() would
+		// pick the unreadable generation and throw the old one away as stale.
+		UE_LOG(LogAICompanion, Warning, TEXT("[AICompanionMemoryStore] Cannot map new snapshot %s, staying on generation %d"), *GetSnapshotPath(NewGeneration), OldGeneration);
+		RestoreFrozen();
+		CompactionBackoffBytes = LogBytes;
+
+		Pipe.Launch(TEXT("AICompanionMemoryRollBack"), [this, OldLogPath = GetLogPath(OldGeneration), NewLogPath = GetLogPath(NewGeneration), NewSnapshotPath = GetSnapshotPath(NewGeneration)]()
+		{
+			// Records written since the switch go back on the end of the old log
+			LogHandle.Reset();
+			TArray<uint8> NewRecords;
+			FFileHelper::LoadFileToArray(NewRecords, *NewLogPath, FILEREAD_Silent);
+
+			IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+			LogHandle.Reset(PlatformFile.OpenWrite(*OldLogPath, true, false));
+			if (!LogHandle)
+			{
+				UE_LOG(LogAICompanion, Warning, TEXT("[AICompanionMemoryStore] Cannot reopen %s for writing"), *OldLogPath);
+				return;
+			}
+			if (NewRecords.Num() > 0)
+			{
+				LogHandle->Write(NewRecords.GetData(), NewRecords.Num());
+				LogHandle->Flush();
+			}
+
+			IFileManager::Get().Delete(*NewSnapshotPath, false, false, true);
+			IFileManager::Get().Delete(*NewLogPath, false, false, true);
+		});
+		return;
+	}
+
+	Generation = NewGeneration;
+	LogBytes -= LogBytesAtCompaction;
+	CompactionBackoffBytes = 0;
+	Frozen.Reset();
+
+	// Nothing maps the old generation any more
+	Pipe.Launch(TEXT("AICompanionMemoryDeleteGeneration"), [SnapshotPath = GetSnapshotPath(OldGeneration), LogPath = GetLogPath(OldGeneration)]()
+	{
+		IFileManager::Get().Delete(*SnapshotPath, false, false, true);
+		IFileManager::Get().Delete(*LogPath, false, false, true);
+	});
+
+	UE_LOG(LogAICompanion, Verbose, TEXT("[AICompanionMemoryStore] Compacted %s into generation %d"), *Name, Generation);
+}
+
+void FAICompanionMemoryStore::RestoreFrozen()
+{
+	// Newer overlay entries win
+	for (TPair<FString, FString>& Pair : Frozen.Preferences)
+	{
+		if (!Overlay.Preferences.Contains(Pair.Key))
+		{
+			Overlay.Preferences.Add(MoveTemp(Pair.Key), MoveTemp(Pair.Value));
+		}
+	}
+	if (!Overlay.bClearsTurns)
+	{
+		Overlay.Turns.Insert(MoveTemp(Frozen.Turns), 0);
+	}
+	Overlay.bClearsTurns |= Frozen.bClearsTurns;
+	Frozen.Reset();
+}
@@ -0,0 +1,150 @@
+// AICompanionMemoryStore.h
+// Persistent preferences and conversation turns
+//
+// On disk a store is a snapshot plus an append-only log, both tagged with a
+// generation number (<Name>-<Gen>.snap / <Name>-<Gen>.log). The snapshot is laid
+// out to be read in place, so Open() maps it instead of parsing it and
+// preferences are found by binary search over its sorted records. Changes are
+// appended to the log on a background pipe and served from an in-memory overlay
+// until a compaction folds everything into generation Gen + 1.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Tasks/Pipe.h"
+#include "AICompanionConversation.h"
+
+class IFileHandle;
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+class FAICompanionMemoryStore
+{
+public:
+	using ERole = FAICompanionConversationHistory::ERole;
+
+	FAICompanionMemoryStore();
+	~FAICompanionMemoryStore();
+
+	/**
+	 * Map the newest snapshot in Directory and replay the log written since.
+	 * MaxTurns is how many conversation turns a compaction keeps.
+	 */
+	bool Open(const FString& Directory, const FString& Name, int32 MaxTurns);
+
+	/** Wait for pending writes and release the files */
+	void Close();
+
+	bool IsOpen() const { return bOpen; }
+
+	void SetPreference(const FString& Key, const FString& Value);
+	bool GetPreference(const FString& Key, FString& OutValue) const;
+
+	void AppendTurn(ERole Role, FStringView Text);
+
+	/** Forget every persisted turn; logged as a marker that hides older turns until compaction drops them */
+	void ClearTurns();
+
+	/** Persisted turns, oldest first */
+	void ForEachTurn(TFunctionRef<void(ERole, FStringView)> Visitor) const;
+
+	/**
+	 * Starts a compaction once the log has grown past CompactLogBytes, and maps the
+	 * new snapshot when one finishes. Game thread; cheap when there is nothing to do.
+	 */
+	void Tick();
+
+	/** Fold the log into a new snapshot in the background (no-op while one is running) */
+	void Compact();
+
+	/** A compaction is running; Tick() has to keep being called until it is picked up */
+	bool IsCompacting() const { return bCompacting; }
+
+	int64 GetLogBytes() const { return LogBytes; }
+	int32 GetGeneration() const { return Generation; }
+
+	/** Log size that triggers a compaction from Tick() */
+	int64 CompactLogBytes = 256 * 1024;
+
+private:
+	struct FTurn
+	{
+		ERole Role = ERole::User;
+		FString Text;
+	};
+
+	/** Changes not yet in the mapped snapshot */
+	struct FOverlay
+	{
+		TMap<FString, FString> Preferences;
+		TArray<FTurn> Turns;
+
+		/** Turns were cleared since the layer below; only Turns above survive */
+		bool bClearsTurns = false;
+
+		void Reset()
+		{
+			Preferences.Reset();
+			Turns.Reset();
+			bClearsTurns = false;
+		}
+	};
+
+	FString GetSnapshotPath(int32 Gen) const;
+	FString GetLogPath(int32 Gen) const;
+
+	/** Map and validate generation Gen's snapshot; on failure the current one stays mapped */
+	bool MapSnapshot(int32 Gen);
+	void UnmapSnapshot();
+
+	bool FindSnapshotPreference(const FString& Key, FString& OutValue) const;
+
+	/** Apply every intact log record to Overlay; returns the length of the intact prefix */
+	int64 ReplayLog(const TArray<uint8>& Bytes);
+
+	/** Record is a payload behind an 8-byte frame header left zeroed; fills the header and queues the write */
+	void AppendRecord(TArray<uint8>&& Record);
+
+	void FinishCompaction();
+	void RestoreFrozen();
+
+	/** Runs on the pipe: merge snapshot + Frozen into generation NewGen and switch the log over to it */
+	bool WriteCompactedSnapshot(int32 NewGen);
+
+	FString Directory;
+	FString Name;
+	int32 MaxTurns = 64;
+	bool bOpen = false;
+
+	/** Generation of the mapped snapshot (0 = none yet) */
+	int32 Generation = 0;
+
+	TUniquePtr<IMappedFileHandle> MappedFile;
+	TUniquePtr<IMappedFileRegion> MappedRegion;
+
+	/** Used instead of a mapping on platforms that cannot map files */
+	TArray<uint8> SnapshotCopy;
+
+	/** Validated snapshot bytes (mapped or copied), or null */
+	const uint8* SnapshotData = nullptr;
+	int64 SnapshotSize = 0;
+
+	/** Newest changes; lookups check this first */
+	FOverlay Overlay;
+
+	/** Changes being folded into the next snapshot; read-only while bCompacting */
+	FOverlay Frozen;
+
+	/** Only touched on the pipe */
+	TUniquePtr<IFileHandle> LogHandle;
+
+	UE::Tasks::FPipe Pipe;
+	UE::Tasks::TTask<bool> CompactionTask;
+	bool bCompacting = false;
+
+	int64 LogBytes = 0;
+	int64 LogBytesAtCompaction = 0;
+
+	/** Raised after a failed compaction so it is not retried every frame */
+	int64 CompactionBackoffBytes = 0;
+};
@@ -0,0 +1,322 @@
+// AICompanionParserTestCommandlet.cpp
+// Parser cases and the checker that runs them
+
+#include "AICompanionParserTestCommandlet.h"
+#include "AICompanionLog.h"
+#include "AICompanionDateTimeParser.h"
+#include "AICompanionCalendarSlots.h"
+#include "AICompanionIntentClassifier.h"
+
+namespace
+{
+	using EWordClass = FAICompanionDateTimeParser::EWordClass;
+	using ESlot = FAICompanionCalendarSlots::ESlot;
+
+	/** UAICompanionManager's default LocalIntentConfidence: the common requests must clear it */
+	constexpr float LocalIntentConfidence = 0.75f;
+
+	/** Wednesday, so weekday cases cover both "later this week" and "next week" */
+	const FDateTime Now(2026, 10, 14, 10, 0, 0);
+
+	/** Sentinel for cases that must not parse */
+	const FDateTime NoDate(0);
+
+	FString Describe(const FDateTime& When)
+	{
+		return When == NoDate ? FString(TEXT("(none)")) : When.ToString(TEXT("%Y-%m-%d %H:%M"));
+	}
+
+	const TCHAR* Describe(EWordClass Class)
+	{
+		switch (Class)
+		{
+		case EWordClass::Number: return TEXT("Number");
+		case EWordClass::NumberSuffix: return TEXT("NumberSuffix");
+		case EWordClass::Unit: return TEXT("Unit");
+		case EWordClass::DateTime: return TEXT("DateTime");
+		case EWordClass::ContextualDate: return TEXT("ContextualDate");
+		default: return TEXT("Other");
+		}
+	}
+
+	class FParserChecker
+	{
+	public:
+		explicit FParserChecker(const FString& InFilter)
+			: Filter(InFilter)
+		{
+		}
+
+		/** False if the group is filtered out */
+		bool Begin(const TCHAR* InGroup)
+		{
+			Group = InGroup;
+			return Filter.IsEmpty() || Group.Contains(Filter);
+		}
+
+		void Check(bool bPassed, const TCHAR* Input, const FString& Expected, const FString& Actual)
+		{
+			++NumRun;
+			if (!bPassed)
+			{
+				++NumFailed;
+				UE_LOG(LogAICompanion, Error, TEXT("[ParserTest] %s \"%s\": expected %s, got %s"), *Group, Input, *Expected, *Actual);
+			}
+		}
+
+		int32 GetNumRun() const { return NumRun; }
+		int32 GetNumFailed() const { return NumFailed; }
+
+	private:
+		FString Filter;
+		FString Group;
+		int32 NumRun = 0;
+		int32 NumFailed = 0;
+	};
+
+	void RunDateTime(FParserChecker& Checker)
+	{
+		if (!Checker.Begin(TEXT("DateTime")))
+		{
+			return;
+		}
+
+		struct FCase
+		{
+			const TCHAR* Input;
+			FDateTime Expected;
+		};
+
+		static const FCase Cases[] =
+		{
+			{ TEXT("tomorrow at 3pm"), FDateTime(2026, 10, 15, 15, 0, 0) },
+			{ TEXT("next friday"), FDateTime(2026, 10, 16, 12, 0, 0) },
+			{ TEXT("november 5 at 2:30 pm"), FDateTime(2026, 11, 5, 14, 30, 0) },
+			{ TEXT("11/5"), FDateTime(2026, 11, 5, 12, 0, 0) },
+			{ TEXT("in an hour"), FDateTime(2026, 10, 14, 11, 0, 0) },
+			{ TEXT("a week from now"), FDateTime(2026, 10, 21, 10, 0, 0) },
+			{ TEXT("tonight"), FDateTime(2026, 10, 14, 20, 0, 0) },
+			{ TEXT("at noon"), FDateTime(2026, 10, 14, 12, 0, 0) },
+			{ TEXT("9am"), FDateTime(2026, 10, 15, 9, 0, 0) },
+			{ TEXT("day after tomorrow"), FDateTime(2026, 10, 16, 12, 0, 0) },
+
+			// Short forms that are also words, in the context that makes them dates
+			{ TEXT("may 5"), FDateTime(2027, 5, 5, 12, 0, 0) },
+			{ TEXT("the 5th of may"), FDateTime(2027, 5, 5, 12, 0, 0) },
+			{ TEXT("next sat"), FDateTime(2026, 10, 17, 12, 0, 0) },
+			{ TEXT("on sun at 9"), FDateTime(2026, 10, 18, 9, 0, 0) },
+
+			// ... and out of it
+			{ TEXT("I may be late"), NoDate },
+			{ TEXT("we sat down"), NoDate },
+			{ TEXT("the sun is out"), NoDate },
+			{ TEXT("have a day off"), NoDate },
+			{ TEXT("do I have enough gold"), NoDate },
+		};
+
+		for (const FCase& Case : Cases)
+		{
+			FDateTime Actual = NoDate;
+			if (!FAICompanionDateTimeParser::ParseDateTime(Case.Input, Now, Actual))
+			{
+				Actual = NoDate;
+			}
+			Checker.Check(Actual == Case.Expected, Case.Input, Describe(Case.Expected), Describe(Actual));
+		}
+
+		// A day alone and a day at noon land on the same time; only one of them names a time
+		static const TPair<const TCHAR*, bool> TimeCases[] =
+		{
+			{ TEXT("tomorrow"), false },
+			{ TEXT("next friday"), false },
+			{ TEXT("tomorrow at noon"), true },
+			{ TEXT("friday at 12"), true },
+			{ TEXT("tonight"), true },
+			{ TEXT("in an hour"), true },
+		};
+
+		for (const TPair<const TCHAR*, bool>& Case : TimeCases)
+		{
+			FDateTime When;
+			bool bHasTime = false;
+			const bool bParsed = FAICompanionDateTimeParser::ParseDateTime(Case.Key, Now, When, bHasTime);
+			Checker.Check(bParsed && bHasTime == Case.Value, Case.Key, Case.Value ? TEXT("a time") : TEXT("a day only"),
+				!bParsed ? TEXT("(none)") : bHasTime ? TEXT("a time") : TEXT("a day only"));
+		}
+	}
+
+	void RunDuration(FParserChecker& Checker)
+	{
+		if (!Checker.Begin(TEXT("Duration")))
+		{
+			return;
+		}
+
+		struct FCase
+		{
+			const TCHAR* Input;
+			int32 Expected;
+		};
+
+		static const FCase Cases[] =
+		{
+			{ TEXT("1 hour"), 60 },
+			{ TEXT("90 min"), 90 },
+			{ TEXT("1.5 hours"), 90 },
+			{ TEXT("an hour and a half"), 90 },
+			{ TEXT("half an hour"), 30 },
+			{ TEXT("1h30"), 90 },
+			{ TEXT("45"), 45 },
+			{ TEXT("no idea"), 0 },
+		};
+
+		for (const FCase& Case : Cases)
+		{
+			const int32 Actual = FAICompanionDateTimeParser::ParseDurationMinutes(Case.Input);
+			Checker.Check(Actual == Case.Expected, Case.Input, FString::FromInt(Case.Expected), FString::FromInt(Actual));
+		}
+	}
+
+	void RunWordClass(FParserChecker& Checker)
+	{
+		if (!Checker.Begin(TEXT("WordClass")))
+		{
+			return;
+		}
+
+		struct FCase
+		{
+			const TCHAR* Input;
+			EWordClass Expected;
+		};
+
+		static const FCase Cases[] =
+		{
+			{ TEXT("3"), EWordClass::Number },
+			{ TEXT("pm"), EWordClass::NumberSuffix },
+			{ TEXT("90min"), EWordClass::Unit },
+			{ TEXT("friday"), EWordClass::DateTime },
+			{ TEXT("2pm"), EWordClass::DateTime },
+			{ TEXT("may"), EWordClass::ContextualDate },
+			{ TEXT("sat"), EWordClass::ContextualDate },
+			{ TEXT("h"), EWordClass::Other },
+			{ TEXT("in"), EWordClass::Other },
+			{ TEXT("dentist"), EWordClass::Other },
+		};
+
+		for (const FCase& Case : Cases)
+		{
+			const EWordClass Actual = FAICompanionDateTimeParser::ClassifyWord(Case.Input);
+			Checker.Check(Actual == Case.Expected, Case.Input, Describe(Case.Expected), Describe(Actual));
+		}
+	}
+
+	void RunIntent(FParserChecker& Checker)
+	{
+		if (!Checker.Begin(TEXT("Intent")))
+		{
+			return;
+		}
+
+		struct FCase
+		{
+			const TCHAR* Input;
+			EAICompanionIntent Expected;
+
+			/** Confidence must reach LocalIntentConfidence, or stay below it */
+			bool bLocal;
+		};
+
+		static const FCase Cases[] =
+		{
+			{ TEXT("add to my calendar lunch friday"), EAICompanionIntent::CreateEvent, true },
+			{ TEXT("put on my calendar dentist monday"), EAICompanionIntent::CreateEvent, true },
+			{ TEXT("schedule a meeting tomorrow at 3pm"), EAICompanionIntent::CreateEvent, true },
+			{ TEXT("what's on my calendar today"), EAICompanionIntent::QueryCalendar, true },
+			{ TEXT("what's on my schedule"), EAICompanionIntent::QueryCalendar, true },
+			{ TEXT("am I free at noon"), EAICompanionIntent::QueryCalendar, true },
+			{ TEXT("set a reminder for 6pm"), EAICompanionIntent::SetReminder, true },
+			{ TEXT("never mind"), EAICompanionIntent::Cancel, true },
+
+			// Two intents in different words: left to the backend
+			{ TEXT("remind me to cancel my gym"), EAICompanionIntent::SetReminder, false },
+
+			{ TEXT("what's the schedule for the concert"), EAICompanionIntent::None, false },
+			{ TEXT("book a table"), EAICompanionIntent::None, false },
+			{ TEXT("don't schedule anything"), EAICompanionIntent::None, false },
+			{ TEXT("do I have enough gold"), EAICompanionIntent::None, false },
+		};
+
+		for (const FCase& Case : Cases)
+		{
+			const FAICompanionIntentClassifier::FResult Result = FAICompanionIntentClassifier::Classify(Case.Input);
+			const bool bLocal = Result.Confidence >= LocalIntentConfidence;
+
+			const FString Expected = FString::Printf(TEXT("%s (%s)"), *UEnum::GetValueAsString(Case.Expected), Case.bLocal ? TEXT("local") : TEXT("backend"));
+			const FString Actual = FString::Printf(TEXT("%s (%.2f)"), *UEnum::GetValueAsString(Result.Intent), Result.Confidence);
+			Checker.Check(Result.Intent == Case.Expected && bLocal == Case.bLocal, Case.Input, Expected, Actual);
+		}
+	}
+
+	void RunCalendarSlots(FParserChecker& Checker)
+	{
+		if (!Checker.Begin(TEXT("CalendarSlots")))
+		{
+			return;
+		}
+
+		struct FCase
+		{
+			const TCHAR* Input;
+			const TCHAR* EventName;
+			FDateTime When;
+			const TCHAR* Notes;
+			int32 DurationMinutes = 0;
+		};
+
+		static const FCase Cases[] =
+		{
+			{ TEXT("schedule lunch with Sam tomorrow at noon"), TEXT("Lunch"), FDateTime(2026, 10, 15, 12, 0, 0), TEXT("Sam") },
+			{ TEXT("book a table for dinner on friday at 7:30 pm with Sam"), TEXT("Table"), FDateTime(2026, 10, 16, 19, 30, 0), TEXT("dinner; Sam") },
+			{ TEXT("meeting with Jan tomorrow"), TEXT("Meeting"), FDateTime(2026, 10, 15, 12, 0, 0), TEXT("Jan") },
+			{ TEXT("lunch for 2 hours tomorrow"), TEXT("Lunch"), FDateTime(2026, 10, 15, 12, 0, 0), TEXT(""), 120 },
+			{ TEXT("review for an hour and a half on friday at 3pm"), TEXT("Review"), FDateTime(2026, 10, 16, 15, 0, 0), TEXT(""), 90 },
+		};
+
+		for (const FCase& Case : Cases)
+		{
+			const FAICompanionCalendarSlots Slots = FAICompanionCalendarSlots::Extract(Case.Input, Now);
+			const FDateTime When = Slots.Has(ESlot::DateTime) ? Slots.EventDateTime : NoDate;
+
+			const int32 Duration = Slots.Has(ESlot::Duration) ? Slots.DurationMinutes : 0;
+
+			const FString Expected = FString::Printf(TEXT("[%s] %s [%s] %d min"), Case.EventName, *Describe(Case.When), Case.Notes, Case.DurationMinutes);
+			const FString Actual = FString::Printf(TEXT("[%s] %s [%s] %d min"), *Slots.EventName, *Describe(When), *Slots.Notes, Duration);
+			Checker.Check(Expected.Equals(Actual, ESearchCase::CaseSensitive), Case.Input, Expected, Actual);
+		}
+	}
+}
+
+UAICompanionParserTestCommandlet::UAICompanionParserTestCommandlet()
+{
+	IsClient = false;
+	IsEditor = false;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UAICompanionParserTestCommandlet::Main(const FString& Params)
+{
+	FString Filter;
+	FParse::Value(*Params, TEXT("filter="), Filter);
+
+	FParserChecker Checker(Filter);
+	RunDateTime(Checker);
+	RunDuration(Checker);
+	RunWordClass(Checker);
+	RunIntent(Checker);
+	RunCalendarSlots(Checker);
+
+	UE_LOG(LogAICompanion, Display, TEXT("[ParserTest] %d of %d cases passed"), Checker.GetNumRun() - Checker.GetNumFailed(), Checker.GetNumRun());
+	return Checker.GetNumFailed() == 0 ? 0 : 1;
+}
@@ -0,0 +1,27 @@
+// AICompanionParserTestCommandlet.h
+// Self-test of the calendar text parsers, for CI
+//
+//   UnrealEditor-Cmd <Project> -run=AICompanionParserTest [-filter=DateTime]
+//
+// Runs fixed cases through FAICompanionDateTimeParser (dates, durations, word
+// classes), FAICompanionIntentClassifier and FAICompanionCalendarSlots against a
+// pinned "now", including the sentences that must not parse ("I may be late",
+// "we sat down"). Every failing case is logged with what came back; returns
+// non-zero if any failed.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "AICompanionParserTestCommandlet.generated.h"
+
+UCLASS()
+class JOEVISV3V1_API UAICompanionParserTestCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UAICompanionParserTestCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,1104 @@
+// AICompanionProtocol.cpp
+// Encoding and decoding of backend frames
+//
+// bin1 frame layout (mirrored in wire-protocol.js - keep the tables in sync):
+//
+//   Frame := 0xAC Version(0x01) Flags(u8) TypeId(u8) [Str TypeName if TypeId == 0] Field* 0xFF
+//   Field := KeyId(u8) [Str KeyName if KeyId == 0] Tag(u8) Value
+//   Tag   := 0 null | 1 false | 2 true | 3 int (zigzag varint) | 4 string (Str)
+//            5 bytes (varint length + raw) | 6 json (Str holding JSON text) | 7 double (8 bytes LE)
+//   Str   := varint byte length + UTF-8
+//
+// Flags bit1 marks a batch frame, which carries whole frames instead of fields:
+//
+//   Batch := 0xAC Version(0x01) Flags(0x02) Count(varint) (varint length + Frame)*
+//
+// Batches are only sent client -> server, once the backend has advertised them.
+//
+// Flags bit0 marks a compressed frame. Everything after Flags is raw deflate primed
+// with the shared Dictionary below, preceded by its inflated length:
+//
+//   Compressed := 0xAC Version(0x01) Flags(bit0 set) RawLength(varint) Deflate
+//
+// Inflating gives back the bytes that followed Flags. Offered with "compression":
+// "zdict2" at registration; the backend then compresses its larger frames, and they
+// are inflated on the decode task with the rest of the frame.
+// Other flag bits are reserved (must be 0).
+
+#include "AICompanionProtocol.h"
+#include "AICompanionLog.h"
+#include "Misc/Base64.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+
+THIRD_PARTY_INCLUDES_START
+#include "zlib.h"
+THIRD_PARTY_INCLUDES_END
+
+namespace AICompanionMessageTypes
+{
+	const FName Connected(TEXT("connected"));
+	const FName Registered(TEXT("registered"));
+	const FName ChatResponse(TEXT("chat_response"));
+	const FName ChatDelta(TEXT("chat_delta"));
+	const FName VoiceProcessed(TEXT("voice_processed"));
+	const FName VoicePartial(TEXT("voice_partial"));
+	const FName Error(TEXT("error"));
+	const FName Pong(TEXT("pong"));
+	const FName Resumed(TEXT("resumed"));
+	const FName ResumeFailed(TEXT("resume_failed"));
+	const FName CalendarSync(TEXT("calendar_sync"));
+	const FName CalendarDelta(TEXT("calendar_delta"));
+}
+
+namespace AICompanionWire
+{
+	static constexpr uint8 Magic = 0xAC;
+	static constexpr uint8 Version = 1;
+	static constexpr uint8 EndOfFields = 0xFF;
+	static constexpr uint8 Flag_Batch = 0x02;
+	static constexpr uint8 Flag_Deflate = 0x01;
+
+	/** Largest frame accepted once inflated */
+	static constexpr uint64 MaxInflatedSize = 16 * 1024 * 1024;
+
+	/** Smaller frames are not worth compressing (same threshold as the backend's default) */
+	static constexpr int32 MinCompressSize = 256;
+
+	// Preset dictionary: nested event fields, type names and phrases common in replies.
+	// Byte-for-byte identical to COMPRESSION_DICTIONARY in wire-protocol.js; changing it
+	// needs a new AICOMPANION_COMPRESSION_NAME (zdict2 dropped zdict1's hard-coded year), so
+	// nothing in it may go stale: timestamps share only the century "20". Least common first,
+	// since deflate reaches the end of the dictionary most cheaply.
+	static const ANSICHAR Dictionary[] =
+		"Google Calendar" "dentist appointment" "doctor" "birthday" "deadline" "workout" "dinner"
+		"lunch with " "budget" "spending" "this month" "next week" "next month" "weekend" "Monday" "Tuesday"
+		"Wednesday" "Thursday" "Friday" "Saturday" "Sunday" "January" "February" "March" "April" "May"
+		"June" "July" "August" "September" "October" "November" "December" "\"status\":\"rescheduled\""
+		"\"status\":\"completed\"" "\"status\":\"cancelled\"" "{\"eventId\":\"evt_" "\",\"title\":\""
+		"\",\"startTime\":\"20" "\",\"endTime\":\"20" "\",\"location\":\"" "\",\"priority\":"
+		",\"status\":\"scheduled\"}" "\"eventName\":\"" "\"dateTime\":\"20" "\"durationMinutes\":"
+		"\"notes\":\"" "\"description\":\"" "\"reminders\":[\"24h\",\"1h\"]" "\"playerId\":\""
+		"\"requestId\":" "\"timestamp\":\"20" "\"message\":\"" "\"type\":\"" "\"text\":\""
+		"calendar_event_created" "calendar_delta" "calendar_sync" "chat_response" "chat_delta"
+		"voice_processed" "T00:00:00.000Z" ":00.000Z" "Is there anything else "
+		"Let me know if you " "Would you like me to " "I can help you with that" "Here is what I found"
+		"Here are " "Sure! " "Of course" "Great question" "I would be happy to help" "a reminder"
+		"your calendar" "your schedule" "scheduled for " "appointment" "meeting with " "reminder "
+		" tomorrow" " today" " tonight" " at " " p.m." " a.m." " PM" " AM" " minutes" " hours" " hour"
+		"It looks like " "I think " "I have " "I will " "I'll " "I'm " "you're " "don't " "it's " "that's "
+		" would " " could " " should " " about " " there " " their " " which " " when " " what " " this "
+		" that " " with " " from " " have " " your " " you " " for " " and " " the " " to " " of " " in "
+		" is " " it " ". " ", ";
+
+	enum ETag : uint8
+	{
+		Tag_Null = 0,
+		Tag_False = 1,
+		Tag_True = 2,
+		Tag_Int = 3,
+		Tag_String = 4,
+		Tag_Bytes = 5,
+		Tag_Json = 6,
+		Tag_Double = 7
+	};
+
+	// Index = wire id. Id 0 means the name follows inline.
+	static const TCHAR* const TypeNames[] =
+	{
+		nullptr,
+		TEXT("connected"),
+		TEXT("register"),
+		TEXT("registered"),
+		TEXT("chat"),
+		TEXT("chat_response"),
+		TEXT("chat_delta"),
+		TEXT("voice"),
+		TEXT("voice_processed"),
+		TEXT("error"),
+		TEXT("ping"),
+		TEXT("pong"),
+		TEXT("create_calendar_event"),
+		TEXT("calendar_event_created"),
+		TEXT("voice_start"),
+		TEXT("voice_chunk"),
+		TEXT("voice_end"),
+		TEXT("voice_partial"),
+		TEXT("resume"),
+		TEXT("resumed"),
+		TEXT("resume_failed"),
+		TEXT("calendar_sync"),
+		TEXT("calendar_delta"),
+	};
+
+	enum EKey : uint8
+	{
+		Key_Inline = 0,
+		Key_Text,
+		Key_Message,
+		Key_Delta,
+		Key_PlayerId,
+		Key_ClientId,
+		Key_Transcription,
+		Key_AIResponse,
+		Key_Error,
+		Key_Stream,
+		Key_Streamed,
+		Key_Timestamp,
+		Key_EventName,
+		Key_DateTime,
+		Key_DurationMinutes,
+		Key_Location,
+		Key_Notes,
+		Key_Priority,
+		Key_Event,
+		Key_Wire,
+		Key_StreamId,
+		Key_Seq,
+		Key_Audio,
+		Key_SampleRate,
+		Key_Channels,
+		Key_Encoding,
+		Key_Batch,
+		Key_Ack,
+		Key_SessionToken,
+		Key_RequestId,
+		Key_Revision,
+		Key_Events,
+		Key_Op,
+		Key_EventId,
+		Key_Count
+	};
+
+	static const TCHAR* const KeyNames[Key_Count] =
+	{
+		nullptr,
+		TEXT("text"),
+		TEXT("message"),
+		TEXT("delta"),
+		TEXT("playerId"),
+		TEXT("clientId"),
+		TEXT("transcription"),
+		TEXT("aiResponse"),
+		TEXT("error"),
+		TEXT("stream"),
+		TEXT("streamed"),
+		TEXT("timestamp"),
+		TEXT("eventName"),
+		TEXT("dateTime"),
+		TEXT("durationMinutes"),
+		TEXT("location"),
+		TEXT("notes"),
+		TEXT("priority"),
+		TEXT("event"),
+		TEXT("wire"),
+		TEXT("streamId"),
+		TEXT("seq"),
+		TEXT("audio"),
+		TEXT("sampleRate"),
+		TEXT("channels"),
+		TEXT("encoding"),
+		TEXT("batch"),
+		TEXT("ack"),
+		TEXT("sessionToken"),
+		TEXT("requestId"),
+		TEXT("revision"),
+		TEXT("events"),
+		TEXT("op"),
+		TEXT("eventId"),
+	};
+
+	template <int32 N>
+	static uint8 FindId(const TCHAR* const (&Table)[N], const TCHAR* Name)
+	{
+		for (int32 Id = 1; Id < N; ++Id)
+		{
+			if (FCString::Strcmp(Table[Id], Name) == 0)
+			{
+				return (uint8)Id;
+			}
+		}
+		return 0;
+	}
+
+	static const FName& TypeIdToName(uint8 Id)
+	{
+		// Built once; FName construction is thread safe
+		static const TArray<FName> Names = []()
+		{
+			TArray<FName> Result;
+			Result.Add(NAME_None);
+			for (int32 Index = 1; Index < UE_ARRAY_COUNT(TypeNames); ++Index)
+			{
+				Result.Add(FName(TypeNames[Index]));
+			}
+			return Result;
+		}();
+
+		return Names.IsValidIndex(Id) ? Names[Id] : Names[0];
+	}
+
+	static void AppendVarint(TArray<uint8>& Out, uint64 Value)
+	{
+		do
+		{
+			uint8 Byte = Value & 0x7F;
+			Value >>= 7;
+			Out.Add(Value ? (Byte | 0x80) : Byte);
+		}
+		while (Value);
+	}
+
+	static void AppendUtf8(TArray<uint8>& Out, FStringView Value)
+	{
+		const int32 Utf8Len = FPlatformString::ConvertedLength<UTF8CHAR>(Value.GetData(), Value.Len());
+		AppendVarint(Out, (uint64)Utf8Len);
+		const int32 Offset = Out.AddUninitialized(Utf8Len);
+		FPlatformString::Convert((UTF8CHAR*)(Out.GetData() + Offset), Utf8Len, Value.GetData(), Value.Len());
+	}
+
+	/** Bounds-checked cursor over a received frame */
+	struct FReader
+	{
+		const uint8* Data;
+		int32 Size;
+		int32 Pos = 0;
+
+		bool ReadByte(uint8& Out)
+		{
+			if (Pos >= Size)
+			{
+				return false;
+			}
+			Out = Data[Pos++];
+			return true;
+		}
+
+		bool ReadVarint(uint64& Out)
+		{
+			Out = 0;
+			for (int32 Shift = 0; Shift < 64; Shift += 7)
+			{
+				uint8 Byte;
+				if (!ReadByte(Byte))
+				{
+					return false;
+				}
+				Out |= (uint64)(Byte & 0x7F) << Shift;
+				if (!(Byte & 0x80))
+				{
+					return true;
+				}
+			}
+			return false;
+		}
+
+		bool ReadSpan(const uint8*& OutData, int32& OutLen)
+		{
+			uint64 Len;
+			if (!ReadVarint(Len) || Len > (uint64)(Size - Pos))
+			{
+				return false;
+			}
+			OutData = Data + Pos;
+			OutLen = (int32)Len;
+			Pos += OutLen;
+			return true;
+		}
+
+		bool ReadString(FString& Out)
+		{
+			const uint8* Utf8;
+			int32 Len;
+			if (!ReadSpan(Utf8, Len))
+			{
+				return false;
+			}
+			FUTF8ToTCHAR Converter((const ANSICHAR*)Utf8, Len);
+			Out = FString(Converter.Length(), Converter.Get());
+			return true;
+		}
+	};
+
+	/** Raw inflate primed with Dictionary; one per decode thread, reset between frames */
+	struct FInflater
+	{
+		z_stream Stream = {};
+		bool bReady = false;
+
+		FInflater()
+		{
+			bReady = inflateInit2(&Stream, -MAX_WBITS) == Z_OK;
+		}
+
+		~FInflater()
+		{
+			if (bReady)
+			{
+				inflateEnd(&Stream);
+			}
+		}
+
+		/** Exactly OutSize bytes must come out, ending the stream */
+		bool Inflate(const uint8* Data, int32 Size, uint8* Out, int32 OutSize)
+		{
+			if (!bReady || inflateReset(&Stream) != Z_OK ||
+				inflateSetDictionary(&Stream, (const Bytef*)Dictionary, sizeof(Dictionary) - 1) != Z_OK)
+			{
+				return false;
+			}
+
+			Stream.next_in = const_cast<Bytef*>(Data);
+			Stream.avail_in = (uInt)Size;
+			Stream.next_out = Out;
+			Stream.avail_out = (uInt)OutSize;
+			return inflate(&Stream, Z_FINISH) == Z_STREAM_END && Stream.avail_out == 0;
+		}
+	};
+
+	/** Rebuild the ordinary frame a compressed one stands for */
+	static bool InflateFrame(const uint8* Data, int32 Size, TArray<uint8>& Out)
+	{
+		FReader Reader{ Data, Size };
+
+		uint8 FrameMagic, FrameVersion, Flags;
+		uint64 RawSize;
+		if (!Reader.ReadByte(FrameMagic) || FrameMagic != Magic ||
+			!Reader.ReadByte(FrameVersion) || FrameVersion != Version ||
+			!Reader.ReadByte(Flags) || !(Flags & Flag_Deflate) ||
+			!Reader.ReadVarint(RawSize) || RawSize == 0 || RawSize > MaxInflatedSize)
+		{
+			return false;
+		}
+
+		Out.Reset(3 + (int32)RawSize);
+		Out.Add(Magic);
+		Out.Add(Version);
+		Out.Add(Flags & ~Flag_Deflate);
+		Out.AddUninitialized((int32)RawSize);
+
+		thread_local FInflater Inflater;
+		return Inflater.Inflate(Data + Reader.Pos, Size - Reader.Pos, Out.GetData() + 3, (int32)RawSize);
+	}
+
+	/** Store a field we have no member for in the message's overflow payload */
+	static bool ReadIntoPayload(FReader& Reader, uint8 Tag, const FString& Key, FAICompanionInboundMessage& OutMessage)
+	{
+		if (!OutMessage.Payload.IsValid())
+		{
+			OutMessage.Payload = MakeShared<FJsonObject>();
+		}
+		FJsonObject& Payload = *OutMessage.Payload;
+
+		switch (Tag)
+		{
+		case Tag_Null:
+			Payload.SetField(Key, MakeShared<FJsonValueNull>());
+			return true;
+		case Tag_False:
+		case Tag_True:
+			Payload.SetBoolField(Key, Tag == Tag_True);
+			return true;
+		case Tag_Int:
+		{
+			uint64 ZigZag;
+			if (!Reader.ReadVarint(ZigZag))
+			{
+				return false;
+			}
+			const int64 Value = (int64)(ZigZag >> 1) ^ -(int64)(ZigZag & 1);
+			Payload.SetNumberField(Key, (double)Value);
+			return true;
+		}
+		case Tag_String:
+		{
+			FString Value;
+			if (!Reader.ReadString(Value))
+			{
+				return false;
+			}
+			Payload.SetStringField(Key, Value);
+			return true;
+		}
+		case Tag_Bytes:
+		{
+			const uint8* Raw;
+			int32 Len;
+			if (!Reader.ReadSpan(Raw, Len))
+			{
+				return false;
+			}
+			Payload.SetStringField(Key, FBase64::Encode(Raw, Len));
+			return true;
+		}
+		case Tag_Json:
+		{
+			FString JsonText;
+			if (!Reader.ReadString(JsonText))
+			{
+				return false;
+			}
+			// Malformed embedded JSON means a bad frame, same as a bad tag or length
+			TSharedPtr<FJsonValue> Value;
+			TSharedRef<TJsonReader<>> JsonReader = TJsonReaderFactory<>::Create(JsonText);
+			if (!FJsonSerializer::Deserialize(JsonReader, Value) || !Value.IsValid())
+			{
+				return false;
+			}
+			Payload.SetField(Key, Value);
+			return true;
+		}
+		case Tag_Double:
+		{
+			if (Reader.Size - Reader.Pos < 8)
+			{
+				return false;
+			}
+			double Value;
+			FMemory::Memcpy(&Value, Reader.Data + Reader.Pos, 8);
+			Reader.Pos += 8;
+			Payload.SetNumberField(Key, Value);
+			return true;
+		}
+		default:
+			return false;
+		}
+	}
+}
+
+// ========================================
+// DECODING
+// ========================================
+
+bool AICompanionProtocol::DecodeJsonFrame(const FString& Frame, FAICompanionInboundMessage& OutMessage)
+{
+	TSharedPtr<FJsonObject> JsonObject;
+	TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(Frame);
+
+	if (!FJsonSerializer::Deserialize(Reader, JsonObject) || !JsonObject.IsValid())
+	{
+		return false;
+	}
+
+	FString MessageType;
+	if (!JsonObject->TryGetStringField(TEXT("type"), MessageType))
+	{
+		return false;
+	}
+
+	OutMessage.Type = FName(*MessageType);
+
+	// The backend sends chat text as "message"; older builds used "text"
+	if (OutMessage.Type == AICompanionMessageTypes::ChatDelta)
+	{
+		JsonObject->TryGetStringField(TEXT("delta"), OutMessage.Text);
+	}
+	else if (!JsonObject->TryGetStringField(TEXT("text"), OutMessage.Text))
+	{
+		JsonObject->TryGetStringField(TEXT("message"), OutMessage.Text);
+	}
+
+	JsonObject->TryGetStringField(TEXT("clientId"), OutMessage.ClientId);
+	JsonObject->TryGetStringField(TEXT("playerId"), OutMessage.PlayerId);
+	JsonObject->TryGetStringField(TEXT("transcription"), OutMessage.Transcription);
+	JsonObject->TryGetStringField(TEXT("aiResponse"), OutMessage.AIResponse);
+	JsonObject->TryGetNumberField(TEXT("requestId"), OutMessage.RequestId);
+
+	if (!JsonObject->TryGetStringField(TEXT("error"), OutMessage.Error) && OutMessage.Type == AICompanionMessageTypes::Error)
+	{
+		OutMessage.Error = OutMessage.Text;
+	}
+
+	OutMessage.Payload = MoveTemp(JsonObject);
+	return true;
+}
+
+bool AICompanionProtocol::DecodeBinaryFrame(const uint8* Data, int32 Size, FAICompanionInboundMessage& OutMessage)
+{
+	using namespace AICompanionWire;
+
+	// Inflated right here on the decode task; the game thread only ever sees the decoded message
+	if (Size > 2 && (Data[2] & Flag_Deflate))
+	{
+		thread_local TArray<uint8> Inflated;
+		return InflateFrame(Data, Size, Inflated) && DecodeBinaryFrame(Inflated.GetData(), Inflated.Num(), OutMessage);
+	}
+
+	FReader Reader{ Data, Size };
+
+	uint8 FrameMagic, FrameVersion, Flags, TypeId;
+	if (!Reader.ReadByte(FrameMagic) || FrameMagic != Magic ||
+		!Reader.ReadByte(FrameVersion) || FrameVersion != Version ||
+		!Reader.ReadByte(Flags) || Flags != 0 ||
+		!Reader.ReadByte(TypeId))
+	{
+		return false;
+	}
+
+	if (TypeId == 0)
+	{
+		FString TypeName;
+		if (!Reader.ReadString(TypeName))
+		{
+			return false;
+		}
+		OutMessage.Type = FName(*TypeName);
+	}
+	else
+	{
+		OutMessage.Type = TypeIdToName(TypeId);
+	}
+
+	const bool bIsDelta = OutMessage.Type == AICompanionMessageTypes::ChatDelta;
+	FString Message;
+
+	for (;;)
+	{
+		uint8 KeyId;
+		if (!Reader.ReadByte(KeyId))
+		{
+			return false;
+		}
+		if (KeyId == EndOfFields)
+		{
+			break;
+		}
+
+		FString InlineKey;
+		if (KeyId == Key_Inline && !Reader.ReadString(InlineKey))
+		{
+			return false;
+		}
+
+		uint8 Tag;
+		if (!Reader.ReadByte(Tag))
+		{
+			return false;
+		}
+
+		// Strings we surface as members are decoded straight into place
+		FString* Target = nullptr;
+		if (Tag == Tag_String)
+		{
+			switch (KeyId)
+			{
+			case Key_Text:			Target = bIsDelta ? nullptr : &OutMessage.Text; break;
+			case Key_Delta:			Target = bIsDelta ? &OutMessage.Text : nullptr; break;
+			case Key_Message:		Target = &Message; break;
+			case Key_PlayerId:		Target = &OutMessage.PlayerId; break;
+			case Key_ClientId:		Target = &OutMessage.ClientId; break;
+			case Key_Transcription:	Target = &OutMessage.Transcription; break;
+			case Key_AIResponse:	Target = &OutMessage.AIResponse; break;
+			case Key_Error:			Target = &OutMessage.Error; break;
+			default: break;
+			}
+		}
+
+		if (Target)
+		{
+			if (!Reader.ReadString(*Target))
+			{
+				return false;
+			}
+			continue;
+		}
+
+		if (KeyId == Key_RequestId && Tag == Tag_Int)
+		{
+			uint64 ZigZag;
+			if (!Reader.ReadVarint(ZigZag))
+			{
+				return false;
+			}
+			OutMessage.RequestId = (int32)((int64)(ZigZag >> 1) ^ -(int64)(ZigZag & 1));
+			continue;
+		}
+
+		const FString Key = KeyId == Key_Inline ? InlineKey : FString(KeyId < Key_Count ? KeyNames[KeyId] : TEXT("unknown"));
+		if (!ReadIntoPayload(Reader, Tag, Key, OutMessage))
+		{
+			return false;
+		}
+	}
+
+	// Same fallbacks as the JSON path
+	if (OutMessage.Text.IsEmpty() && !bIsDelta)
+	{
+		OutMessage.Text = MoveTemp(Message);
+	}
+	if (OutMessage.Error.IsEmpty() && OutMessage.Type == AICompanionMessageTypes::Error)
+	{
+		OutMessage.Error = OutMessage.Text;
+	}
+
+	return true;
+}
+
+bool AICompanionProtocol::TranscodeBinaryToJson(TArrayView<const uint8> Frame, FString& OutJson)
+{
+	using namespace AICompanionWire;
+
+	FReader Reader{ Frame.GetData(), Frame.Num() };
+
+	uint8 FrameMagic, FrameVersion, Flags, TypeId;
+	if (!Reader.ReadByte(FrameMagic) || FrameMagic != Magic ||
+		!Reader.ReadByte(FrameVersion) || FrameVersion != Version ||
+		!Reader.ReadByte(Flags) || Flags != 0 ||
+		!Reader.ReadByte(TypeId))
+	{
+		return false;
+	}
+
+	FString Name;
+	if (TypeId == 0 ? !Reader.ReadString(Name) : TypeId >= UE_ARRAY_COUNT(TypeNames))
+	{
+		return false;
+	}
+
+	OutJson.Reset();
+	OutJson.AppendChars(TEXT("{\"type\":"), 8);
+	FAICompanionMessageWriter::AppendEscaped(OutJson, TypeId == 0 ? FStringView(Name) : FStringView(TypeNames[TypeId]));
+
+	for (;;)
+	{
+		uint8 KeyId, Tag;
+		if (!Reader.ReadByte(KeyId))
+		{
+			return false;
+		}
+		if (KeyId == EndOfFields)
+		{
+			break;
+		}
+		if (KeyId == Key_Inline ? !Reader.ReadString(Name) : KeyId >= Key_Count)
+		{
+			return false;
+		}
+		if (!Reader.ReadByte(Tag))
+		{
+			return false;
+		}
+
+		OutJson.AppendChar(TEXT(','));
+		FAICompanionMessageWriter::AppendEscaped(OutJson, KeyId == Key_Inline ? FStringView(Name) : FStringView(KeyNames[KeyId]));
+		OutJson.AppendChar(TEXT(':'));
+
+		switch (Tag)
+		{
+		case Tag_Null:	OutJson.Append(TEXT("null")); break;
+		case Tag_False:	OutJson.Append(TEXT("false")); break;
+		case Tag_True:	OutJson.Append(TEXT("true")); break;
+		case Tag_Int:
+		{
+			uint64 ZigZag;
+			if (!Reader.ReadVarint(ZigZag))
+			{
+				return false;
+			}
+			OutJson.Appendf(TEXT("%lld"), (long long)((int64)(ZigZag >> 1) ^ -(int64)(ZigZag & 1)));
+			break;
+		}
+		case Tag_String:
+		{
+			FString Value;
+			if (!Reader.ReadString(Value))
+			{
+				return false;
+			}
+			FAICompanionMessageWriter::AppendEscaped(OutJson, Value);
+			break;
+		}
+		case Tag_Bytes:
+		{
+			// Same base64 convention as FAICompanionMessageWriter::WriteBytes in JSON mode
+			const uint8* Raw;
+			int32 Len;
+			if (!Reader.ReadSpan(Raw, Len))
+			{
+				return false;
+			}
+			FAICompanionMessageWriter::AppendEscaped(OutJson, FBase64::Encode(Raw, Len));
+			break;
+		}
+		case Tag_Json:
+		{
+			FString JsonText;
+			if (!Reader.ReadString(JsonText))
+			{
+				return false;
+			}
+			OutJson.Append(JsonText);
+			break;
+		}
+		case Tag_Double:
+		{
+			if (Reader.Size - Reader.Pos < 8)
+			{
+				return false;
+			}
+			double Value;
+			FMemory::Memcpy(&Value, Reader.Data + Reader.Pos, 8);
+			Reader.Pos += 8;
+			OutJson.Append(FString::SanitizeFloat(Value));
+			break;
+		}
+		default:
+			return false;
+		}
+	}
+
+	OutJson.AppendChar(TEXT('}'));
+	return true;
+}
+
+// ========================================
+// ENCODING
+// ========================================
+
+bool AICompanionProtocol::CompressBinaryFrame(TArrayView<const uint8> Frame, TArray<uint8>& OutFrame)
+{
+	using namespace AICompanionWire;
+
+	if (Frame.Num() < MinCompressSize || Frame[0] != Magic || (Frame[2] & Flag_Deflate))
+	{
+		return false;
+	}
+
+	z_stream Stream = {};
+	if (deflateInit2(&Stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+	{
+		return false;
+	}
+
+	const int32 BodySize = Frame.Num() - 3;
+	OutFrame.Reset(16 + (int32)deflateBound(&Stream, BodySize));
+	OutFrame.Add(Magic);
+	OutFrame.Add(Version);
+	OutFrame.Add(Frame[2] | Flag_Deflate);
+	AppendVarint(OutFrame, (uint64)BodySize);
+
+	const int32 HeaderSize = OutFrame.Num();
+	OutFrame.AddUninitialized(OutFrame.Max() - HeaderSize);
+
+	bool bOk = deflateSetDictionary(&Stream, (const Bytef*)Dictionary, sizeof(Dictionary) - 1) == Z_OK;
+	if (bOk)
+	{
+		Stream.next_in = const_cast<Bytef*>(Frame.GetData() + 3);
+		Stream.avail_in = (uInt)BodySize;
+		Stream.next_out = OutFrame.GetData() + HeaderSize;
+		Stream.avail_out = (uInt)(OutFrame.Num() - HeaderSize);
+		bOk = deflate(&Stream, Z_FINISH) == Z_STREAM_END;
+	}
+	OutFrame.SetNum(HeaderSize + (int32)Stream.total_out, EAllowShrinking::No);
+	deflateEnd(&Stream);
+
+	// Not worth it if it did not shrink
+	return bOk && OutFrame.Num() < Frame.Num();
+}
+
+void AICompanionProtocol::BeginBinaryBatch(TArray<uint8>& Out, int32 Count)
+{
+	Out.Add(AICompanionWire::Magic);
+	Out.Add(AICompanionWire::Version);
+	Out.Add(AICompanionWire::Flag_Batch);
+	AICompanionWire::AppendVarint(Out, (uint64)Count);
+}
+
+void AICompanionProtocol::AppendBinaryBatchEntry(TArray<uint8>& Out, TArrayView<const uint8> Frame)
+{
+	AICompanionWire::AppendVarint(Out, (uint64)Frame.Num());
+	Out.Append(Frame.GetData(), Frame.Num());
+}
+
+FAICompanionMessageWriter::FAICompanionMessageWriter(int32 InitialReserve)
+{
+	Text.Reserve(InitialReserve);
+	Bytes.Reserve(InitialReserve);
+}
+
+FAICompanionMessageWriter& FAICompanionMessageWriter::Begin(const TCHAR* Type)
+{
+	ActiveFormat = Format;
+	Text.Reset();
+	Bytes.Reset();
+
+	if (IsBinary())
+	{
+		using namespace AICompanionWire;
+
+		const uint8 TypeId = FindId(TypeNames, Type);
+		Bytes.Add(Magic);
+		Bytes.Add(Version);
+		Bytes.Add(0);
+		Bytes.Add(TypeId);
+		if (TypeId == 0)
+		{
+			AppendUtf8(Bytes, Type);
+		}
+	}
+	else
+	{
+		Text.AppendChars(TEXT("{\"type\":"), 8);
+		AppendEscaped(Text, Type);
+	}
+	return *this;
+}
+
+FAICompanionMessageWriter& FAICompanionMessageWriter::WriteString(const TCHAR* Key, FStringView Value)
+{
+	WriteKey(Key, AICompanionWire::Tag_String);
+	if (IsBinary())
+	{
+		AICompanionWire::AppendUtf8(Bytes, Value);
+	}
+	else
+	{
+		AppendEscaped(Text, Value);
+	}
+	return *this;
+}
+
+FAICompanionMessageWriter& FAICompanionMessageWriter::WriteInt(const TCHAR* Key, int64 Value)
+{
+	WriteKey(Key, AICompanionWire::Tag_Int);
+
+	if (IsBinary())
+	{
+		AICompanionWire::AppendVarint(Bytes, ((uint64)Value << 1) ^ (uint64)(Value >> 63));
+		return *this;
+	}
+
+	// Format into a stack buffer, least significant digit first
+	TCHAR Digits[24];
+	int32 Count = 0;
+	uint64 Magnitude = Value < 0 ? (uint64)(-(Value + 1)) + 1 : (uint64)Value;
+	do
+	{
+		Digits[Count++] = TEXT('0') + (TCHAR)(Magnitude % 10);
+		Magnitude /= 10;
+	}
+	while (Magnitude != 0);
+
+	if (Value < 0)
+	{
+		Text.AppendChar(TEXT('-'));
+	}
+	while (Count > 0)
+	{
+		Text.AppendChar(Digits[--Count]);
+	}
+	return *this;
+}
+
+FAICompanionMessageWriter& FAICompanionMessageWriter::WriteBool(const TCHAR* Key, bool bValue)
+{
+	WriteKey(Key, bValue ? AICompanionWire::Tag_True : AICompanionWire::Tag_False);
+
+	if (IsBinary())
+	{
+		// The tag carries the value
+	}
+	else if (bValue)
+	{
+		Text.AppendChars(TEXT("true"), 4);
+	}
+	else
+	{
+		Text.AppendChars(TEXT("false"), 5);
+	}
+	return *this;
+}
+
+FAICompanionMessageWriter& FAICompanionMessageWriter::WriteBytes(const TCHAR* Key, TArrayView<const uint8> Value)
+{
+	if (IsBinary())
+	{
+		WriteKey(Key, AICompanionWire::Tag_Bytes);
+		AICompanionWire::AppendVarint(Bytes, (uint64)Value.Num());
+		Bytes.Append(Value.GetData(), Value.Num());
+		return *this;
+	}
+
+	// JSON has no byte type; the backend decodes base64 strings for these keys
+	WriteKey(Key, AICompanionWire::Tag_String);
+	AppendEscaped(Text, FBase64::Encode(Value.GetData(), (uint32)Value.Num()));
+	return *this;
+}
+
+FAICompanionMessageWriter& FAICompanionMessageWriter::WriteDateTime(const TCHAR* Key, const FDateTime& Value)
+{
+	// yyyy-mm-ddThh:mm:ss.mmmZ
+	TCHAR Iso[24];
+	int32 Pos = 0;
+
+	auto AppendPadded = [&Iso, &Pos](int32 Number, int32 Width)
+	{
+		for (int32 Index = Width - 1; Index >= 0; --Index)
+		{
+			Iso[Pos + Index] = TEXT('0') + (TCHAR)(Number % 10);
+			Number /= 10;
+		}
+		Pos += Width;
+	};
+
+	AppendPadded(Value.GetYear(), 4);
+	Iso[Pos++] = TEXT('-');
+	AppendPadded(Value.GetMonth(), 2);
+	Iso[Pos++] = TEXT('-');
+	AppendPadded(Value.GetDay(), 2);
+	Iso[Pos++] = TEXT('T');
+	AppendPadded(Value.GetHour(), 2);
+	Iso[Pos++] = TEXT(':');
+	AppendPadded(Value.GetMinute(), 2);
+	Iso[Pos++] = TEXT(':');
+	AppendPadded(Value.GetSecond(), 2);
+	Iso[Pos++] = TEXT('.');
+	AppendPadded(Value.GetMillisecond(), 3);
+	Iso[Pos++] = TEXT('Z');
+
+	return WriteString(Key, FStringView(Iso, Pos));
+}
+
+const FAICompanionMessageWriter& FAICompanionMessageWriter::Finish()
+{
+	if (IsBinary())
+	{
+		Bytes.Add(AICompanionWire::EndOfFields);
+	}
+	else
+	{
+		Text.AppendChar(TEXT('}'));
+	}
+	return *this;
+}
+
+void FAICompanionMessageWriter::WriteKey(const TCHAR* Key, uint8 BinaryTag)
+{
+	if (IsBinary())
+	{
+		const uint8 KeyId = AICompanionWire::FindId(AICompanionWire::KeyNames, Key);
+		Bytes.Add(KeyId);
+		if (KeyId == AICompanionWire::Key_Inline)
+		{
+			AICompanionWire::AppendUtf8(Bytes, Key);
+		}
+		Bytes.Add(BinaryTag);
+		return;
+	}
+
+	// Keys are compile-time literals from this module and never need escaping
+	Text.AppendChars(TEXT(",\""), 2);
+	Text.Append(Key);
+	Text.AppendChars(TEXT("\":"), 2);
+}
+
+void FAICompanionMessageWriter::AppendEscaped(FString& Out, FStringView Value)
+{
+	static const TCHAR HexDigits[] = TEXT("0123456789abcdef");
+
+	Out.AppendChar(TEXT('"'));
+
+	const TCHAR* Data = Value.GetData();
+	const int32 Len = Value.Len();
+	int32 RunStart = 0;
+
+	for (int32 Index = 0; Index < Len; ++Index)
+	{
+		const TCHAR Char = Data[Index];
+		if (Char >= 0x20 && Char != TEXT('"') && Char != TEXT('\\'))
+		{
+			continue;
+		}
+
+		// Flush the run of characters that need no escaping
+		Out.AppendChars(Data + RunStart, Index - RunStart);
+		RunStart = Index + 1;
+
+		switch (Char)
+		{
+		case TEXT('"'):  Out.AppendChars(TEXT("\\\""), 2); break;
+		case TEXT('\\'): Out.AppendChars(TEXT("\\\\"), 2); break;
+		case TEXT('\n'): Out.AppendChars(TEXT("\\n"), 2); break;
+		case TEXT('\r'): Out.AppendChars(TEXT("\\r"), 2); break;
+		case TEXT('\t'): Out.AppendChars(TEXT("\\t"), 2); break;
+		case TEXT('\b'): Out.AppendChars(TEXT("\\b"), 2); break;
+		case TEXT('\f'): Out.AppendChars(TEXT("\\f"), 2); break;
+		default:
+			Out.AppendChars(TEXT("\\u00"), 4);
+			Out.AppendChar(HexDigits[(Char >> 4) & 0xF]);
+			Out.AppendChar(HexDigits[Char & 0xF]);
+			break;
+		}
+	}
+
+	Out.AppendChars(Data + RunStart, Len - RunStart);
+	Out.AppendChar(TEXT('"'));
+}
+
+// ========================================
+// DECODE PIPELINE
+// ========================================
+
+FAICompanionDecodePipeline::FAICompanionDecodePipeline()
+	: Pipe(TEXT("AICompanionDecode"))
+{
+}
+
+FAICompanionDecodePipeline::~FAICompanionDecodePipeline()
+{
+	Flush();
+}
+
+void FAICompanionDecodePipeline::Enqueue(FString Frame)
+{
+	InFlight.fetch_add(1, std::memory_order_relaxed);
+
+	// The pipe runs one task at a time, so frames are decoded (and queued) in arrival order
+	Pipe.Launch(TEXT("AICompanionDecodeFrame"), [this, Frame = MoveTemp(Frame)]()
+	{
+		FAICompanionInboundMessage Message;
+		if (AICompanionProtocol::DecodeJsonFrame(Frame, Message))
+		{
+			Decoded.Enqueue(MoveTemp(Message));
+		}
+		else
+		{
+			InFlight.fetch_sub(1, std::memory_order_release);
+			UE_LOG(LogAICompanion, Error, TEXT("[AICompanionProtocol] Failed to parse message (%d chars)"), Frame.Len());
+		}
+	});
+}
+
+void FAICompanionDecodePipeline::EnqueueBinary(TArray<uint8> Frame)
+{
+	InFlight.fetch_add(1, std::memory_order_relaxed);
+
+	Pipe.Launch(TEXT("AICompanionDecodeBinaryFrame"), [this, Frame = MoveTemp(Frame)]()
+	{
+		FAICompanionInboundMessage Message;
+		if (AICompanionProtocol::DecodeBinaryFrame(Frame.GetData(), Frame.Num(), Message))
+		{
+			Decoded.Enqueue(MoveTemp(Message));
+		}
+		else
+		{
+			InFlight.fetch_sub(1, std::memory_order_release);
+			UE_LOG(LogAICompanion, Error, TEXT("[AICompanionProtocol] Failed to parse binary message (%d bytes)"), Frame.Num());
+		}
+	});
+}
+
+bool FAICompanionDecodePipeline::Dequeue(FAICompanionInboundMessage& OutMessage)
+{
+	if (!Decoded.Dequeue(OutMessage))
+	{
+		return false;
+	}
+	InFlight.fetch_sub(1, std::memory_order_release);
+	return true;
+}
+
+void FAICompanionDecodePipeline::Flush()
+{
+	Pipe.WaitUntilEmpty();
+}
@@ -0,0 +1,197 @@
+// AICompanionProtocol.h
+// Typed messages exchanged with the AI Assistant backend
+// Frames are decoded off the game thread and handed over ready to dispatch
+//
+// Two wire formats are supported:
+//  - JSON text frames (default, always understood by the backend)
+//  - "bin1" compact binary frames, negotiated during register/registered
+//    (layout documented in AICompanionProtocol.cpp and wire-protocol.js),
+//    optionally deflated against a shared dictionary ("zdict2")
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Queue.h"
+#include "Dom/JsonObject.h"
+#include "Tasks/Pipe.h"
+#include <atomic>
+
+/**
+ * Message type names used by the backend (index.js)
+ */
+namespace AICompanionMessageTypes
+{
+	extern const FName Connected;
+	extern const FName Registered;
+	extern const FName ChatResponse;
+	extern const FName ChatDelta;
+	extern const FName VoiceProcessed;
+	extern const FName VoicePartial;
+	extern const FName Error;
+	extern const FName Pong;
+	extern const FName Resumed;
+	extern const FName ResumeFailed;
+	extern const FName CalendarSync;
+	extern const FName CalendarDelta;
+}
+
+/**
+ * Encoding used on the socket
+ */
+enum class EAICompanionWireFormat : uint8
+{
+	Json,
+	Binary
+};
+
+/** Name sent in register/registered to negotiate the binary format */
+#define AICOMPANION_BINARY_WIRE_NAME TEXT("bin1")
+
+/** Name sent in register/registered to negotiate dictionary-compressed bin1 frames */
+#define AICOMPANION_COMPRESSION_NAME TEXT("zdict2")
+
+/**
+ * A fully decoded inbound frame
+ * Common fields are pulled out during decode so the game thread never touches JSON
+ */
+struct FAICompanionInboundMessage
+{
+	/** Message "type" field */
+	FName Type;
+
+	/** "text" (or "message" for chat_response, "delta" for chat_delta) */
+	FString Text;
+
+	FString ClientId;
+	FString PlayerId;
+	FString Transcription;
+	FString AIResponse;
+
+	/** "error" (or "message" for error frames) */
+	FString Error;
+
+	/** "requestId" echoed from the request this replies to (0 if none) */
+	int32 RequestId = 0;
+
+	/**
+	 * Remaining fields, for handlers that need more than the members above.
+	 * JSON frames keep the whole document; binary frames only carry the fields
+	 * not already decoded into members (null if there were none).
+	 */
+	TSharedPtr<FJsonObject> Payload;
+};
+
+namespace AICompanionProtocol
+{
+	/** Parse a JSON text frame into a typed message. Safe to call from any thread. */
+	bool DecodeJsonFrame(const FString& Frame, FAICompanionInboundMessage& OutMessage);
+
+	/** Parse a bin1 binary frame (compressed or not) into a typed message. Safe to call from any thread. */
+	bool DecodeBinaryFrame(const uint8* Data, int32 Size, FAICompanionInboundMessage& OutMessage);
+
+	/** Deflate a bin1 frame against the shared dictionary; false (OutFrame unusable) if it is small or did not shrink */
+	bool CompressBinaryFrame(TArrayView<const uint8> Frame, TArray<uint8>& OutFrame);
+
+	/** Rewrite a single bin1 frame as the equivalent JSON document (bytes become base64) */
+	bool TranscodeBinaryToJson(TArrayView<const uint8> Frame, FString& OutJson);
+
+	/** Write a bin1 batch header for Count frames; follow with Count AppendBinaryBatchEntry calls */
+	void BeginBinaryBatch(TArray<uint8>& Out, int32 Count);
+
+	/** Append one finished bin1 frame to a batch started with BeginBinaryBatch */
+	void AppendBinaryBatchEntry(TArray<uint8>& Out, TArrayView<const uint8> Frame);
+}
+
+/**
+ * Reusable encoder for outbound messages
+ *
+ * Writes flat {"type":...,"key":value} documents straight into one buffer,
+ * as JSON text or as a bin1 frame depending on SetFormat(). Begin() resets
+ * the length but keeps the capacity, so a long-lived writer stops
+ * allocating once it has seen its largest message.
+ *
+ * Usage:
+ *   Manager->SendEncodedMessage(Writer.Begin(TEXT("chat"))
+ *       .WriteString(TEXT("text"), Message)
+ *       .WriteBool(TEXT("stream"), true)
+ *       .Finish());
+ */
+class FAICompanionMessageWriter
+{
+public:
+	explicit FAICompanionMessageWriter(int32 InitialReserve = 1024);
+
+	/** Applies from the next Begin() */
+	void SetFormat(EAICompanionWireFormat InFormat) { Format = InFormat; }
+	EAICompanionWireFormat GetFormat() const { return Format; }
+
+	/** Start a new message; discards the previous one */
+	FAICompanionMessageWriter& Begin(const TCHAR* Type);
+
+	FAICompanionMessageWriter& WriteString(const TCHAR* Key, FStringView Value);
+	FAICompanionMessageWriter& WriteInt(const TCHAR* Key, int64 Value);
+	FAICompanionMessageWriter& WriteBool(const TCHAR* Key, bool bValue);
+
+	/** Raw bytes in binary frames, base64 text in JSON */
+	FAICompanionMessageWriter& WriteBytes(const TCHAR* Key, TArrayView<const uint8> Value);
+
+	/** ISO 8601 timestamp, same format as FDateTime::ToIso8601 */
+	FAICompanionMessageWriter& WriteDateTime(const TCHAR* Key, const FDateTime& Value);
+
+	/** Close the message. Contents stay valid until the next Begin(). */
+	const FAICompanionMessageWriter& Finish();
+
+	bool IsBinary() const { return ActiveFormat == EAICompanionWireFormat::Binary; }
+
+	/** Finished JSON text (empty for binary messages) */
+	const FString& GetText() const { return Text; }
+
+	/** Finished bin1 frame (empty for JSON messages) */
+	const TArray<uint8>& GetBytes() const { return Bytes; }
+
+	/** Append Value as a quoted, escaped JSON string */
+	static void AppendEscaped(FString& Out, FStringView Value);
+
+private:
+	void WriteKey(const TCHAR* Key, uint8 BinaryTag);
+
+	EAICompanionWireFormat Format = EAICompanionWireFormat::Json;
+	EAICompanionWireFormat ActiveFormat = EAICompanionWireFormat::Json;
+	FString Text;
+	TArray<uint8> Bytes;
+};
+
+/**
+ * Background decode stage for inbound frames
+ *
+ * Frames are parsed in order on a task pipe and pushed onto a lock-free queue.
+ * The owner drains the queue on the game thread (see AAICompanionManager::Tick).
+ */
+class FAICompanionDecodePipeline
+{
+public:
+	FAICompanionDecodePipeline();
+	~FAICompanionDecodePipeline();
+
+	/** Queue a raw text frame for decoding (game thread) */
+	void Enqueue(FString Frame);
+
+	/** Queue a raw binary frame for decoding (game thread) */
+	void EnqueueBinary(TArray<uint8> Frame);
+
+	/** Pop the next decoded message (game thread) */
+	bool Dequeue(FAICompanionInboundMessage& OutMessage);
+
+	/** Block until every queued frame has been decoded */
+	void Flush();
+
+	/** Nothing being decoded and nothing waiting to be dequeued */
+	bool IsIdle() const { return InFlight.load(std::memory_order_acquire) == 0; }
+
+private:
+	UE::Tasks::FPipe Pipe;
+	TQueue<FAICompanionInboundMessage, EQueueMode::Spsc> Decoded;
+
+	/** Frames enqueued but not yet dequeued (or dropped as unparseable) */
+	std::atomic<int32> InFlight{ 0 };
+};
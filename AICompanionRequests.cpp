@@ -0,0 +1,173 @@
+// AICompanionRequests.cpp
+// Request matching, timeouts and STAT AICompanion counters
+
+#include "AICompanionRequests.h"
+#include "AICompanionLog.h"
+#include "HAL/PlatformTime.h"
+
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Ping RTT p50 (ms)"), STAT_AICompanion_PingP50, STATGROUP_AICompanion);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Ping RTT p99 (ms)"), STAT_AICompanion_PingP99, STATGROUP_AICompanion);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("First Chunk p50 (ms)"), STAT_AICompanion_FirstChunkP50, STATGROUP_AICompanion);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("First Chunk p99 (ms)"), STAT_AICompanion_FirstChunkP99, STATGROUP_AICompanion);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Chat Response p50 (ms)"), STAT_AICompanion_ChatP50, STATGROUP_AICompanion);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Chat Response p99 (ms)"), STAT_AICompanion_ChatP99, STATGROUP_AICompanion);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Voice Response p50 (ms)"), STAT_AICompanion_VoiceP50, STATGROUP_AICompanion);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Voice Response p99 (ms)"), STAT_AICompanion_VoiceP99, STATGROUP_AICompanion);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Calendar Response p50 (ms)"), STAT_AICompanion_CalendarP50, STATGROUP_AICompanion);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Calendar Response p99 (ms)"), STAT_AICompanion_CalendarP99, STATGROUP_AICompanion);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Requests In Flight"), STAT_AICompanion_RequestsInFlight, STATGROUP_AICompanion);
+
+// Requests without a timeout are still dropped after this long
+static constexpr double RequestSafetyExpirySeconds = 600.0;
+
+int32 FAICompanionRequestTable::ReserveId()
+{
+	const int32 RequestId = NextRequestId++;
+	if (NextRequestId <= 0)
+	{
+		NextRequestId = 1;
+	}
+	return RequestId;
+}
+
+int32 FAICompanionRequestTable::Begin(EAICompanionLatencyMetric Metric, float TimeoutSeconds, FAICompanionRequestCallback Callback)
+{
+	const int32 RequestId = ReserveId();
+	const double Now = FPlatformTime::Seconds();
+
+	FPendingRequest& Request = Pending.Add(RequestId);
+	Request.StartSeconds = Now;
+	Request.Deadline = Now + (TimeoutSeconds > 0.0f ? (double)TimeoutSeconds : RequestSafetyExpirySeconds);
+	Request.Metric = Metric;
+	Request.Callback = MoveTemp(Callback);
+	return RequestId;
+}
+
+void FAICompanionRequestTable::MarkFirstChunk(int32 RequestId)
+{
+	FPendingRequest* Request = Pending.Find(RequestId);
+	if (Request && !Request->bSawFirstChunk)
+	{
+		Request->bSawFirstChunk = true;
+		RecordLatency(EAICompanionLatencyMetric::TimeToFirstChunk, Request->StartSeconds);
+	}
+}
+
+void FAICompanionRequestTable::Complete(int32 RequestId, const FAICompanionInboundMessage& Reply)
+{
+	Finish(RequestId, EAICompanionRequestResult::Completed, Reply);
+}
+
+void FAICompanionRequestTable::Fail(int32 RequestId, const FAICompanionInboundMessage& Reply)
+{
+	Finish(RequestId, EAICompanionRequestResult::Failed, Reply);
+}
+
+void FAICompanionRequestTable::Forget(int32 RequestId)
+{
+	Pending.Remove(RequestId);
+}
+
+void FAICompanionRequestTable::CancelAll()
+{
+	TMap<int32, FPendingRequest> Cancelled = MoveTemp(Pending);
+	Pending.Reset();
+
+	const FAICompanionInboundMessage NoReply;
+	for (TPair<int32, FPendingRequest>& Pair : Cancelled)
+	{
+		Pair.Value.Callback.ExecuteIfBound(EAICompanionRequestResult::Cancelled, NoReply);
+	}
+}
+
+void FAICompanionRequestTable::Finish(int32 RequestId, EAICompanionRequestResult Result, const FAICompanionInboundMessage& Reply)
+{
+	// Removed before the callback runs, so it may safely begin new requests
+	FPendingRequest Request;
+	if (!Pending.RemoveAndCopyValue(RequestId, Request))
+	{
+		return;
+	}
+
+	if (Result == EAICompanionRequestResult::Completed)
+	{
+		if (!Request.bSawFirstChunk && Request.Metric != EAICompanionLatencyMetric::PingRTT)
+		{
+			// Unstreamed reply: the first content arrived with it
+			RecordLatency(EAICompanionLatencyMetric::TimeToFirstChunk, Request.StartSeconds);
+		}
+		RecordLatency(Request.Metric, Request.StartSeconds);
+	}
+
+	Request.Callback.ExecuteIfBound(Result, Reply);
+}
+
+void FAICompanionRequestTable::Tick(double Now)
+{
+	if (Pending.Num() > 0)
+	{
+		Expired.Reset();
+		for (const TPair<int32, FPendingRequest>& Pair : Pending)
+		{
+			if (Pair.Value.Deadline <= Now)
+			{
+				Expired.Add(Pair.Key);
+			}
+		}
+
+		if (Expired.Num() > 0)
+		{
+			const FAICompanionInboundMessage NoReply;
+			for (const int32 RequestId : Expired)
+			{
+				UE_LOG(LogAICompanion, Warning, TEXT("[AICompanionRequests] Request %d timed out"), RequestId);
+				Finish(RequestId, EAICompanionRequestResult::TimedOut, NoReply);
+			}
+		}
+	}
+
+	SET_DWORD_STAT(STAT_AICompanion_RequestsInFlight, Pending.Num());
+
+	if (bStatsDirty)
+	{
+		bStatsDirty = false;
+		PublishStats();
+	}
+}
+
+void FAICompanionRequestTable::ResetHistograms()
+{
+	for (FAICompanionLatencyHistogram& Histogram : Histograms)
+	{
+		Histogram.Reset();
+	}
+	bStatsDirty = true;
+}
+
+void FAICompanionRequestTable::RecordLatency(EAICompanionLatencyMetric Metric, double StartSeconds)
+{
+	const double ElapsedMicros = (FPlatformTime::Seconds() - StartSeconds) * 1000000.0;
+	Histograms[(int32)Metric].Record((uint64)FMath::Max(ElapsedMicros, 0.0));
+	bStatsDirty = true;
+}
+
+void FAICompanionRequestTable::PublishStats()
+{
+#if STATS
+	auto Ms = [this](EAICompanionLatencyMetric Metric, double Percentile)
+	{
+		return (float)(GetHistogram(Metric).GetValueAtPercentile(Percentile) / 1000.0);
+	};
+
+	SET_FLOAT_STAT(STAT_AICompanion_PingP50, Ms(EAICompanionLatencyMetric::PingRTT, 50.0));
+	SET_FLOAT_STAT(STAT_AICompanion_PingP99, Ms(EAICompanionLatencyMetric::PingRTT, 99.0));
+	SET_FLOAT_STAT(STAT_AICompanion_FirstChunkP50, Ms(EAICompanionLatencyMetric::TimeToFirstChunk, 50.0));
+	SET_FLOAT_STAT(STAT_AICompanion_FirstChunkP99, Ms(EAICompanionLatencyMetric::TimeToFirstChunk, 99.0));
+	SET_FLOAT_STAT(STAT_AICompanion_ChatP50, Ms(EAICompanionLatencyMetric::ChatResponse, 50.0));
+	SET_FLOAT_STAT(STAT_AICompanion_ChatP99, Ms(EAICompanionLatencyMetric::ChatResponse, 99.0));
+	SET_FLOAT_STAT(STAT_AICompanion_VoiceP50, Ms(EAICompanionLatencyMetric::VoiceResponse, 50.0));
+	SET_FLOAT_STAT(STAT_AICompanion_VoiceP99, Ms(EAICompanionLatencyMetric::VoiceResponse, 99.0));
+	SET_FLOAT_STAT(STAT_AICompanion_CalendarP50, Ms(EAICompanionLatencyMetric::CalendarResponse, 50.0));
+	SET_FLOAT_STAT(STAT_AICompanion_CalendarP99, Ms(EAICompanionLatencyMetric::CalendarResponse, 99.0));
+#endif
+}
@@ -0,0 +1,89 @@
+// AICompanionRequests.h
+// Pending-request table for backend round trips
+//
+// Every request carries a requestId that the backend echoes on each reply to it,
+// so several requests can be in flight on the one socket and still be matched
+// to their callers. Latency for each request is recorded as it completes.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AICompanionLatency.h"
+#include "AICompanionProtocol.h"
+#include "AICompanionRequests.generated.h"
+
+/**
+ * How a request ended
+ */
+UENUM(BlueprintType)
+enum class EAICompanionRequestResult : uint8
+{
+	Completed UMETA(DisplayName = "Completed"),
+	Failed UMETA(DisplayName = "Failed"),
+	TimedOut UMETA(DisplayName = "Timed Out"),
+	Cancelled UMETA(DisplayName = "Cancelled")
+};
+
+/**
+ * Completion callback. Reply is the backend message for Completed and Failed, and an empty message otherwise.
+ */
+DECLARE_DELEGATE_TwoParams(FAICompanionRequestCallback, EAICompanionRequestResult /*Result*/, const FAICompanionInboundMessage& /*Reply*/);
+
+class FAICompanionRequestTable
+{
+public:
+	/**
+	 * Register a request about to be sent; returns the requestId to send with it.
+	 * TimeoutSeconds <= 0 never times out (the entry still expires after a long safety window).
+	 */
+	int32 Begin(EAICompanionLatencyMetric Metric, float TimeoutSeconds, FAICompanionRequestCallback Callback = FAICompanionRequestCallback());
+
+	/** A requestId that is never pending, for replies answered locally (e.g. from a cache) */
+	int32 ReserveId();
+
+	/** A streamed chunk for a request arrived (records TimeToFirstChunk once) */
+	void MarkFirstChunk(int32 RequestId);
+
+	/** Final reply arrived: records latency and fires the callback */
+	void Complete(int32 RequestId, const FAICompanionInboundMessage& Reply);
+
+	/** Backend answered with an error */
+	void Fail(int32 RequestId, const FAICompanionInboundMessage& Reply);
+
+	/** Forget a request that was never sent; no callback */
+	void Forget(int32 RequestId);
+
+	/** Fire Cancelled for everything still pending (owner shutting down) */
+	void CancelAll();
+
+	/** Expire timed-out requests and push stats. Call once per frame. */
+	void Tick(double Now);
+
+	int32 Num() const { return Pending.Num(); }
+	bool Contains(int32 RequestId) const { return Pending.Contains(RequestId); }
+
+	const FAICompanionLatencyHistogram& GetHistogram(EAICompanionLatencyMetric Metric) const { return Histograms[(int32)Metric]; }
+	void ResetHistograms();
+
+private:
+	struct FPendingRequest
+	{
+		double StartSeconds = 0.0;
+		double Deadline = 0.0;
+		EAICompanionLatencyMetric Metric = EAICompanionLatencyMetric::ChatResponse;
+		bool bSawFirstChunk = false;
+		FAICompanionRequestCallback Callback;
+	};
+
+	void Finish(int32 RequestId, EAICompanionRequestResult Result, const FAICompanionInboundMessage& Reply);
+	void RecordLatency(EAICompanionLatencyMetric Metric, double StartSeconds);
+	void PublishStats();
+
+	TMap<int32, FPendingRequest> Pending;
+	FAICompanionLatencyHistogram Histograms[(int32)EAICompanionLatencyMetric::Count];
+	int32 NextRequestId = 1;
+	bool bStatsDirty = false;
+
+	/** Scratch list for Tick, so callbacks can start new requests while we expire old ones */
+	TArray<int32> Expired;
+};
@@ -0,0 +1,174 @@
+// AICompanionResponseCache.cpp
+// Prompt normalization and LRU bookkeeping
+
+#include "AICompanionResponseCache.h"
+#include "Hash/CityHash.h"
+#include "Misc/StringBuilder.h"
+
+FAICompanionResponseCache::FAICompanionResponseCache()
+{
+	Configure(64, 64 * 1024, 300.0f);
+}
+
+void FAICompanionResponseCache::Configure(int32 MaxEntries, int32 MaxChars, float TimeToLiveSeconds)
+{
+	Entries.SetNum(FMath::Max(MaxEntries, 1));
+	MaxTotalChars = FMath::Max(MaxChars, 1);
+	TimeToLive = FMath::Max((double)TimeToLiveSeconds, 0.0);
+	Reset();
+}
+
+void FAICompanionResponseCache::Reset()
+{
+	Index.Reset();
+	FreeSlots.Reset();
+	for (int32 Slot = Entries.Num() - 1; Slot >= 0; --Slot)
+	{
+		Entries[Slot].Response.Reset();
+		Entries[Slot].Prev = INDEX_NONE;
+		Entries[Slot].Next = INDEX_NONE;
+		FreeSlots.Add(Slot);
+	}
+	Head = INDEX_NONE;
+	Tail = INDEX_NONE;
+	TotalChars = 0;
+}
+
+uint64 FAICompanionResponseCache::MakeKey(FStringView Prompt, uint32 ContextVersion)
+{
+	// Lowercase, single spaces, no surrounding whitespace or trailing punctuation
+	TStringBuilder<256> Normalized;
+	bool bPendingSpace = false;
+	for (const TCHAR Char : Prompt)
+	{
+		if (FChar::IsWhitespace(Char))
+		{
+			bPendingSpace = Normalized.Len() > 0;
+			continue;
+		}
+		if (bPendingSpace)
+		{
+			Normalized.AppendChar(TEXT(' '));
+			bPendingSpace = false;
+		}
+		Normalized.AppendChar(FChar::ToLower(Char));
+	}
+
+	int32 Length = Normalized.Len();
+	while (Length > 0 && (Normalized.GetData()[Length - 1] == TEXT('.') || Normalized.GetData()[Length - 1] == TEXT('!') || Normalized.GetData()[Length - 1] == TEXT('?')))
+	{
+		--Length;
+	}
+
+	FTCHARToUTF8 Utf8(Normalized.GetData(), Length);
+	return CityHash64WithSeed(Utf8.Get(), (uint32)Utf8.Length(), ContextVersion);
+}
+
+const FString* FAICompanionResponseCache::Find(uint64 Key, double Now)
+{
+	const int32* Slot = Index.Find(Key);
+	if (!Slot)
+	{
+		++Misses;
+		return nullptr;
+	}
+
+	const int32 Found = *Slot;
+	if (Entries[Found].ExpiresAt <= Now)
+	{
+		Remove(Found);
+		++Misses;
+		return nullptr;
+	}
+
+	if (Head != Found)
+	{
+		Unlink(Found);
+		LinkFront(Found);
+	}
+
+	++Hits;
+	return &Entries[Found].Response;
+}
+
+void FAICompanionResponseCache::Add(uint64 Key, const FString& Response, double Now)
+{
+	// Anything that alone exceeds the budget is not worth evicting everything for
+	if (Response.IsEmpty() || Response.Len() > MaxTotalChars / 2 || TimeToLive <= 0.0)
+	{
+		return;
+	}
+
+	if (const int32* Existing = Index.Find(Key))
+	{
+		Remove(*Existing);
+	}
+
+	while (Tail != INDEX_NONE && (FreeSlots.Num() == 0 || TotalChars + Response.Len() > MaxTotalChars))
+	{
+		Remove(Tail);
+	}
+
+	const int32 Slot = FreeSlots.Pop(EAllowShrinking::No);
+	FEntry& Entry = Entries[Slot];
+	Entry.Key = Key;
+	Entry.ExpiresAt = Now + TimeToLive;
+
+	// Assignment reuses the slot's previous allocation when it is large enough
+	Entry.Response = Response;
+
+	Index.Add(Key, Slot);
+	LinkFront(Slot);
+	TotalChars += Response.Len();
+}
+
+void FAICompanionResponseCache::Remove(int32 Slot)
+{
+	FEntry& Entry = Entries[Slot];
+	Unlink(Slot);
+	Index.Remove(Entry.Key);
+	TotalChars -= Entry.Response.Len();
+	Entry.Response.Reset();
+	FreeSlots.Add(Slot);
+}
+
+void FAICompanionResponseCache::Unlink(int32 Slot)
+{
+	FEntry& Entry = Entries[Slot];
+	if (Entry.Prev != INDEX_NONE)
+	{
+		Entries[Entry.Prev].Next = Entry.Next;
+	}
+	else
+	{
+		Head = Entry.Next;
+	}
+
+	if (Entry.Next != INDEX_NONE)
+	{
+		Entries[Entry.Next].Prev = Entry.Prev;
+	}
+	else
+	{
+		Tail = Entry.Prev;
+	}
+
+	Entry.Prev = INDEX_NONE;
+	Entry.Next = INDEX_NONE;
+}
+
+void FAICompanionResponseCache::LinkFront(int32 Slot)
+{
+	FEntry& Entry = Entries[Slot];
+	Entry.Prev = INDEX_NONE;
+	Entry.Next = Head;
+	if (Head != INDEX_NONE)
+	{
+		Entries[Head].Prev = Slot;
+	}
+	Head = Slot;
+	if (Tail == INDEX_NONE)
+	{
+		Tail = Slot;
+	}
+}
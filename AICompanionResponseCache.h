@@ -0,0 +1,66 @@
+// AICompanionResponseCache.h
+// Client-side cache of chat responses for repeated prompts
+//
+// Keyed by a hash of the normalized prompt ("Hello there!" and "  hello   THERE"
+// share an entry) seeded with a context version, so bumping the version retires
+// every entry at once. Entries expire after a TTL; beyond the entry or character
+// limit the least recently used are evicted.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FAICompanionResponseCache
+{
+public:
+	FAICompanionResponseCache();
+
+	/** Sets the limits and clears the cache */
+	void Configure(int32 MaxEntries, int32 MaxChars, float TimeToLiveSeconds);
+
+	/** Hash of the normalized prompt under a context version */
+	static uint64 MakeKey(FStringView Prompt, uint32 ContextVersion);
+
+	/** Valid cached response, or null. Refreshes its LRU position. Expired entries are dropped here. */
+	const FString* Find(uint64 Key, double Now);
+
+	void Add(uint64 Key, const FString& Response, double Now);
+
+	void Reset();
+
+	int32 Num() const { return Index.Num(); }
+	uint64 GetHitCount() const { return Hits; }
+	uint64 GetMissCount() const { return Misses; }
+
+private:
+	struct FEntry
+	{
+		uint64 Key = 0;
+		double ExpiresAt = 0.0;
+		FString Response;
+
+		// Intrusive LRU list over Entries; INDEX_NONE terminated
+		int32 Prev = INDEX_NONE;
+		int32 Next = INDEX_NONE;
+	};
+
+	void Unlink(int32 Slot);
+	void LinkFront(int32 Slot);
+	void Remove(int32 Slot);
+
+	/** Fixed slots; slots not in Index are on the free list */
+	TArray<FEntry> Entries;
+	TArray<int32> FreeSlots;
+	TMap<uint64, int32> Index;
+
+	/** Most recently used first */
+	int32 Head = INDEX_NONE;
+	int32 Tail = INDEX_NONE;
+
+	int32 MaxTotalChars = 0;
+	int32 TotalChars = 0;
+	double TimeToLive = 0.0;
+
+	uint64 Hits = 0;
+	uint64 Misses = 0;
+};
@@ -0,0 +1,187 @@
+// AICompanionSendQueue.cpp
+// Outbound queue, batch coalescing and replay
+
+#include "AICompanionSendQueue.h"
+#include "AICompanionLog.h"
+
+FAICompanionSendQueue::FAICompanionSendQueue(int32 InCapacity)
+{
+	SetCapacity(InCapacity);
+}
+
+void FAICompanionSendQueue::SetCapacity(int32 InCapacity)
+{
+	Slots.Reset();
+	Slots.SetNum(FMath::Max(InCapacity, 1));
+	Head = 0;
+	Count = 0;
+	SentCount = 0;
+	BaseSeq = 0;
+}
+
+FAICompanionSendQueue::FEntry* FAICompanionSendQueue::AllocSlot()
+{
+	if (Count == Slots.Num())
+	{
+		++DroppedCount;
+		UE_LOG(LogAICompanion, Warning, TEXT("[AICompanionSendQueue] Queue full (%d messages, %d unacknowledged), dropping message"), Count, SentCount);
+		return nullptr;
+	}
+
+	FEntry& Entry = Peek(Count++);
+	Entry.Text.Reset();
+	Entry.Bytes.Reset();
+	return &Entry;
+}
+
+bool FAICompanionSendQueue::Enqueue(const FAICompanionMessageWriter& Writer)
+{
+	if (!Writer.IsBinary())
+	{
+		return EnqueueText(Writer.GetText());
+	}
+
+	FEntry* Entry = AllocSlot();
+	if (!Entry)
+	{
+		return false;
+	}
+
+	Entry->bBinary = true;
+	Entry->Bytes.Append(Writer.GetBytes());
+	return true;
+}
+
+bool FAICompanionSendQueue::EnqueueText(FStringView Text)
+{
+	FEntry* Entry = AllocSlot();
+	if (!Entry)
+	{
+		return false;
+	}
+
+	Entry->bBinary = false;
+	Entry->Text.Append(Text.GetData(), Text.Len());
+	Entry->TextBytes = FTCHARToUTF8_Convert::ConvertedLength(Text.GetData(), Text.Len());
+	return true;
+}
+
+void FAICompanionSendQueue::Pop(int32 Number)
+{
+	Head = (Head + Number) % Slots.Num();
+	Count -= Number;
+	SentCount -= Number;
+	BaseSeq += Number;
+}
+
+void FAICompanionSendQueue::Acknowledge(uint64 Ack)
+{
+	if (Ack > BaseSeq)
+	{
+		Pop((int32)FMath::Min<uint64>(Ack - BaseSeq, (uint64)SentCount));
+	}
+}
+
+void FAICompanionSendQueue::Rewind()
+{
+	SentCount = 0;
+}
+
+void FAICompanionSendQueue::RestartSequence()
+{
+	SentCount = 0;
+	BaseSeq = 0;
+}
+
+void FAICompanionSendQueue::Flush(const FFlushParams& Params, TFunctionRef<void(const FString&)> SendText, TFunctionRef<void(const TArray<uint8>&)> SendBinary)
+{
+	// Nothing will acknowledge what is retained; let it go
+	if (!Params.bRetainUntilAcked && SentCount > 0)
+	{
+		Pop(SentCount);
+	}
+
+	while (SentCount < Count)
+	{
+		FEntry& First = Peek(SentCount);
+		int32 RunLength = 1;
+
+		if (First.bBinary && !Params.bCanSendBinary)
+		{
+			// Encoded for a binary connection that came back as JSON-only
+			if (AICompanionProtocol::TranscodeBinaryToJson(First.Bytes, BatchText))
+			{
+				SendText(BatchText);
+			}
+			else
+			{
+				UE_LOG(LogAICompanion, Error, TEXT("[AICompanionSendQueue] Could not convert queued binary message to JSON"));
+			}
+		}
+		else
+		{
+			// Take the longest run of same-format messages that fits the batch budget
+			int32 RunBytes = First.Size();
+			if (Params.bCanBatch)
+			{
+				while (SentCount + RunLength < Count)
+				{
+					const FEntry& Next = Peek(SentCount + RunLength);
+					if (Next.bBinary != First.bBinary || RunBytes + Next.Size() > Params.MaxBatchBytes)
+					{
+						break;
+					}
+					RunBytes += Next.Size();
+					++RunLength;
+				}
+			}
+
+			if (RunLength == 1)
+			{
+				if (First.bBinary)
+				{
+					SendBinary(First.Bytes);
+				}
+				else
+				{
+					SendText(First.Text);
+				}
+			}
+			else if (First.bBinary)
+			{
+				BatchBytes.Reset();
+				AICompanionProtocol::BeginBinaryBatch(BatchBytes, RunLength);
+				for (int32 Index = 0; Index < RunLength; ++Index)
+				{
+					AICompanionProtocol::AppendBinaryBatchEntry(BatchBytes, Peek(SentCount + Index).Bytes);
+				}
+				SendBinary(BatchBytes);
+			}
+			else
+			{
+				// Entries are complete JSON documents, so the batch is plain concatenation
+				BatchText.Reset();
+				BatchText.Append(TEXT("{\"type\":\"batch\",\"messages\":["));
+				for (int32 Index = 0; Index < RunLength; ++Index)
+				{
+					if (Index > 0)
+					{
+						BatchText.AppendChar(TEXT(','));
+					}
+					BatchText.Append(Peek(SentCount + Index).Text);
+				}
+				BatchText.AppendChars(TEXT("]}"), 2);
+				SendText(BatchText);
+			}
+		}
+
+		++FramesSent;
+		MessagesSent += RunLength;
+		SentCount += RunLength;
+
+		if (!Params.bRetainUntilAcked)
+		{
+			Pop(RunLength);
+		}
+	}
+}
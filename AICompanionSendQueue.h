@@ -0,0 +1,120 @@
+// AICompanionSendQueue.h
+// Bounded outbound queue in front of the socket
+// Messages wait here while disconnected and are coalesced into batch frames when flushed
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AICompanionProtocol.h"
+
+/**
+ * Fixed-capacity FIFO of encoded messages.
+ *
+ * Slots are recycled in a ring, so each keeps the buffer capacity of the largest
+ * message it has held. When the queue is full new messages are rejected and
+ * counted, leaving the caller to decide what to do (backpressure).
+ *
+ * With a resumable session, sent messages stay in the ring until the backend
+ * acknowledges them, so they can be replayed after a reconnect. Messages are
+ * numbered implicitly: the n-th message sent in a session has sequence n, and
+ * the backend acknowledges with the count of messages it has received.
+ */
+class FAICompanionSendQueue
+{
+public:
+	struct FFlushParams
+	{
+		/** Backend accepts batch frames (negotiated at registration) */
+		bool bCanBatch = false;
+
+		/** Connection is using bin1; binary messages are sent as JSON otherwise */
+		bool bCanSendBinary = false;
+
+		/** Keep sent messages until Acknowledge() (session can be resumed) */
+		bool bRetainUntilAcked = false;
+
+		/** Upper bound for one coalesced frame */
+		int32 MaxBatchBytes = 16 * 1024;
+	};
+
+	explicit FAICompanionSendQueue(int32 InCapacity = 256);
+
+	/** Drops anything queued and resizes the ring */
+	void SetCapacity(int32 InCapacity);
+
+	/** Copy a finished message into the queue. Returns false (and counts a drop) when full. */
+	bool Enqueue(const FAICompanionMessageWriter& Writer);
+
+	/** Queue an already-encoded JSON message */
+	bool EnqueueText(FStringView Text);
+
+	/** Send everything not yet sent, merging consecutive messages of the same format into batch frames */
+	void Flush(const FFlushParams& Params, TFunctionRef<void(const FString&)> SendText, TFunctionRef<void(const TArray<uint8>&)> SendBinary);
+
+	/** Release sent messages the backend has received (Ack = messages received this session) */
+	void Acknowledge(uint64 Ack);
+
+	/** Mark every retained message unsent so the next Flush replays it (session resumed) */
+	void Rewind();
+
+	/** Start numbering from zero for a new session; retained messages are replayed in it */
+	void RestartSequence();
+
+	/** Queued messages, including sent ones awaiting acknowledgement */
+	int32 Num() const { return Count; }
+	int32 GetCapacity() const { return Slots.Num(); }
+	bool IsEmpty() const { return Count == 0; }
+
+	/** Sent but not yet acknowledged */
+	int32 GetUnackedCount() const { return SentCount; }
+
+	/** Something is waiting for the next Flush() */
+	bool HasUnsent() const { return SentCount < Count; }
+
+	/** Messages rejected because the queue was full */
+	uint64 GetDroppedCount() const { return DroppedCount; }
+
+	/** Socket frames written (a batch counts once) */
+	uint64 GetFramesSent() const { return FramesSent; }
+
+	/** Messages written, batched or not (replays count again) */
+	uint64 GetMessagesSent() const { return MessagesSent; }
+
+private:
+	struct FEntry
+	{
+		bool bBinary = false;
+		FString Text;
+		TArray<uint8> Bytes;
+
+		/** Text as it goes out on the socket (UTF-8), measured once at enqueue */
+		int32 TextBytes = 0;
+
+		/** Wire size, for the MaxBatchBytes budget */
+		int32 Size() const { return bBinary ? Bytes.Num() : TextBytes; }
+	};
+
+	FEntry* AllocSlot();
+	FEntry& Peek(int32 Offset) { return Slots[(Head + Offset) % Slots.Num()]; }
+
+	/** Remove sent messages from the front */
+	void Pop(int32 Number);
+
+	TArray<FEntry> Slots;
+	int32 Head = 0;
+	int32 Count = 0;
+
+	/** The first SentCount entries have been sent and await acknowledgement */
+	int32 SentCount = 0;
+
+	/** Session sequence number of the entry at Head */
+	uint64 BaseSeq = 0;
+
+	// Scratch buffers for coalesced or transcoded frames, reused between flushes
+	FString BatchText;
+	TArray<uint8> BatchBytes;
+
+	uint64 DroppedCount = 0;
+	uint64 FramesSent = 0;
+	uint64 MessagesSent = 0;
+};
@@ -0,0 +1,804 @@
+// AICompanionSessionHost.cpp
+// Link pool, player registration and playerId routing
+
+#include "AICompanionSessionHost.h"
+#include "AICompanionLog.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/Paths.h"
+
+FAICompanionSessionHost::FAICompanionSessionHost(const FSettings& InSettings)
+	: Settings(InSettings)
+{
+	Settings.NumLinks = FMath::Max(Settings.NumLinks, 1);
+
+	for (int32 Index = 0; Index < Settings.NumLinks; ++Index)
+	{
+		TUniquePtr<FLink>& Link = Links.Add_GetRef(MakeUnique<FLink>());
+		Link->Decode = MakeUnique<FAICompanionDecodePipeline>();
+		Link->Queue.SetCapacity(Settings.MaxQueuedMessages);
+		Link->Heartbeat.Configure(Settings.Heartbeat);
+
+		Link->Socket = MakeShared<FAICompanionConnection>();
+		Link->Socket->OnTextFrame.BindRaw(this, &FAICompanionSessionHost::HandleLinkText, Index);
+		Link->Socket->OnBinaryFrame.BindRaw(this, &FAICompanionSessionHost::HandleLinkBinary, Index);
+		Link->Socket->OnConnectionChanged.BindRaw(this, &FAICompanionSessionHost::HandleLinkConnectionChanged, Index);
+		Link->Socket->OnError.BindRaw(this, &FAICompanionSessionHost::HandleLinkError, Index);
+	}
+}
+
+FAICompanionSessionHost::~FAICompanionSessionHost()
+{
+	bWantsConnection = false;
+
+	for (TUniquePtr<FLink>& Link : Links)
+	{
+		// Nothing may call back into a host that is going away
+		Link->Socket->OnTextFrame.Unbind();
+		Link->Socket->OnBinaryFrame.Unbind();
+		Link->Socket->OnConnectionChanged.Unbind();
+		Link->Socket->OnError.Unbind();
+		Link->Socket->Close();
+
+		// Waits for in-flight decodes
+		Link->Decode.Reset();
+	}
+
+	Requests.CancelAll();
+
+	for (TPair<FString, TUniquePtr<FPlayer>>& Pair : Players)
+	{
+		WaitForMemoryLoad(*Pair.Value);
+		Pair.Value->MemoryStore.Close();
+	}
+}
+
+void FAICompanionSessionHost::Connect()
+{
+	bWantsConnection = true;
+
+	for (TUniquePtr<FLink>& Link : Links)
+	{
+		Link->ReconnectAt = 0.0;
+		if (!Link->Socket->IsConnected())
+		{
+			Link->Socket->Connect(Settings.URL);
+		}
+	}
+
+	UE_LOG(LogAICompanion, Log, TEXT("[AICompanionSessionHost] Connecting %d links to %s"), Links.Num(), *Settings.URL);
+}
+
+void FAICompanionSessionHost::Disconnect()
+{
+	bWantsConnection = false;
+
+	for (TUniquePtr<FLink>& Link : Links)
+	{
+		Link->ReconnectAt = 0.0;
+		Link->Socket->Close();
+	}
+}
+
+void FAICompanionSessionHost::Tick(double Now)
+{
+	for (int32 Index = 0; Index < Links.Num(); ++Index)
+	{
+		// Per link, so a player's replies stay in the order its link received them
+		FAICompanionInboundMessage Message;
+		while (Links[Index]->Decode->Dequeue(Message))
+		{
+			DispatchMessage(Index, Message);
+		}
+
+		UpdateLink(Index, Now);
+	}
+
+	Requests.Tick(Now);
+
+	for (TPair<FString, TUniquePtr<FPlayer>>& Pair : Players)
+	{
+		// Drop partial responses whose request timed out
+		FPlayer& Player = *Pair.Value;
+		if (Player.StreamingResponses.Num() > 0)
+		{
+			for (auto It = Player.StreamingResponses.CreateIterator(); It; ++It)
+			{
+				if (It.Key() != 0 && !Requests.Contains(It.Key()))
+				{
+					It.RemoveCurrent();
+				}
+			}
+		}
+
+		if (Player.bMemoryLoading)
+		{
+			if (Player.MemoryLoadTask.IsCompleted())
+			{
+				FinishMemoryLoad(Player);
+			}
+			continue;
+		}
+		Player.MemoryStore.Tick();
+	}
+}
+
+void FAICompanionSessionHost::UpdateLink(int32 LinkIndex, double Now)
+{
+	FLink& Link = *Links[LinkIndex];
+
+	if (Link.ReconnectAt > 0.0 && Now >= Link.ReconnectAt)
+	{
+		Link.ReconnectAt = 0.0;
+		if (bWantsConnection && !Link.Socket->IsConnected())
+		{
+			Link.Socket->Connect(Settings.URL);
+		}
+		return;
+	}
+
+	if (!Link.bReady || !Link.Socket->IsConnected())
+	{
+		return;
+	}
+
+	if (!Link.Queue.IsEmpty())
+	{
+		// Nothing is retained: a link that drops registers its players again instead of replaying
+		FAICompanionSendQueue::FFlushParams Params;
+		Params.bCanBatch = Link.bAcceptsBatch;
+		Params.bCanSendBinary = Link.Format == EAICompanionWireFormat::Binary;
+		Params.bRetainUntilAcked = false;
+		Params.MaxBatchBytes = Settings.MaxBatchBytes;
+
+		Link.Queue.Flush(Params,
+			[this, &Link](const FString& Frame) { Transmit(Link, Frame); },
+			[this, &Link](const TArray<uint8>& Frame) { TransmitBinary(Link, Frame); });
+	}
+
+	if (Link.bHeartbeatRunning)
+	{
+		switch (Link.Heartbeat.Update(Now))
+		{
+		case FAICompanionHeartbeat::EAction::SendPing:
+			SendPing(LinkIndex);
+			break;
+		case FAICompanionHeartbeat::EAction::ConnectionDead:
+			UE_LOG(LogAICompanion, Warning, TEXT("[AICompanionSessionHost] Link %d stopped answering pings, reconnecting"), LinkIndex);
+			Link.Socket->Abandon();
+			break;
+		default:
+			break;
+		}
+	}
+}
+
+bool FAICompanionSessionHost::AddPlayer(const FString& PlayerId)
+{
+	if (PlayerId.IsEmpty() || Players.Contains(PlayerId))
+	{
+		return false;
+	}
+
+	// Least loaded link; ties go to the lowest index so a quiet server fills link 0 first
+	int32 LinkIndex = 0;
+	for (int32 Index = 1; Index < Links.Num(); ++Index)
+	{
+		if (Links[Index]->NumPlayers < Links[LinkIndex]->NumPlayers)
+		{
+			LinkIndex = Index;
+		}
+	}
+
+	FPlayer& Player = *Players.Add(PlayerId, MakeUnique<FPlayer>());
+	Player.PlayerId = PlayerId;
+	Player.Link = LinkIndex;
+	Player.Conversation.Configure(Settings.MaxConversationTurns, Settings.ConversationHistoryChars, Settings.ConversationSummaryChars);
+	++Links[LinkIndex]->NumPlayers;
+
+	// One directory per player, so stores never see each other's generation files. Opening maps
+	// the snapshot and replays the log, which is file I/O; Tick picks up the result.
+	if (Settings.bPersistMemory && !Settings.MemoryDirectory.IsEmpty())
+	{
+		Player.bMemoryLoading = true;
+		Player.MemoryLoadTask = UE::Tasks::Launch(UE_SOURCE_LOCATION,
+			[Store = &Player.MemoryStore, Directory = Settings.MemoryDirectory / FPaths::MakeValidFileName(PlayerId), Name = Settings.MemoryStoreName, MaxTurns = Settings.MaxConversationTurns]()
+			{
+				return Store->Open(Directory, Name, MaxTurns);
+			});
+	}
+
+	UE_LOG(LogAICompanion, Log, TEXT("[AICompanionSessionHost] Player %s added on link %d (%d players)"), *PlayerId, LinkIndex, Players.Num());
+
+	// Otherwise registered when the link's connected frame arrives
+	if (Links[LinkIndex]->bReady)
+	{
+		RegisterOnLink(Player);
+	}
+	return true;
+}
+
+void FAICompanionSessionHost::RemovePlayer(const FString& PlayerId)
+{
+	TUniquePtr<FPlayer> Player;
+	if (!Players.RemoveAndCopyValue(PlayerId, Player))
+	{
+		return;
+	}
+
+	FLink& Link = *Links[Player->Link];
+	--Link.NumPlayers;
+
+	// Queued behind anything the player still has waiting, so those go out first
+	if (Link.bReady)
+	{
+		Link.Queue.Enqueue(BeginMessage(*Player, TEXT("unregister")).Finish());
+	}
+
+	WaitForMemoryLoad(*Player);
+	Player->MemoryStore.Close();
+	UE_LOG(LogAICompanion, Log, TEXT("[AICompanionSessionHost] Player %s removed (%d players)"), *PlayerId, Players.Num());
+}
+
+bool FAICompanionSessionHost::IsPlayerRegistered(const FString& PlayerId) const
+{
+	const FPlayer* Player = FindPlayer(PlayerId);
+	return Player && Player->bRegistered;
+}
+
+int32 FAICompanionSessionHost::NumConnectedLinks() const
+{
+	int32 Connected = 0;
+	for (const TUniquePtr<FLink>& Link : Links)
+	{
+		Connected += Link->bReady ? 1 : 0;
+	}
+	return Connected;
+}
+
+void FAICompanionSessionHost::SendChat(const FString& PlayerId, const FString& Message)
+{
+	FPlayer* Player = FindPlayer(PlayerId);
+	if (!Player)
+	{
+		UE_LOG(LogAICompanion, Warning, TEXT("[AICompanionSessionHost] Chat for unknown player %s"), *PlayerId);
+		return;
+	}
+
+	// While a dialogue runs, everything the player says answers its question
+	if (Player->Dialogue.IsActive())
+	{
+		RecordTurn(*Player, FAICompanionConversationHistory::ERole::User, Message);
+		HandleDialogueResult(*Player, Player->Dialogue.Submit(Message));
+		return;
+	}
+
+	SendChatRequest(PlayerId, Message);
+}
+
+int32 FAICompanionSessionHost::SendChatRequest(const FString& PlayerId, const FString& Message, FAICompanionRequestCallback Callback)
+{
+	FPlayer* Player = FindPlayer(PlayerId);
+	if (!Player)
+	{
+		return 0;
+	}
+
+	const int32 RequestId = Requests.Begin(EAICompanionLatencyMetric::ChatResponse, Settings.RequestTimeoutSeconds, MoveTemp(Callback));
+
+	BeginMessage(*Player, TEXT("chat"))
+		.WriteString(TEXT("text"), Message)
+		.WriteBool(TEXT("stream"), Settings.bStreamResponses)
+		.WriteInt(TEXT("requestId"), RequestId);
+
+	if (!Links[Player->Link]->Queue.Enqueue(Writer.Finish()))
+	{
+		UE_LOG(LogAICompanion, Warning, TEXT("[AICompanionSessionHost] Chat for %s dropped: link %d queue full"), *PlayerId, Player->Link);
+		Requests.Forget(RequestId);
+		return 0;
+	}
+
+	RecordTurn(*Player, FAICompanionConversationHistory::ERole::User, Message);
+	return RequestId;
+}
+
+bool FAICompanionSessionHost::StartDialogue(const FString& PlayerId, TSharedRef<const FAICompanionDialogueFlow> Flow, bool bSkipOptional)
+{
+	FPlayer* Player = FindPlayer(PlayerId);
+	if (!Player)
+	{
+		return false;
+	}
+
+	if (Player->Dialogue.IsActive())
+	{
+		CancelDialogue(PlayerId);
+	}
+
+	Player->Dialogue.Start(Flow);
+	const FAICompanionDialogueSession::EResult Result = Player->Dialogue.Begin(bSkipOptional);
+	HandleDialogueResult(*Player, Result);
+	return Result == FAICompanionDialogueSession::EResult::Ask;
+}
+
+void FAICompanionSessionHost::CancelDialogue(const FString& PlayerId)
+{
+	FPlayer* Player = FindPlayer(PlayerId);
+	if (Player && Player->Dialogue.IsActive())
+	{
+		Player->Dialogue.Cancel();
+		HandleDialogueResult(*Player, FAICompanionDialogueSession::EResult::Cancelled);
+	}
+}
+
+bool FAICompanionSessionHost::IsDialogueActive(const FString& PlayerId) const
+{
+	const FPlayer* Player = FindPlayer(PlayerId);
+	return Player && Player->Dialogue.IsActive();
+}
+
+void FAICompanionSessionHost::HandleDialogueResult(FPlayer& Player, FAICompanionDialogueSession::EResult Result)
+{
+	switch (Result)
+	{
+	case FAICompanionDialogueSession::EResult::Ask:
+	case FAICompanionDialogueSession::EResult::Rejected:
+	{
+		// Same fallback as UAICompanionDialogueComponent for steps without a question
+		FString Question = Player.Dialogue.GetQuestion();
+		if (Question.IsEmpty())
+		{
+			Question = Player.Dialogue.BuildSummary() + TEXT("Should I go ahead?");
+		}
+		RecordTurn(Player, FAICompanionConversationHistory::ERole::Assistant, Question);
+		OnDialogueQuestion.ExecuteIfBound(Player.PlayerId, Player.Dialogue.GetFlowName(), Question);
+		break;
+	}
+	case FAICompanionDialogueSession::EResult::Completed:
+	case FAICompanionDialogueSession::EResult::Cancelled:
+		UE_LOG(LogAICompanion, Verbose, TEXT("[AICompanionSessionHost] Dialogue %s for %s %s"), *Player.Dialogue.GetFlowName().ToString(), *Player.PlayerId,
+			Result == FAICompanionDialogueSession::EResult::Completed ? TEXT("completed") : TEXT("cancelled"));
+		OnDialogueFinished.ExecuteIfBound(Player.PlayerId, Player.Dialogue, Result == FAICompanionDialogueSession::EResult::Completed);
+		break;
+	}
+}
+
+void FAICompanionSessionHost::SetMemory(const FString& PlayerId, const FString& Key, const FString& Value)
+{
+	FPlayer* Player = FindPlayer(PlayerId);
+	if (!Player)
+	{
+		return;
+	}
+
+	if (Player->bMemoryLoading)
+	{
+		Player->PendingPreferences.Add(Key, Value);
+	}
+	else if (Player->MemoryStore.IsOpen())
+	{
+		Player->MemoryStore.SetPreference(Key, Value);
+	}
+}
+
+bool FAICompanionSessionHost::GetMemory(const FString& PlayerId, const FString& Key, FString& OutValue) const
+{
+	const FPlayer* Player = FindPlayer(PlayerId);
+	if (!Player)
+	{
+		return false;
+	}
+
+	// The store belongs to its loading task until FinishMemoryLoad; only what was set meanwhile is known
+	if (Player->bMemoryLoading)
+	{
+		const FString* Pending = Player->PendingPreferences.Find(Key);
+		if (Pending)
+		{
+			OutValue = *Pending;
+		}
+		return Pending != nullptr;
+	}
+	return Player->MemoryStore.GetPreference(Key, OutValue);
+}
+
+FString FAICompanionSessionHost::GetConversationContext(const FString& PlayerId, int32 MaxChars) const
+{
+	FString Context;
+	if (const FPlayer* Player = FindPlayer(PlayerId))
+	{
+		Player->Conversation.BuildContext(MaxChars, Context);
+	}
+	return Context;
+}
+
+int32 FAICompanionSessionHost::GetQueuedMessageCount() const
+{
+	int32 Queued = 0;
+	for (const TUniquePtr<FLink>& Link : Links)
+	{
+		Queued += Link->Queue.Num();
+	}
+	return Queued;
+}
+
+uint64 FAICompanionSessionHost::GetSentFrameCount() const
+{
+	uint64 Frames = 0;
+	for (const TUniquePtr<FLink>& Link : Links)
+	{
+		Frames += Link->Queue.GetFramesSent();
+	}
+	return Frames;
+}
+
+void FAICompanionSessionHost::RecordTurn(FPlayer& Player, FAICompanionConversationHistory::ERole Role, const FString& Text)
+{
+	Player.Conversation.Add(Role, Text);
+
+	if (Player.bMemoryLoading)
+	{
+		Player.PendingStoreTurns.Emplace(Role, Text);
+	}
+	else
+	{
+		Player.MemoryStore.AppendTurn(Role, Text);
+	}
+}
+
+void FAICompanionSessionHost::FinishMemoryLoad(FPlayer& Player)
+{
+	const bool bOpened = Player.MemoryLoadTask.GetResult();
+	Player.bMemoryLoading = false;
+	Player.MemoryLoadTask = {};
+
+	if (bOpened)
+	{
+		// Persisted turns come before anything said while loading; rebuild the history in order
+		Player.Conversation.Reset();
+		Player.MemoryStore.ForEachTurn([&Player](FAICompanionConversationHistory::ERole Role, FStringView Text)
+		{
+			Player.Conversation.Add(Role, Text);
+		});
+
+		for (const TPair<FAICompanionConversationHistory::ERole, FString>& Turn : Player.PendingStoreTurns)
+		{
+			Player.Conversation.Add(Turn.Key, Turn.Value);
+			Player.MemoryStore.AppendTurn(Turn.Key, Turn.Value);
+		}
+		for (const TPair<FString, FString>& Preference : Player.PendingPreferences)
+		{
+			Player.MemoryStore.SetPreference(Preference.Key, Preference.Value);
+		}
+	}
+
+	UE_LOG(LogAICompanion, Verbose, TEXT("[AICompanionSessionHost] Memory store for %s %s (%d turns, %d preferences set while loading)"),
+		*Player.PlayerId, bOpened ? TEXT("loaded") : TEXT("unavailable"), Player.PendingStoreTurns.Num(), Player.PendingPreferences.Num());
+
+	Player.PendingStoreTurns.Reset();
+	Player.PendingPreferences.Reset();
+}
+
+void FAICompanionSessionHost::WaitForMemoryLoad(FPlayer& Player)
+{
+	if (Player.bMemoryLoading)
+	{
+		Player.MemoryLoadTask.Wait();
+		Player.bMemoryLoading = false;
+		Player.MemoryLoadTask = {};
+	}
+}
+
+FAICompanionMessageWriter& FAICompanionSessionHost::BeginMessage(const FPlayer& Player, const TCHAR* Type)
+{
+	Writer.SetFormat(Links[Player.Link]->Format);
+	return Writer.Begin(Type).WriteString(TEXT("playerId"), Player.PlayerId);
+}
+
+void FAICompanionSessionHost::RegisterOnLink(const FPlayer& Player)
+{
+	// Registration always goes out as JSON; the link switches to binary once the backend agrees
+	Writer.SetFormat(EAICompanionWireFormat::Json);
+	Writer.Begin(TEXT("register"))
+		.WriteString(TEXT("playerId"), Player.PlayerId)
+		.WriteBool(TEXT("multiplex"), true);
+
+	if (Settings.bUseBinaryProtocol)
+	{
+		Writer.WriteString(TEXT("wire"), AICOMPANION_BINARY_WIRE_NAME);
+		if (Settings.bCompressFrames)
+		{
+			Writer.WriteString(TEXT("compression"), AICOMPANION_COMPRESSION_NAME);
+		}
+	}
+
+	// Ahead of anything queued - the backend rejects a player's messages until it is registered
+	Writer.Finish();
+	SendImmediate(Player.Link);
+}
+
+void FAICompanionSessionHost::SendPing(int32 LinkIndex)
+{
+	FLink& Link = *Links[LinkIndex];
+	const int32 RequestId = Requests.Begin(EAICompanionLatencyMetric::PingRTT, 10.0f);
+
+	// Pings are for the socket, not a player
+	Writer.SetFormat(Link.Format);
+	Writer.Begin(TEXT("ping"))
+		.WriteInt(TEXT("requestId"), RequestId)
+		.Finish();
+
+	if (SendImmediate(LinkIndex))
+	{
+		Link.Heartbeat.NotePingSent(RequestId, FPlatformTime::Seconds());
+	}
+	else
+	{
+		Requests.Forget(RequestId);
+	}
+}
+
+bool FAICompanionSessionHost::SendImmediate(int32 LinkIndex)
+{
+	FLink& Link = *Links[LinkIndex];
+	if (!Link.Socket->IsConnected())
+	{
+		return false;
+	}
+
+	if (Writer.IsBinary())
+	{
+		TransmitBinary(Link, Writer.GetBytes());
+	}
+	else
+	{
+		Transmit(Link, Writer.GetText());
+	}
+	return true;
+}
+
+void FAICompanionSessionHost::Transmit(FLink& Link, const FString& Frame)
+{
+	Link.Heartbeat.NoteSent(FPlatformTime::Seconds());
+	AICOMPANION_LOG_PAYLOAD(TEXT("[AICompanionSessionHost] >>"), Frame);
+	Link.Socket->SendText(Frame);
+}
+
+void FAICompanionSessionHost::TransmitBinary(FLink& Link, const TArray<uint8>& Frame)
+{
+	Link.Heartbeat.NoteSent(FPlatformTime::Seconds());
+	Link.Socket->SendBinary(Frame);
+}
+
+void FAICompanionSessionHost::HandleLinkText(const FString& Frame, int32 LinkIndex)
+{
+	AICOMPANION_LOG_PAYLOAD(TEXT("[AICompanionSessionHost] <<"), Frame);
+	Links[LinkIndex]->Heartbeat.NoteReceived(FPlatformTime::Seconds());
+	Links[LinkIndex]->Decode->Enqueue(Frame);
+}
+
+void FAICompanionSessionHost::HandleLinkBinary(TArray<uint8>& Frame, int32 LinkIndex)
+{
+	Links[LinkIndex]->Heartbeat.NoteReceived(FPlatformTime::Seconds());
+	Links[LinkIndex]->Decode->EnqueueBinary(MoveTemp(Frame));
+}
+
+void FAICompanionSessionHost::HandleLinkConnectionChanged(bool bConnected, int32 LinkIndex)
+{
+	UE_LOG(LogAICompanion, Log, TEXT("[AICompanionSessionHost] Link %d %s"), LinkIndex, bConnected ? TEXT("connected") : TEXT("disconnected"));
+
+	// Connected only opens the socket; the link is ready once the backend says hello
+	if (!bConnected)
+	{
+		HandleLinkLost(LinkIndex);
+	}
+}
+
+void FAICompanionSessionHost::HandleLinkError(const FString& Error, int32 LinkIndex)
+{
+	UE_LOG(LogAICompanion, Error, TEXT("[AICompanionSessionHost] Link %d error: %s"), LinkIndex, *Error);
+	HandleLinkLost(LinkIndex);
+}
+
+void FAICompanionSessionHost::HandleLinkLost(int32 LinkIndex)
+{
+	FLink& Link = *Links[LinkIndex];
+
+	// Every new connection starts in JSON until registration negotiates otherwise
+	Link.Format = EAICompanionWireFormat::Json;
+	Link.bAcceptsBatch = false;
+	Link.bReady = false;
+
+	if (Link.bHeartbeatRunning)
+	{
+		Link.bHeartbeatRunning = false;
+		Link.Heartbeat.NoteConnectionLost(FPlatformTime::Seconds());
+		Link.Heartbeat.Stop();
+	}
+
+	for (TPair<FString, TUniquePtr<FPlayer>>& Pair : Players)
+	{
+		if (Pair.Value->Link == LinkIndex)
+		{
+			Pair.Value->bRegistered = false;
+		}
+	}
+
+	ScheduleReconnect(LinkIndex);
+}
+
+void FAICompanionSessionHost::ScheduleReconnect(int32 LinkIndex)
+{
+	FLink& Link = *Links[LinkIndex];
+
+	// Errors and closes both report the same failure; retry once
+	if (!bWantsConnection || Link.ReconnectAt > 0.0)
+	{
+		return;
+	}
+
+	if (Settings.MaxReconnectAttempts > 0 && Link.ReconnectAttempt >= Settings.MaxReconnectAttempts)
+	{
+		UE_LOG(LogAICompanion, Error, TEXT("[AICompanionSessionHost] Link %d giving up after %d reconnect attempts"), LinkIndex, Link.ReconnectAttempt);
+		return;
+	}
+
+	// Same full-jitter backoff as AAICompanionManager::ScheduleReconnect
+	const float Ceiling = FMath::Min(Settings.ReconnectMaxDelay, Settings.ReconnectBaseDelay * FMath::Pow(2.0f, (float)FMath::Min(Link.ReconnectAttempt, 16)));
+	const float Delay = FMath::Max(FMath::FRandRange(0.0f, Ceiling), 0.01f);
+	++Link.ReconnectAttempt;
+	Link.ReconnectAt = FPlatformTime::Seconds() + Delay;
+
+	UE_LOG(LogAICompanion, Log, TEXT("[AICompanionSessionHost] Link %d reconnecting in %.2fs (attempt %d)"), LinkIndex, Delay, Link.ReconnectAttempt);
+}
+
+void FAICompanionSessionHost::DispatchMessage(int32 LinkIndex, const FAICompanionInboundMessage& Message)
+{
+	UE_LOG(LogAICompanion, Verbose, TEXT("[AICompanionSessionHost] Link %d received %s for %s"), LinkIndex, *Message.Type.ToString(), *Message.PlayerId);
+
+	// Socket-level messages carry no player
+	if (Message.Type == AICompanionMessageTypes::Connected)
+	{
+		HandleConnected(LinkIndex);
+		return;
+	}
+	if (Message.Type == AICompanionMessageTypes::Pong)
+	{
+		Links[LinkIndex]->Heartbeat.NotePong(Message.RequestId, FPlatformTime::Seconds());
+		ResolveRequest(Message);
+		return;
+	}
+	if (Message.Type == AICompanionMessageTypes::Registered)
+	{
+		HandleRegistered(LinkIndex, Message);
+		return;
+	}
+
+	// A reply can still arrive for a player that has just left; its request is settled all the same
+	FPlayer* Player = FindPlayer(Message.PlayerId);
+	if (Player)
+	{
+		if (Message.Type == AICompanionMessageTypes::ChatDelta)
+		{
+			if (!Message.Text.IsEmpty())
+			{
+				Player->StreamingResponses.FindOrAdd(Message.RequestId).Append(Message.Text);
+				OnDelta.ExecuteIfBound(Player->PlayerId, Message.Text);
+			}
+		}
+		else if (Message.Type == AICompanionMessageTypes::ChatResponse)
+		{
+			HandleChatResponse(*Player, Message);
+		}
+		else if (Message.Type == AICompanionMessageTypes::Error)
+		{
+			UE_LOG(LogAICompanion, Error, TEXT("[AICompanionSessionHost] Backend error for %s: %s"), *Player->PlayerId, *Message.Error);
+		}
+		else
+		{
+			OnUnhandledMessage.ExecuteIfBound(Message);
+		}
+	}
+	else if (Message.Type == AICompanionMessageTypes::Error)
+	{
+		UE_LOG(LogAICompanion, Error, TEXT("[AICompanionSessionHost] Backend error on link %d: %s"), LinkIndex, *Message.Error);
+	}
+
+	ResolveRequest(Message);
+}
+
+void FAICompanionSessionHost::HandleConnected(int32 LinkIndex)
+{
+	FLink& Link = *Links[LinkIndex];
+	Link.bReady = true;
+	Link.ReconnectAttempt = 0;
+
+	if (Settings.bEnableHeartbeat && !Link.bHeartbeatRunning)
+	{
+		Link.bHeartbeatRunning = true;
+		Link.Heartbeat.Start(FPlatformTime::Seconds());
+	}
+
+	int32 Registered = 0;
+	for (TPair<FString, TUniquePtr<FPlayer>>& Pair : Players)
+	{
+		if (Pair.Value->Link == LinkIndex)
+		{
+			RegisterOnLink(*Pair.Value);
+			++Registered;
+		}
+	}
+
+	UE_LOG(LogAICompanion, Log, TEXT("[AICompanionSessionHost] Link %d ready, registering %d players"), LinkIndex, Registered);
+}
+
+void FAICompanionSessionHost::HandleRegistered(int32 LinkIndex, const FAICompanionInboundMessage& Message)
+{
+	FLink& Link = *Links[LinkIndex];
+
+	// Negotiated per connection: the first registration decides for every player on it
+	if (Message.Payload.IsValid())
+	{
+		Message.Payload->TryGetBoolField(TEXT("batch"), Link.bAcceptsBatch);
+
+		FString Wire;
+		if (Settings.bUseBinaryProtocol && Message.Payload->TryGetStringField(TEXT("wire"), Wire) && Wire == AICOMPANION_BINARY_WIRE_NAME)
+		{
+			Link.Format = EAICompanionWireFormat::Binary;
+		}
+	}
+
+	if (FPlayer* Player = FindPlayer(Message.PlayerId))
+	{
+		Player->bRegistered = true;
+		UE_LOG(LogAICompanion, Verbose, TEXT("[AICompanionSessionHost] Player %s registered on link %d"), *Player->PlayerId, LinkIndex);
+		OnRegistered.ExecuteIfBound(Player->PlayerId, Message.Text);
+	}
+}
+
+void FAICompanionSessionHost::HandleChatResponse(FPlayer& Player, const FAICompanionInboundMessage& Message)
+{
+	// A streamed response may close with an empty chat_response; fall back to what was accumulated
+	FString Streamed;
+	Player.StreamingResponses.RemoveAndCopyValue(Message.RequestId, Streamed);
+	const FString& ResponseText = Message.Text.IsEmpty() ? Streamed : Message.Text;
+
+	if (!ResponseText.IsEmpty())
+	{
+		RecordTurn(Player, FAICompanionConversationHistory::ERole::Assistant, ResponseText);
+		OnResponse.ExecuteIfBound(Player.PlayerId, ResponseText);
+	}
+}
+
+void FAICompanionSessionHost::ResolveRequest(const FAICompanionInboundMessage& Message)
+{
+	if (Message.RequestId == 0)
+	{
+		return;
+	}
+
+	// Streamed chunks keep the request open; anything else answers it
+	if (Message.Type == AICompanionMessageTypes::ChatDelta || Message.Type == AICompanionMessageTypes::VoicePartial)
+	{
+		Requests.MarkFirstChunk(Message.RequestId);
+	}
+	else if (Message.Type == AICompanionMessageTypes::Error)
+	{
+		Requests.Fail(Message.RequestId, Message);
+	}
+	else
+	{
+		Requests.Complete(Message.RequestId, Message);
+	}
+}
+
+FAICompanionSessionHost::FPlayer* FAICompanionSessionHost::FindPlayer(const FString& PlayerId)
+{
+	TUniquePtr<FPlayer>* Found = Players.Find(PlayerId);
+	return Found ? Found->Get() : nullptr;
+}
+
+const FAICompanionSessionHost::FPlayer* FAICompanionSessionHost::FindPlayer(const FString& PlayerId) const
+{
+	const TUniquePtr<FPlayer>* Found = Players.Find(PlayerId);
+	return Found ? Found->Get() : nullptr;
+}
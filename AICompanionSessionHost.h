@@ -0,0 +1,225 @@
+// AICompanionSessionHost.h
+// Many player sessions over a small pool of backend sockets (dedicated servers)
+//
+// A listen or client build has one manager per player, each with its own socket.
+// On a dedicated server that is one TLS socket per connected player, so the host
+// keeps a few links instead and pins every player to one of them. A player
+// registers on its link with its playerId and tags every message with it; the
+// backend tags its replies the same way, so frames are routed back to the right
+// player. Each player keeps its own conversation, memory store and dialogue.
+//
+// Links do not resume sessions: after a reconnect every player on the link simply
+// registers again, and anything still queued goes out once it has.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Tasks/Task.h"
+#include "AICompanionConnection.h"
+#include "AICompanionProtocol.h"
+#include "AICompanionSendQueue.h"
+#include "AICompanionRequests.h"
+#include "AICompanionHeartbeat.h"
+#include "AICompanionConversation.h"
+#include "AICompanionMemoryStore.h"
+#include "AICompanionDialogueFlow.h"
+
+class FAICompanionSessionHost
+{
+public:
+	struct FSettings
+	{
+		FString URL;
+
+		/** Sockets shared by all players */
+		int32 NumLinks = 4;
+
+		/** Offer bin1 at registration (links always use the engine socket) */
+		bool bUseBinaryProtocol = false;
+
+		/** Offer dictionary compression along with bin1 */
+		bool bCompressFrames = true;
+
+		bool bStreamResponses = true;
+
+		/** Per link */
+		int32 MaxQueuedMessages = 256;
+		int32 MaxBatchBytes = 16 * 1024;
+
+		float RequestTimeoutSeconds = 30.0f;
+
+		float ReconnectBaseDelay = 0.5f;
+		float ReconnectMaxDelay = 30.0f;
+
+		/** 0 = keep trying */
+		int32 MaxReconnectAttempts = 0;
+
+		bool bEnableHeartbeat = true;
+		FAICompanionHeartbeat::FSettings Heartbeat;
+
+		/** Each player gets a store named MemoryStoreName in MemoryDirectory/<PlayerId> */
+		bool bPersistMemory = true;
+		FString MemoryDirectory;
+		FString MemoryStoreName = TEXT("Memory");
+
+		int32 MaxConversationTurns = 64;
+		int32 ConversationHistoryChars = 32 * 1024;
+		int32 ConversationSummaryChars = 1024;
+	};
+
+	DECLARE_DELEGATE_TwoParams(FOnPlayerText, const FString& /*PlayerId*/, const FString& /*Text*/);
+	DECLARE_DELEGATE_ThreeParams(FOnPlayerDialogueQuestion, const FString& /*PlayerId*/, FName /*FlowName*/, const FString& /*Question*/);
+	DECLARE_DELEGATE_ThreeParams(FOnPlayerDialogueFinished, const FString& /*PlayerId*/, const FAICompanionDialogueSession& /*Session*/, bool /*bCompleted*/);
+	DECLARE_DELEGATE_OneParam(FOnPlayerMessage, const FAICompanionInboundMessage& /*Message - PlayerId is set*/);
+
+	explicit FAICompanionSessionHost(const FSettings& InSettings);
+	~FAICompanionSessionHost();
+
+	/** Open every link; each reconnects on its own until Disconnect */
+	void Connect();
+
+	void Disconnect();
+
+	/** Dispatch decoded frames, flush queues, run reconnects and heartbeats. Call once per frame. */
+	void Tick(double Now);
+
+	/** Start a session for a player (pinned to the least loaded link); false if it already exists */
+	bool AddPlayer(const FString& PlayerId);
+
+	/** Unregister the player on the backend and close its memory store */
+	void RemovePlayer(const FString& PlayerId);
+
+	bool HasPlayer(const FString& PlayerId) const { return Players.Contains(PlayerId); }
+	int32 NumPlayers() const { return Players.Num(); }
+
+	/** Backend has acknowledged the player's registration on its current link */
+	bool IsPlayerRegistered(const FString& PlayerId) const;
+
+	int32 NumConnectedLinks() const;
+
+	/** Answers the player's running dialogue if there is one, otherwise sends a chat request */
+	void SendChat(const FString& PlayerId, const FString& Message);
+
+	/** Chat request whose reply goes to Callback as well as OnResponse; 0 if unknown player or queue full */
+	int32 SendChatRequest(const FString& PlayerId, const FString& Message, FAICompanionRequestCallback Callback = FAICompanionRequestCallback());
+
+	/** Replace the player's dialogue with a new run of Flow; false if unknown player or nothing to ask */
+	bool StartDialogue(const FString& PlayerId, TSharedRef<const FAICompanionDialogueFlow> Flow, bool bSkipOptional = false);
+
+	void CancelDialogue(const FString& PlayerId);
+
+	bool IsDialogueActive(const FString& PlayerId) const;
+
+	void SetMemory(const FString& PlayerId, const FString& Key, const FString& Value);
+	bool GetMemory(const FString& PlayerId, const FString& Key, FString& OutValue) const;
+
+	/** Recent conversation for one player, as AAICompanionManager::GetConversationContext */
+	FString GetConversationContext(const FString& PlayerId, int32 MaxChars) const;
+
+	const FAICompanionRequestTable& GetRequests() const { return Requests; }
+
+	/** Sum over all links */
+	int32 GetQueuedMessageCount() const;
+	uint64 GetSentFrameCount() const;
+
+	FOnPlayerText OnRegistered;
+	FOnPlayerText OnResponse;
+	FOnPlayerText OnDelta;
+	FOnPlayerDialogueQuestion OnDialogueQuestion;
+	FOnPlayerDialogueFinished OnDialogueFinished;
+
+	/** Any player-tagged message type the host does not handle itself */
+	FOnPlayerMessage OnUnhandledMessage;
+
+private:
+	struct FLink
+	{
+		TSharedPtr<FAICompanionConnection> Socket;
+		TUniquePtr<FAICompanionDecodePipeline> Decode;
+		FAICompanionSendQueue Queue;
+		FAICompanionHeartbeat Heartbeat;
+
+		/** Negotiated by the first registration on this connection */
+		EAICompanionWireFormat Format = EAICompanionWireFormat::Json;
+		bool bAcceptsBatch = false;
+
+		/** The backend's connected frame arrived and the link's players have been registered */
+		bool bReady = false;
+		bool bHeartbeatRunning = false;
+
+		int32 ReconnectAttempt = 0;
+
+		/** 0 when no reconnect is pending */
+		double ReconnectAt = 0.0;
+
+		int32 NumPlayers = 0;
+	};
+
+	struct FPlayer
+	{
+		FString PlayerId;
+		int32 Link = 0;
+		bool bRegistered = false;
+
+		FAICompanionConversationHistory Conversation;
+		FAICompanionMemoryStore MemoryStore;
+		FAICompanionDialogueSession Dialogue;
+
+		/** Opens MemoryStore in the background, as the manager does; until it finishes, turns and preferences wait below */
+		UE::Tasks::TTask<bool> MemoryLoadTask;
+		bool bMemoryLoading = false;
+		TArray<TPair<FAICompanionConversationHistory::ERole, FString>> PendingStoreTurns;
+		TMap<FString, FString> PendingPreferences;
+
+		/** chat_delta chunks per requestId */
+		TMap<int32, FString> StreamingResponses;
+	};
+
+	void HandleLinkConnectionChanged(bool bConnected, int32 LinkIndex);
+	void HandleLinkError(const FString& Error, int32 LinkIndex);
+	void HandleLinkText(const FString& Frame, int32 LinkIndex);
+	void HandleLinkBinary(TArray<uint8>& Frame, int32 LinkIndex);
+	void HandleLinkLost(int32 LinkIndex);
+	void ScheduleReconnect(int32 LinkIndex);
+	void UpdateLink(int32 LinkIndex, double Now);
+
+	void DispatchMessage(int32 LinkIndex, const FAICompanionInboundMessage& Message);
+	void HandleConnected(int32 LinkIndex);
+	void HandleRegistered(int32 LinkIndex, const FAICompanionInboundMessage& Message);
+	void HandleChatResponse(FPlayer& Player, const FAICompanionInboundMessage& Message);
+	void ResolveRequest(const FAICompanionInboundMessage& Message);
+
+	void RegisterOnLink(const FPlayer& Player);
+	void SendPing(int32 LinkIndex);
+
+	/** Begin a message in the link's format, tagged with the player */
+	FAICompanionMessageWriter& BeginMessage(const FPlayer& Player, const TCHAR* Type);
+
+	bool SendImmediate(int32 LinkIndex);
+	void Transmit(FLink& Link, const FString& Frame);
+	void TransmitBinary(FLink& Link, const TArray<uint8>& Frame);
+
+	/** Take the store over from its loading task and replay what happened meanwhile */
+	void FinishMemoryLoad(FPlayer& Player);
+
+	/** Block until the loading task is done with the store, so it can be closed */
+	void WaitForMemoryLoad(FPlayer& Player);
+
+	void HandleDialogueResult(FPlayer& Player, FAICompanionDialogueSession::EResult Result);
+	void RecordTurn(FPlayer& Player, FAICompanionConversationHistory::ERole Role, const FString& Text);
+
+	FPlayer* FindPlayer(const FString& PlayerId);
+	const FPlayer* FindPlayer(const FString& PlayerId) const;
+
+	FSettings Settings;
+	bool bWantsConnection = false;
+
+	TArray<TUniquePtr<FLink>> Links;
+	TMap<FString, TUniquePtr<FPlayer>> Players;
+
+	/** Shared by all links; requestIds are unique across the host */
+	FAICompanionRequestTable Requests;
+
+	/** Shared encoder; switched to each link's format per message */
+	FAICompanionMessageWriter Writer;
+};
@@ -0,0 +1,42 @@
+// AICompanionSubsystem.cpp
+// Per-world registry of AI Companion managers
+
+#include "AICompanionSubsystem.h"
+#include "AICompanionManager.h"
+#include "Engine/World.h"
+
+void UAICompanionSubsystem::RegisterManager(AAICompanionManager* Manager)
+{
+	if (Manager)
+	{
+		Managers.AddUnique(Manager);
+		OnManagerRegistered.Broadcast(Manager);
+	}
+}
+
+void UAICompanionSubsystem::UnregisterManager(AAICompanionManager* Manager)
+{
+	Managers.RemoveAll([Manager](const TWeakObjectPtr<AAICompanionManager>& Entry)
+	{
+		return !Entry.IsValid() || Entry.Get() == Manager;
+	});
+}
+
+AAICompanionManager* UAICompanionSubsystem::GetManager() const
+{
+	for (const TWeakObjectPtr<AAICompanionManager>& Entry : Managers)
+	{
+		if (AAICompanionManager* Manager = Entry.Get())
+		{
+			return Manager;
+		}
+	}
+	return nullptr;
+}
+
+AAICompanionManager* UAICompanionSubsystem::FindManager(const UObject* WorldContextObject)
+{
+	const UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	const UAICompanionSubsystem* Subsystem = World ? World->GetSubsystem<UAICompanionSubsystem>() : nullptr;
+	return Subsystem ? Subsystem->GetManager() : nullptr;
+}
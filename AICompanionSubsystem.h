@@ -0,0 +1,39 @@
+// AICompanionSubsystem.h
+// Per-world registry of AI Companion managers
+// Lets components find the active manager without scanning the actor list
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "AICompanionSubsystem.generated.h"
+
+class AAICompanionManager;
+
+UCLASS()
+class JOEVISV3V1_API UAICompanionSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	DECLARE_MULTICAST_DELEGATE_OneParam(FOnManagerRegistered, AAICompanionManager* /*Manager*/);
+
+	/** Broadcast when a manager registers; for components that began play before any manager did */
+	FOnManagerRegistered OnManagerRegistered;
+
+	/** Called by AAICompanionManager in BeginPlay */
+	void RegisterManager(AAICompanionManager* Manager);
+
+	/** Called by AAICompanionManager in EndPlay (including when its level streams out) */
+	void UnregisterManager(AAICompanionManager* Manager);
+
+	/** The first registered manager still alive, or null */
+	UFUNCTION(BlueprintPure, Category = "AI Companion")
+	AAICompanionManager* GetManager() const;
+
+	/** Convenience lookup from any world context */
+	static AAICompanionManager* FindManager(const UObject* WorldContextObject);
+
+private:
+	TArray<TWeakObjectPtr<AAICompanionManager>> Managers;
+};
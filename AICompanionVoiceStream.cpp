@@ -0,0 +1,241 @@
+// AICompanionVoiceStream.cpp
+// Chunked microphone capture
+
+#include "AICompanionVoiceStream.h"
+#include "AICompanionLog.h"
+
+FAICompanionVoiceStream::FAICompanionVoiceStream(float InChunkSeconds)
+	: ChunkSeconds(FMath::Max(InChunkSeconds, 0.02f))
+{
+}
+
+FAICompanionVoiceStream::~FAICompanionVoiceStream()
+{
+	Stop();
+}
+
+bool FAICompanionVoiceStream::Prepare()
+{
+	if (bPrepared)
+	{
+		return true;
+	}
+
+	// Device enumeration is what makes the first open slow on most platforms
+	TArray<Audio::FCaptureDeviceInfo> Devices;
+	Capture.GetCaptureDevicesAvailable(Devices);
+
+	Audio::FCaptureDeviceInfo Default;
+	if (!Capture.GetCaptureDeviceInfo(Default))
+	{
+		UE_LOG(LogAICompanion, Warning, TEXT("[AICompanionVoiceStream] No capture device (%d listed)"), Devices.Num());
+		return false;
+	}
+
+	bPrepared = true;
+	UE_LOG(LogAICompanion, Verbose, TEXT("[AICompanionVoiceStream] Capture device %s (%d Hz, %d devices)"), *Default.DeviceName, Default.PreferredSampleRate, Devices.Num());
+	return true;
+}
+
+bool FAICompanionVoiceStream::Start()
+{
+	if (bCapturing)
+	{
+		return true;
+	}
+
+	// Size the slots for the rate the device will most likely deliver; a different
+	// rate only changes how long each chunk is, never their capacity
+	Audio::FCaptureDeviceInfo Info;
+	const int32 ExpectedRate = Capture.GetCaptureDeviceInfo(Info) && Info.PreferredSampleRate > 0 ? Info.PreferredSampleRate : 48000;
+	const int32 WantedSamples = FMath::Max(FMath::RoundToInt(ExpectedRate * ChunkSeconds), 1);
+	if (Slots.Num() == 0 || (WantedSamples != SlotSamples && ReadySlots.IsEmpty()))
+	{
+		AllocateSlots(WantedSamples);
+	}
+
+	Audio::FAudioCaptureDeviceParams Params;
+	Audio::FOnCaptureFunction OnCapture = [this](const float* AudioData, int32 NumFrames, int32 NumChannels, int32 SampleRate, double StreamTime, bool bOverflow)
+	{
+		OnAudioCaptured(AudioData, NumFrames, NumChannels, SampleRate);
+	};
+
+	if (!Capture.OpenCaptureStream(Params, MoveTemp(OnCapture), 1024))
+	{
+		UE_LOG(LogAICompanion, Error, TEXT("[AICompanionVoiceStream] Failed to open capture device"));
+		return false;
+	}
+
+	FillSlot = INDEX_NONE;
+	DroppedFrames.store(0, std::memory_order_relaxed);
+	if (!Capture.StartStream())
+	{
+		UE_LOG(LogAICompanion, Error, TEXT("[AICompanionVoiceStream] Failed to start capture"));
+		Capture.CloseStream();
+		return false;
+	}
+
+	bCapturing = true;
+	return true;
+}
+
+void FAICompanionVoiceStream::Stop()
+{
+	if (!bCapturing)
+	{
+		return;
+	}
+
+	Capture.StopStream();
+	Capture.CloseStream();
+
+	// No new callbacks after this point, but one may still be finishing; the game
+	// thread only takes over FillSlot and the ready ring once it has returned
+	while (bInCallback.load(std::memory_order_acquire))
+	{
+		FPlatformProcess::Yield();
+	}
+	bCapturing = false;
+
+	if (FillSlot != INDEX_NONE)
+	{
+		FSlotRing& Ring = Slots[FillSlot].NumBytes > 0 ? ReadySlots : FreeSlots;
+		Ring.Push(FillSlot);
+		FillSlot = INDEX_NONE;
+	}
+
+	if (const uint64 Dropped = DroppedFrames.load(std::memory_order_relaxed))
+	{
+		UE_LOG(LogAICompanion, Warning, TEXT("[AICompanionVoiceStream] Dropped %llu frames: no free chunk slot"), Dropped);
+	}
+}
+
+bool FAICompanionVoiceStream::DequeueChunk(FChunk& OutChunk)
+{
+	int32 Index = INDEX_NONE;
+	if (!ReadySlots.Pop(Index))
+	{
+		return false;
+	}
+
+	FSlot& Slot = Slots[Index];
+	OutChunk.Pcm16.Reset(Slot.NumBytes);
+	OutChunk.Pcm16.Append(Slot.Pcm16.GetData(), Slot.NumBytes);
+	OutChunk.SampleRate = Slot.SampleRate;
+
+	Slot.NumBytes = 0;
+	FreeSlots.Push(Index);
+	return true;
+}
+
+void FAICompanionVoiceStream::AllocateSlots(int32 InSlotSamples)
+{
+	check(!bCapturing);
+
+	// About two seconds of audio, so a long hitch on the game thread doesn't drop any
+	const int32 NumSlots = FMath::Clamp(FMath::CeilToInt(2.0f / ChunkSeconds), 4, 64);
+
+	SlotSamples = InSlotSamples;
+	Slots.SetNum(NumSlots);
+	FreeSlots.Init(NumSlots);
+	ReadySlots.Init(NumSlots);
+
+	for (int32 Index = 0; Index < NumSlots; ++Index)
+	{
+		Slots[Index].Pcm16.SetNumUninitialized(SlotSamples * (int32)sizeof(int16));
+		Slots[Index].NumBytes = 0;
+		FreeSlots.Push(Index);
+	}
+}
+
+void FAICompanionVoiceStream::OnAudioCaptured(const float* AudioData, int32 NumFrames, int32 NumChannels, int32 SampleRate)
+{
+	if (NumFrames <= 0 || NumChannels <= 0)
+	{
+		return;
+	}
+
+	bInCallback.store(true, std::memory_order_release);
+
+	const float ChannelScale = 1.0f / NumChannels;
+	int32 Frame = 0;
+
+	while (Frame < NumFrames)
+	{
+		if (FillSlot == INDEX_NONE && !FreeSlots.Pop(FillSlot))
+		{
+			FillSlot = INDEX_NONE;
+			DroppedFrames.fetch_add(NumFrames - Frame, std::memory_order_relaxed);
+			break;
+		}
+
+		FSlot& Slot = Slots[FillSlot];
+		if (Slot.NumBytes == 0)
+		{
+			Slot.SampleRate = SampleRate;
+		}
+
+		// Downmix to mono and convert to int16 straight into the slot
+		int16* Out = reinterpret_cast<int16*>(Slot.Pcm16.GetData()) + Slot.NumBytes / (int32)sizeof(int16);
+		const int32 Count = FMath::Min(NumFrames - Frame, SlotSamples - Slot.NumBytes / (int32)sizeof(int16));
+
+		for (int32 Index = 0; Index < Count; ++Index, ++Frame)
+		{
+			float Sample = 0.0f;
+			for (int32 Channel = 0; Channel < NumChannels; ++Channel)
+			{
+				Sample += AudioData[Frame * NumChannels + Channel];
+			}
+			Out[Index] = (int16)FMath::Clamp(FMath::RoundToInt(Sample * ChannelScale * 32767.0f), -32768, 32767);
+		}
+
+		Slot.NumBytes += Count * (int32)sizeof(int16);
+		if (Slot.NumBytes >= SlotSamples * (int32)sizeof(int16))
+		{
+			// Every slot fits in the ring, so this cannot fail
+			ReadySlots.Push(FillSlot);
+			FillSlot = INDEX_NONE;
+		}
+	}
+
+	bInCallback.store(false, std::memory_order_release);
+}
+
+// ============================================================================
+// Slot ring
+// ============================================================================
+
+void FAICompanionVoiceStream::FSlotRing::Init(int32 Capacity)
+{
+	// One spare entry tells a full ring from an empty one
+	Indices.SetNumZeroed(Capacity + 1);
+	Head.store(0, std::memory_order_relaxed);
+	Tail.store(0, std::memory_order_relaxed);
+}
+
+bool FAICompanionVoiceStream::FSlotRing::Push(int32 Slot)
+{
+	const int32 CurrentTail = Tail.load(std::memory_order_relaxed);
+	const int32 NextTail = (CurrentTail + 1) % Indices.Num();
+	if (NextTail == Head.load(std::memory_order_acquire))
+	{
+		return false;
+	}
+
+	Indices[CurrentTail] = Slot;
+	Tail.store(NextTail, std::memory_order_release);
+	return true;
+}
+
+bool FAICompanionVoiceStream::FSlotRing::Pop(int32& OutSlot)
+{
+	const int32 CurrentHead = Head.load(std::memory_order_relaxed);
+	if (CurrentHead == Tail.load(std::memory_order_acquire))
+	{
+		return false;
+	}
+
+	OutSlot = Indices[CurrentHead];
+	Head.store((CurrentHead + 1) % Indices.Num(), std::memory_order_release);
+	return true;
+}
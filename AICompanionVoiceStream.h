@@ -0,0 +1,107 @@
+// AICompanionVoiceStream.h
+// Microphone capture for streamed voice input (AudioCaptureCore module)
+// Audio is cut into small PCM chunks while recording so they can be uploaded as they fill
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AudioCaptureCore.h"
+#include <atomic>
+
+/**
+ * Captures the default input device as mono 16-bit PCM.
+ *
+ * The capture callback runs on the audio thread and only fills chunks;
+ * the owner drains them on the game thread with DequeueChunk().
+ *
+ * Chunk buffers are allocated up front by Start() and cycle between two
+ * single-producer rings: the audio thread takes empty slots from FreeSlots and
+ * hands full ones over through ReadySlots, the game thread copies them out and
+ * returns them. The callback never allocates; if the game thread falls so far
+ * behind that no slot is free, audio is dropped (and counted).
+ */
+class FAICompanionVoiceStream
+{
+public:
+	struct FChunk
+	{
+		/** Mono little-endian int16 samples */
+		TArray<uint8> Pcm16;
+		int32 SampleRate = 0;
+	};
+
+	explicit FAICompanionVoiceStream(float InChunkSeconds = 0.1f);
+	~FAICompanionVoiceStream();
+
+	/**
+	 * Enumerate capture devices ahead of the first Start(), which otherwise pays for it.
+	 * Safe on a background thread as long as nothing else uses the stream meanwhile.
+	 */
+	bool Prepare();
+
+	/** Open the default capture device and start filling chunks */
+	bool Start();
+
+	/** Stop capturing; whatever was recorded since the last full chunk is queued as a final chunk */
+	void Stop();
+
+	bool IsCapturing() const { return bCapturing; }
+
+	/** Pop the next finished chunk (game thread); OutChunk's buffer is reused, so keep one around */
+	bool DequeueChunk(FChunk& OutChunk);
+
+	/** Captured frames dropped because every chunk slot was waiting for the game thread */
+	uint64 GetDroppedFrames() const { return DroppedFrames.load(std::memory_order_relaxed); }
+
+private:
+	/** Fixed-capacity single-producer single-consumer ring of slot indices */
+	class FSlotRing
+	{
+	public:
+		void Init(int32 Capacity);
+		bool Push(int32 Slot);
+		bool Pop(int32& OutSlot);
+		bool IsEmpty() const { return Head.load(std::memory_order_acquire) == Tail.load(std::memory_order_acquire); }
+
+	private:
+		TArray<int32> Indices;
+		std::atomic<int32> Head{ 0 };
+		std::atomic<int32> Tail{ 0 };
+	};
+
+	struct FSlot
+	{
+		/** Sized once by Start(); NumBytes of it are filled */
+		TArray<uint8> Pcm16;
+		int32 NumBytes = 0;
+		int32 SampleRate = 0;
+	};
+
+	/** Size the slot pool for chunks of SlotSamples (game thread, not capturing) */
+	void AllocateSlots(int32 InSlotSamples);
+
+	void OnAudioCaptured(const float* AudioData, int32 NumFrames, int32 NumChannels, int32 SampleRate);
+
+	Audio::FAudioCapture Capture;
+
+	TArray<FSlot> Slots;
+	int32 SlotSamples = 0;
+
+	/** Empty slots: pushed by the game thread, popped by the audio thread */
+	FSlotRing FreeSlots;
+
+	/** Full slots: pushed by the audio thread (by Stop() once capture has ended), popped by the game thread */
+	FSlotRing ReadySlots;
+
+	/** Slot being filled; owned by the audio thread while capturing */
+	int32 FillSlot = INDEX_NONE;
+
+	/** Set while the audio thread is inside OnAudioCaptured, so Stop() can wait it out */
+	std::atomic<bool> bInCallback{ false };
+
+	std::atomic<uint64> DroppedFrames{ 0 };
+
+	float ChunkSeconds;
+	bool bCapturing = false;
+	bool bPrepared = false;
+};
@@ -3,10 +3,18 @@
 
 #include "CalendarDialogueComponent.h"
 #include "AICompanionManager.h"
-#include "Kismet/GameplayStatics.h"
+#include "AICompanionCalendarSlots.h"
+#include "AICompanionDateTimeParser.h"
+#include "AICompanionLog.h"
+#include "AICompanionSubsystem.h"
+#include "Algo/AnyOf.h"
+
+// Straight to UE_LOG, so lines compiled out of Shipping skip their formatting too
+#define CALENDAR_LOG(Verbosity, Format, ...) UE_LOG(LogAICompanion, Verbosity, TEXT("[CalendarDialogue] ") Format, ##__VA_ARGS__)
 
 UCalendarDialogueComponent::UCalendarDialogueComponent()
 {
+	// Driven entirely by answers and manager callbacks
 	PrimaryComponentTick.bCanEverTick = false;
 	CurrentState = ECalendarDialogueState::Idle;
 }
@@ -14,485 +22,632 @@ UCalendarDialogueComponent::UCalendarDialogueComponent()
 void UCalendarDialogueComponent::BeginPlay()
 {
 	Super::BeginPlay();
-	LogCalendar("Calendar Dialogue Component initialized");
+
+	// May still be null if the manager begins play after us; ResolveManager retries
+	CachedManager = UAICompanionSubsystem::FindManager(this);
+	RegisterIntentHandlers();
+
+	CALENDAR_LOG(Verbose, TEXT("Calendar Dialogue Component initialized"));
 }
 
-void UCalendarDialogueComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+void UCalendarDialogueComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+	if (AAICompanionManager* Manager = IntentManager.Get())
+	{
+		Manager->UnregisterIntentHandler(EAICompanionIntent::CreateEvent);
+		Manager->UnregisterIntentHandler(EAICompanionIntent::QueryCalendar);
+		Manager->UnregisterIntentHandler(EAICompanionIntent::Cancel);
+	}
+	IntentManager.Reset();
+
+	if (ManagerRegisteredHandle.IsValid())
+	{
+		if (UAICompanionSubsystem* Subsystem = GetWorld()->GetSubsystem<UAICompanionSubsystem>())
+		{
+			Subsystem->OnManagerRegistered.Remove(ManagerRegisteredHandle);
+		}
+		ManagerRegisteredHandle.Reset();
+	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
 // ========================================
 // PUBLIC API IMPLEMENTATION
 // ========================================
 
-void UCalendarDialogueComponent::StartEventCreation()
-{
-	LogCalendar("Starting calendar event creation flow");
-	
-	// Reset event data
-	EventData = FCalendarEventData();
-	EventData.bIsValid = false;
-	
-	// Start flow
-	CurrentState = ECalendarDialogueState::AskingEventName;
-	AskCurrentQuestion();
-}
+const FCalendarEventData UCalendarDialogueComponent::EmptyEventData;
 
-void UCalendarDialogueComponent::ProcessUserResponse(const FString& Response)
+namespace
 {
-	if (CurrentState == ECalendarDialogueState::Idle)
+	/** Back to the defaults, keeping the strings' buffers for the next event */
+	void ResetEventData(FCalendarEventData& Event)
 	{
-		LogCalendar("Received response but not in calendar flow - ignoring", true);
-		return;
+		static const FCalendarEventData Defaults;
+		Event.EventName.Reset();
+		Event.Location.Reset();
+		Event.Notes.Reset();
+		Event.DateTime = Defaults.DateTime;
+		Event.DurationMinutes = Defaults.DurationMinutes;
+		Event.Priority = Defaults.Priority;
+		Event.bIsValid = Defaults.bIsValid;
 	}
 
-	LogCalendar(FString::Printf(TEXT("Processing response in state %d: %s"), 
-		(int32)CurrentState, *Response));
-
-	// Process answer based on current state
-	bool bSuccess = ProcessAnswer(Response);
+	FCalendarEventData ToEventData(const FAICompanionCalendarIndex::FEntry& Entry)
+	{
+		FCalendarEventData Event;
+		Event.EventName = Entry.Title;
+		Event.DateTime = Entry.Start;
+		Event.DurationMinutes = FMath::RoundToInt((Entry.End - Entry.Start).GetTotalMinutes());
+		Event.Location = Entry.Location;
+		Event.Priority = Entry.Priority;
+		Event.bIsValid = true;
+		return Event;
+	}
 
-	if (bSuccess)
+	/** "Dentist at 10:00 AM", joined with commas */
+	FString DescribeEvents(TConstArrayView<const FAICompanionCalendarIndex::FEntry*> Events, bool bWithDay)
 	{
-		// Move to next question
-		AdvanceToNextState();
+		FString Result;
+		for (const FAICompanionCalendarIndex::FEntry* Entry : Events)
+		{
+			if (!Result.IsEmpty())
+			{
+				Result += TEXT(", ");
+			}
+			Result += Entry->Title.IsEmpty() ? TEXT("an event") : Entry->Title;
+			Result += bWithDay ? Entry->Start.ToString(TEXT(" on %A, %B %d at %I:%M %p")) : Entry->Start.ToString(TEXT(" at %I:%M %p"));
+		}
+		return Result;
 	}
-	else
+
+	/** Copy into Out's existing buffer; it only grows when Value is longer than anything it held */
+	void AssignKeepingBuffer(FString& Out, const FString& Value)
 	{
-		// Invalid answer, ask again
-		LogCalendar("Invalid answer, asking again", true);
-		AskCurrentQuestion();
+		Out.Reset(Value.Len());
+		Out.Append(Value);
 	}
 }
 
-void UCalendarDialogueComponent::CancelFlow()
+namespace CalendarFlowFields
 {
-	LogCalendar("Calendar flow cancelled");
-	CurrentState = ECalendarDialogueState::Idle;
-	EventData = FCalendarEventData();
-	OnFlowCancelled.Broadcast();
+	static const FName Flow(TEXT("Calendar"));
+	static const FName Name(TEXT("name"));
+	static const FName DateTime(TEXT("dateTime"));
+	static const FName Duration(TEXT("duration"));
+	static const FName Location(TEXT("location"));
+	static const FName Notes(TEXT("notes"));
+	static const FName Priority(TEXT("priority"));
+	static const FName Confirm(TEXT("confirm"));
 }
 
-// ========================================
-// CONVERSATION FLOW
-// ========================================
+void UCalendarDialogueComponent::StartEventCreation()
+{
+	CALENDAR_LOG(Verbose, TEXT("Starting calendar event creation flow"));
+	BeginFlow(nullptr);
+}
 
-void UCalendarDialogueComponent::AdvanceToNextState()
+void UCalendarDialogueComponent::StartEventCreationFromRequest(const FString& Request)
 {
-	switch (CurrentState)
+	const FAICompanionCalendarSlots Slots = FAICompanionCalendarSlots::Extract(Request, FDateTime::Now());
+	CALENDAR_LOG(Verbose, TEXT("Starting calendar event creation flow (%d fields from request)"), Slots.Num());
+	BeginFlow(&Slots);
+}
+
+void UCalendarDialogueComponent::ProcessUserResponse(const FString& Response)
+{
+	if (!Session.IsActive())
 	{
-	case ECalendarDialogueState::AskingEventName:
-		CurrentState = ECalendarDialogueState::AskingDateTime;
-		break;
-	case ECalendarDialogueState::AskingDateTime:
-		CurrentState = ECalendarDialogueState::AskingDuration;
-		break;
-	case ECalendarDialogueState::AskingDuration:
-		CurrentState = ECalendarDialogueState::AskingLocation;
-		break;
-	case ECalendarDialogueState::AskingLocation:
-		CurrentState = ECalendarDialogueState::AskingNotes;
-		break;
-	case ECalendarDialogueState::AskingNotes:
-		CurrentState = ECalendarDialogueState::AskingPriority;
-		break;
-	case ECalendarDialogueState::AskingPriority:
-		CurrentState = ECalendarDialogueState::Confirming;
-		break;
-	case ECalendarDialogueState::Confirming:
-		CurrentState = ECalendarDialogueState::Creating;
-		SendEventToBackend();
-		CurrentState = ECalendarDialogueState::Complete;
-		CurrentState = ECalendarDialogueState::Idle; // Reset for next time
-		return;
-	default:
-		CurrentState = ECalendarDialogueState::Idle;
+		CALENDAR_LOG(Warning, TEXT("Received response but not in calendar flow - ignoring"));
 		return;
 	}
 
-	// Ask next question
-	AskCurrentQuestion();
+	CALENDAR_LOG(Verbose, TEXT("Processing response in state %d: %s"), 
+		(int32)CurrentState, *Response);
+
+	HandleFlowResult(Session.Submit(Response));
 }
 
-void UCalendarDialogueComponent::AskCurrentQuestion()
+void UCalendarDialogueComponent::CancelFlow()
 {
-	FString Question;
+	CALENDAR_LOG(Verbose, TEXT("Calendar flow cancelled"));
+	Session.Cancel();
+	CurrentState = ECalendarDialogueState::Idle;
+	ClearDraft();
+	QueueBroadcast(EAICompanionBroadcastPriority::Normal, [this]()
+	{
+		OnFlowCancelled.Broadcast();
+	});
+}
 
-	switch (CurrentState)
+TArray<FCalendarEventData> UCalendarDialogueComponent::GetUpcomingEvents(int32 MaxCount)
+{
+	TArray<FCalendarEventData> Result;
+	if (const FAICompanionCalendarIndex* Index = GetCalendarIndex())
 	{
-	case ECalendarDialogueState::AskingEventName:
-		Question = TEXT("What would you like to call this event?");
-		break;
-	case ECalendarDialogueState::AskingDateTime:
-		Question = TEXT("When would you like to schedule it? (e.g., 'tomorrow at 2pm', 'November 5 at 3:30pm')");
-		break;
-	case ECalendarDialogueState::AskingDuration:
-		Question = TEXT("How long will it take? (e.g., '1 hour', '30 minutes')");
-		break;
-	case ECalendarDialogueState::AskingLocation:
-		Question = TEXT("Where will this take place? (or say 'none')");
-		break;
-	case ECalendarDialogueState::AskingNotes:
-		Question = TEXT("Any notes or details? (or say 'none')");
-		break;
-	case ECalendarDialogueState::AskingPriority:
-		Question = TEXT("How important is this event? (1-10, where 10 is most important)");
-		break;
-	case ECalendarDialogueState::Confirming:
-		Question = GenerateConfirmationMessage();
-		break;
-	default:
-		return;
+		TArray<const FAICompanionCalendarIndex::FEntry*> Events;
+		Index->GetUpcoming(FDateTime::Now(), MaxCount, Events);
+		for (const FAICompanionCalendarIndex::FEntry* Entry : Events)
+		{
+			Result.Add(ToEventData(*Entry));
+		}
 	}
-
-	LogCalendar(FString::Printf(TEXT("Asking: %s"), *Question));
-	OnAskQuestion.Broadcast(Question);
+	return Result;
 }
 
-bool UCalendarDialogueComponent::ProcessAnswer(const FString& Answer)
+TArray<FCalendarEventData> UCalendarDialogueComponent::FindConflictingEvents(const FDateTime& Start, int32 DurationMinutes)
 {
-	switch (CurrentState)
-	{
-	case ECalendarDialogueState::AskingEventName:
-		return ProcessEventName(Answer);
-	case ECalendarDialogueState::AskingDateTime:
-		return ProcessDateTime(Answer);
-	case ECalendarDialogueState::AskingDuration:
-		return ProcessDuration(Answer);
-	case ECalendarDialogueState::AskingLocation:
-		return ProcessLocation(Answer);
-	case ECalendarDialogueState::AskingNotes:
-		return ProcessNotes(Answer);
-	case ECalendarDialogueState::AskingPriority:
-		return ProcessPriority(Answer);
-	case ECalendarDialogueState::Confirming:
-		return ProcessConfirmation(Answer);
-	default:
-		return false;
+	TArray<FCalendarEventData> Result;
+	if (const FAICompanionCalendarIndex* Index = GetCalendarIndex())
+	{
+		TArray<const FAICompanionCalendarIndex::FEntry*> Events;
+		Index->FindOverlaps(Start, Start + FTimespan::FromMinutes(FMath::Max(DurationMinutes, 1)), Events);
+		for (const FAICompanionCalendarIndex::FEntry* Entry : Events)
+		{
+			Result.Add(ToEventData(*Entry));
+		}
 	}
+	return Result;
 }
 
 // ========================================
-// ANSWER PROCESSORS
+// CONVERSATION FLOW
 // ========================================
 
-bool UCalendarDialogueComponent::ProcessEventName(const FString& Answer)
+void UCalendarDialogueComponent::BeginFlow(const FAICompanionCalendarSlots* Slots)
 {
-	if (Answer.IsEmpty() || Answer.Len() < 2)
+	using ESlot = FAICompanionCalendarSlots::ESlot;
+	using FValue = FAICompanionDialogueValue;
+
+	AcquireDraft();
+
+	Session.Start(FAICompanionDialogueFlow::FindBuiltIn(CalendarFlowFields::Flow).ToSharedRef());
+
+	// Answers already in the request are not asked for; if there were any, neither are the optional questions
+	bool bSkipOptional = false;
+	if (Slots)
 	{
-		return false;
+		if (Slots->Has(ESlot::Name))
+		{
+			Session.Prefill(CalendarFlowFields::Name, FValue::MakeText(Slots->EventName));
+		}
+		if (Slots->Has(ESlot::DateTime))
+		{
+			Session.Prefill(CalendarFlowFields::DateTime, FValue::MakeDateTime(Slots->EventDateTime));
+		}
+		if (Slots->Has(ESlot::Duration))
+		{
+			Session.Prefill(CalendarFlowFields::Duration, FValue::MakeNumber(Slots->DurationMinutes));
+		}
+		if (Slots->Has(ESlot::Location))
+		{
+			Session.Prefill(CalendarFlowFields::Location, FValue::MakeText(Slots->Location));
+		}
+		if (Slots->Has(ESlot::Notes))
+		{
+			Session.Prefill(CalendarFlowFields::Notes, FValue::MakeText(Slots->Notes));
+		}
+		if (Slots->Has(ESlot::Priority))
+		{
+			Session.Prefill(CalendarFlowFields::Priority, FValue::MakeNumber(Slots->Priority));
+		}
+		bSkipOptional = Slots->Filled != 0;
 	}
 
-	EventData.EventName = Answer.TrimStartAndEnd();
-	LogCalendar(FString::Printf(TEXT("Event name set: %s"), *EventData.EventName));
-	return true;
+	HandleFlowResult(Session.Begin(bSkipOptional));
 }
 
-bool UCalendarDialogueComponent::ProcessDateTime(const FString& Answer)
+void UCalendarDialogueComponent::HandleFlowResult(FAICompanionDialogueSession::EResult Result)
 {
-	FDateTime ParsedDateTime = ParseDateTime(Answer);
-	
-	if (ParsedDateTime == FDateTime::MinValue())
+	SyncEventData();
+
+	switch (Result)
 	{
-		return false;
+	case FAICompanionDialogueSession::EResult::Ask:
+		CurrentState = GetStateForField(Session.GetCurrentField());
+		AskCurrentQuestion();
+		break;
+	case FAICompanionDialogueSession::EResult::Rejected:
+		// Invalid answer, ask again
+		CALENDAR_LOG(Warning, TEXT("Invalid answer, asking again"));
+		AskCurrentQuestion();
+		break;
+	case FAICompanionDialogueSession::EResult::Completed:
+		CALENDAR_LOG(Verbose, TEXT("Event confirmed by user"));
+		EventPool[DraftSlot]->Event.bIsValid = true;
+		CurrentState = ECalendarDialogueState::Creating;
+		SendEventToBackend();
+		CurrentState = ECalendarDialogueState::Idle; // Reset for next time
+		break;
+	case FAICompanionDialogueSession::EResult::Cancelled:
+		CALENDAR_LOG(Verbose, TEXT("Event creation cancelled by user"));
+		CancelFlow();
+		break;
 	}
-
-	EventData.DateTime = ParsedDateTime;
-	LogCalendar(FString::Printf(TEXT("DateTime set: %s"), *EventData.DateTime.ToString()));
-	return true;
 }
 
-bool UCalendarDialogueComponent::ProcessDuration(const FString& Answer)
+void UCalendarDialogueComponent::AskCurrentQuestion()
 {
-	int32 Minutes = ParseDuration(Answer);
-	
-	if (Minutes <= 0)
+	// The confirm step leaves its wording to us
+	FString Question = Session.GetQuestion();
+	if (Question.IsEmpty())
 	{
-		return false;
+		Question = GenerateConfirmationMessage();
 	}
 
-	EventData.DurationMinutes = Minutes;
-	LogCalendar(FString::Printf(TEXT("Duration set: %d minutes"), EventData.DurationMinutes));
-	return true;
+	CALENDAR_LOG(Verbose, TEXT("Asking: %s"), *Question);
+	QueueBroadcast(EAICompanionBroadcastPriority::Normal, [this, Question = MoveTemp(Question)]()
+	{
+		OnAskQuestion.Broadcast(Question);
+	});
 }
 
-bool UCalendarDialogueComponent::ProcessLocation(const FString& Answer)
+void UCalendarDialogueComponent::SyncEventData()
 {
-	FString Trimmed = Answer.TrimStartAndEnd().ToLower();
-	
-	if (Trimmed == TEXT("none") || Trimmed == TEXT("no") || Trimmed == TEXT("skip"))
+	using FValue = FAICompanionDialogueValue;
+
+	FCalendarEventData& EventData = EventPool[DraftSlot]->Event;
+
+	if (const FValue* Value = Session.FindValue(CalendarFlowFields::Name))
 	{
-		EventData.Location = TEXT("");
-		LogCalendar("Location: none");
+		AssignKeepingBuffer(EventData.EventName, Value->Text);
 	}
-	else
+	if (const FValue* Value = Session.FindValue(CalendarFlowFields::DateTime))
 	{
-		EventData.Location = Answer.TrimStartAndEnd();
-		LogCalendar(FString::Printf(TEXT("Location set: %s"), *EventData.Location));
+		EventData.DateTime = Value->Time;
+	}
+	if (const FValue* Value = Session.FindValue(CalendarFlowFields::Duration))
+	{
+		EventData.DurationMinutes = (int32)Value->Number;
+	}
+	if (const FValue* Value = Session.FindValue(CalendarFlowFields::Location))
+	{
+		AssignKeepingBuffer(EventData.Location, Value->Text);
+	}
+	if (const FValue* Value = Session.FindValue(CalendarFlowFields::Notes))
+	{
+		AssignKeepingBuffer(EventData.Notes, Value->Text);
+	}
+	if (const FValue* Value = Session.FindValue(CalendarFlowFields::Priority))
+	{
+		EventData.Priority = (int32)Value->Number;
 	}
-	
-	return true; // Always succeeds
 }
 
-bool UCalendarDialogueComponent::ProcessNotes(const FString& Answer)
+FCalendarEventData& UCalendarDialogueComponent::AcquireDraft()
 {
-	FString Trimmed = Answer.TrimStartAndEnd().ToLower();
-	
-	if (Trimmed == TEXT("none") || Trimmed == TEXT("no") || Trimmed == TEXT("skip"))
+	if (DraftSlot != INDEX_NONE && EventPool[DraftSlot]->bInFlight)
 	{
-		EventData.Notes = TEXT("");
-		LogCalendar("Notes: none");
+		DraftSlot = INDEX_NONE;
 	}
-	else
+
+	if (DraftSlot == INDEX_NONE)
 	{
-		EventData.Notes = Answer.TrimStartAndEnd();
-		LogCalendar(FString::Printf(TEXT("Notes set: %s"), *EventData.Notes));
+		DraftSlot = FreeEventSlots.Num() > 0 ? FreeEventSlots.Pop(EAllowShrinking::No) : EventPool.Add(MakeUnique<FEventSlot>());
 	}
-	
-	return true; // Always succeeds
+
+	FCalendarEventData& Draft = EventPool[DraftSlot]->Event;
+	ResetEventData(Draft);
+	return Draft;
 }
 
-bool UCalendarDialogueComponent::ProcessPriority(const FString& Answer)
+void UCalendarDialogueComponent::ClearDraft()
 {
-	int32 Priority = ExtractNumber(Answer);
-	
-	if (Priority < 1 || Priority > 10)
+	if (DraftSlot == INDEX_NONE)
 	{
-		return false;
+		return;
 	}
 
-	EventData.Priority = Priority;
-	LogCalendar(FString::Printf(TEXT("Priority set: %d"), EventData.Priority));
-	return true;
+	if (EventPool[DraftSlot]->bInFlight)
+	{
+		DraftSlot = INDEX_NONE;
+	}
+	else
+	{
+		ResetEventData(EventPool[DraftSlot]->Event);
+	}
 }
 
-bool UCalendarDialogueComponent::ProcessConfirmation(const FString& Answer)
+void UCalendarDialogueComponent::FinishEventSlot(int32 Slot)
 {
-	bool bConfirmed = IsAffirmative(Answer);
-	
-	if (!bConfirmed)
+	EventPool[Slot]->bInFlight = false;
+	if (Slot != DraftSlot)
 	{
-		LogCalendar("Event creation cancelled by user");
-		CancelFlow();
-		return false;
+		FreeEventSlots.Add(Slot);
 	}
+}
 
-	LogCalendar("Event confirmed by user");
-	EventData.bIsValid = true;
-	return true;
+ECalendarDialogueState UCalendarDialogueComponent::GetStateForField(FName Field)
+{
+	static const TPair<FName, ECalendarDialogueState> States[] =
+	{
+		{ CalendarFlowFields::Name, ECalendarDialogueState::AskingEventName },
+		{ CalendarFlowFields::DateTime, ECalendarDialogueState::AskingDateTime },
+		{ CalendarFlowFields::Duration, ECalendarDialogueState::AskingDuration },
+		{ CalendarFlowFields::Location, ECalendarDialogueState::AskingLocation },
+		{ CalendarFlowFields::Notes, ECalendarDialogueState::AskingNotes },
+		{ CalendarFlowFields::Priority, ECalendarDialogueState::AskingPriority },
+		{ CalendarFlowFields::Confirm, ECalendarDialogueState::Confirming },
+	};
+
+	for (const TPair<FName, ECalendarDialogueState>& State : States)
+	{
+		if (State.Key == Field)
+		{
+			return State.Value;
+		}
+	}
+	return ECalendarDialogueState::Idle;
 }
 
 // ========================================
 // HELPERS
 // ========================================
 
-FDateTime UCalendarDialogueComponent::ParseDateTime(const FString& Input)
+FString UCalendarDialogueComponent::GenerateConfirmationMessage()
 {
-	FString Lower = Input.ToLower().TrimStartAndEnd();
-	FDateTime Now = FDateTime::Now();
-	FDateTime Result = FDateTime::MinValue();
+	const FCalendarEventData& EventData = GetEventData();
 
-	// Simple parsing - extend this for more complex cases
+	FString Message = TEXT("Here's what I have:\n\n");
+	Message += FString::Printf(TEXT("📅 %s\n"), *EventData.EventName);
+	Message += FString::Printf(TEXT("⏰ %s\n"), *EventData.DateTime.ToString(TEXT("%B %d, %Y at %I:%M %p")));
+	Message += FString::Printf(TEXT("⏱️ Duration: %d minutes\n"), EventData.DurationMinutes);
 	
-	// "tomorrow at 2pm"
-	if (Lower.Contains(TEXT("tomorrow")))
+	if (!EventData.Location.IsEmpty())
 	{
-		Result = Now + FTimespan::FromDays(1);
-		
-		// Extract time
-		if (Lower.Contains(TEXT("at")))
-		{
-			int32 Hour = 12; // Default noon
-			
-			if (Lower.Contains(TEXT("pm")))
-			{
-				Hour = ExtractNumber(Lower);
-				if (Hour < 12) Hour += 12;
-			}
-			else if (Lower.Contains(TEXT("am")))
-			{
-				Hour = ExtractNumber(Lower);
-			}
-			
-			Result = FDateTime(Result.GetYear(), Result.GetMonth(), Result.GetDay(), Hour, 0, 0);
-		}
-		
-		return Result;
+		Message += FString::Printf(TEXT("📍 %s\n"), *EventData.Location);
+	}
+	
+	if (!EventData.Notes.IsEmpty())
+	{
+		Message += FString::Printf(TEXT("📝 %s\n"), *EventData.Notes);
 	}
 	
-	// "today at 3pm"
-	if (Lower.Contains(TEXT("today")))
+	Message += FString::Printf(TEXT("⭐ Priority: %d/10\n\n"), EventData.Priority);
+
+	// Checked against the local calendar copy, so confirming costs no round trip
+	if (const FAICompanionCalendarIndex* Index = GetCalendarIndex())
 	{
-		Result = Now;
-		
-		if (Lower.Contains(TEXT("at")))
+		TArray<const FAICompanionCalendarIndex::FEntry*> Conflicts;
+		const FDateTime End = EventData.DateTime + FTimespan::FromMinutes(FMath::Max(EventData.DurationMinutes, 1));
+		if (Index->FindOverlaps(EventData.DateTime, End, Conflicts) > 0)
 		{
-			int32 Hour = 12;
-			
-			if (Lower.Contains(TEXT("pm")))
-			{
-				Hour = ExtractNumber(Lower);
-				if (Hour < 12) Hour += 12;
-			}
-			else if (Lower.Contains(TEXT("am")))
-			{
-				Hour = ExtractNumber(Lower);
-			}
-			
-			Result = FDateTime(Result.GetYear(), Result.GetMonth(), Result.GetDay(), Hour, 0, 0);
+			Message += FString::Printf(TEXT("⚠️ This overlaps with %s\n\n"), *DescribeEvents(Conflicts, false));
 		}
-		
-		return Result;
 	}
 
-	// TODO: Add more complex parsing (specific dates, times, etc.)
-	// For now, return invalid if we can't parse
+	Message += TEXT("Should I create this event?");
 	
-	LogCalendar(FString::Printf(TEXT("Could not parse datetime: %s"), *Input), true);
-	return FDateTime::MinValue();
+	return Message;
 }
 
-int32 UCalendarDialogueComponent::ParseDuration(const FString& Input)
+AAICompanionManager* UCalendarDialogueComponent::ResolveManager()
 {
-	FString Lower = Input.ToLower().TrimStartAndEnd();
-	int32 Number = ExtractNumber(Lower);
-
-	if (Number <= 0)
+	if (!CachedManager.IsValid())
 	{
-		return 0;
+		CachedManager = UAICompanionSubsystem::FindManager(this);
 	}
+	return CachedManager.Get();
+}
 
-	// Check units
-	if (Lower.Contains(TEXT("hour")))
-	{
-		return Number * 60; // Convert to minutes
-	}
-	else if (Lower.Contains(TEXT("minute")) || Lower.Contains(TEXT("min")))
+const FAICompanionCalendarIndex* UCalendarDialogueComponent::GetCalendarIndex()
+{
+	AAICompanionManager* Manager = ResolveManager();
+	return Manager && Manager->IsCalendarSynced() ? &Manager->GetCalendarIndex() : nullptr;
+}
+
+bool UCalendarDialogueComponent::AnswerCalendarQuery(const FString& Utterance)
+{
+	const FAICompanionCalendarIndex* Index = GetCalendarIndex();
+	if (!Index)
 	{
-		return Number;
+		return false;
 	}
-	else
+
+	const FDateTime Now = FDateTime::Now();
+	TArray<const FAICompanionCalendarIndex::FEntry*> Events;
+	FString Answer;
+
+	// "When is my dentist appointment?": an upcoming event named in the question
+	Index->GetUpcoming(Now, Index->Num(), Events);
+	for (const FAICompanionCalendarIndex::FEntry* Entry : Events)
 	{
-		// Assume minutes if no unit specified
-		return Number;
+		if (Entry->Title.Len() >= 3 && Utterance.Contains(Entry->Title))
+		{
+			Answer = FString::Printf(TEXT("%s."), *DescribeEvents(MakeArrayView(&Entry, 1), true));
+			break;
+		}
 	}
-}
+	Events.Reset();
 
-int32 UCalendarDialogueComponent::ExtractNumber(const FString& Input)
-{
-	// Extract first number from string
-	FString NumberStr;
-	
-	for (TCHAR Char : Input)
+	FDateTime When;
+	bool bHasTime = false;
+	if (Answer.IsEmpty() && FAICompanionDateTimeParser::ParseDateTime(Utterance, Now, When, bHasTime))
 	{
-		if (FChar::IsDigit(Char))
+		// A day with no time asks about the whole day
+		const bool bWholeDay = !bHasTime;
+		const FDateTime From = bWholeDay ? When.GetDate() : When;
+		const FDateTime To = From + (bWholeDay ? FTimespan::FromDays(1.0) : FTimespan::FromHours(1.0));
+		const FString Day = From.ToString(TEXT("%A, %B %d"));
+
+		if (Index->FindOverlaps(From, To, Events) == 0)
 		{
-			NumberStr.AppendChar(Char);
+			Answer = bWholeDay
+				? FString::Printf(TEXT("Nothing is scheduled for %s."), *Day)
+				: FString::Printf(TEXT("You're free at %s on %s."), *From.ToString(TEXT("%I:%M %p")), *Day);
 		}
-		else if (!NumberStr.IsEmpty())
+		else
 		{
-			// Found number, stop
-			break;
+			Answer = FString::Printf(TEXT("On %s you have %s."), *Day, *DescribeEvents(Events, false));
 		}
 	}
-
-	if (NumberStr.IsEmpty())
+	else if (Answer.IsEmpty())
 	{
-		return 0;
+		// With no event or day to go on, only answer when the question is plainly about the calendar;
+		// anything else goes to the backend rather than getting "Your calendar is clear."
+		static const TCHAR* const CalendarWords[] = { TEXT("calendar"), TEXT("schedule"), TEXT("plans"), TEXT("planned"), TEXT("coming up"), TEXT("upcoming"), TEXT("meeting"), TEXT("appointment") };
+		if (!Algo::AnyOf(CalendarWords, [&Utterance](const TCHAR* Word) { return Utterance.Contains(Word); }))
+		{
+			return false;
+		}
+
+		Answer = Index->GetUpcoming(Now, 3, Events) == 0
+			? FString(TEXT("Your calendar is clear."))
+			: FString::Printf(TEXT("Coming up: %s."), *DescribeEvents(Events, true));
 	}
 
-	return FCString::Atoi(*NumberStr);
+	CALENDAR_LOG(Verbose, TEXT("Answered locally: %s"), *Answer);
+	ResolveManager()->DeliverLocalResponse(Answer);
+	return true;
 }
 
-bool UCalendarDialogueComponent::IsAffirmative(const FString& Answer)
+void UCalendarDialogueComponent::QueueBroadcast(EAICompanionBroadcastPriority Priority, TUniqueFunction<void()>&& Delivery)
 {
-	FString Lower = Answer.ToLower().TrimStartAndEnd();
-	
-	return Lower == TEXT("yes") ||
-	       Lower == TEXT("yeah") ||
-	       Lower == TEXT("yep") ||
-	       Lower == TEXT("sure") ||
-	       Lower == TEXT("ok") ||
-	       Lower == TEXT("okay") ||
-	       Lower == TEXT("y") ||
-	       Lower == TEXT("confirm") ||
-	       Lower == TEXT("correct") ||
-	       Lower == TEXT("right");
+	if (AAICompanionManager* Manager = ResolveManager())
+	{
+		Manager->QueueBroadcast(Priority, this, MoveTemp(Delivery));
+		return;
+	}
+	Delivery();
 }
 
-FString UCalendarDialogueComponent::GenerateConfirmationMessage() const
+void UCalendarDialogueComponent::RegisterIntentHandlers()
 {
-	FString Message = TEXT("Here's what I have:\n\n");
-	Message += FString::Printf(TEXT("📅 %s\n"), *EventData.EventName);
-	Message += FString::Printf(TEXT("⏰ %s\n"), *EventData.DateTime.ToString(TEXT("%B %d, %Y at %I:%M %p")));
-	Message += FString::Printf(TEXT("⏱️ Duration: %d minutes\n"), EventData.DurationMinutes);
-	
-	if (!EventData.Location.IsEmpty())
+	AAICompanionManager* Manager = ResolveManager();
+	if (!Manager)
 	{
-		Message += FString::Printf(TEXT("📍 %s\n"), *EventData.Location);
+		// The manager registers with the subsystem in its own BeginPlay, which may not have run yet
+		UAICompanionSubsystem* Subsystem = GetWorld()->GetSubsystem<UAICompanionSubsystem>();
+		if (Subsystem && !ManagerRegisteredHandle.IsValid())
+		{
+			ManagerRegisteredHandle = Subsystem->OnManagerRegistered.AddUObject(this, &UCalendarDialogueComponent::OnManagerRegistered);
+		}
+		return;
 	}
-	
-	if (!EventData.Notes.IsEmpty())
+
+	Manager->RegisterIntentHandler(EAICompanionIntent::CreateEvent, FAICompanionIntentHandler::CreateUObject(this, &UCalendarDialogueComponent::HandleIntent));
+	Manager->RegisterIntentHandler(EAICompanionIntent::QueryCalendar, FAICompanionIntentHandler::CreateUObject(this, &UCalendarDialogueComponent::HandleIntent));
+	Manager->RegisterIntentHandler(EAICompanionIntent::Cancel, FAICompanionIntentHandler::CreateUObject(this, &UCalendarDialogueComponent::HandleIntent));
+	IntentManager = Manager;
+}
+
+void UCalendarDialogueComponent::OnManagerRegistered(AAICompanionManager* Manager)
+{
+	if (UAICompanionSubsystem* Subsystem = GetWorld()->GetSubsystem<UAICompanionSubsystem>())
 	{
-		Message += FString::Printf(TEXT("📝 %s\n"), *EventData.Notes);
+		Subsystem->OnManagerRegistered.Remove(ManagerRegisteredHandle);
+	}
+	ManagerRegisteredHandle.Reset();
+
+	CachedManager = Manager;
+	RegisterIntentHandlers();
+}
+
+bool UCalendarDialogueComponent::HandleIntent(EAICompanionIntent Intent, const FString& Utterance)
+{
+	switch (Intent)
+	{
+	case EAICompanionIntent::CreateEvent:
+		// Mid-flow the utterance is an answer (or small talk), not a new request
+		if (IsInCalendarFlow())
+		{
+			return false;
+		}
+		CALENDAR_LOG(Verbose, TEXT("Create-event intent: %s"), *Utterance);
+		StartEventCreationFromRequest(Utterance);
+		return true;
+	case EAICompanionIntent::QueryCalendar:
+		return !IsInCalendarFlow() && AnswerCalendarQuery(Utterance);
+	case EAICompanionIntent::Cancel:
+		if (!IsInCalendarFlow())
+		{
+			return false;
+		}
+		CancelFlow();
+		return true;
+	default:
+		return false;
 	}
-	
-	Message += FString::Printf(TEXT("⭐ Priority: %d/10\n\n"), EventData.Priority);
-	Message += TEXT("Should I create this event?");
-	
-	return Message;
 }
 
 void UCalendarDialogueComponent::SendEventToBackend()
 {
-	LogCalendar("Sending event to backend...");
-	
-	// Find AICompanionManager
-	TArray<AActor*> FoundActors;
-	UGameplayStatics::GetAllActorsOfClass(GetWorld(), AAICompanionManager::StaticClass(), FoundActors);
+	CALENDAR_LOG(Verbose, TEXT("Sending event to backend..."));
 	
-	if (FoundActors.Num() == 0)
+	AAICompanionManager* Manager = ResolveManager();
+	if (!Manager)
 	{
-		LogCalendar("ERROR: Could not find AICompanionManager!", true);
+		CALENDAR_LOG(Warning, TEXT("ERROR: Could not find AICompanionManager!"));
 		return;
 	}
 
-	AAICompanionManager* Manager = Cast<AAICompanionManager>(FoundActors[0]);
-	if (!Manager)
+	// Build the message in the manager's shared (escaping) encoder
+	const FCalendarEventData& EventData = EventPool[DraftSlot]->Event;
+	FAICompanionMessageWriter& Message = Manager->GetMessageWriter().Begin(TEXT("create_calendar_event"))
+		.WriteString(TEXT("eventName"), EventData.EventName)
+		.WriteDateTime(TEXT("dateTime"), EventData.DateTime)
+		.WriteInt(TEXT("durationMinutes"), EventData.DurationMinutes)
+		.WriteString(TEXT("location"), EventData.Location)
+		.WriteString(TEXT("notes"), EventData.Notes)
+		.WriteInt(TEXT("priority"), EventData.Priority);
+
+	// The reply handler gets the slot itself; a flow started before the reply arrives takes a new one
+	EventPool[DraftSlot]->bInFlight = true;
+	const int32 RequestId = Manager->SendRequest(Message, EAICompanionLatencyMetric::CalendarResponse,
+		FAICompanionRequestCallback::CreateUObject(this, &UCalendarDialogueComponent::HandleEventCreateReply, DraftSlot));
+	if (RequestId == 0)
 	{
-		LogCalendar("ERROR: Failed to cast to AICompanionManager!", true);
+		EventPool[DraftSlot]->bInFlight = false;
+		CALENDAR_LOG(Warning, TEXT("ERROR: Send queue full, event was not sent"));
+		QueueBroadcast(EAICompanionBroadcastPriority::High, [this]()
+		{
+			OnEventCreationFailed.Broadcast(TEXT("Send queue full"));
+		});
 		return;
 	}
 
-	// Build JSON message
-	FString JSON = TEXT("{");
-	JSON += FString::Printf(TEXT("\"type\":\"create_calendar_event\","));
-	JSON += FString::Printf(TEXT("\"eventName\":\"%s\","), *EventData.EventName);
-	JSON += FString::Printf(TEXT("\"dateTime\":\"%s\","), *EventData.DateTime.ToIso8601());
-	JSON += FString::Printf(TEXT("\"durationMinutes\":%d,"), EventData.DurationMinutes);
-	JSON += FString::Printf(TEXT("\"location\":\"%s\","), *EventData.Location);
-	JSON += FString::Printf(TEXT("\"notes\":\"%s\","), *EventData.Notes);
-	JSON += FString::Printf(TEXT("\"priority\":%d"), EventData.Priority);
-	JSON += TEXT("}");
-
-	// Send via AICompanionManager
-	Manager->SendMessageToBackend(JSON);
-
-	LogCalendar("Event sent to backend successfully");
-	
-	// Broadcast completion
-	OnEventCreated.Broadcast(EventData);
+	CALENDAR_LOG(Verbose, TEXT("Event queued for backend (request %d)"), RequestId);
 }
 
-void UCalendarDialogueComponent::LogCalendar(const FString& Message, bool bWarning)
+void UCalendarDialogueComponent::HandleEventCreateReply(EAICompanionRequestResult Result, const FAICompanionInboundMessage& Reply, int32 Slot)
 {
-	if (bWarning)
+	switch (Result)
 	{
-		UE_LOG(LogTemp, Warning, TEXT("[CalendarDialogue] %s"), *Message);
-	}
-	else
-	{
-		UE_LOG(LogTemp, Log, TEXT("[CalendarDialogue] %s"), *Message);
+	case EAICompanionRequestResult::Completed:
+		CALENDAR_LOG(Verbose, TEXT("Backend created event: %s"), *EventPool[Slot]->Event.EventName);
+
+		// Cached answers about the calendar are stale now
+		if (AAICompanionManager* Manager = ResolveManager())
+		{
+			Manager->InvalidateResponseCache();
+		}
+
+		// The broadcast gets its own copy, so the slot goes back to the pool now even
+		// if the scheduler is reset before delivering it
+		QueueBroadcast(EAICompanionBroadcastPriority::Normal, [this, Event = EventPool[Slot]->Event]()
+		{
+			OnEventCreated.Broadcast(Event);
+			OnEventCreatedNative.Broadcast(Event);
+		});
+		break;
+	case EAICompanionRequestResult::Failed:
+		CALENDAR_LOG(Warning, TEXT("ERROR: Backend rejected event: %s"), *Reply.Error);
+		QueueBroadcast(EAICompanionBroadcastPriority::High, [this, Error = Reply.Error]()
+		{
+			OnEventCreationFailed.Broadcast(Error);
+		});
+		break;
+	case EAICompanionRequestResult::TimedOut:
+		CALENDAR_LOG(Warning, TEXT("ERROR: Backend did not confirm the event in time"));
+		QueueBroadcast(EAICompanionBroadcastPriority::High, [this]()
+		{
+			OnEventCreationFailed.Broadcast(TEXT("Timed out"));
+		});
+		break;
+	default:
+		// Manager shutting down
+		break;
 	}
+
+	FinishEventSlot(Slot);
 }
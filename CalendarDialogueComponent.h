@@ -6,8 +6,16 @@
 
 #include "CoreMinimal.h"
 #include "Components/ActorComponent.h"
+#include "AICompanionRequests.h"
+#include "AICompanionIntentClassifier.h"
+#include "AICompanionDialogueFlow.h"
+#include "AICompanionBroadcastScheduler.h"
 #include "CalendarDialogueComponent.generated.h"
 
+class AAICompanionManager;
+class FAICompanionCalendarIndex;
+struct FAICompanionCalendarSlots;
+
 /**
  * Calendar conversation states
  */
@@ -61,10 +69,13 @@ struct FCalendarEventData
  * 
  * Usage:
  * 1. User says "Schedule my dentist appointment"
- * 2. AI responds "What would you like to call this event?"
- * 3. This component detects we're in calendar flow
+ * 2. The manager recognizes the intent locally and starts this flow (no backend round trip)
+ * 3. This component asks "What would you like to call this event?"
  * 4. Manages conversation state and stores answers
  * 5. When complete, sends event to backend
+ *
+ * Questions about the calendar ("what's on tomorrow?", "am I free at 3?") are answered
+ * from the manager's local copy of the player's events once the backend has synced it.
  */
 UCLASS(ClassGroup=(Custom), meta=(BlueprintSpawnableComponent))
 class JOEVISV3V1_API UCalendarDialogueComponent : public UActorComponent
@@ -76,10 +87,9 @@ public:
 
 protected:
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 public:
-	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
-
 	// ========================================
 	// PUBLIC API
 	// ========================================
@@ -91,6 +101,15 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Calendar")
 	void StartEventCreation();
 
+	/**
+	 * Start the flow from the user's request ("schedule lunch with Sam tomorrow at noon").
+	 * Whatever the request already says is filled in and only the rest is asked; if it
+	 * named something, the optional questions (duration, location, notes, priority)
+	 * are skipped and keep their defaults.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Calendar")
+	void StartEventCreationFromRequest(const FString& Request);
+
 	/**
 	 * Process user's response to current question
 	 * Call this when user provides an answer
@@ -112,9 +131,10 @@ public:
 
 	/**
 	 * Get current event data (partial or complete)
+	 * The last event stays here after it is sent, until the next flow starts
 	 */
 	UFUNCTION(BlueprintPure, Category = "Calendar")
-	FCalendarEventData GetEventData() const { return EventData; }
+	const FCalendarEventData& GetEventData() const { return DraftSlot != INDEX_NONE ? EventPool[DraftSlot]->Event : EmptyEventData; }
 
 	/**
 	 * Is currently in calendar conversation?
@@ -122,6 +142,19 @@ public:
 	UFUNCTION(BlueprintPure, Category = "Calendar")
 	bool IsInCalendarFlow() const { return CurrentState != ECalendarDialogueState::Idle; }
 
+	/**
+	 * Events still to come, soonest first, from the local calendar copy
+	 * Empty until the backend has synced it
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Calendar")
+	TArray<FCalendarEventData> GetUpcomingEvents(int32 MaxCount = 5);
+
+	/**
+	 * Events that overlap a proposed time, checked locally
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Calendar")
+	TArray<FCalendarEventData> FindConflictingEvents(const FDateTime& Start, int32 DurationMinutes = 60);
+
 	// ========================================
 	// DELEGATES (Events)
 	// ========================================
@@ -135,13 +168,26 @@ public:
 	FOnAskQuestion OnAskQuestion;
 
 	/**
-	 * Fired when event creation is complete
-	 * Send this data to backend
+	 * Fired when the backend has created the event
 	 */
 	DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnEventCreated, const FCalendarEventData&, EventData);
 	UPROPERTY(BlueprintAssignable, Category = "Calendar")
 	FOnEventCreated OnEventCreated;
 
+	/**
+	 * OnEventCreated for C++ listeners. Blueprint delegates marshal the event into a
+	 * copy of their parameters; this passes a reference to the pooled event instead.
+	 */
+	DECLARE_MULTICAST_DELEGATE_OneParam(FOnEventCreatedNative, const FCalendarEventData& /*EventData*/);
+	FOnEventCreatedNative OnEventCreatedNative;
+
+	/**
+	 * Fired when the backend rejected the event or did not answer in time
+	 */
+	DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnEventCreationFailed, const FString&, Reason);
+	UPROPERTY(BlueprintAssignable, Category = "Calendar")
+	FOnEventCreationFailed OnEventCreationFailed;
+
 	/**
 	 * Fired when flow is cancelled
 	 */
@@ -157,56 +203,97 @@ private:
 	UPROPERTY()
 	ECalendarDialogueState CurrentState;
 
-	UPROPERTY()
-	FCalendarEventData EventData;
+	/** A pooled event: the flow's draft, or one sent and not yet answered by the backend */
+	struct FEventSlot
+	{
+		FCalendarEventData Event;
+		bool bInFlight = false;
+	};
+
+	/**
+	 * Event pool. Slots are reused with their string buffers, so a long calendar session
+	 * stops allocating for names, places and notes. Each slot has its own allocation,
+	 * so references handed to delegates stay valid while the pool grows.
+	 */
+	TArray<TUniquePtr<FEventSlot>> EventPool;
+	TArray<int32> FreeEventSlots;
+
+	/** Slot the current flow fills in (mirrors Session's answers); INDEX_NONE before the first flow */
+	int32 DraftSlot = INDEX_NONE;
+
+	/** What GetEventData returns when there is no draft */
+	static const FCalendarEventData EmptyEventData;
+
+	/** Position in the built-in Calendar flow and the answers so far */
+	FAICompanionDialogueSession Session;
+
+	/** Manager resolved through UAICompanionSubsystem; re-resolved if it goes away */
+	TWeakObjectPtr<AAICompanionManager> CachedManager;
+
+	/** Manager our intent handlers are registered with */
+	TWeakObjectPtr<AAICompanionManager> IntentManager;
+
+	/** Bound to UAICompanionSubsystem::OnManagerRegistered while no manager exists yet */
+	FDelegateHandle ManagerRegisteredHandle;
 
 	// ========================================
 	// CONVERSATION FLOW
 	// ========================================
 
-	/** Move to next question in flow */
-	void AdvanceToNextState();
+	/** Start the Calendar flow, with whatever the opening request already answered */
+	void BeginFlow(const FAICompanionCalendarSlots* Slots);
+
+	/** Ask, re-ask, send or cancel after the session moved */
+	void HandleFlowResult(FAICompanionDialogueSession::EResult Result);
 
-	/** Ask current question based on state */
+	/** Ask the session's current question (the confirm step gets the event summary) */
 	void AskCurrentQuestion();
 
-	/** Validate and store user's answer */
-	bool ProcessAnswer(const FString& Answer);
+	/** Copy the session's answers into the draft */
+	void SyncEventData();
 
-	// ========================================
-	// ANSWER PROCESSORS
-	// ========================================
+	/** Reset the draft slot for a new flow; a slot still waiting on the backend is left to its reply */
+	FCalendarEventData& AcquireDraft();
+
+	/** Forget the draft's contents (cancelled flow) */
+	void ClearDraft();
 
-	bool ProcessEventName(const FString& Answer);
-	bool ProcessDateTime(const FString& Answer);
-	bool ProcessDuration(const FString& Answer);
-	bool ProcessLocation(const FString& Answer);
-	bool ProcessNotes(const FString& Answer);
-	bool ProcessPriority(const FString& Answer);
-	bool ProcessConfirmation(const FString& Answer);
+	/** The backend has answered for Slot; it returns to the pool unless it is still the draft */
+	void FinishEventSlot(int32 Slot);
+
+	/** Blueprint-facing state for a Calendar flow field */
+	static ECalendarDialogueState GetStateForField(FName Field);
 
 	// ========================================
 	// HELPERS
 	// ========================================
 
-	/** Parse natural language date/time (e.g., "tomorrow at 2pm") */
-	FDateTime ParseDateTime(const FString& Input);
+	/** Generate confirmation message (warns about overlapping events) */
+	FString GenerateConfirmationMessage();
+
+	/** Get the AI Companion manager for this world (cached) */
+	AAICompanionManager* ResolveManager();
+
+	/** Broadcast through the manager's per-frame budget (inline if there is no manager) */
+	void QueueBroadcast(EAICompanionBroadcastPriority Priority, TUniqueFunction<void()>&& Delivery);
+
+	/** The manager's calendar copy, or null until the backend has synced it */
+	const FAICompanionCalendarIndex* GetCalendarIndex();
 
-	/** Parse duration (e.g., "1 hour", "30 minutes") */
-	int32 ParseDuration(const FString& Input);
+	/** Answer a schedule question from the calendar copy; false leaves it to the backend */
+	bool AnswerCalendarQuery(const FString& Utterance);
 
-	/** Extract number from string */
-	int32 ExtractNumber(const FString& Input);
+	/** Claim CreateEvent, QueryCalendar and Cancel on the manager; waits for one to register if there is none yet */
+	void RegisterIntentHandlers();
 
-	/** Check if answer is affirmative (yes, yeah, sure, etc.) */
-	bool IsAffirmative(const FString& Answer);
+	void OnManagerRegistered(AAICompanionManager* Manager);
 
-	/** Generate confirmation message */
-	FString GenerateConfirmationMessage() const;
+	/** Local intent from AAICompanionManager::SendChatMessage; true if we took it */
+	bool HandleIntent(EAICompanionIntent Intent, const FString& Utterance);
 
 	/** Send event to backend */
 	void SendEventToBackend();
 
-	/** Log calendar activity */
-	void LogCalendar(const FString& Message, bool bWarning = false);
+	/** Backend answered create_calendar_event (or the request timed out) */
+	void HandleEventCreateReply(EAICompanionRequestResult Result, const FAICompanionInboundMessage& Reply, int32 Slot);
 };
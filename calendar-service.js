@@ -22,6 +22,10 @@ export class CalendarService {
     this.events = new Map(); // playerId -> [events]
     this.googleClients = new Map(); // playerId -> google calendar client
 
+    // Change feed for clients that keep a local copy (calendar_sync / calendar_delta)
+    this.revisions = new Map(); // playerId -> revision, bumped on every change
+    this.changeListeners = new Set();
+
     // Create storage directory
     if (!fs.existsSync(this.storageDir)) {
       fs.mkdirSync(this.storageDir, { recursive: true });
@@ -111,6 +115,7 @@ export class CalendarService {
       }
 
       this.saveEvents();
+      this.notifyChange(playerId, { op: 'upsert', event });
 
       console.log(`[Calendar] ✅ Event created: ${event.title}`);
 
@@ -194,6 +199,7 @@ export class CalendarService {
       }
 
       this.saveEvents();
+      this.notifyChange(playerId, { op: 'upsert', event });
 
       console.log(`[Calendar] ✅ Event updated: ${event.title}`);
 
@@ -239,6 +245,7 @@ export class CalendarService {
       // Remove from local storage
       events.splice(eventIndex, 1);
       this.saveEvents();
+      this.notifyChange(playerId, { op: 'remove', eventId });
 
       console.log(`[Calendar] ✅ Event deleted: ${event.title}`);
 
@@ -323,6 +330,41 @@ export class CalendarService {
     });
   }
 
+  /**
+   * Current change revision for a player (0 before the first change)
+   * @param {string} playerId - Player ID
+   * @returns {number} - Revision
+   */
+  getRevision(playerId) {
+    return this.revisions.get(playerId) || 0;
+  }
+
+  /**
+   * Listen for event changes
+   * @param {Function} listener - Called with (playerId, { revision, op, event | eventId })
+   * @returns {Function} - Removes the listener
+   */
+  onChange(listener) {
+    this.changeListeners.add(listener);
+    return () => this.changeListeners.delete(listener);
+  }
+
+  /**
+   * Bump the player's revision and tell listeners what changed
+   */
+  notifyChange(playerId, change) {
+    const revision = this.getRevision(playerId) + 1;
+    this.revisions.set(playerId, revision);
+
+    for (const listener of this.changeListeners) {
+      try {
+        listener(playerId, { revision, ...change });
+      } catch (error) {
+        console.error('[Calendar] ❌ Change listener failed:', error.message);
+      }
+    }
+  }
+
   /**
    * Sync with Google Calendar
    * @param {string} playerId - Player ID
@@ -12,6 +12,7 @@
 
 import express from 'express';
 import { WebSocketServer } from 'ws';
+import { randomBytes } from 'crypto';
 import cors from 'cors';
 import dotenv from 'dotenv';
 
@@ -22,6 +23,8 @@ import { ReminderService } from './reminder-service.js';
 import { PriorityAssessmentService } from './priority-assessment-service.js';
 import { CalendarConversationFlow } from './calendar-conversation-flow.js';
 import { BudgetManagerService } from './budget-manager-service.js';
+import { VoiceProcessor } from './voice-processor.js';
+import { encodeFrame, decodeFrame, compressFrame, BINARY_WIRE_NAME, COMPRESSION_NAME } from './wire-protocol.js';
 
 dotenv.config();
 
@@ -93,11 +96,42 @@ const calendarFlow = new CalendarConversationFlow({
 
 console.log('✅ Calendar Conversation Flow initialized');
 
+// Voice Processor (streamed voice uploads and transcription)
+const voiceProcessor = new VoiceProcessor();
+
+console.log('✅ Voice Processor initialized');
+
 // ═══════════════════════════════════════════════════════════
 // SESSION MANAGEMENT
 // ═══════════════════════════════════════════════════════════
 
-const sessions = new Map(); // playerId → { ws, playerData, conversationState }
+const sessions = new Map(); // playerId → { playerId, ws, playerData, conversationState, sessionToken, received }
+
+// How long a dropped client has to resume its session before it is discarded
+const SESSION_GRACE_MS = parseInt(process.env.SESSION_GRACE_MS) || 60000;
+
+// Messages that manage the session itself and are not counted for acks
+const CONTROL_MESSAGE_TYPES = new Set(['register', 'resume', 'unregister', 'ping']);
+
+// Event fields a client keeps in its local calendar index
+const toCalendarEntry = (event) => ({
+  eventId: event.eventId,
+  title: event.title,
+  startTime: event.startTime,
+  endTime: event.endTime,
+  location: event.location,
+  priority: event.priority,
+  status: event.status,
+});
+
+// Events that have not ended yet. Stored times are the client's wall clock, so allow a day of slack for its timezone.
+const upcomingCalendarEntries = (playerId) => {
+  const cutoff = Date.now() - 24 * 60 * 60 * 1000;
+  return calendarService.getEvents(playerId)
+    .filter(event => new Date(event.endTime).getTime() > cutoff)
+    .filter(event => event.status !== 'completed' && event.status !== 'cancelled')
+    .map(toCalendarEntry);
+};
 
 // ═══════════════════════════════════════════════════════════
 // WEBSOCKET SERVER
@@ -110,96 +144,461 @@ const server = app.listen(PORT, () => {
   console.log(`═══════════════════════════════════════════════════════════\n`);
 });
 
-const wss = new WebSocketServer({ server });
+// permessage-deflate for clients whose WebSocket stack offers it (JSON clients mostly;
+// bin1 clients that negotiated zdict2 get dictionary compression instead)
+const wss = new WebSocketServer({
+  server,
+  perMessageDeflate: process.env.PERMESSAGE_DEFLATE === 'false' ? false : {
+    threshold: 1024,
+    serverNoContextTakeover: true,
+    clientNoContextTakeover: true,
+  },
+});
 
 wss.on('connection', (ws) => {
   console.log('🔌 New WebSocket connection');
   
-  let playerId = null;
+  // Sessions on this socket. A game client has one; a dedicated server multiplexes
+  // many (register with multiplex: true) and tags every message with its playerId.
+  const attached = new Map(); // playerId → session
+  let primary = null; // most recent registration; answers untagged messages
+  let wire = 'json'; // switched to bin1 once the client offers it at registration
+  let compression = false; // zdict2 frames, once a bin1 client offers it
+
+  // The session a message belongs to: by playerId when tagged, else this socket's only player
+  const sessionFor = (message) => {
+    if (message.playerId !== undefined && attached.has(message.playerId)) {
+      return attached.get(message.playerId);
+    }
+    return primary?.multiplex ? null : primary;
+  };
+
+  // Send in whichever format this connection negotiated.
+  // Every reply carries the count of client messages received, which the client uses to trim its replay buffer.
+  const send = (message, session = primary) => {
+    const payload = session ? { ...message, ack: session.received } : message;
+    if (wire === BINARY_WIRE_NAME && compression) {
+      // Already compressed; permessage-deflate would only spend CPU on it again
+      ws.send(compressFrame(encodeFrame(payload)), { binary: true, compress: false });
+    } else if (wire === BINARY_WIRE_NAME) {
+      ws.send(encodeFrame(payload), { binary: true });
+    } else {
+      ws.send(JSON.stringify(payload));
+    }
+  };
+
+  // Snapshot of a player's calendar; calendar_delta messages bring it up to date from here.
+  // Multiplexed players are game-server sessions without a local calendar.
+  const sendCalendarSync = (session) => {
+    if (session.multiplex) {
+      return;
+    }
+    send({
+      type: 'calendar_sync',
+      playerId: session.playerId,
+      revision: calendarService.getRevision(session.playerId),
+      events: upcomingCalendarEntries(session.playerId),
+    }, session);
+  };
+
+  const stopCalendarFeed = calendarService.onChange((changedPlayerId, change) => {
+    const session = attached.get(changedPlayerId);
+    if (!session || session.ws !== ws || session.multiplex) {
+      return;
+    }
+    send({
+      type: 'calendar_delta',
+      playerId: changedPlayerId,
+      revision: change.revision,
+      op: change.op,
+      event: change.event ? toCalendarEntry(change.event) : undefined,
+      eventId: change.eventId,
+    }, session);
+  });
+
+  send({
+    type: 'connected',
+    clientId: `client_${Date.now()}_${Math.random().toString(36).substring(2, 8)}`,
+    wire: ['json', BINARY_WIRE_NAME],
+    timestamp: new Date().toISOString(),
+  });
   
-  ws.on('message', async (data) => {
+  // Handle one decoded message (batch entries arrive here one at a time)
+  const handleMessage = async (message) => {
+    let session = sessionFor(message);
+    let playerId = session ? session.playerId : null;
+
+    // Replies echo the request's requestId so the client can match them, even when several are in flight,
+    // and its playerId so a multiplexing client can route them to the right player
+    const reply = (payload) => send({ requestId: message.requestId, playerId: message.playerId, ...payload }, session);
+
     try {
-      const message = JSON.parse(data.toString());
       console.log('📨 Received:', message.type);
       
       switch (message.type) {
-        case 'register':
+        case 'register': {
           playerId = message.playerId || `player_${Date.now()}`;
-          sessions.set(playerId, {
+
+          // A fresh registration replaces any session this player left behind
+          const previous = sessions.get(playerId);
+          if (previous?.expiryTimer) {
+            clearTimeout(previous.expiryTimer);
+          }
+
+          session = {
+            playerId,
             ws,
+            multiplex: !!message.multiplex,
             playerData: message,
             conversationState: {},
-          });
+            sessionToken: randomBytes(16).toString('hex'),
+            received: 0,
+            expiryTimer: null,
+          };
+          sessions.set(playerId, session);
+          attached.set(playerId, session);
+          primary = session;
           
-          ws.send(JSON.stringify({
+          // The registered reply still goes out in JSON; binary starts after it
+          const acceptBinary = message.wire === BINARY_WIRE_NAME;
+          const acceptCompression = acceptBinary && message.compression === COMPRESSION_NAME;
+          send({
             type: 'registered',
             playerId,
             message: 'Connected to AI Assistant Backend v3.0',
+            wire: acceptBinary ? BINARY_WIRE_NAME : undefined,
+            compression: acceptCompression ? COMPRESSION_NAME : undefined,
+            batch: true,
+            sessionToken: session.sessionToken,
             timestamp: new Date().toISOString(),
-          }));
+          }, session);
+          if (acceptBinary) {
+            wire = BINARY_WIRE_NAME;
+            compression = compression || acceptCompression;
+          }
+          sendCalendarSync(session);
           
-          console.log(`✅ Player registered: ${playerId}`);
+          console.log(`✅ Player registered: ${playerId}${session.multiplex ? ` (${attached.size} on this connection)` : ''}`);
           break;
+        }
+
+        case 'unregister': {
+          // A multiplexed player left; the socket stays up for the others
+          if (!session) {
+            break;
+          }
+          attached.delete(playerId);
+          if (primary === session) {
+            primary = [...attached.values()].pop() || null;
+          }
+          if (sessions.get(playerId) === session) {
+            sessions.delete(playerId);
+          }
+          voiceProcessor.clearAudioBuffers(playerId);
+          console.log(`👋 Player unregistered: ${playerId}`);
+          break;
+        }
+
+        case 'resume': {
+          // Reattach to a session kept alive after a dropped connection
+          const existing = sessions.get(message.playerId);
+          if (!existing || existing.sessionToken !== message.sessionToken) {
+            send({
+              type: 'resume_failed',
+              message: 'Session expired. Send register message.',
+              timestamp: new Date().toISOString(),
+            });
+            break;
+          }
+
+          if (existing.expiryTimer) {
+            clearTimeout(existing.expiryTimer);
+            existing.expiryTimer = null;
+          }
+          if (existing.ws && existing.ws !== ws) {
+            existing.ws.terminate();
+          }
+          existing.ws = ws;
+
+          playerId = message.playerId;
+          session = existing;
+          attached.set(playerId, session);
+          primary = session;
+
+          // ack tells the client which of its messages to replay
+          const acceptBinary = message.wire === BINARY_WIRE_NAME;
+          const acceptCompression = acceptBinary && message.compression === COMPRESSION_NAME;
+          send({
+            type: 'resumed',
+            playerId,
+            wire: acceptBinary ? BINARY_WIRE_NAME : undefined,
+            compression: acceptCompression ? COMPRESSION_NAME : undefined,
+            batch: true,
+            sessionToken: session.sessionToken,
+            timestamp: new Date().toISOString(),
+          }, session);
+          if (acceptBinary) {
+            wire = BINARY_WIRE_NAME;
+            compression = compression || acceptCompression;
+          }
+
+          // Changes made while it was away were not delivered; start it from a fresh snapshot
+          sendCalendarSync(session);
+
+          console.log(`🔁 Player resumed: ${playerId} (${session.received} messages received)`);
+          break;
+        }
           
         case 'chat':
           // FIXED: Proper error handling and AI response
           if (!playerId) {
-            ws.send(JSON.stringify({
+            reply({
               type: 'error',
               message: 'Player not registered. Send register message first.',
               timestamp: new Date().toISOString(),
-            }));
+            });
             break;
           }
           
-          // Get AI response
+          // Get AI response (streamed as chat_delta chunks when the client asks for it)
           const userMessage = message.message || message.text || '';
           const response = await aiService.chat(userMessage, {
             playerId,
             context: sessions.get(playerId)?.conversationState,
+            stream: !!message.stream,
+            onDelta: (delta) => {
+              reply({
+                type: 'chat_delta',
+                delta,
+              });
+            },
           });
           
-          ws.send(JSON.stringify({
+          // A streamed reply has already arrived as chat_delta; only close it out
+          reply({
             type: 'chat_response',
-            message: response,
+            message: message.stream ? undefined : response,
+            streamed: !!message.stream,
             timestamp: new Date().toISOString(),
-          }));
+          });
           
           console.log(`💬 Chat response sent to ${playerId}`);
           break;
           
+        case 'create_calendar_event': {
+          if (!playerId) {
+            reply({
+              type: 'error',
+              message: 'Player not registered. Send register message first.',
+              timestamp: new Date().toISOString(),
+            });
+            break;
+          }
+
+          const startTime = new Date(message.dateTime);
+          const endTime = new Date(startTime.getTime() + (message.durationMinutes || 60) * 60 * 1000);
+          const result = await calendarService.createEvent(playerId, {
+            title: message.eventName,
+            startTime,
+            endTime,
+            location: message.location,
+            notes: message.notes,
+            priority: message.priority,
+          });
+
+          reply({
+            type: result.success ? 'calendar_event_created' : 'error',
+            event: result.event,
+            message: result.error,
+            timestamp: new Date().toISOString(),
+          });
+          break;
+        }
+          
+        case 'calendar_sync': {
+          // The client missed a calendar_delta and wants a fresh snapshot
+          if (!playerId) {
+            reply({
+              type: 'error',
+              message: 'Player not registered. Send register message first.',
+              timestamp: new Date().toISOString(),
+            });
+            break;
+          }
+          sendCalendarSync(session);
+          break;
+        }
+
+        case 'voice_start':
+        case 'voice_chunk':
+        case 'voice_end': {
+          if (!playerId) {
+            reply({
+              type: 'error',
+              message: 'Player not registered. Send register message first.',
+              timestamp: new Date().toISOString(),
+            });
+            break;
+          }
+
+          const streamId = message.streamId || 0;
+
+          if (message.type === 'voice_start') {
+            const started = voiceProcessor.startStream(playerId, streamId, {
+              sampleRate: message.sampleRate,
+              channels: message.channels,
+              encoding: message.encoding,
+            });
+            if (!started.success) {
+              reply({
+                type: 'error',
+                streamId,
+                message: started.error,
+                timestamp: new Date().toISOString(),
+              });
+            }
+            break;
+          }
+
+          if (message.type === 'voice_chunk') {
+            // Audio arrives as raw bytes in bin1 frames, base64 in JSON
+            const partial = await voiceProcessor.appendChunk(playerId, streamId, message.seq, message.audio);
+            if (partial?.error) {
+              reply({
+                type: 'error',
+                streamId,
+                message: partial.error,
+                timestamp: new Date().toISOString(),
+              });
+            } else if (partial) {
+              reply({
+                type: 'voice_partial',
+                streamId,
+                transcription: partial,
+              });
+            }
+            break;
+          }
+
+          // voice_end: final transcription, then answer it like a chat message
+          const result = await voiceProcessor.endStream(playerId, streamId);
+          if (!result.success) {
+            reply({
+              type: 'error',
+              message: result.error,
+              timestamp: new Date().toISOString(),
+            });
+            break;
+          }
+
+          const aiResponse = result.transcription
+            ? await aiService.chat(result.transcription, {
+              playerId,
+              context: sessions.get(playerId)?.conversationState,
+            })
+            : '';
+
+          reply({
+            type: 'voice_processed',
+            streamId,
+            transcription: result.transcription,
+            aiResponse,
+            timestamp: new Date().toISOString(),
+          });
+
+          console.log(`🎤 Voice stream ${streamId} processed for ${playerId}`);
+          break;
+        }
+
+        case 'ping':
+          reply({
+            type: 'pong',
+            timestamp: new Date().toISOString(),
+          });
+          break;
+
         case 'voice':
           // Voice transcription (future implementation)
-          ws.send(JSON.stringify({
+          reply({
             type: 'voice_response',
             message: 'Voice processing not yet implemented',
             timestamp: new Date().toISOString(),
-          }));
+          });
           break;
           
         default:
           console.log(`⚠️  Unknown message type: ${message.type}`);
-          ws.send(JSON.stringify({
+          reply({
             type: 'error',
             message: `Unknown message type: ${message.type}`,
             timestamp: new Date().toISOString(),
-          }));
+          });
       }
     } catch (error) {
       console.error('❌ Error processing message:', error);
-      ws.send(JSON.stringify({
+      reply({
         type: 'error',
         message: error.message,
         timestamp: new Date().toISOString(),
-      }));
+      });
+    }
+  };
+
+  ws.on('message', (data, isBinary) => {
+    let message;
+    try {
+      message = isBinary ? decodeFrame(data) : JSON.parse(data.toString());
+    } catch (error) {
+      console.error('❌ Error decoding message:', error);
+      send({
+        type: 'error',
+        message: error.message,
+        timestamp: new Date().toISOString(),
+      });
+      return;
+    }
+
+    // Start batched messages in order, exactly as if they had arrived as separate frames
+    const entries = message.type === 'batch' && Array.isArray(message.messages) ? message.messages : [message];
+    for (const entry of entries) {
+      const session = sessionFor(entry);
+      if (session && !CONTROL_MESSAGE_TYPES.has(entry.type)) {
+        session.received++;
+      }
+      handleMessage(entry);
     }
   });
   
   ws.on('close', () => {
-    if (playerId) {
-      sessions.delete(playerId);
-      console.log(`👋 Player disconnected: ${playerId}`);
+    stopCalendarFeed();
+    for (const [closedPlayerId, closedSession] of attached) {
+      // A resumed session has already moved to another socket
+      if (closedSession.ws !== ws) {
+        continue;
+      }
+
+      closedSession.ws = null;
+      voiceProcessor.clearAudioBuffers(closedPlayerId);
+
+      // Multiplexed players register again on the next connection; they are not resumed
+      if (closedSession.multiplex) {
+        if (sessions.get(closedPlayerId) === closedSession) {
+          sessions.delete(closedPlayerId);
+        }
+        continue;
+      }
+
+      // Keep the session for a while so the client can resume instead of re-registering
+      closedSession.expiryTimer = setTimeout(() => {
+        if (sessions.get(closedPlayerId) === closedSession) {
+          sessions.delete(closedPlayerId);
+          console.log(`🗑️  Session expired: ${closedPlayerId}`);
+        }
+      }, SESSION_GRACE_MS);
+
+      console.log(`👋 Player disconnected: ${closedPlayerId} (session kept ${SESSION_GRACE_MS}ms)`);
     }
+    attached.clear();
   });
   
   ws.on('error', (error) => {
@@ -119,24 +119,7 @@ export class MultiModelAIService {
 
       } catch (error) {
         console.error(`[MultiModelAI] ❌ ${modelName} failed:`, error.message);
-        
-        // Update error tracking
-        this.usage[modelName].errors++;
-        this.availability[modelName].errorCount++;
-        this.availability[modelName].lastError = error.message;
-
-        // Circuit breaker: disable model after 3 consecutive errors
-        if (this.availability[modelName].errorCount >= 3) {
-          this.availability[modelName].available = false;
-          console.log(`[MultiModelAI] 🚫 ${modelName} disabled due to repeated errors`);
-          
-          // Re-enable after 5 minutes
-          setTimeout(() => {
-            this.availability[modelName].available = true;
-            this.availability[modelName].errorCount = 0;
-            console.log(`[MultiModelAI] ✅ ${modelName} re-enabled`);
-          }, 5 * 60 * 1000);
-        }
+        this.recordModelError(modelName, error);
 
         // Continue to next model
         continue;
@@ -151,6 +134,128 @@ export class MultiModelAIService {
     };
   }
 
+  /**
+   * Stream chat completion with automatic failover
+   * Failover only happens before the first chunk; once text has been
+   * delivered to the caller a failure ends the stream.
+   * @param {Array} messages - Chat messages
+   * @param {Function} onDelta - Called with each text chunk as it arrives
+   * @param {Object} options - Generation options (same as generateCompletion)
+   * @returns {Promise<Object>} - Response with the full content
+   */
+  async streamCompletion(messages, onDelta, options = {}) {
+    const {
+      temperature = 0.7,
+      maxTokens = 500,
+      preferredModel = null,
+      taskType = 'general'
+    } = options;
+
+    const modelPriority = this.getModelPriority(taskType, preferredModel);
+
+    for (const modelName of modelPriority) {
+      if (!this.isModelAvailable(modelName)) {
+        continue;
+      }
+
+      let content = '';
+      const emit = (text) => {
+        if (text) {
+          content += text;
+          onDelta(text);
+        }
+      };
+
+      try {
+        await this.streamModel(modelName, messages, { temperature, maxTokens }, emit);
+
+        // Providers don't report usage on streamed responses; estimate ~4 chars per token
+        const tokens = Math.ceil(content.length / 4);
+        const cost = (tokens / 1000) * this.config[modelName].costPer1kTokens;
+
+        this.usage[modelName].requests++;
+        this.usage[modelName].tokens += tokens;
+        this.usage[modelName].cost += cost;
+        this.availability[modelName].errorCount = 0;
+
+        return {
+          success: true,
+          model: modelName,
+          content,
+          tokens,
+          cost
+        };
+
+      } catch (error) {
+        console.error(`[MultiModelAI] ❌ ${modelName} stream failed:`, error.message);
+        this.recordModelError(modelName, error);
+
+        if (content.length > 0) {
+          return {
+            success: false,
+            model: modelName,
+            content,
+            error: error.message
+          };
+        }
+      }
+    }
+
+    return {
+      success: false,
+      error: 'All AI models failed',
+      details: this.getAvailabilityStatus()
+    };
+  }
+
+  /**
+   * Simple chat helper used by the WebSocket server
+   * @param {string} userMessage - Player message
+   * @param {Object} options - { playerId, context, stream, onDelta }
+   * @returns {Promise<string>} - Response text; throws if the model failed, even after streaming some of it
+   */
+  async chat(userMessage, options = {}) {
+    const messages = [
+      { role: 'system', content: 'You are a helpful AI companion inside a game.' },
+      { role: 'user', content: userMessage }
+    ];
+
+    const result = options.stream && options.onDelta
+      ? await this.streamCompletion(messages, options.onDelta, { taskType: 'conversation' })
+      : await this.generateCompletion(messages, { taskType: 'conversation' });
+
+    // Includes a stream that failed part-way: the text already sent is incomplete
+    if (!result.success || !result.content) {
+      throw new Error(result.error || 'No response from AI');
+    }
+
+    return result.content;
+  }
+
+  /**
+   * Track a model failure and trip the circuit breaker
+   * @param {string} modelName - Model name
+   * @param {Error} error - Error raised by the provider
+   */
+  recordModelError(modelName, error) {
+    this.usage[modelName].errors++;
+    this.availability[modelName].errorCount++;
+    this.availability[modelName].lastError = error.message;
+
+    // Circuit breaker: disable model after 3 consecutive errors
+    if (this.availability[modelName].errorCount >= 3) {
+      this.availability[modelName].available = false;
+      console.log(`[MultiModelAI] 🚫 ${modelName} disabled due to repeated errors`);
+      
+      // Re-enable after 5 minutes
+      setTimeout(() => {
+        this.availability[modelName].available = true;
+        this.availability[modelName].errorCount = 0;
+        console.log(`[MultiModelAI] ✅ ${modelName} re-enabled`);
+      }, 5 * 60 * 1000);
+    }
+  }
+
   /**
    * Call specific model
    * @param {string} modelName - Model name
@@ -257,6 +362,76 @@ export class MultiModelAIService {
     };
   }
 
+  /**
+   * Stream from specific model
+   * @param {string} modelName - Model name
+   * @param {Array} messages - Messages
+   * @param {Object} options - Options
+   * @param {Function} emit - Receives each text chunk
+   */
+  async streamModel(modelName, messages, options, emit) {
+    switch (modelName) {
+      case 'openai': {
+        const stream = await this.clients.openai.chat.completions.create({
+          model: this.config.openai.model,
+          messages,
+          temperature: options.temperature,
+          max_tokens: options.maxTokens,
+          stream: true
+        });
+        for await (const chunk of stream) {
+          emit(chunk.choices[0]?.delta?.content);
+        }
+        return;
+      }
+
+      case 'anthropic': {
+        const systemMessage = messages.find(m => m.role === 'system');
+        const stream = await this.clients.anthropic.messages.create({
+          model: this.config.anthropic.model,
+          system: systemMessage ? systemMessage.content : undefined,
+          messages: messages.filter(m => m.role !== 'system').map(m => ({
+            role: m.role === 'assistant' ? 'assistant' : 'user',
+            content: m.content
+          })),
+          temperature: options.temperature,
+          max_tokens: options.maxTokens,
+          stream: true
+        });
+        for await (const event of stream) {
+          if (event.type === 'content_block_delta') {
+            emit(event.delta?.text);
+          }
+        }
+        return;
+      }
+
+      case 'gemini': {
+        const model = this.clients.gemini.getGenerativeModel({
+          model: this.config.gemini.model
+        });
+        const prompt = messages.map(m => {
+          const role = m.role === 'assistant' ? 'model' : 'user';
+          return `${role}: ${m.content}`;
+        }).join('\n\n');
+        const result = await model.generateContentStream({
+          contents: [{ role: 'user', parts: [{ text: prompt }] }],
+          generationConfig: {
+            temperature: options.temperature,
+            maxOutputTokens: options.maxTokens
+          }
+        });
+        for await (const chunk of result.stream) {
+          emit(chunk.text());
+        }
+        return;
+      }
+
+      default:
+        throw new Error(`Unknown model: ${modelName}`);
+    }
+  }
+
   /**
    * Get model priority based on task type
    * @param {string} taskType - Task type
@@ -3,10 +3,206 @@
  * Handles voice data processing, transcription, and audio management
  */
 
+// Formats a voice_start may ask for
+const MIN_SAMPLE_RATE = 8000;
+const MAX_SAMPLE_RATE = 48000;
+const MAX_CHANNELS = 2;
+
 export class VoiceProcessor {
-  constructor() {
+  constructor(options = {}) {
     this.audioBuffers = new Map();
     this.processingQueue = [];
+
+    // Streamed uploads in progress: `${playerId}:${streamId}` → stream state
+    this.streams = new Map();
+
+    // Seconds of new audio between partial transcriptions
+    this.partialIntervalSeconds = options.partialIntervalSeconds || 1.0;
+
+    // Audio from before the last partial that is sent again with the next one,
+    // so a word cut at the window edge is still heard whole
+    this.partialOverlapSeconds = options.partialOverlapSeconds ?? 0.3;
+
+    // Limits on what one client can make the server hold
+    this.maxStreamSeconds = options.maxStreamSeconds || 120;
+    this.maxStreamsPerPlayer = options.maxStreamsPerPlayer || 2;
+  }
+
+  /**
+   * Begin a streamed voice upload
+   * @param {string} playerId - The player's ID
+   * @param {number} streamId - Client-assigned stream ID
+   * @param {Object} format - { sampleRate, channels, encoding }
+   * @returns {Object} - { success, error }
+   */
+  startStream(playerId, streamId, format = {}) {
+    const sampleRate = format.sampleRate ?? 16000;
+    const channels = format.channels ?? 1;
+    if (!Number.isInteger(sampleRate) || sampleRate < MIN_SAMPLE_RATE || sampleRate > MAX_SAMPLE_RATE
+      || !Number.isInteger(channels) || channels < 1 || channels > MAX_CHANNELS) {
+      return { success: false, error: `Unsupported voice format: ${sampleRate} Hz, ${channels} channels` };
+    }
+
+    const key = `${playerId}:${streamId}`;
+    if (!this.streams.has(key) && this.countStreams(playerId) >= this.maxStreamsPerPlayer) {
+      return { success: false, error: `Too many voice streams (at most ${this.maxStreamsPerPlayer})` };
+    }
+
+    const bytesPerSecond = sampleRate * channels * 2;
+    this.streams.set(key, {
+      // One growing buffer; only the first `bytes` are audio
+      audio: Buffer.allocUnsafe(bytesPerSecond * 4),
+      bytes: 0,
+      maxBytes: bytesPerSecond * this.maxStreamSeconds,
+      chunkCount: 0,
+      nextSeq: 0,
+      sampleRate,
+      channels,
+      encoding: format.encoding || 'pcm16',
+      bytesPerSecond,
+      partialAtBytes: 0,
+      partialText: '',
+      transcribing: false,
+      ended: false,
+      startedAt: Date.now(),
+    });
+
+    console.log(`[VoiceProcessor] Stream ${streamId} started for player: ${playerId} (${sampleRate} Hz)`);
+    return { success: true };
+  }
+
+  /**
+   * Streams a player has open
+   * @param {string} playerId - The player's ID
+   * @returns {number}
+   */
+  countStreams(playerId) {
+    const prefix = `${playerId}:`;
+    let count = 0;
+    for (const key of this.streams.keys()) {
+      if (key.startsWith(prefix)) {
+        count++;
+      }
+    }
+    return count;
+  }
+
+  /**
+   * Add one chunk to a streamed upload
+   * The chunk is stored immediately; the returned promise resolves to a partial
+   * transcription when enough new audio has arrived, otherwise null.
+   * Each partial only transcribes the audio since the previous one (plus a short
+   * overlap) and is merged onto the text so far, so cost stays linear in the
+   * stream length.
+   * @param {string} playerId - The player's ID
+   * @param {number} streamId - Client-assigned stream ID
+   * @param {number} seq - Chunk sequence number (0-based)
+   * A chunk that would take the stream past maxStreamSeconds ends it; the
+   * promise then resolves to { error } instead.
+   * @param {Buffer|string} audio - PCM chunk (buffer or base64)
+   * @returns {Promise<string|Object|null>} - Partial transcription, { error }, or null
+   */
+  async appendChunk(playerId, streamId, seq, audio) {
+    const key = `${playerId}:${streamId}`;
+    const stream = this.streams.get(key);
+    if (!stream || stream.ended) {
+      return null;
+    }
+
+    // Duplicates (e.g. replays) are dropped; the socket keeps order otherwise
+    if (typeof seq === 'number' && seq < stream.nextSeq) {
+      return null;
+    }
+    stream.nextSeq = typeof seq === 'number' ? seq + 1 : stream.nextSeq + 1;
+
+    const buffer = typeof audio === 'string' ? Buffer.from(audio, 'base64') : audio;
+    if (!buffer || buffer.length === 0) {
+      return null;
+    }
+    if (stream.bytes + buffer.length > stream.maxBytes) {
+      stream.ended = true;
+      this.streams.delete(key);
+      console.warn(`[VoiceProcessor] Stream ${streamId} for player ${playerId} passed ${this.maxStreamSeconds}s; dropped`);
+      return { error: `Voice stream ${streamId} is longer than ${this.maxStreamSeconds} seconds` };
+    }
+    this.appendAudio(stream, buffer);
+
+    // One partial at a time per stream
+    const intervalBytes = stream.bytesPerSecond * this.partialIntervalSeconds;
+    if (stream.transcribing || stream.bytes - stream.partialAtBytes < intervalBytes) {
+      return null;
+    }
+
+    // Whole frames only, so the window never starts mid-sample
+    const frameBytes = stream.channels * 2;
+    const overlapBytes = Math.floor(stream.bytesPerSecond * this.partialOverlapSeconds / frameBytes) * frameBytes;
+    const windowStart = Math.max(0, stream.partialAtBytes - overlapBytes);
+
+    stream.transcribing = true;
+    stream.partialAtBytes = stream.bytes;
+    try {
+      // A view, not a copy; later chunks may move `audio` but never this window's bytes
+      const text = await this.transcribeAudio(stream.audio.subarray(windowStart, stream.partialAtBytes), {
+        sampleRate: stream.sampleRate,
+        channels: stream.channels,
+        encoding: stream.encoding,
+        partial: true,
+        prompt: stream.partialText,
+      });
+      if (stream.ended) {
+        return null;
+      }
+      stream.partialText = mergeTranscripts(stream.partialText, text);
+      return stream.partialText;
+    } finally {
+      stream.transcribing = false;
+    }
+  }
+
+  /**
+   * Finish a streamed upload and produce the final transcription
+   * @param {string} playerId - The player's ID
+   * @param {number} streamId - Client-assigned stream ID
+   * @returns {Promise<Object>} - Same result shape as processVoiceData
+   */
+  async endStream(playerId, streamId) {
+    const key = `${playerId}:${streamId}`;
+    const stream = this.streams.get(key);
+    if (!stream) {
+      return {
+        success: false,
+        error: `Unknown voice stream ${streamId}`,
+        timestamp: new Date().toISOString()
+      };
+    }
+
+    stream.ended = true;
+    this.streams.delete(key);
+
+    console.log(`[VoiceProcessor] Stream ${streamId} ended: ${stream.chunkCount} chunks, ${stream.bytes} bytes in ${Date.now() - stream.startedAt}ms`);
+
+    return this.processVoiceData(playerId, stream.audio.subarray(0, stream.bytes), {
+      sampleRate: stream.sampleRate,
+      channels: stream.channels,
+      encoding: stream.encoding,
+    });
+  }
+
+  /**
+   * Append one chunk to a stream's buffer, doubling it when full
+   * @param {Object} stream - Stream state from startStream
+   * @param {Buffer} buffer - PCM chunk
+   */
+  appendAudio(stream, buffer) {
+    const needed = stream.bytes + buffer.length;
+    if (needed > stream.audio.length) {
+      const grown = Buffer.allocUnsafe(Math.max(needed, stream.audio.length * 2));
+      stream.audio.copy(grown, 0, 0, stream.bytes);
+      stream.audio = grown;
+    }
+    buffer.copy(stream.audio, stream.bytes);
+    stream.bytes = needed;
+    stream.chunkCount++;
   }
 
   /**
@@ -172,6 +368,12 @@ export class VoiceProcessor {
    */
   clearAudioBuffers(playerId) {
     this.audioBuffers.delete(playerId);
+    for (const [key, stream] of this.streams.entries()) {
+      if (key.startsWith(`${playerId}:`)) {
+        stream.ended = true;
+        this.streams.delete(key);
+      }
+    }
     console.log(`[VoiceProcessor] Cleared audio buffers for player: ${playerId}`);
   }
 
@@ -196,4 +398,29 @@ export class VoiceProcessor {
   }
 }
 
+/**
+ * Join a partial transcription window onto the text before it
+ * The window starts with a little audio the previous one already covered, so the
+ * longest run of words ending `previous` and starting `next` is only kept once.
+ * @param {string} previous - Text so far
+ * @param {string} next - Transcription of the latest window
+ * @returns {string} - Combined text
+ */
+export function mergeTranscripts(previous, next) {
+  const before = previous.split(/\s+/).filter(Boolean);
+  const after = next.split(/\s+/).filter(Boolean);
+  const normalize = (word) => word.toLowerCase().replace(/[^\p{L}\p{N}']/gu, '');
+
+  for (let overlap = Math.min(before.length, after.length); overlap > 0; overlap--) {
+    let matches = true;
+    for (let i = 0; i < overlap && matches; i++) {
+      matches = normalize(before[before.length - overlap + i]) === normalize(after[i]);
+    }
+    if (matches) {
+      return [...before, ...after.slice(overlap)].join(' ');
+    }
+  }
+  return [...before, ...after].join(' ');
+}
+
 export default VoiceProcessor;
@@ -0,0 +1,408 @@
+/**
+ * Wire Protocol Module
+ * Compact "bin1" binary framing used alongside JSON on the WebSocket channel
+ *
+ * Layout (mirrored in AICompanionProtocol.cpp - keep the tables in sync):
+ *
+ *   Frame := 0xAC Version(0x01) Flags(u8) TypeId(u8) [Str TypeName if TypeId == 0] Field* 0xFF
+ *   Field := KeyId(u8) [Str KeyName if KeyId == 0] Tag(u8) Value
+ *   Tag   := 0 null | 1 false | 2 true | 3 int (zigzag varint) | 4 string (Str)
+ *            5 bytes (varint length + raw) | 6 json (Str holding JSON text) | 7 double (8 bytes LE)
+ *   Str   := varint byte length + UTF-8
+ *
+ * Flags bit1 marks a batch frame carrying whole frames (client -> server only):
+ *
+ *   Batch := 0xAC Version(0x01) Flags(0x02) Count(varint) (varint length + Frame)*
+ *
+ * A decoded batch is returned as { type: 'batch', messages: [...] },
+ * the same shape as a JSON batch. Entries are plain frames: a batch inside a
+ * batch, or an entry of its own compressed, is rejected, and a batch holds at
+ * most MAX_BATCH_ENTRIES.
+ *
+ * Flags bit0 marks a compressed frame. Everything after Flags is raw deflate,
+ * primed with COMPRESSION_DICTIONARY:
+ *
+ *   Compressed := 0xAC Version(0x01) Flags(bit0 set) RawLength(varint) Deflate
+ *
+ * Inflating gives back the bytes that followed Flags, so clearing bit0 and
+ * appending them reconstructs the ordinary frame. Only the outermost frame may
+ * be compressed, so one received frame inflates at most once.
+ *
+ * A client offers the format with `wire: 'bin1'` in its register message;
+ * the server echoes it in `registered` and both sides switch to binary.
+ * Compression is offered the same way with `compression: 'zdict2'`.
+ */
+
+import zlib from 'zlib';
+
+export const BINARY_WIRE_NAME = 'bin1';
+export const COMPRESSION_NAME = 'zdict2';
+
+const MAGIC = 0xAC;
+const VERSION = 1;
+const END_OF_FIELDS = 0xFF;
+const FLAG_BATCH = 0x02;
+const FLAG_DEFLATE = 0x01;
+
+// Frames smaller than this are not worth compressing
+const COMPRESSION_MIN_BYTES = parseInt(process.env.COMPRESSION_MIN_BYTES) || 256;
+
+// Largest frame accepted once inflated
+const MAX_INFLATED_BYTES = 16 * 1024 * 1024;
+
+// Most entries accepted in one batch frame; the client's 16 KB batch budget stays well under it
+const MAX_BATCH_ENTRIES = 1024;
+
+// Preset dictionary: nested event fields, type names and phrases common in replies.
+// Byte-for-byte identical to Dictionary in AICompanionProtocol.cpp; changing it needs a new COMPRESSION_NAME
+// (zdict1 -> zdict2 dropped a hard-coded year). Nothing in it may go stale: timestamps share only the century "20".
+// Least common first, since deflate reaches the end of the dictionary most cheaply.
+const COMPRESSION_DICTIONARY = Buffer.from(
+  'Google Calendar' + 'dentist appointment' + 'doctor' + 'birthday' + 'deadline' + 'workout' +
+  'dinner' + 'lunch with ' + 'budget' + 'spending' + 'this month' + 'next week' + 'next month' +
+  'weekend' + 'Monday' + 'Tuesday' + 'Wednesday' + 'Thursday' + 'Friday' + 'Saturday' + 'Sunday' +
+  'January' + 'February' + 'March' + 'April' + 'May' + 'June' + 'July' + 'August' + 'September' +
+  'October' + 'November' + 'December' + '"status":"rescheduled"' + '"status":"completed"' +
+  '"status":"cancelled"' + '{"eventId":"evt_' + '","title":"' + '","startTime":"20' + '","endTime":"20' +
+  '","location":"' + '","priority":' + ',"status":"scheduled"}' + '"eventName":"' + '"dateTime":"20' +
+  '"durationMinutes":' + '"notes":"' + '"description":"' + '"reminders":["24h","1h"]' + '"playerId":"' +
+  '"requestId":' + '"timestamp":"20' + '"message":"' + '"type":"' + '"text":"' +
+  'calendar_event_created' + 'calendar_delta' + 'calendar_sync' + 'chat_response' + 'chat_delta' +
+  'voice_processed' + 'T00:00:00.000Z' + ':00.000Z' + 'Is there anything else ' +
+  'Let me know if you ' + 'Would you like me to ' + 'I can help you with that' +
+  'Here is what I found' + 'Here are ' + 'Sure! ' + 'Of course' + 'Great question' +
+  'I would be happy to help' + 'a reminder' + 'your calendar' + 'your schedule' + 'scheduled for ' +
+  'appointment' + 'meeting with ' + 'reminder ' + ' tomorrow' + ' today' + ' tonight' + ' at ' +
+  ' p.m.' + ' a.m.' + ' PM' + ' AM' + ' minutes' + ' hours' + ' hour' + 'It looks like ' + 'I think ' +
+  'I have ' + 'I will ' + 'I\'ll ' + 'I\'m ' + 'you\'re ' + 'don\'t ' + 'it\'s ' + 'that\'s ' +
+  ' would ' + ' could ' + ' should ' + ' about ' + ' there ' + ' their ' + ' which ' + ' when ' +
+  ' what ' + ' this ' + ' that ' + ' with ' + ' from ' + ' have ' + ' your ' + ' you ' + ' for ' +
+  ' and ' + ' the ' + ' to ' + ' of ' + ' in ' + ' is ' + ' it ' + '. ' + ', ',
+  'latin1'
+);
+
+const TAG_NULL = 0;
+const TAG_FALSE = 1;
+const TAG_TRUE = 2;
+const TAG_INT = 3;
+const TAG_STRING = 4;
+const TAG_BYTES = 5;
+const TAG_JSON = 6;
+const TAG_DOUBLE = 7;
+
+// Index = wire id. Id 0 means the name follows inline.
+const TYPE_NAMES = [
+  null,
+  'connected',
+  'register',
+  'registered',
+  'chat',
+  'chat_response',
+  'chat_delta',
+  'voice',
+  'voice_processed',
+  'error',
+  'ping',
+  'pong',
+  'create_calendar_event',
+  'calendar_event_created',
+  'voice_start',
+  'voice_chunk',
+  'voice_end',
+  'voice_partial',
+  'resume',
+  'resumed',
+  'resume_failed',
+  'calendar_sync',
+  'calendar_delta',
+];
+
+const KEY_NAMES = [
+  null,
+  'text',
+  'message',
+  'delta',
+  'playerId',
+  'clientId',
+  'transcription',
+  'aiResponse',
+  'error',
+  'stream',
+  'streamed',
+  'timestamp',
+  'eventName',
+  'dateTime',
+  'durationMinutes',
+  'location',
+  'notes',
+  'priority',
+  'event',
+  'wire',
+  'streamId',
+  'seq',
+  'audio',
+  'sampleRate',
+  'channels',
+  'encoding',
+  'batch',
+  'ack',
+  'sessionToken',
+  'requestId',
+  'revision',
+  'events',
+  'op',
+  'eventId',
+];
+
+const TYPE_IDS = new Map(TYPE_NAMES.map((name, id) => [name, id]));
+const KEY_IDS = new Map(KEY_NAMES.map((name, id) => [name, id]));
+
+/**
+ * Growable byte buffer for encoding
+ */
+class ByteWriter {
+  constructor(size = 256) {
+    this.buffer = Buffer.allocUnsafe(size);
+    this.length = 0;
+  }
+
+  ensure(extra) {
+    if (this.length + extra > this.buffer.length) {
+      const grown = Buffer.allocUnsafe(Math.max(this.buffer.length * 2, this.length + extra));
+      this.buffer.copy(grown, 0, 0, this.length);
+      this.buffer = grown;
+    }
+  }
+
+  byte(value) {
+    this.ensure(1);
+    this.buffer[this.length++] = value;
+  }
+
+  varint(value) {
+    // Numbers up to 2^53 - use division rather than 32-bit shifts
+    do {
+      let byte = value % 128;
+      value = Math.floor(value / 128);
+      if (value > 0) byte |= 0x80;
+      this.byte(byte);
+    } while (value > 0);
+  }
+
+  raw(data) {
+    this.varint(data.length);
+    this.ensure(data.length);
+    data.copy(this.buffer, this.length);
+    this.length += data.length;
+  }
+
+  string(value) {
+    const byteLength = Buffer.byteLength(value, 'utf8');
+    this.varint(byteLength);
+    this.ensure(byteLength);
+    this.buffer.write(value, this.length, byteLength, 'utf8');
+    this.length += byteLength;
+  }
+
+  double(value) {
+    this.ensure(8);
+    this.buffer.writeDoubleLE(value, this.length);
+    this.length += 8;
+  }
+
+  result() {
+    return this.buffer.subarray(0, this.length);
+  }
+}
+
+/**
+ * Encode a message object into a bin1 frame
+ * @param {Object} message - Message with a string `type` field
+ * @returns {Buffer} - Encoded frame
+ */
+export function encodeFrame(message) {
+  const writer = new ByteWriter();
+  const typeId = TYPE_IDS.get(message.type) || 0;
+
+  writer.byte(MAGIC);
+  writer.byte(VERSION);
+  writer.byte(0);
+  writer.byte(typeId);
+  if (typeId === 0) {
+    writer.string(String(message.type));
+  }
+
+  for (const [key, value] of Object.entries(message)) {
+    if (key === 'type' || value === undefined) continue;
+
+    const keyId = KEY_IDS.get(key) || 0;
+    writer.byte(keyId);
+    if (keyId === 0) {
+      writer.string(key);
+    }
+
+    if (value === null) {
+      writer.byte(TAG_NULL);
+    } else if (typeof value === 'boolean') {
+      writer.byte(value ? TAG_TRUE : TAG_FALSE);
+    } else if (typeof value === 'number') {
+      if (Number.isSafeInteger(value)) {
+        writer.byte(TAG_INT);
+        writer.varint(value >= 0 ? value * 2 : -value * 2 - 1);
+      } else {
+        writer.byte(TAG_DOUBLE);
+        writer.double(value);
+      }
+    } else if (typeof value === 'string') {
+      writer.byte(TAG_STRING);
+      writer.string(value);
+    } else if (Buffer.isBuffer(value)) {
+      writer.byte(TAG_BYTES);
+      writer.raw(value);
+    } else {
+      writer.byte(TAG_JSON);
+      writer.string(JSON.stringify(value));
+    }
+  }
+
+  writer.byte(END_OF_FIELDS);
+  return writer.result();
+}
+
+/**
+ * Compress an encoded bin1 frame for a client that negotiated COMPRESSION_NAME
+ * @param {Buffer} frame - Frame from encodeFrame
+ * @returns {Buffer} - Compressed frame, or the frame itself if small or incompressible
+ */
+export function compressFrame(frame) {
+  if (frame.length < COMPRESSION_MIN_BYTES || frame[2] & FLAG_DEFLATE) {
+    return frame;
+  }
+
+  const body = frame.subarray(3);
+  const deflated = zlib.deflateRawSync(body, { dictionary: COMPRESSION_DICTIONARY });
+
+  const writer = new ByteWriter(deflated.length + 16);
+  writer.byte(MAGIC);
+  writer.byte(VERSION);
+  writer.byte(frame[2] | FLAG_DEFLATE);
+  writer.varint(body.length);
+  writer.ensure(deflated.length);
+  deflated.copy(writer.buffer, writer.length);
+  writer.length += deflated.length;
+
+  return writer.length < frame.length ? writer.result() : frame;
+}
+
+/**
+ * Decode a bin1 frame into a message object
+ * @param {Buffer} data - Received frame
+ * @returns {Object} - Message with a `type` field
+ */
+export function decodeFrame(data) {
+  return decodeFrameAt(data, true, true);
+}
+
+/**
+ * @param {Buffer} data - Frame bytes
+ * @param {boolean} allowDeflate - Only for the received frame itself
+ * @param {boolean} allowBatch - For the received frame or what it inflated to, never a batch entry
+ * @returns {Object} - Message with a `type` field
+ */
+function decodeFrameAt(data, allowDeflate, allowBatch) {
+  let pos = 0;
+
+  const byte = () => {
+    if (pos >= data.length) throw new Error('Truncated binary frame');
+    return data[pos++];
+  };
+
+  const varint = () => {
+    let value = 0;
+    let scale = 1;
+    for (;;) {
+      const b = byte();
+      value += (b & 0x7F) * scale;
+      if (!(b & 0x80)) return value;
+      scale *= 128;
+    }
+  };
+
+  const span = () => {
+    const length = varint();
+    if (pos + length > data.length) throw new Error('Truncated binary frame');
+    const slice = data.subarray(pos, pos + length);
+    pos += length;
+    return slice;
+  };
+
+  const string = () => span().toString('utf8');
+
+  if (byte() !== MAGIC || byte() !== VERSION) {
+    throw new Error('Not a bin1 frame');
+  }
+  const flags = byte();
+  if (flags & FLAG_DEFLATE) {
+    if (!allowDeflate) throw new Error('Nested compressed frame');
+    const rawLength = varint();
+    if (rawLength > MAX_INFLATED_BYTES) throw new Error('Compressed frame too large');
+    const body = zlib.inflateRawSync(data.subarray(pos), {
+      dictionary: COMPRESSION_DICTIONARY,
+      maxOutputLength: Math.max(rawLength, 1),
+    });
+    if (body.length !== rawLength) throw new Error('Corrupt compressed frame');
+    // The inflated frame may still be a batch, but cannot inflate again
+    return decodeFrameAt(Buffer.concat([Buffer.from([MAGIC, VERSION, flags & ~FLAG_DEFLATE]), body]), false, allowBatch);
+  }
+  if (flags === FLAG_BATCH) {
+    if (!allowBatch) throw new Error('Nested batch frame');
+    const count = varint();
+    // Every entry takes at least a byte, so a larger count is a lie too
+    if (count > MAX_BATCH_ENTRIES || count > data.length - pos) throw new Error('Batch frame too large');
+    const messages = [];
+    for (let i = 0; i < count; i++) {
+      messages.push(decodeFrameAt(span(), false, false));
+    }
+    return { type: 'batch', messages };
+  }
+  if (flags !== 0) {
+    throw new Error('Unsupported bin1 flags');
+  }
+
+  const typeId = byte();
+  const message = { type: typeId === 0 ? string() : TYPE_NAMES[typeId] };
+
+  for (;;) {
+    const keyId = byte();
+    if (keyId === END_OF_FIELDS) break;
+
+    const key = keyId === 0 ? string() : KEY_NAMES[keyId] || `key_${keyId}`;
+    const tag = byte();
+
+    switch (tag) {
+      case TAG_NULL: message[key] = null; break;
+      case TAG_FALSE: message[key] = false; break;
+      case TAG_TRUE: message[key] = true; break;
+      case TAG_INT: {
+        const zigzag = varint();
+        message[key] = zigzag % 2 === 0 ? zigzag / 2 : -(zigzag + 1) / 2;
+        break;
+      }
+      case TAG_STRING: message[key] = string(); break;
+      case TAG_BYTES: message[key] = Buffer.from(span()); break;
+      case TAG_JSON: message[key] = JSON.parse(string()); break;
+      case TAG_DOUBLE: {
+        if (pos + 8 > data.length) throw new Error('Truncated binary frame');
+        message[key] = data.readDoubleLE(pos);
+        pos += 8;
+        break;
+      }
+      default:
+        throw new Error(`Unknown bin1 tag ${tag}`);
+    }
+  }
+
+  return message;
+}
+
+export default { encodeFrame, decodeFrame, compressFrame, BINARY_WIRE_NAME, COMPRESSION_NAME };